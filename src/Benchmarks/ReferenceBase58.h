@@ -0,0 +1,19 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/* The Base58 codec as it was before Tools::Base58 gained its fixed buffer
+   versions, kept so the benchmarks can measure the two side by side */
+namespace ReferenceBase58
+{
+    std::string encode(const std::string& data);
+    bool decode(const std::string& enc, std::string& data);
+
+    std::string encode_addr(uint64_t tag, const std::string& data);
+    bool decode_addr(std::string addr, uint64_t& tag, std::string& data);
+}
@@ -0,0 +1,1126 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+/* Microbenchmarks for the hot paths of the node: ring signature checks, key
+   derivations, the slow hash, Base58 addresses, (de)serialization of the big
+   sync messages, the transaction pool, the blockchain cache and the database. All the inputs are
+   generated from fixed seeds, so two runs (or two builds) measure the same
+   work, and the results can be written as JSON to compare them. */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+
+#include <cxxopts.hpp>
+#include <config/CliHeader.h>
+
+#include "json.hpp"
+
+#include <Common/Base58.h>
+#include <Common/FileSystemShim.h>
+#include <Common/StringTools.h>
+
+#include "CryptoNoteCore/BlockchainCache.h"
+#include "CryptoNoteCore/CachedBlock.h"
+#include "CryptoNoteCore/CachedTransaction.h"
+#include "CryptoNoteCore/CryptoNoteBasicImpl.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/DataBaseConfig.h"
+#include "CryptoNoteCore/ICoreDefinitions.h"
+#include "CryptoNoteCore/RocksDBWrapper.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "CryptoNoteCore/TransactionPool.h"
+#include "CryptoNoteCore/TransactionValidatiorState.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+#include "IReadBatch.h"
+#include "IWriteBatch.h"
+#include "Logging/ConsoleLogger.h"
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+#include "ReferenceBase58.h"
+#include "Serialization/SerializationTools.h"
+#include "WalletBackend/ValidateParameters.h"
+#include "crypto/crypto.h"
+#include "crypto/hash.h"
+
+using json = nlohmann::json;
+
+using namespace CryptoNote;
+
+namespace
+{
+
+const uint64_t BENCHMARK_SEED = 0x536d7574436f696e;
+
+const size_t DEFAULT_RUNS = 5;
+
+/* The sync messages are sized like a full response to a syncing peer / wallet */
+const size_t SYNC_BLOCK_COUNT = 100;
+const size_t SYNC_TRANSACTIONS_PER_BLOCK = 10;
+
+const size_t POOL_TRANSACTION_COUNT = 5000;
+
+const size_t CHAIN_BLOCK_COUNT = 2000;
+const size_t CHAIN_TRANSACTIONS_PER_BLOCK = 5;
+
+/* Half of the addresses are integrated ones */
+const size_t ADDRESS_COUNT = 100;
+
+const size_t DATABASE_BATCH_SIZE = 1000;
+const size_t DATABASE_VALUE_SIZE = 1024;
+
+struct BenchmarkResult
+{
+    std::string name;
+
+    /* Operations timed per run */
+    uint64_t iterations;
+
+    /* Nanoseconds per operation, one entry per run */
+    std::vector<double> runs;
+
+    double min() const
+    {
+        return *std::min_element(runs.begin(), runs.end());
+    }
+
+    double max() const
+    {
+        return *std::max_element(runs.begin(), runs.end());
+    }
+
+    double mean() const
+    {
+        return std::accumulate(runs.begin(), runs.end(), 0.0) / runs.size();
+    }
+
+    double median() const
+    {
+        std::vector<double> sorted = runs;
+        std::sort(sorted.begin(), sorted.end());
+
+        const size_t middle = sorted.size() / 2;
+
+        return sorted.size() % 2 == 0 ? (sorted[middle - 1] + sorted[middle]) / 2 : sorted[middle];
+    }
+};
+
+class BenchmarkRunner
+{
+  public:
+    BenchmarkRunner(const std::string &filter, size_t runs) :
+        m_filter(filter),
+        m_runs(runs)
+    {
+    }
+
+    bool enabled(const std::string &name) const
+    {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    /* Whether any of a group's benchmarks will run. Checked before building
+       the group's fixtures, so the filter skips their setup as well */
+    bool anyEnabled(const std::vector<std::string> &names) const
+    {
+        return std::any_of(names.begin(), names.end(), [this](const std::string &name)
+        {
+            return enabled(name);
+        });
+    }
+
+    /* Times `iterations` calls of operation(i), m_runs times over. setup is
+       called before every run, and is not timed. */
+    void run(
+        const std::string &name,
+        const uint64_t iterations,
+        const std::function<void(uint64_t)> &operation,
+        const std::function<void()> &setup = {})
+    {
+        if (!enabled(name))
+        {
+            return;
+        }
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+
+        for (size_t run = 0; run < m_runs; run++)
+        {
+            if (setup)
+            {
+                setup();
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                operation(i);
+            }
+
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+
+            result.runs.push_back(
+                std::chrono::duration<double, std::nano>(elapsed).count() / iterations
+            );
+        }
+
+        std::cout << std::left << std::setw(56) << name
+                  << std::right << std::setw(16) << std::fixed << std::setprecision(0) << result.median() << " ns/op"
+                  << std::setw(16) << std::setprecision(1) << (1e9 / result.median()) << " op/s" << std::endl;
+
+        m_results.push_back(result);
+    }
+
+    json toJson() const
+    {
+        json benchmarks = json::array();
+
+        for (const auto &result : m_results)
+        {
+            benchmarks.push_back({
+                {"name", result.name},
+                {"iterations", result.iterations},
+                {"runs", result.runs},
+                {"minNanoseconds", result.min()},
+                {"medianNanoseconds", result.median()},
+                {"meanNanoseconds", result.mean()},
+                {"maxNanoseconds", result.max()},
+                {"operationsPerSecond", 1e9 / result.median()}
+            });
+        }
+
+        return {
+            {"version", PROJECT_VERSION_LONG},
+            {"runs", m_runs},
+            {"benchmarks", benchmarks}
+        };
+    }
+
+  private:
+    const std::string m_filter;
+
+    const size_t m_runs;
+
+    std::vector<BenchmarkResult> m_results;
+};
+
+template <typename T>
+T randomPod(std::mt19937_64 &generator)
+{
+    T result;
+
+    uint8_t *bytes = reinterpret_cast<uint8_t *>(&result);
+
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        bytes[i] = static_cast<uint8_t>(generator());
+    }
+
+    return result;
+}
+
+KeyPair deterministicKeys(std::mt19937_64 &generator)
+{
+    Crypto::SecretKey seed = randomPod<Crypto::SecretKey>(generator);
+
+    KeyPair keys;
+    Crypto::generate_deterministic_keys(keys.publicKey, keys.secretKey, seed);
+
+    return keys;
+}
+
+/* A transaction shaped like a real one. The keys and signatures are random
+   bytes, which is fine for everything but signature checks. */
+Transaction makeTransaction(std::mt19937_64 &generator, size_t inputCount, size_t ringSize, size_t outputCount)
+{
+    Transaction transaction;
+    transaction.version = CURRENT_TRANSACTION_VERSION;
+    transaction.unlockTime = 0;
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        KeyInput input;
+        input.amount = 1000 + generator() % 1000000;
+        input.keyImage = randomPod<Crypto::KeyImage>(generator);
+
+        for (size_t j = 0; j < ringSize; j++)
+        {
+            input.outputIndexes.push_back(static_cast<uint32_t>(generator() % 10000));
+        }
+
+        transaction.inputs.push_back(input);
+        transaction.signatures.push_back(std::vector<Crypto::Signature>(ringSize));
+
+        for (auto &signature : transaction.signatures.back())
+        {
+            signature = randomPod<Crypto::Signature>(generator);
+        }
+    }
+
+    for (size_t i = 0; i < outputCount; i++)
+    {
+        TransactionOutput output;
+        output.amount = 1000 + generator() % 1000000;
+        output.target = KeyOutput{randomPod<Crypto::PublicKey>(generator)};
+
+        transaction.outputs.push_back(output);
+    }
+
+    addTransactionPublicKeyToExtra(transaction.extra, randomPod<Crypto::PublicKey>(generator));
+
+    return transaction;
+}
+
+BlockTemplate makeBlock(
+    std::mt19937_64 &generator,
+    uint32_t blockIndex,
+    const Crypto::Hash &previousBlockHash,
+    const std::vector<Transaction> &transactions)
+{
+    BlockTemplate block;
+    block.majorVersion = BLOCK_MAJOR_VERSION_1;
+    block.minorVersion = BLOCK_MINOR_VERSION_0;
+    block.nonce = static_cast<uint32_t>(generator());
+    block.timestamp = 1530000000 + blockIndex * 30;
+    block.previousBlockHash = previousBlockHash;
+
+    block.baseTransaction.version = CURRENT_TRANSACTION_VERSION;
+    block.baseTransaction.unlockTime = blockIndex + parameters::CRYPTONOTE_MINED_MONEY_UNLOCK_WINDOW;
+    block.baseTransaction.inputs.push_back(BaseInput{blockIndex});
+
+    TransactionOutput reward;
+    reward.amount = 1000000;
+    reward.target = KeyOutput{randomPod<Crypto::PublicKey>(generator)};
+
+    block.baseTransaction.outputs.push_back(reward);
+
+    addTransactionPublicKeyToExtra(block.baseTransaction.extra, randomPod<Crypto::PublicKey>(generator));
+
+    for (const auto &transaction : transactions)
+    {
+        block.transactionHashes.push_back(getObjectHash(transaction));
+    }
+
+    return block;
+}
+
+/* A block ready to be pushed onto a BlockchainCache */
+struct ChainBlock
+{
+    BlockTemplate block;
+    std::vector<Transaction> transactions;
+    TransactionValidatorState validatorState;
+    RawBlock rawBlock;
+    size_t blockSize;
+};
+
+std::vector<ChainBlock> makeChain(std::mt19937_64 &generator, const Crypto::Hash &genesisBlockHash)
+{
+    std::vector<ChainBlock> chain;
+
+    Crypto::Hash previousBlockHash = genesisBlockHash;
+
+    for (uint32_t blockIndex = 1; blockIndex <= CHAIN_BLOCK_COUNT; blockIndex++)
+    {
+        ChainBlock chainBlock;
+
+        for (size_t i = 0; i < CHAIN_TRANSACTIONS_PER_BLOCK; i++)
+        {
+            chainBlock.transactions.push_back(makeTransaction(generator, 2, 4, 2));
+        }
+
+        chainBlock.block = makeBlock(generator, blockIndex, previousBlockHash, chainBlock.transactions);
+        chainBlock.rawBlock.block = toBinaryArray(chainBlock.block);
+        chainBlock.blockSize = chainBlock.rawBlock.block.size();
+
+        for (const auto &transaction : chainBlock.transactions)
+        {
+            chainBlock.rawBlock.transactions.push_back(toBinaryArray(transaction));
+            chainBlock.blockSize += chainBlock.rawBlock.transactions.back().size();
+
+            for (const auto &input : transaction.inputs)
+            {
+                chainBlock.validatorState.spentKeyImages.insert(boost::get<KeyInput>(input).keyImage);
+            }
+        }
+
+        previousBlockHash = CachedBlock(chainBlock.block).getBlockHash();
+
+        chain.push_back(std::move(chainBlock));
+    }
+
+    return chain;
+}
+
+void pushChainBlock(BlockchainCache &cache, const ChainBlock &chainBlock, uint32_t blockIndex)
+{
+    std::vector<CachedTransaction> transactions;
+
+    for (const auto &transaction : chainBlock.transactions)
+    {
+        transactions.emplace_back(transaction);
+    }
+
+    RawBlock rawBlock = chainBlock.rawBlock;
+
+    cache.pushBlock(
+        CachedBlock(chainBlock.block),
+        transactions,
+        chainBlock.validatorState,
+        chainBlock.blockSize,
+        1000000,
+        blockIndex * 100,
+        std::move(rawBlock)
+    );
+}
+
+void benchmarkCrypto(BenchmarkRunner &runner)
+{
+    std::mt19937_64 generator(BENCHMARK_SEED);
+
+    const Crypto::Hash prefixHash = randomPod<Crypto::Hash>(generator);
+
+    for (const size_t ringSize : {1, 4, 8, 16, 32})
+    {
+        std::vector<KeyPair> members;
+        std::vector<Crypto::PublicKey> publicKeys;
+
+        for (size_t i = 0; i < ringSize; i++)
+        {
+            members.push_back(deterministicKeys(generator));
+            publicKeys.push_back(members.back().publicKey);
+        }
+
+        const uint64_t realOutput = generator() % ringSize;
+
+        Crypto::KeyImage keyImage;
+        Crypto::generate_key_image(members[realOutput].publicKey, members[realOutput].secretKey, keyImage);
+
+        bool success;
+        std::vector<Crypto::Signature> signatures;
+
+        std::tie(success, signatures) = Crypto::crypto_ops::generateRingSignatures(
+            prefixHash, keyImage, publicKeys, members[realOutput].secretKey, realOutput
+        );
+
+        if (!success)
+        {
+            throw std::runtime_error("Failed to generate ring signatures");
+        }
+
+        std::vector<const Crypto::PublicKey *> publicKeyPointers;
+
+        for (const auto &key : publicKeys)
+        {
+            publicKeyPointers.push_back(&key);
+        }
+
+        const uint64_t iterations = std::max<uint64_t>(10, 800 / ringSize);
+
+        runner.run("crypto/check_ring_signature/ring" + std::to_string(ringSize), iterations, [&](uint64_t)
+        {
+            if (!Crypto::check_ring_signature(prefixHash, keyImage, publicKeyPointers, signatures.data(), true))
+            {
+                throw std::runtime_error("Ring signature did not verify");
+            }
+        });
+
+        std::vector<Crypto::DecodedPublicKey> decodedKeys(ringSize);
+        std::vector<const Crypto::DecodedPublicKey *> decodedKeyPointers;
+
+        for (size_t i = 0; i < ringSize; i++)
+        {
+            Crypto::decode_public_key(publicKeys[i], decodedKeys[i]);
+            decodedKeyPointers.push_back(&decodedKeys[i]);
+        }
+
+        runner.run("crypto/check_ring_signature_decoded/ring" + std::to_string(ringSize), iterations, [&](uint64_t)
+        {
+            if (!Crypto::check_ring_signature(prefixHash, keyImage, decodedKeyPointers, signatures.data(), true))
+            {
+                throw std::runtime_error("Ring signature did not verify");
+            }
+        });
+
+        /* One block worth of inputs with this ring size, checked as a batch */
+        std::vector<Crypto::RingSignatureCheck> checks(SYNC_TRANSACTIONS_PER_BLOCK * 2);
+
+        for (auto &check : checks)
+        {
+            check.prefixHash = prefixHash;
+            check.keyImage = keyImage;
+            check.publicKeys = decodedKeys;
+            check.signatures = signatures.data();
+            check.checkKeyImage = true;
+        }
+
+        runner.run("crypto/check_ring_signatures/" + std::to_string(checks.size()) + "xring" + std::to_string(ringSize),
+            std::max<uint64_t>(5, iterations / checks.size()), [&](uint64_t)
+        {
+            if (Crypto::check_ring_signatures(checks) != checks.size())
+            {
+                throw std::runtime_error("Ring signature batch did not verify");
+            }
+        });
+    }
+
+    const KeyPair viewKeys = deterministicKeys(generator);
+    const KeyPair spendKeys = deterministicKeys(generator);
+    const KeyPair transactionKeys = deterministicKeys(generator);
+
+    Crypto::KeyDerivation derivation;
+
+    runner.run("crypto/generate_key_derivation", 1000, [&](uint64_t)
+    {
+        Crypto::generate_key_derivation(transactionKeys.publicKey, viewKeys.secretKey, derivation);
+    });
+
+    Crypto::PublicKey outputKey;
+    Crypto::derive_public_key(derivation, 0, spendKeys.publicKey, outputKey);
+
+    runner.run("crypto/underive_public_key", 1000, [&](uint64_t i)
+    {
+        Crypto::PublicKey spendKey;
+        Crypto::underive_public_key(derivation, i % 16, outputKey, spendKey);
+    });
+
+    std::vector<uint8_t> hashInput(76);
+
+    for (auto &byte : hashInput)
+    {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    runner.run("crypto/cn_lite_slow_hash_v1", 20, [&](uint64_t i)
+    {
+        /* Change the nonce like a miner would */
+        hashInput[39] = static_cast<uint8_t>(i);
+
+        Crypto::Hash hash;
+        Crypto::cn_lite_slow_hash_v1(hashInput.data(), hashInput.size(), hash);
+    });
+}
+
+void benchmarkBase58(BenchmarkRunner &runner)
+{
+    std::mt19937_64 generator(BENCHMARK_SEED + 5);
+
+    /* The size of the tag, keys and checksum of a standard address */
+    std::vector<uint8_t> data(72);
+
+    for (auto &byte : data)
+    {
+        byte = static_cast<uint8_t>(generator());
+    }
+
+    const std::string dataString(data.begin(), data.end());
+
+    /* The codec before the fixed buffer rewrite, to compare against */
+    if (ReferenceBase58::encode(dataString) != Tools::Base58::encode(dataString))
+    {
+        throw std::runtime_error("Base58 encoding differs from the reference codec");
+    }
+
+    runner.run("base58/round_trip/reference/" + std::to_string(data.size()), 1000, [&](uint64_t)
+    {
+        std::string decoded;
+
+        if (!ReferenceBase58::decode(ReferenceBase58::encode(dataString), decoded) || decoded != dataString)
+        {
+            throw std::runtime_error("Base58 round trip failed");
+        }
+    });
+
+    runner.run("base58/round_trip/string/" + std::to_string(data.size()), 1000, [&](uint64_t)
+    {
+        std::string decoded;
+
+        if (!Tools::Base58::decode(Tools::Base58::encode(dataString), decoded) || decoded != dataString)
+        {
+            throw std::runtime_error("Base58 round trip failed");
+        }
+    });
+
+    std::vector<char> encoded(Tools::Base58::encoded_size(data.size()));
+    std::vector<uint8_t> decoded(data.size());
+
+    runner.run("base58/round_trip/buffer/" + std::to_string(data.size()), 1000, [&](uint64_t)
+    {
+        Tools::Base58::encode(data.data(), data.size(), encoded.data());
+
+        if (!Tools::Base58::decode(encoded.data(), encoded.size(), decoded.data()) || decoded != data)
+        {
+            throw std::runtime_error("Base58 round trip failed");
+        }
+    });
+
+    std::vector<AccountPublicAddress> keys;
+    std::vector<std::string> addresses;
+
+    for (size_t i = 0; i < ADDRESS_COUNT; i++)
+    {
+        const AccountPublicAddress address {
+            deterministicKeys(generator).publicKey,
+            deterministicKeys(generator).publicKey
+        };
+
+        keys.push_back(address);
+
+        if (i % 2 == 0)
+        {
+            addresses.push_back(getAccountAddressAsStr(parameters::CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX, address));
+        }
+        else
+        {
+            /* The payment ID in hex, followed by the binary public keys */
+            const std::string paymentID = Common::podToHex(randomPod<Crypto::Hash>(generator));
+
+            addresses.push_back(Tools::Base58::encode_addr(
+                parameters::CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX,
+                paymentID + Common::asString(toBinaryArray(address))
+            ));
+        }
+    }
+
+    runner.run("base58/address_round_trip/reference", ADDRESS_COUNT, [&](uint64_t i)
+    {
+        uint64_t prefix;
+        std::string parsed;
+
+        const std::string keyData = Common::asString(toBinaryArray(keys[i]));
+
+        const std::string address = ReferenceBase58::encode_addr(parameters::CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX, keyData);
+
+        if (!ReferenceBase58::decode_addr(address, prefix, parsed) || parsed != keyData)
+        {
+            throw std::runtime_error("Address round trip failed");
+        }
+    });
+
+    runner.run("base58/address_round_trip/buffer", ADDRESS_COUNT, [&](uint64_t i)
+    {
+        uint64_t prefix;
+        AccountPublicAddress parsed;
+
+        const std::string address = getAccountAddressAsStr(parameters::CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX, keys[i]);
+
+        if (!parseAccountAddressString(prefix, parsed, address) || parsed.spendPublicKey != keys[i].spendPublicKey)
+        {
+            throw std::runtime_error("Address round trip failed");
+        }
+    });
+
+    runner.run("wallet/validate_addresses/" + std::to_string(addresses.size()), 20, [&](uint64_t)
+    {
+        if (validateAddresses(addresses, true) != SUCCESS)
+        {
+            throw std::runtime_error("Failed to validate addresses");
+        }
+    });
+}
+
+void benchmarkSerialization(BenchmarkRunner &runner)
+{
+    std::vector<std::string> benchmarks;
+
+    for (const std::string message : {"get_objects", "get_wallet_sync_data"})
+    {
+        for (const std::string operation : {"store_binary", "load_binary", "store_json", "load_json"})
+        {
+            benchmarks.push_back("serialization/" + message + "/" + operation);
+        }
+    }
+
+    if (!runner.anyEnabled(benchmarks))
+    {
+        return;
+    }
+
+    std::mt19937_64 generator(BENCHMARK_SEED + 1);
+
+    NOTIFY_RESPONSE_GET_OBJECTS_request objects;
+    objects.current_blockchain_height = 500000;
+
+    COMMAND_RPC_GET_WALLET_SYNC_DATA::response syncData;
+    syncData.status = CORE_RPC_STATUS_OK;
+
+    for (size_t blockIndex = 0; blockIndex < SYNC_BLOCK_COUNT; blockIndex++)
+    {
+        std::vector<Transaction> transactions;
+
+        for (size_t i = 0; i < SYNC_TRANSACTIONS_PER_BLOCK; i++)
+        {
+            transactions.push_back(makeTransaction(generator, 2, 4, 2));
+        }
+
+        const BlockTemplate block = makeBlock(
+            generator, static_cast<uint32_t>(blockIndex + 1), randomPod<Crypto::Hash>(generator), transactions
+        );
+
+        RawBlockLegacy rawBlock;
+        rawBlock.block = toBinaryArray(block);
+
+        WalletTypes::WalletBlockInfo walletBlock;
+        walletBlock.blockHeight = blockIndex + 1;
+        walletBlock.blockHash = CachedBlock(block).getBlockHash();
+        walletBlock.blockTimestamp = block.timestamp;
+        walletBlock.coinbaseTransaction.hash = getObjectHash(block.baseTransaction);
+        walletBlock.coinbaseTransaction.transactionPublicKey = getTransactionPublicKeyFromExtra(block.baseTransaction.extra);
+        walletBlock.coinbaseTransaction.unlockTime = block.baseTransaction.unlockTime;
+
+        for (const auto &output : block.baseTransaction.outputs)
+        {
+            walletBlock.coinbaseTransaction.keyOutputs.push_back(
+                {boost::get<KeyOutput>(output.target).key, output.amount}
+            );
+        }
+
+        for (const auto &transaction : transactions)
+        {
+            rawBlock.transactions.push_back(toBinaryArray(transaction));
+
+            WalletTypes::RawTransaction walletTransaction;
+            walletTransaction.hash = getObjectHash(transaction);
+            walletTransaction.transactionPublicKey = getTransactionPublicKeyFromExtra(transaction.extra);
+            walletTransaction.unlockTime = transaction.unlockTime;
+
+            for (const auto &input : transaction.inputs)
+            {
+                walletTransaction.keyInputs.push_back(boost::get<KeyInput>(input));
+            }
+
+            for (const auto &output : transaction.outputs)
+            {
+                walletTransaction.keyOutputs.push_back({boost::get<KeyOutput>(output.target).key, output.amount});
+            }
+
+            walletBlock.transactions.push_back(walletTransaction);
+        }
+
+        objects.blocks.push_back(rawBlock);
+        syncData.items.push_back(walletBlock);
+    }
+
+    const std::string objectsBinary = storeToBinaryKeyValue(objects);
+    const std::string objectsJson = storeToJson(objects);
+    const std::string syncDataBinary = storeToBinaryKeyValue(syncData);
+    const std::string syncDataJson = storeToJson(syncData);
+
+    runner.run("serialization/get_objects/store_binary", 20, [&](uint64_t)
+    {
+        storeToBinaryKeyValue(objects);
+    });
+
+    runner.run("serialization/get_objects/load_binary", 20, [&](uint64_t)
+    {
+        NOTIFY_RESPONSE_GET_OBJECTS_request loaded;
+
+        if (!loadFromBinaryKeyValue(loaded, objectsBinary))
+        {
+            throw std::runtime_error("Failed to load NOTIFY_RESPONSE_GET_OBJECTS");
+        }
+    });
+
+    runner.run("serialization/get_objects/store_json", 20, [&](uint64_t)
+    {
+        storeToJson(objects);
+    });
+
+    runner.run("serialization/get_objects/load_json", 20, [&](uint64_t)
+    {
+        NOTIFY_RESPONSE_GET_OBJECTS_request loaded;
+
+        if (!loadFromJson(loaded, objectsJson))
+        {
+            throw std::runtime_error("Failed to load NOTIFY_RESPONSE_GET_OBJECTS");
+        }
+    });
+
+    runner.run("serialization/get_wallet_sync_data/store_binary", 20, [&](uint64_t)
+    {
+        storeToBinaryKeyValue(syncData);
+    });
+
+    runner.run("serialization/get_wallet_sync_data/load_binary", 20, [&](uint64_t)
+    {
+        COMMAND_RPC_GET_WALLET_SYNC_DATA::response loaded;
+
+        if (!loadFromBinaryKeyValue(loaded, syncDataBinary))
+        {
+            throw std::runtime_error("Failed to load COMMAND_RPC_GET_WALLET_SYNC_DATA");
+        }
+    });
+
+    runner.run("serialization/get_wallet_sync_data/store_json", 20, [&](uint64_t)
+    {
+        storeToJson(syncData);
+    });
+
+    runner.run("serialization/get_wallet_sync_data/load_json", 20, [&](uint64_t)
+    {
+        COMMAND_RPC_GET_WALLET_SYNC_DATA::response loaded;
+
+        if (!loadFromJson(loaded, syncDataJson))
+        {
+            throw std::runtime_error("Failed to load COMMAND_RPC_GET_WALLET_SYNC_DATA");
+        }
+    });
+}
+
+void benchmarkTransactionPool(BenchmarkRunner &runner, Logging::ILogger &logger)
+{
+    if (!runner.anyEnabled({"transaction_pool/push", "transaction_pool/remove", "transaction_pool/get_pool_transactions"}))
+    {
+        return;
+    }
+
+    std::mt19937_64 generator(BENCHMARK_SEED + 2);
+
+    std::vector<Transaction> transactions;
+    std::vector<TransactionValidatorState> states;
+    std::vector<Crypto::Hash> hashes;
+
+    for (size_t i = 0; i < POOL_TRANSACTION_COUNT; i++)
+    {
+        transactions.push_back(makeTransaction(generator, 2, 4, 2));
+        hashes.push_back(getObjectHash(transactions.back()));
+
+        TransactionValidatorState state;
+
+        for (const auto &input : transactions.back().inputs)
+        {
+            state.spentKeyImages.insert(boost::get<KeyInput>(input).keyImage);
+        }
+
+        states.push_back(state);
+    }
+
+    std::unique_ptr<TransactionPool> pool;
+
+    const auto emptyPool = [&]()
+    {
+        pool.reset(new TransactionPool(logger));
+    };
+
+    const auto fullPool = [&]()
+    {
+        emptyPool();
+
+        for (size_t i = 0; i < POOL_TRANSACTION_COUNT; i++)
+        {
+            pool->pushTransaction(CachedTransaction(transactions[i]), TransactionValidatorState(states[i]));
+        }
+    };
+
+    runner.run("transaction_pool/push", POOL_TRANSACTION_COUNT, [&](uint64_t i)
+    {
+        if (!pool->pushTransaction(CachedTransaction(transactions[i]), TransactionValidatorState(states[i])))
+        {
+            throw std::runtime_error("Failed to push transaction to the pool");
+        }
+    }, emptyPool);
+
+    runner.run("transaction_pool/remove", POOL_TRANSACTION_COUNT, [&](uint64_t i)
+    {
+        if (!pool->removeTransaction(hashes[i]))
+        {
+            throw std::runtime_error("Failed to remove transaction from the pool");
+        }
+    }, fullPool);
+
+    /* What fillBlockTemplate starts with */
+    runner.run("transaction_pool/get_pool_transactions", 20, [&](uint64_t)
+    {
+        pool->getPoolTransactions();
+    }, fullPool);
+}
+
+void benchmarkBlockchainCache(BenchmarkRunner &runner, const Currency &currency, Logging::ILogger &logger)
+{
+    if (!runner.anyEnabled({"blockchain_cache/push_block", "blockchain_cache/split"}))
+    {
+        return;
+    }
+
+    std::mt19937_64 generator(BENCHMARK_SEED + 3);
+
+    const std::vector<ChainBlock> chain = makeChain(generator, currency.genesisBlockHash());
+
+    std::unique_ptr<BlockchainCache> cache;
+    std::unique_ptr<IBlockchainCache> upperCache;
+
+    const auto emptyCache = [&]()
+    {
+        upperCache.reset();
+        cache.reset(new BlockchainCache("benchmark", currency, logger, nullptr));
+    };
+
+    const auto fullCache = [&]()
+    {
+        emptyCache();
+
+        for (size_t i = 0; i < chain.size(); i++)
+        {
+            pushChainBlock(*cache, chain[i], static_cast<uint32_t>(i + 1));
+        }
+    };
+
+    runner.run("blockchain_cache/push_block", chain.size(), [&](uint64_t i)
+    {
+        pushChainBlock(*cache, chain[i], static_cast<uint32_t>(i + 1));
+    }, emptyCache);
+
+    runner.run("blockchain_cache/split", 1, [&](uint64_t)
+    {
+        upperCache = cache->split(static_cast<uint32_t>(chain.size() / 2));
+    }, fullCache);
+
+    upperCache.reset();
+    cache.reset();
+}
+
+class BenchmarkWriteBatch : public IWriteBatch
+{
+  public:
+    std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
+    {
+        return std::move(m_rawData);
+    }
+
+    std::vector<std::string> extractRawKeysToRemove() override
+    {
+        return {};
+    }
+
+    std::vector<std::pair<std::string, std::string>> m_rawData;
+};
+
+class BenchmarkReadBatch : public IReadBatch
+{
+  public:
+    std::vector<std::string> getRawKeys() const override
+    {
+        return m_keys;
+    }
+
+    void submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override
+    {
+        if (std::count(resultStates.begin(), resultStates.end(), true) != static_cast<ptrdiff_t>(m_keys.size()))
+        {
+            throw std::runtime_error("Database read batch is missing keys");
+        }
+    }
+
+    std::vector<std::string> m_keys;
+};
+
+void benchmarkDatabase(BenchmarkRunner &runner, Logging::ILogger &logger)
+{
+    const std::string writeBatch = "database/write_batch/" + std::to_string(DATABASE_BATCH_SIZE);
+    const std::string readBatch = "database/read_batch/" + std::to_string(DATABASE_BATCH_SIZE);
+
+    if (!runner.anyEnabled({writeBatch, readBatch}))
+    {
+        return;
+    }
+
+    std::mt19937_64 generator(BENCHMARK_SEED + 4);
+
+    const fs::path dataDir = fs::temp_directory_path()
+        / ("benchmarks-" + Common::podToHex(randomPod<uint64_t>(generator)) + "-" + std::to_string(std::time(nullptr)));
+
+    fs::create_directories(dataDir);
+
+    DataBaseConfig config;
+    config.setDataDir(dataDir.string());
+
+    /* The batches written by each run. Keys are spread like block hashes would be. */
+    const size_t batchCount = 20;
+
+    std::vector<std::vector<std::pair<std::string, std::string>>> batches(batchCount);
+
+    for (auto &batch : batches)
+    {
+        for (size_t i = 0; i < DATABASE_BATCH_SIZE; i++)
+        {
+            std::string key(32, '\0');
+            std::string value(DATABASE_VALUE_SIZE, '\0');
+
+            for (auto &c : key)
+            {
+                c = static_cast<char>(generator());
+            }
+
+            for (auto &c : value)
+            {
+                c = static_cast<char>(generator());
+            }
+
+            batch.emplace_back(key, value);
+        }
+    }
+
+    std::unique_ptr<RocksDBWrapper> database;
+
+    const auto emptyDatabase = [&]()
+    {
+        if (database)
+        {
+            database->shutdown();
+            database->destroy(config);
+        }
+
+        database.reset(new RocksDBWrapper(logger));
+        database->init(config);
+    };
+
+    runner.run(writeBatch, batchCount, [&](uint64_t i)
+    {
+        BenchmarkWriteBatch batch;
+        batch.m_rawData = batches[i];
+
+        if (database->write(batch))
+        {
+            throw std::runtime_error("Failed to write to the database");
+        }
+    }, emptyDatabase);
+
+    /* The reads need every batch written, which the last write run leaves behind */
+    if (runner.enabled(readBatch) && !runner.enabled(writeBatch))
+    {
+        emptyDatabase();
+
+        for (auto &rawData : batches)
+        {
+            BenchmarkWriteBatch batch;
+            batch.m_rawData = rawData;
+            database->write(batch);
+        }
+    }
+
+    runner.run(readBatch, batchCount, [&](uint64_t i)
+    {
+        BenchmarkReadBatch batch;
+
+        for (const auto &pair : batches[i])
+        {
+            batch.m_keys.push_back(pair.first);
+        }
+
+        if (database->read(batch))
+        {
+            throw std::runtime_error("Failed to read from the database");
+        }
+    });
+
+    database->shutdown();
+    database->destroy(config);
+    database.reset();
+
+    fs::remove_all(dataDir);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool help;
+    bool version;
+
+    size_t runs;
+
+    std::string filter;
+    std::string jsonFile;
+
+    cxxopts::Options options(argv[0], getProjectCLIHeader());
+
+    options.add_options("Core")
+        ("h,help", "Display this help message", cxxopts::value<bool>(help)->implicit_value("true"))
+        ("v,version", "Output software version information", cxxopts::value<bool>(version)->default_value("false")->implicit_value("true"));
+
+    options.add_options("Benchmarks")
+        ("f,filter", "Only run the benchmarks whose name contains this string",
+            cxxopts::value<std::string>(filter)->default_value(""), "<string>")
+        ("r,runs", "The number of times to run each benchmark. The median run is reported",
+            cxxopts::value<size_t>(runs)->default_value(std::to_string(DEFAULT_RUNS)), "#")
+        ("j,json", "Write the results as JSON to this file",
+            cxxopts::value<std::string>(jsonFile)->default_value(""), "<file>");
+
+    try
+    {
+        auto result = options.parse(argc, argv);
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cout << "Error: Unable to parse command line argument options: " << e.what() << std::endl << std::endl;
+        std::cout << options.help({}) << std::endl;
+        exit(1);
+    }
+
+    if (help)
+    {
+        std::cout << options.help({}) << std::endl;
+        exit(0);
+    }
+    else if (version)
+    {
+        std::cout << getProjectCLIHeader() << std::endl;
+        exit(0);
+    }
+
+    if (runs == 0)
+    {
+        std::cout << "Error: --runs must be at least 1" << std::endl;
+        exit(1);
+    }
+
+    std::cout << getProjectCLIHeader() << std::endl;
+
+    Logging::ConsoleLogger logger(Logging::ERROR);
+
+    const Currency currency = CurrencyBuilder(logger).currency();
+
+    BenchmarkRunner runner(filter, runs);
+
+    try
+    {
+        benchmarkCrypto(runner);
+        benchmarkBase58(runner);
+        benchmarkSerialization(runner);
+        benchmarkTransactionPool(runner, logger);
+        benchmarkBlockchainCache(runner, currency, logger);
+        benchmarkDatabase(runner, logger);
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+        exit(1);
+    }
+
+    if (!jsonFile.empty())
+    {
+        std::ofstream file(jsonFile);
+
+        if (!file)
+        {
+            std::cout << "Error: Failed to open " << jsonFile << " for writing" << std::endl;
+            exit(1);
+        }
+
+        file << std::setw(4) << runner.toJson() << std::endl;
+
+        std::cout << std::endl << "Wrote results to " << jsonFile << std::endl;
+    }
+
+    return 0;
+}
@@ -18,6 +18,8 @@
 #include "Base58.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -37,58 +39,45 @@ namespace Tools
       const uint64_t full_block_size = sizeof(encoded_block_sizes) / sizeof(encoded_block_sizes[0]) - 1;
       const uint64_t full_encoded_block_size = encoded_block_sizes[full_block_size];
       const uint64_t addr_checksum_size = 4;
+      const uint64_t max_varint_size = 10;
+
+      // addresses which decode to more than this are decoded on the heap
+      const size_t addr_buffer_size = 512;
+
+      // 58^i, the weight of the i'th digit from the end of an encoded block
+      const uint64_t powers_of_58[] = {
+        UINT64_C(1), UINT64_C(58), UINT64_C(3364), UINT64_C(195112), UINT64_C(11316496), UINT64_C(656356768),
+        UINT64_C(38068692544), UINT64_C(2207984167552), UINT64_C(128063081718016), UINT64_C(7427658739644928),
+        UINT64_C(430804206899405824)
+      };
 
       struct reverse_alphabet
       {
-        reverse_alphabet()
+        constexpr reverse_alphabet() : m_data()
         {
-          m_data.resize(alphabet[alphabet_size - 1] - alphabet[0] + 1, -1);
+          for (auto& digit : m_data)
+          {
+            digit = -1;
+          }
 
           for (uint64_t i = 0; i < alphabet_size; ++i)
           {
-            uint64_t idx = static_cast<uint64_t>(alphabet[i] - alphabet[0]);
-            m_data[idx] = static_cast<int8_t>(i);
+            m_data[static_cast<uint8_t>(alphabet[i])] = static_cast<int8_t>(i);
           }
         }
 
         int operator()(char letter) const
         {
-          uint64_t idx = static_cast<uint64_t>(letter - alphabet[0]);
-          return idx < m_data.size() ? m_data[idx] : -1;
+          return m_data[static_cast<uint8_t>(letter)];
         }
 
-        static reverse_alphabet instance;
-
-      private:
-        std::vector<int8_t> m_data;
+        int8_t m_data[256];
       };
 
-      reverse_alphabet reverse_alphabet::instance;
-
-      struct decoded_block_sizes
-      {
-        decoded_block_sizes()
-        {
-          m_data.resize(encoded_block_sizes[full_block_size] + 1, -1);
-          for (uint64_t i = 0; i <= full_block_size; ++i)
-          {
-            m_data[encoded_block_sizes[i]] = static_cast<int>(i);
-          }
-        }
-
-        int operator()(uint64_t encoded_block_size) const
-        {
-          assert(encoded_block_size <= full_encoded_block_size);
-          return m_data[encoded_block_size];
-        }
-
-        static decoded_block_sizes instance;
-
-      private:
-        std::vector<int> m_data;
-      };
+      constexpr reverse_alphabet reverse_alphabet_table;
 
-      decoded_block_sizes decoded_block_sizes::instance;
+      // decoded size of a block by its encoded size, -1 for sizes no block encodes to
+      const int decoded_block_sizes[] = {0, -1, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8};
 
       uint64_t uint_8be_to_64(const uint8_t* data, uint64_t size)
       {
@@ -119,11 +108,11 @@ namespace Tools
         memcpy(data, reinterpret_cast<uint8_t*>(&num_be) + sizeof(uint64_t) - size, size);
       }
 
-      void encode_block(const char* block, uint64_t size, char* res)
+      void encode_block(const uint8_t* block, uint64_t size, char* res)
       {
         assert(1 <= size && size <= full_block_size);
 
-        uint64_t num = uint_8be_to_64(reinterpret_cast<const uint8_t*>(block), size);
+        uint64_t num = uint_8be_to_64(block, size);
         int i = static_cast<int>(encoded_block_sizes[size]) - 1;
         while (0 < num)
         {
@@ -134,11 +123,25 @@ namespace Tools
         }
       }
 
-      bool decode_block(const char* block, uint64_t size, char* res)
+      // all 11 digits are written, so res doesn't have to be filled with zero digits first
+      void encode_full_block(const uint8_t* block, char* res)
+      {
+        uint64_t num;
+        memcpy(&num, block, sizeof(num));
+        num = SWAP64BE(num);
+
+        for (uint64_t i = full_encoded_block_size; i > 0; --i)
+        {
+          res[i - 1] = alphabet[num % alphabet_size];
+          num /= alphabet_size;
+        }
+      }
+
+      bool decode_block(const char* block, uint64_t size, uint8_t* res)
       {
         assert(1 <= size && size <= full_encoded_block_size);
 
-        int res_size = decoded_block_sizes::instance(size);
+        int res_size = decoded_block_sizes[size];
         if (res_size <= 0)
           return false; // Invalid block size
 
@@ -146,7 +149,7 @@ namespace Tools
         uint64_t order = 1;
         for (uint64_t i = size - 1; i < size; --i)
         {
-          int digit = reverse_alphabet::instance(block[i]);
+          int digit = reverse_alphabet_table(block[i]);
           if (digit < 0)
             return false; // Invalid symbol
 
@@ -162,96 +165,203 @@ namespace Tools
         if (static_cast<uint64_t>(res_size) < full_block_size && (UINT64_C(1) << (8 * res_size)) <= res_num)
           return false; // Overflow
 
-        uint_64_to_8be(res_num, res_size, reinterpret_cast<uint8_t*>(res));
+        uint_64_to_8be(res_num, res_size, res);
+
+        return true;
+      }
+
+      // only the first digit can overflow, the other 10 are below 58^10 < 2^64 together
+      bool decode_full_block(const char* block, uint8_t* res)
+      {
+        int invalid = 0;
+        uint64_t res_num = 0;
+        for (uint64_t i = 1; i < full_encoded_block_size; ++i)
+        {
+          int digit = reverse_alphabet_table(block[i]);
+          invalid |= digit;
+          res_num += static_cast<uint64_t>(digit) * powers_of_58[full_encoded_block_size - 1 - i];
+        }
+
+        int first_digit = reverse_alphabet_table(block[0]);
+        if ((invalid | first_digit) < 0)
+          return false; // Invalid symbol
+
+        uint64_t product_hi;
+        uint64_t tmp = res_num + mul128(powers_of_58[full_encoded_block_size - 1], first_digit, &product_hi);
+        if (tmp < res_num || 0 != product_hi)
+          return false; // Overflow
+
+        tmp = SWAP64BE(tmp);
+        memcpy(res, &tmp, sizeof(tmp));
+
+        return true;
+      }
+
+      // checks the checksum of a decoded address and finds the payload after the tag
+      bool parse_decoded_addr(const uint8_t* decoded, size_t decoded_size, uint64_t& tag, const uint8_t*& payload, size_t& payload_size)
+      {
+        if (decoded_size <= addr_checksum_size)
+          return false;
+
+        const size_t data_size = decoded_size - addr_checksum_size;
+        Crypto::Hash hash = Crypto::cn_fast_hash(decoded, data_size);
+        if (memcmp(&hash, decoded + data_size, addr_checksum_size) != 0)
+          return false;
+
+        int read = Tools::read_varint(decoded + 0, decoded + data_size, tag);
+        if (read <= 0)
+          return false;
 
+        payload = decoded + read;
+        payload_size = data_size - read;
         return true;
       }
     }
 
-    std::string encode(const std::string& data)
+    size_t encoded_size(size_t size)
+    {
+      return size / full_block_size * full_encoded_block_size + encoded_block_sizes[size % full_block_size];
+    }
+
+    bool decoded_size(size_t encoded_size, size_t& size)
     {
-      if (data.empty())
-        return std::string();
+      int last_block_decoded_size = decoded_block_sizes[encoded_size % full_encoded_block_size];
+      if (last_block_decoded_size < 0)
+        return false; // Invalid enc length
 
-      uint64_t full_block_count = data.size() / full_block_size;
-      uint64_t last_block_size = data.size() % full_block_size;
-      uint64_t res_size = full_block_count * full_encoded_block_size + encoded_block_sizes[last_block_size];
+      size = encoded_size / full_encoded_block_size * full_block_size + last_block_decoded_size;
+      return true;
+    }
+
+    void encode(const uint8_t* data, size_t size, char* enc)
+    {
+      uint64_t full_block_count = size / full_block_size;
+      uint64_t last_block_size = size % full_block_size;
 
-      std::string res(res_size, alphabet[0]);
       for (uint64_t i = 0; i < full_block_count; ++i)
       {
-        encode_block(data.data() + i * full_block_size, full_block_size, &res[i * full_encoded_block_size]);
+        encode_full_block(data + i * full_block_size, enc + i * full_encoded_block_size);
       }
 
       if (0 < last_block_size)
       {
-        encode_block(data.data() + full_block_count * full_block_size, last_block_size, &res[full_block_count * full_encoded_block_size]);
+        char* last_block = enc + full_block_count * full_encoded_block_size;
+        std::fill(last_block, last_block + encoded_block_sizes[last_block_size], alphabet[0]);
+        encode_block(data + full_block_count * full_block_size, last_block_size, last_block);
       }
-
-      return res;
     }
 
-    bool decode(const std::string& enc, std::string& data)
+    bool decode(const char* enc, size_t size, uint8_t* data)
     {
-      if (enc.empty())
-      {
-        data.clear();
-        return true;
-      }
-
-      uint64_t full_block_count = enc.size() / full_encoded_block_size;
-      uint64_t last_block_size = enc.size() % full_encoded_block_size;
-      int last_block_decoded_size = decoded_block_sizes::instance(last_block_size);
-      if (last_block_decoded_size < 0)
+      uint64_t full_block_count = size / full_encoded_block_size;
+      uint64_t last_block_size = size % full_encoded_block_size;
+      if (decoded_block_sizes[last_block_size] < 0)
         return false; // Invalid enc length
-      uint64_t data_size = full_block_count * full_block_size + last_block_decoded_size;
 
-      data.resize(data_size, 0);
       for (uint64_t i = 0; i < full_block_count; ++i)
       {
-        if (!decode_block(enc.data() + i * full_encoded_block_size, full_encoded_block_size, &data[i * full_block_size]))
+        if (!decode_full_block(enc + i * full_encoded_block_size, data + i * full_block_size))
           return false;
       }
 
       if (0 < last_block_size)
       {
-        if (!decode_block(enc.data() + full_block_count * full_encoded_block_size, last_block_size,
-          &data[full_block_count * full_block_size]))
+        if (!decode_block(enc + full_block_count * full_encoded_block_size, last_block_size, data + full_block_count * full_block_size))
           return false;
       }
 
       return true;
     }
 
+    std::string encode(const std::string& data)
+    {
+      std::string res(encoded_size(data.size()), alphabet[0]);
+      encode(reinterpret_cast<const uint8_t*>(data.data()), data.size(), &res[0]);
+      return res;
+    }
+
+    bool decode(const std::string& enc, std::string& data)
+    {
+      size_t data_size;
+      if (!decoded_size(enc.size(), data_size))
+        return false;
+
+      data.resize(data_size, 0);
+      return decode(enc.data(), enc.size(), reinterpret_cast<uint8_t*>(&data[0]));
+    }
+
+    std::string encode_addr(uint64_t tag, const uint8_t* data, size_t size)
+    {
+      uint8_t stack_buffer[addr_buffer_size];
+      std::vector<uint8_t> heap_buffer;
+      uint8_t* buf = stack_buffer;
+      if (max_varint_size + size + addr_checksum_size > sizeof(stack_buffer))
+      {
+        heap_buffer.resize(max_varint_size + size + addr_checksum_size);
+        buf = heap_buffer.data();
+      }
+
+      uint8_t* end = buf;
+      write_varint(end, tag);
+      memcpy(end, data, size);
+      end += size;
+
+      Crypto::Hash hash = Crypto::cn_fast_hash(buf, end - buf);
+      memcpy(end, &hash, addr_checksum_size);
+      end += addr_checksum_size;
+
+      std::string res(encoded_size(end - buf), alphabet[0]);
+      encode(buf, end - buf, &res[0]);
+      return res;
+    }
+
     std::string encode_addr(uint64_t tag, const std::string& data)
     {
-      std::string buf = get_varint_data(tag);
-      buf += data;
-      Crypto::Hash hash = Crypto::cn_fast_hash(buf.data(), buf.size());
-      const char* hash_data = reinterpret_cast<const char*>(&hash);
-      buf.append(hash_data, addr_checksum_size);
-      return encode(buf);
+      return encode_addr(tag, reinterpret_cast<const uint8_t*>(data.data()), data.size());
     }
 
-    bool decode_addr(std::string addr, uint64_t& tag, std::string& data)
+    bool decode_addr(const std::string& addr, uint64_t& tag, uint8_t* data, size_t capacity, size_t& size)
     {
-      std::string addr_data;
-      bool r = decode(addr, addr_data);
-      if (!r) return false;
-      if (addr_data.size() <= addr_checksum_size) return false;
+      size_t addr_data_size;
+      if (!decoded_size(addr.size(), addr_data_size))
+        return false;
+
+      uint8_t stack_buffer[addr_buffer_size];
+      std::vector<uint8_t> heap_buffer;
+      uint8_t* addr_data = stack_buffer;
+      if (addr_data_size > sizeof(stack_buffer))
+      {
+        heap_buffer.resize(addr_data_size);
+        addr_data = heap_buffer.data();
+      }
+
+      if (!decode(addr.data(), addr.size(), addr_data))
+        return false;
 
-      std::string checksum(addr_checksum_size, '\0');
-      checksum = addr_data.substr(addr_data.size() - addr_checksum_size);
+      const uint8_t* payload;
+      size_t payload_size;
+      if (!parse_decoded_addr(addr_data, addr_data_size, tag, payload, payload_size) || payload_size > capacity)
+        return false;
+
+      memcpy(data, payload, payload_size);
+      size = payload_size;
+      return true;
+    }
+
+    bool decode_addr(const std::string& addr, uint64_t& tag, std::string& data)
+    {
+      size_t addr_data_size;
+      if (!decoded_size(addr.size(), addr_data_size))
+        return false;
 
-      addr_data.resize(addr_data.size() - addr_checksum_size);
-      Crypto::Hash hash = Crypto::cn_fast_hash(addr_data.data(), addr_data.size());
-      std::string expected_checksum(reinterpret_cast<const char*>(&hash), addr_checksum_size);
-      if (expected_checksum != checksum) return false;
+      /* The payload is never larger than the decoded address */
+      data.resize(addr_data_size);
 
-      int read = Tools::read_varint(addr_data.begin(), addr_data.end(), tag);
-      if (read <= 0) return false;
+      size_t size;
+      if (!decode_addr(addr, tag, reinterpret_cast<uint8_t*>(&data[0]), data.size(), size))
+        return false;
 
-      data = addr_data.substr(read);
+      data.resize(size);
       return true;
     }
   }
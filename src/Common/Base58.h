@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -28,6 +29,17 @@ namespace Tools
     bool decode(const std::string& enc, std::string& data);
 
     std::string encode_addr(uint64_t tag, const std::string& data);
-    bool decode_addr(std::string addr, uint64_t& tag, std::string& data);
+    bool decode_addr(const std::string& addr, uint64_t& tag, std::string& data);
+
+    /* Fixed buffer versions, which don't allocate. encode() writes encoded_size(size)
+       characters, decode() writes the size given by decoded_size() */
+    size_t encoded_size(size_t size);
+    bool decoded_size(size_t encoded_size, size_t& size);
+    void encode(const uint8_t* data, size_t size, char* enc);
+    bool decode(const char* enc, size_t size, uint8_t* data);
+
+    std::string encode_addr(uint64_t tag, const uint8_t* data, size_t size);
+    /* Fails if the decoded data is larger than capacity, otherwise sets size to its size */
+    bool decode_addr(const std::string& addr, uint64_t& tag, uint8_t* data, size_t capacity, size_t& size);
   }
 }
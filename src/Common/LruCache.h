@@ -0,0 +1,132 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Common {
+
+struct LruCacheStatistics {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t size;
+  uint64_t capacity;
+};
+
+/* Bounded cache which evicts the least recently used entry once it is full.
+   A capacity of zero caches nothing. Safe to use from several threads. */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+  explicit LruCache(size_t capacity) : capacity(capacity), hits(0), misses(0) {
+  }
+
+  LruCache(const LruCache&) = delete;
+  LruCache& operator=(const LruCache&) = delete;
+
+  /* Copies the value of key to value and marks it as the most recently used one */
+  bool find(const Key& key, Value& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it == index.end()) {
+      misses++;
+      return false;
+    }
+
+    hits++;
+
+    /* The least recently used entry is always at the back */
+    entries.splice(entries.begin(), entries, it->second);
+    value = it->second->second;
+    return true;
+  }
+
+  /* Adds key, or replaces its value if it is already cached */
+  void insert(const Key& key, const Value& value) {
+    if (capacity == 0) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+      it->second->second = value;
+      entries.splice(entries.begin(), entries, it->second);
+      return;
+    }
+
+    if (index.size() >= capacity) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+
+    entries.emplace_front(key, value);
+    index.emplace(key, entries.begin());
+  }
+
+  void erase(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+      entries.erase(it->second);
+      index.erase(it);
+    }
+  }
+
+  /* Drops the entries for which predicate(key, value) is true */
+  template<typename Predicate>
+  void eraseIf(Predicate predicate) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (predicate(it->first, it->second)) {
+        index.erase(it->first);
+        it = entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.clear();
+    entries.clear();
+  }
+
+  LruCacheStatistics getStatistics() const {
+    LruCacheStatistics statistics;
+    statistics.hits = hits;
+    statistics.misses = misses;
+    statistics.capacity = capacity;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    statistics.size = index.size();
+    return statistics;
+  }
+
+private:
+  using Entry = std::pair<Key, Value>;
+
+  const size_t capacity;
+
+  mutable std::mutex mutex;
+  std::list<Entry> entries;
+  std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index;
+
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+};
+
+}
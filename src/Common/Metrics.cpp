@@ -0,0 +1,237 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace Metrics {
+
+namespace {
+
+std::atomic<bool> metricsEnabled(true);
+
+std::string withLabels(const std::string& name, const std::string& labels, const std::string& extraLabel = "") {
+  if (labels.empty() && extraLabel.empty()) {
+    return name;
+  }
+
+  if (labels.empty() || extraLabel.empty()) {
+    return name + "{" + labels + extraLabel + "}";
+  }
+
+  return name + "{" + labels + "," + extraLabel + "}";
+}
+
+}
+
+Counter::Counter() : m_value(0) {
+}
+
+void Counter::increment(uint64_t value) {
+  m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Counter::value() const {
+  return m_value.load(std::memory_order_relaxed);
+}
+
+Gauge::Gauge() : m_value(0) {
+}
+
+void Gauge::set(int64_t value) {
+  m_value.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::add(int64_t value) {
+  m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t Gauge::value() const {
+  return m_value.load(std::memory_order_relaxed);
+}
+
+Histogram::Histogram(const std::vector<double>& upperBounds) :
+  m_upperBounds(upperBounds),
+  m_bucketCounts(new std::atomic<uint64_t>[upperBounds.size() + 1]),
+  m_count(0),
+  m_sum(0) {
+  for (size_t i = 0; i <= m_upperBounds.size(); ++i) {
+    m_bucketCounts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::observe(double value) {
+  size_t bucket = std::lower_bound(m_upperBounds.begin(), m_upperBounds.end(), value) - m_upperBounds.begin();
+  m_bucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+
+  double sum = m_sum.load(std::memory_order_relaxed);
+  while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+  }
+}
+
+const std::vector<double>& Histogram::upperBounds() const {
+  return m_upperBounds;
+}
+
+std::vector<uint64_t> Histogram::bucketCounts() const {
+  std::vector<uint64_t> counts(m_upperBounds.size() + 1);
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = m_bucketCounts[i].load(std::memory_order_relaxed);
+  }
+
+  return counts;
+}
+
+uint64_t Histogram::count() const {
+  return m_count.load(std::memory_order_relaxed);
+}
+
+double Histogram::sum() const {
+  return m_sum.load(std::memory_order_relaxed);
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& metric = family(name, help, Type::COUNTER).counters[labels];
+  if (!metric) {
+    metric.reset(new Counter());
+  }
+
+  return *metric;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& metric = family(name, help, Type::GAUGE).gauges[labels];
+  if (!metric) {
+    metric.reset(new Gauge());
+  }
+
+  return *metric;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help, const std::vector<double>& upperBounds, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& metric = family(name, help, Type::HISTOGRAM).histograms[labels];
+  if (!metric) {
+    metric.reset(new Histogram(upperBounds));
+  }
+
+  return *metric;
+}
+
+Registry::Family& Registry::family(const std::string& name, const std::string& help, Type type) {
+  auto it = m_families.find(name);
+  if (it == m_families.end()) {
+    it = m_families.emplace(name, Family()).first;
+    it->second.type = type;
+    it->second.help = help;
+  } else if (it->second.type != type) {
+    throw std::logic_error("Metric " + name + " is already registered with another type");
+  }
+
+  return it->second;
+}
+
+std::string Registry::toPrometheusText() const {
+  std::ostringstream out;
+  out.imbue(std::locale::classic());
+  out.precision(10);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& namedFamily : m_families) {
+    const std::string& name = namedFamily.first;
+    const Family& family = namedFamily.second;
+
+    out << "# HELP " << name << " " << family.help << "\n";
+    switch (family.type) {
+    case Type::COUNTER:
+      out << "# TYPE " << name << " counter\n";
+      for (const auto& metric : family.counters) {
+        out << withLabels(name, metric.first) << " " << metric.second->value() << "\n";
+      }
+      break;
+    case Type::GAUGE:
+      out << "# TYPE " << name << " gauge\n";
+      for (const auto& metric : family.gauges) {
+        out << withLabels(name, metric.first) << " " << metric.second->value() << "\n";
+      }
+      break;
+    case Type::HISTOGRAM:
+      out << "# TYPE " << name << " histogram\n";
+      for (const auto& metric : family.histograms) {
+        const Histogram& histogram = *metric.second;
+        auto counts = histogram.bucketCounts();
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+          cumulative += counts[i];
+          std::ostringstream bound;
+          bound.imbue(std::locale::classic());
+          if (i < histogram.upperBounds().size()) {
+            bound << histogram.upperBounds()[i];
+          } else {
+            bound << "+Inf";
+          }
+
+          out << withLabels(name + "_bucket", metric.first, "le=\"" + bound.str() + "\"") << " " << cumulative << "\n";
+        }
+
+        // the buckets are read one by one, so report the count they add up to
+        out << withLabels(name + "_sum", metric.first) << " " << histogram.sum() << "\n";
+        out << withLabels(name + "_count", metric.first) << " " << cumulative << "\n";
+      }
+      break;
+    }
+  }
+
+  return out.str();
+}
+
+Registry& registry() {
+  static Registry registry;
+  return registry;
+}
+
+void setEnabled(bool enabled) {
+  metricsEnabled = enabled;
+}
+
+bool enabled() {
+  return metricsEnabled;
+}
+
+const std::vector<double>& latencyBuckets() {
+  static const std::vector<double> buckets = {
+    0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10
+  };
+
+  return buckets;
+}
+
+Timer::Timer() : m_enabled(enabled()) {
+  if (m_enabled) {
+    m_start = std::chrono::steady_clock::now();
+  }
+}
+
+void Timer::record(Histogram& histogram) {
+  if (m_enabled) {
+    auto now = std::chrono::steady_clock::now();
+    histogram.observe(std::chrono::duration<double>(now - m_start).count());
+    m_start = now;
+  }
+}
+
+ScopedTimer::ScopedTimer(Histogram& histogram) : m_histogram(histogram) {
+}
+
+ScopedTimer::~ScopedTimer() {
+  m_timer.record(m_histogram);
+}
+
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Counters, gauges and fixed-bucket histograms, rendered in the Prometheus text format.
+ *
+ * Metrics are registered once, usually into a function-local static reference, and from then on
+ * are updated with atomic operations only:
+ *
+ *   static auto& duration = Metrics::registry().histogram("x_seconds", "Time spent in x", Metrics::latencyBuckets());
+ *   Metrics::ScopedTimer timer(duration);
+ */
+namespace Metrics {
+
+class Counter {
+public:
+  Counter();
+  void increment(uint64_t value = 1);
+  uint64_t value() const;
+
+private:
+  std::atomic<uint64_t> m_value;
+};
+
+class Gauge {
+public:
+  Gauge();
+  void set(int64_t value);
+  void add(int64_t value);
+  int64_t value() const;
+
+private:
+  std::atomic<int64_t> m_value;
+};
+
+class Histogram {
+public:
+  // upperBounds must be sorted; values above the last bound fall in the +Inf bucket
+  explicit Histogram(const std::vector<double>& upperBounds);
+  void observe(double value);
+
+  const std::vector<double>& upperBounds() const;
+  // counts per bucket, not cumulative, with the +Inf bucket last
+  std::vector<uint64_t> bucketCounts() const;
+  uint64_t count() const;
+  double sum() const;
+
+private:
+  const std::vector<double> m_upperBounds;
+  std::unique_ptr<std::atomic<uint64_t>[]> m_bucketCounts;
+  std::atomic<uint64_t> m_count;
+  std::atomic<double> m_sum;
+};
+
+class Registry {
+public:
+  // Returns the metric with this name and labels, creating it the first time. labels is in the
+  // Prometheus form, e.g. method="getinfo", and may be empty.
+  Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+  Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+  Histogram& histogram(const std::string& name, const std::string& help, const std::vector<double>& upperBounds, const std::string& labels = "");
+
+  std::string toPrometheusText() const;
+
+private:
+  enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+  };
+
+  Family& family(const std::string& name, const std::string& help, Type type);
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Family> m_families;
+};
+
+// The registry of the process.
+Registry& registry();
+
+// Timers don't read the clock while metrics are disabled.
+void setEnabled(bool enabled);
+bool enabled();
+
+// Buckets in seconds from 10us to 10s, for timing operations.
+const std::vector<double>& latencyBuckets();
+
+// Records the time since it started, or since the last record, into histograms.
+class Timer {
+public:
+  Timer();
+  void record(Histogram& histogram);
+
+private:
+  bool m_enabled;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram& histogram);
+  ~ScopedTimer();
+
+private:
+  Histogram& m_histogram;
+  Timer m_timer;
+};
+
+}
@@ -38,13 +38,6 @@ StringView::StringView(const Object* stringData, Size stringSize) : data(stringD
 StringView::StringView(const std::string& string) : data(string.data()), size(string.size()) {
 }
 
-StringView::StringView(const StringView& other) : data(other.data), size(other.size) {
-  assert(data != nullptr || size == 0);
-}
-
-StringView::~StringView() {
-}
-
 StringView& StringView::operator=(const StringView& other) {
   assert(other.data != nullptr || other.size == 0);
   data = other.data;
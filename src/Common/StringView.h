@@ -58,11 +58,11 @@ public:
   // Copy constructor.
   // Performs default action - bitwise copying of source object.
   // The behavior is undefined unless 'other' 'StringView' is in defined state, that is 'data' != 'nullptr' || 'size' == 0
-  StringView(const StringView& other);
+  StringView(const StringView& other) = default;
 
   // Destructor.
   // No special action is performed.
-  ~StringView();
+  ~StringView() = default;
 
   // Copy assignment operator.
   // The behavior is undefined unless 'other' 'StringView' is in defined state, that is 'data' != 'nullptr' || 'size' == 0
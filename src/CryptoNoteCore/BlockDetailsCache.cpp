@@ -0,0 +1,20 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockDetailsCache.h"
+
+namespace CryptoNote {
+
+BlockDetailsCache::BlockDetailsCache(size_t capacity) : LruCache(capacity) {
+}
+
+void BlockDetailsCache::insert(const BlockDetails& details) {
+  insert(details.index, details);
+}
+
+void BlockDetailsCache::removeFrom(uint32_t blockIndex) {
+  eraseIf([blockIndex](uint32_t index, const BlockDetails&) { return index >= blockIndex; });
+}
+
+}
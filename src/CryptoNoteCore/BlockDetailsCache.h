@@ -0,0 +1,30 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <BlockchainExplorerData.h>
+
+#include "Common/LruCache.h"
+
+namespace CryptoNote {
+
+using BlockDetailsCacheStatistics = Common::LruCacheStatistics;
+
+/* Bounded LRU cache of assembled block details, keyed by main chain height.
+   Only blocks buried deep enough not to change are meant to be stored, and
+   the heights above a reorganisation point must be dropped with removeFrom()
+   when the main chain switches. Safe to use from several threads. */
+class BlockDetailsCache : public Common::LruCache<uint32_t, BlockDetails> {
+public:
+  explicit BlockDetailsCache(size_t capacity);
+
+  using LruCache::insert;
+  void insert(const BlockDetails& details);
+
+  /* Drops the details of the blocks at blockIndex and above */
+  void removeFrom(uint32_t blockIndex);
+};
+
+}
@@ -264,6 +264,11 @@ std::unique_ptr<IBlockchainCache> BlockchainCache::split(uint32_t splitBlockInde
   return std::move(newCache);
 }
 
+void BlockchainCache::cut(uint32_t startIndex) {
+  auto upperPart = split(startIndex);
+  deleteChild(upperPart.get());
+}
+
 void BlockchainCache::splitSpentKeyImages(BlockchainCache& newCache, uint32_t splitBlockIndex) {
   //Key images with blockIndex == splitBlockIndex remain in upper segment
   auto& imagesIndex = spentKeyImages.get<BlockIndexTag>();
@@ -597,7 +602,8 @@ size_t BlockchainCache::getTransactionCount() const {
 std::vector<RawBlock> BlockchainCache::getBlocksByHeight(
     const uint64_t startHeight, const uint64_t endHeight) const
 {
-    if (endHeight < startIndex)
+    /* endHeight is exclusive, the same as in DatabaseBlockchainCache */
+    if (endHeight <= startIndex)
     {
         return parent->getBlocksByHeight(startHeight, endHeight);
     }
@@ -606,12 +612,15 @@ std::vector<RawBlock> BlockchainCache::getBlocksByHeight(
 
     if (startHeight < startIndex)
     {
-        blocks = parent->getBlocksByHeight(startHeight, startIndex - 1);
+        blocks = parent->getBlocksByHeight(startHeight, startIndex);
     }
 
     uint64_t startOffset = std::max(startHeight, static_cast<uint64_t>(startIndex));
 
-    for (uint64_t i = startOffset; i <= endHeight; i++)
+    /* Blocks past the top of the segment aren't part of it */
+    const uint64_t end = std::min<uint64_t>(endHeight, getTopBlockIndex() + 1);
+
+    for (uint64_t i = startOffset; i < end; i++)
     {
         blocks.push_back(storage->getBlockByIndex(i - startIndex));
     }
@@ -645,7 +654,7 @@ std::unordered_map<Crypto::Hash, std::vector<uint64_t>> BlockchainCache::getGlob
     }
 
     /* Didn't find all the transactions in this segment, query parent */
-    if (!remainingTransactions.empty())
+    if (!remainingTransactions.empty() && parent != nullptr)
     {
         /* Query the parent for the transactions we couldn't find */
         auto parentResult = parent->getGlobalIndexes(remainingTransactions);
@@ -82,21 +82,6 @@ BlockchainReadBatch& BlockchainReadBatch::requestKeyOutputGlobalIndexForAmount(I
   return *this;
 }
 
-BlockchainReadBatch& BlockchainReadBatch::requestRawBlock(uint32_t blockIndex) {
-  state.rawBlocks.emplace(blockIndex, RawBlock());
-  return *this;
-}
-
-BlockchainReadBatch& BlockchainReadBatch::requestRawBlocks(uint64_t startHeight, uint64_t endHeight)
-{
-    for (uint64_t i = startHeight; i < endHeight; i++)
-    {
-        state.rawBlocks.emplace(i, RawBlock());
-    }
-
-    return *this;
-}
-
 BlockchainReadBatch& BlockchainReadBatch::requestCachedBlocks(uint64_t startHeight, uint64_t endHeight)
 {
     for (uint64_t i = startHeight; i < endHeight; i++)
@@ -137,6 +122,11 @@ BlockchainReadBatch& BlockchainReadBatch::requestTransactionHashByPaymentId(cons
   return *this;
 }
 
+BlockchainReadBatch& BlockchainReadBatch::requestPaymentIdByTransactionHash(const Crypto::Hash& transactionHash) {
+  state.paymentIdsByTransactionHashes.emplace(transactionHash, NULL_HASH);
+  return *this;
+}
+
 BlockchainReadBatch& BlockchainReadBatch::requestBlockHashesByTimestamp(uint64_t timestamp) {
   state.blockHashesByTimestamp.emplace(timestamp, std::vector<Crypto::Hash>());
   return *this;
@@ -174,11 +164,11 @@ std::vector<std::string> BlockchainReadBatch::getRawKeys() const {
   DB::serializeKeys(rawKeys, DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX, state.blockIndexesByBlockHashes);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesCountForAmounts);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNT_PREFIX, state.keyOutputGlobalIndexesForAmounts);
-  DB::serializeKeys(rawKeys, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, state.rawBlocks);
   DB::serializeKeys(rawKeys, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, state.closestTimestampBlockIndex);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX, state.keyOutputAmounts);
   DB::serializeKeys(rawKeys, DB::PAYMENT_ID_TO_TX_HASH_PREFIX, state.transactionCountsByPaymentIds);
   DB::serializeKeys(rawKeys, DB::PAYMENT_ID_TO_TX_HASH_PREFIX, state.transactionHashesByPaymentIds);
+  DB::serializeKeys(rawKeys, DB::TX_HASH_TO_PAYMENT_ID_PREFIX, state.paymentIdsByTransactionHashes);
   DB::serializeKeys(rawKeys, DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX, state.blockHashesByTimestamp);
   DB::serializeKeys(rawKeys, DB::KEY_OUTPUT_KEY_PREFIX, state.keyOutputKeys);
 
@@ -238,10 +228,6 @@ const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOu
   return state.keyOutputGlobalIndexesForAmounts;
 }
 
-const std::unordered_map<uint32_t, RawBlock>& BlockchainReadResult::getRawBlocks() const {
-  return state.rawBlocks;
-}
-
 const std::pair<uint32_t, bool>& BlockchainReadResult::getLastBlockIndex() const {
   return state.lastBlockIndex;
 }
@@ -266,6 +252,10 @@ const std::unordered_map<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash>& Block
   return state.transactionHashesByPaymentIds;
 }
 
+const std::unordered_map<Crypto::Hash, Crypto::Hash>& BlockchainReadResult::getPaymentIdsByTransactionHashes() const {
+  return state.paymentIdsByTransactionHashes;
+}
+
 const std::unordered_map<uint64_t, std::vector<Crypto::Hash>>& BlockchainReadResult::getBlockHashesByTimestamp() const {
   return state.blockHashesByTimestamp;
 }
@@ -292,11 +282,11 @@ void BlockchainReadBatch::submitRawResult(const std::vector<std::string>& values
   DB::deserializeValues(state.blockIndexesByBlockHashes, iter, DB::BLOCK_HASH_TO_BLOCK_INDEX_PREFIX);
   DB::deserializeValues(state.keyOutputGlobalIndexesCountForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
   DB::deserializeValues(state.keyOutputGlobalIndexesForAmounts, iter, DB::KEY_OUTPUT_AMOUNT_PREFIX);
-  DB::deserializeValues(state.rawBlocks, iter, DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX);
   DB::deserializeValues(state.closestTimestampBlockIndex, iter, DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX);
   DB::deserializeValues(state.keyOutputAmounts, iter, DB::KEY_OUTPUT_AMOUNTS_COUNT_PREFIX);
   DB::deserializeValues(state.transactionCountsByPaymentIds, iter, DB::PAYMENT_ID_TO_TX_HASH_PREFIX);
   DB::deserializeValues(state.transactionHashesByPaymentIds, iter, DB::PAYMENT_ID_TO_TX_HASH_PREFIX);
+  DB::deserializeValues(state.paymentIdsByTransactionHashes, iter, DB::TX_HASH_TO_PAYMENT_ID_PREFIX);
   DB::deserializeValues(state.blockHashesByTimestamp, iter, DB::TIMESTAMP_TO_BLOCKHASHES_PREFIX);
   DB::deserializeValues(state.keyOutputKeys, iter, DB::KEY_OUTPUT_KEY_PREFIX);
 
@@ -318,7 +308,6 @@ cachedBlocks(std::move(state.cachedBlocks)),
 blockIndexesByBlockHashes(std::move(state.blockIndexesByBlockHashes)),
 keyOutputGlobalIndexesCountForAmounts(std::move(state.keyOutputGlobalIndexesCountForAmounts)),
 keyOutputGlobalIndexesForAmounts(std::move(state.keyOutputGlobalIndexesForAmounts)),
-rawBlocks(std::move(state.rawBlocks)),
 blockHashesByTimestamp(std::move(state.blockHashesByTimestamp)),
 keyOutputKeys(std::move(state.keyOutputKeys)),
 closestTimestampBlockIndex(std::move(state.closestTimestampBlockIndex)),
@@ -327,6 +316,7 @@ keyOutputAmountsCount(std::move(state.keyOutputAmountsCount)),
 keyOutputAmounts(std::move(state.keyOutputAmounts)),
 transactionCountsByPaymentIds(std::move(state.transactionCountsByPaymentIds)),
 transactionHashesByPaymentIds(std::move(state.transactionHashesByPaymentIds)),
+paymentIdsByTransactionHashes(std::move(state.paymentIdsByTransactionHashes)),
 transactionsCount(std::move(state.transactionsCount)) {
 }
 
@@ -339,11 +329,11 @@ size_t BlockchainReadState::size() const {
     blockIndexesByBlockHashes.size() +
     keyOutputGlobalIndexesCountForAmounts.size() +
     keyOutputGlobalIndexesForAmounts.size() +
-    rawBlocks.size() +
     closestTimestampBlockIndex.size() +
     keyOutputAmounts.size() +
     transactionCountsByPaymentIds.size() +
     transactionHashesByPaymentIds.size() +
+    paymentIdsByTransactionHashes.size() +
     blockHashesByTimestamp.size() +
     keyOutputKeys.size() +
     (lastBlockIndex.second ? 1 : 0) +
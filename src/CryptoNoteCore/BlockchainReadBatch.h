@@ -61,11 +61,11 @@ struct BlockchainReadState {
   std::unordered_map<Crypto::Hash, uint32_t> blockIndexesByBlockHashes;
   std::unordered_map<IBlockchainCache::Amount, uint32_t> keyOutputGlobalIndexesCountForAmounts;
   std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex> keyOutputGlobalIndexesForAmounts;
-  std::unordered_map<uint32_t, RawBlock> rawBlocks;
   std::unordered_map<uint64_t, uint32_t> closestTimestampBlockIndex;
   std::unordered_map<uint32_t, IBlockchainCache::Amount> keyOutputAmounts;
   std::unordered_map<Crypto::Hash, uint32_t> transactionCountsByPaymentIds;
   std::unordered_map<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash> transactionHashesByPaymentIds;
+  std::unordered_map<Crypto::Hash, Crypto::Hash> paymentIdsByTransactionHashes;
   std::unordered_map<uint64_t, std::vector<Crypto::Hash>> blockHashesByTimestamp;
   KeyOutputKeyResult keyOutputKeys;
 
@@ -95,13 +95,13 @@ public:
   const std::unordered_map<Crypto::Hash, uint32_t>& getBlockIndexesByBlockHashes() const;
   const std::unordered_map<IBlockchainCache::Amount, uint32_t>& getKeyOutputGlobalIndexesCountForAmounts() const;
   const std::unordered_map<std::pair<IBlockchainCache::Amount, uint32_t>, PackedOutIndex>& getKeyOutputGlobalIndexesForAmounts() const;
-  const std::unordered_map<uint32_t, RawBlock>& getRawBlocks() const;
   const std::pair<uint32_t, bool>& getLastBlockIndex() const;
   const std::unordered_map<uint64_t, uint32_t>& getClosestTimestampBlockIndex() const;
   uint32_t getKeyOutputAmountsCount() const;
   const std::unordered_map<uint32_t, IBlockchainCache::Amount>& getKeyOutputAmounts() const;
   const std::unordered_map<Crypto::Hash, uint32_t>& getTransactionCountByPaymentIds() const;
   const std::unordered_map<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash>& getTransactionHashesByPaymentIds() const;
+  const std::unordered_map<Crypto::Hash, Crypto::Hash>& getPaymentIdsByTransactionHashes() const;
   const std::unordered_map<uint64_t, std::vector<Crypto::Hash> >& getBlockHashesByTimestamp() const;
   const std::pair<uint64_t, bool>& getTransactionsCount() const;
   const KeyOutputKeyResult& getKeyOutputInfo() const;
@@ -125,14 +125,13 @@ public:
   BlockchainReadBatch& requestBlockIndexByBlockHash(const Crypto::Hash& blockHash);
   BlockchainReadBatch& requestKeyOutputGlobalIndexesCountForAmount(IBlockchainCache::Amount amount);
   BlockchainReadBatch& requestKeyOutputGlobalIndexForAmount(IBlockchainCache::Amount amount, uint32_t outputIndexWithinAmout);
-  BlockchainReadBatch& requestRawBlock(uint32_t blockIndex);
-  BlockchainReadBatch& requestRawBlocks(uint64_t startHeight, uint64_t endHeight);
   BlockchainReadBatch& requestLastBlockIndex();
   BlockchainReadBatch& requestClosestTimestampBlockIndex(uint64_t timestamp);
   BlockchainReadBatch& requestKeyOutputAmountsCount();
   BlockchainReadBatch& requestKeyOutputAmount(uint32_t index);
   BlockchainReadBatch& requestTransactionCountByPaymentId(const Crypto::Hash& paymentId);
   BlockchainReadBatch& requestTransactionHashByPaymentId(const Crypto::Hash& paymentId, uint32_t transactionIndexWithinPaymentId);
+  BlockchainReadBatch& requestPaymentIdByTransactionHash(const Crypto::Hash& transactionHash);
   BlockchainReadBatch& requestBlockHashesByTimestamp(uint64_t timestamp);
   BlockchainReadBatch& requestTransactionsCount();
   BlockchainReadBatch& requestKeyOutputInfo(IBlockchainCache::Amount amount, IBlockchainCache::GlobalOutputIndex globalIndex);
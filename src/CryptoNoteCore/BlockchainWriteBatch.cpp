@@ -47,6 +47,7 @@ BlockchainWriteBatch& BlockchainWriteBatch::insertCachedTransaction(const Extend
 BlockchainWriteBatch& BlockchainWriteBatch::insertPaymentId(const Crypto::Hash& transactionHash, const Crypto::Hash paymentId, uint32_t totalTxsCountForPaymentId) {
   rawDataToInsert.emplace_back(DB::serialize(DB::PAYMENT_ID_TO_TX_HASH_PREFIX, paymentId, totalTxsCountForPaymentId));
   rawDataToInsert.emplace_back(DB::serialize(DB::PAYMENT_ID_TO_TX_HASH_PREFIX, std::make_pair(paymentId, totalTxsCountForPaymentId - 1), transactionHash));
+  rawDataToInsert.emplace_back(DB::serialize(DB::TX_HASH_TO_PAYMENT_ID_PREFIX, transactionHash, paymentId));
   return *this;
 }
 
@@ -71,11 +72,6 @@ BlockchainWriteBatch& BlockchainWriteBatch::insertKeyOutputGlobalIndexes(IBlockc
   return *this;
 }
 
-BlockchainWriteBatch& BlockchainWriteBatch::insertRawBlock(uint32_t blockIndex, const RawBlock& block) {
-  rawDataToInsert.emplace_back(DB::serialize(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, blockIndex, block));
-  return *this;
-}
-
 BlockchainWriteBatch& BlockchainWriteBatch::insertClosestTimestampBlockIndex(uint64_t timestamp, uint32_t blockIndex) {
   rawDataToInsert.emplace_back(DB::serialize(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, timestamp, blockIndex));
   return *this;
@@ -118,6 +114,7 @@ BlockchainWriteBatch& BlockchainWriteBatch::removeSpentKeyImages(uint32_t blockI
 
 BlockchainWriteBatch& BlockchainWriteBatch::removeCachedTransaction(const Crypto::Hash& transactionHash, uint64_t totalTxsCount) {
   rawKeysToRemove.emplace_back(DB::serializeKey(DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, transactionHash));
+  rawKeysToRemove.emplace_back(DB::serializeKey(DB::TX_HASH_TO_PAYMENT_ID_PREFIX, transactionHash));
   rawDataToInsert.emplace_back(DB::serialize(DB::TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX, DB::TRANSACTIONS_COUNT_KEY, totalTxsCount));
   return *this;
 }
@@ -145,11 +142,6 @@ BlockchainWriteBatch& BlockchainWriteBatch::removeKeyOutputGlobalIndexes(IBlockc
   return *this;
 }
 
-BlockchainWriteBatch& BlockchainWriteBatch::removeRawBlock(uint32_t blockIndex) {
-  rawKeysToRemove.emplace_back(DB::serializeKey(DB::BLOCK_INDEX_TO_RAW_BLOCK_PREFIX, blockIndex));
-  return *this;
-}
-
 BlockchainWriteBatch& BlockchainWriteBatch::removeClosestTimestampBlockIndex(uint64_t timestamp) {
   rawKeysToRemove.emplace_back(DB::serializeKey(DB::CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX, timestamp));
   return *this;
@@ -0,0 +1,178 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BufferedDataBase.h"
+
+#include <utility>
+#include <vector>
+
+#include "Common/Metrics.h"
+
+namespace CryptoNote {
+
+namespace {
+
+class RawWriteBatch : public IWriteBatch {
+public:
+  std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override {
+    return std::move(dataToInsert);
+  }
+
+  std::vector<std::string> extractRawKeysToRemove() override {
+    return std::move(keysToRemove);
+  }
+
+  std::vector<std::pair<std::string, std::string>> dataToInsert;
+  std::vector<std::string> keysToRemove;
+};
+
+Metrics::Histogram& operationDuration(const std::string& operation) {
+  return Metrics::registry().histogram("blockchain_database_seconds", "Time spent in blockchain cache database operations",
+    Metrics::latencyBuckets(), "operation=\"" + operation + "\"");
+}
+
+Metrics::Counter& keyCount(const std::string& operation) {
+  return Metrics::registry().counter("blockchain_database_keys_total", "Keys passed through blockchain cache database operations",
+    "operation=\"" + operation + "\"");
+}
+
+class RawReadBatch : public IReadBatch {
+public:
+  std::vector<std::string> getRawKeys() const override {
+    return keys;
+  }
+
+  void submitRawResult(const std::vector<std::string>& rawValues, const std::vector<bool>& rawResultStates) override {
+    values = rawValues;
+    resultStates = rawResultStates;
+  }
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  std::vector<bool> resultStates;
+};
+
+}
+
+BufferedDataBase::BufferedDataBase(IDataBase& database) : database(database) {
+}
+
+std::error_code BufferedDataBase::write(IWriteBatch& batch) {
+  merge(batch);
+  return std::error_code();
+}
+
+std::error_code BufferedDataBase::writeSync(IWriteBatch& batch) {
+  merge(batch);
+  return flush(true);
+}
+
+std::error_code BufferedDataBase::read(IReadBatch& batch) {
+  static auto& readDuration = operationDuration("read");
+  static auto& readKeys = keyCount("read");
+  static auto& bufferedReadKeys = keyCount("read_buffered");
+  Metrics::ScopedTimer timer(readDuration);
+
+  std::vector<std::string> rawKeys(batch.getRawKeys());
+  std::vector<std::string> values(rawKeys.size());
+  std::vector<bool> resultStates(rawKeys.size(), false);
+
+  RawReadBatch missedBatch;
+  std::vector<size_t> missedPositions;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (size_t i = 0; i < rawKeys.size(); ++i) {
+      auto it = pendingWrites.find(rawKeys[i]);
+      if (it == pendingWrites.end()) {
+        missedBatch.keys.push_back(rawKeys[i]);
+        missedPositions.push_back(i);
+      } else if (it->second) {
+        values[i] = *it->second;
+        resultStates[i] = true;
+      }
+    }
+  }
+
+  readKeys.increment(rawKeys.size());
+  bufferedReadKeys.increment(rawKeys.size() - missedBatch.keys.size());
+
+  if (!missedBatch.keys.empty()) {
+    auto error = database.read(missedBatch);
+    if (error) {
+      return error;
+    }
+
+    for (size_t i = 0; i < missedPositions.size(); ++i) {
+      values[missedPositions[i]] = std::move(missedBatch.values[i]);
+      resultStates[missedPositions[i]] = missedBatch.resultStates[i];
+    }
+  }
+
+  batch.submitRawResult(values, resultStates);
+  return std::error_code();
+}
+
+std::error_code BufferedDataBase::flush() {
+  return flush(false);
+}
+
+size_t BufferedDataBase::getPendingKeysCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return pendingWrites.size();
+}
+
+void BufferedDataBase::merge(IWriteBatch& batch) {
+  static auto& writeDuration = operationDuration("write");
+  static auto& writeKeys = keyCount("write");
+  Metrics::ScopedTimer timer(writeDuration);
+
+  auto dataToInsert = batch.extractRawDataToInsert();
+  auto keysToRemove = batch.extractRawKeysToRemove();
+  writeKeys.increment(dataToInsert.size() + keysToRemove.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // same order as a write to the database: inserts first, then removals
+  for (auto& kv : dataToInsert) {
+    pendingWrites[std::move(kv.first)] = std::move(kv.second);
+  }
+
+  for (auto& key : keysToRemove) {
+    pendingWrites[std::move(key)] = boost::none;
+  }
+}
+
+std::error_code BufferedDataBase::flush(bool sync) {
+  static auto& flushDuration = operationDuration("flush");
+  static auto& flushKeys = keyCount("flush");
+  Metrics::ScopedTimer timer(flushDuration);
+
+  // held during the write, so a reader never misses keys which are between memory and the database
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (pendingWrites.empty()) {
+    return std::error_code();
+  }
+
+  RawWriteBatch batch;
+  for (const auto& kv : pendingWrites) {
+    if (kv.second) {
+      batch.dataToInsert.emplace_back(kv.first, *kv.second);
+    } else {
+      batch.keysToRemove.push_back(kv.first);
+    }
+  }
+
+  auto error = sync ? database.writeSync(batch) : database.write(batch);
+  if (!error) {
+    flushKeys.increment(pendingWrites.size());
+    pendingWrites.clear();
+  }
+
+  return error;
+}
+
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+#include "IDataBase.h"
+
+namespace CryptoNote {
+
+/*
+ * Write-behind layer over a database. Written batches are merged in memory and
+ * are committed to the underlying database as one atomic batch by flush().
+ * Reads see the merged writes before they are committed.
+ */
+class BufferedDataBase : public IDataBase {
+public:
+  explicit BufferedDataBase(IDataBase& database);
+
+  BufferedDataBase(const BufferedDataBase&) = delete;
+  BufferedDataBase& operator=(const BufferedDataBase&) = delete;
+
+  virtual std::error_code write(IWriteBatch& batch) override;
+  virtual std::error_code writeSync(IWriteBatch& batch) override;
+
+  virtual std::error_code read(IReadBatch& batch) override;
+
+  std::error_code flush();
+
+  size_t getPendingKeysCount() const;
+
+private:
+  void merge(IWriteBatch& batch);
+  std::error_code flush(bool sync);
+
+  IDataBase& database;
+
+  mutable std::mutex mutex;
+  // the latest value of each written key, boost::none when the key is removed
+  std::unordered_map<std::string, boost::optional<std::string>> pendingWrites;
+};
+
+}
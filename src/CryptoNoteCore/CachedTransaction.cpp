@@ -47,6 +47,28 @@ const Crypto::Hash& CachedTransaction::getTransactionHash() const {
   return transactionHash.get();
 }
 
+void CachedTransaction::computeTransactionHashes(const std::vector<CachedTransaction>& transactions) {
+  std::vector<const CachedTransaction*> pending;
+  std::vector<const void*> data;
+  std::vector<size_t> sizes;
+
+  for (const auto& transaction : transactions) {
+    if (!transaction.transactionHash.is_initialized()) {
+      const BinaryArray& binaryArray = transaction.getTransactionBinaryArray();
+      pending.push_back(&transaction);
+      data.push_back(binaryArray.data());
+      sizes.push_back(binaryArray.size());
+    }
+  }
+
+  std::vector<Crypto::Hash> hashes(pending.size());
+  Crypto::cn_fast_hash_batch(data.data(), sizes.data(), pending.size(), hashes.data());
+
+  for (size_t i = 0; i < pending.size(); ++i) {
+    pending[i]->transactionHash = hashes[i];
+  }
+}
+
 const Crypto::Hash& CachedTransaction::getTransactionPrefixHash() const {
   if (!transactionPrefixHash.is_initialized()) {
     transactionPrefixHash = getObjectHash(static_cast<const TransactionPrefix&>(transaction));
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <boost/optional.hpp>
 #include <CryptoNote.h>
 
@@ -33,6 +35,9 @@ public:
   const BinaryArray& getTransactionBinaryArray() const;
   uint64_t getTransactionFee() const;
 
+  /* Fills in the hashes of the transactions which don't have them yet, hashing several at a time */
+  static void computeTransactionHashes(const std::vector<CachedTransaction>& transactions);
+
 private:
   Transaction transaction;
   mutable boost::optional<BinaryArray> transactionBinaryArray;
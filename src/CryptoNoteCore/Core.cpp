@@ -5,14 +5,18 @@
 // Please see the included LICENSE file for more information.
 
 #include <algorithm>
+#include <future>
 #include <numeric>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #include "Core.h"
 #include "Common/ShuffleGenerator.h"
 #include "Common/Math.h"
 #include "Common/MemoryInputStream.h"
+#include "Common/Metrics.h"
+#include "Common/ScopeExit.h"
 #include "CryptoNoteTools.h"
 #include "CryptoNoteFormatUtils.h"
 #include "BlockchainCache.h"
@@ -24,6 +28,7 @@
 #include "CryptoNoteCore/TransactionExtra.h"
 #include "CryptoNoteCore/TransactionPool.h"
 #include "CryptoNoteCore/TransactionPoolCleaner.h"
+#include "CryptoNoteCore/TransactionPoolStorage.h"
 #include "CryptoNoteCore/UpgradeManager.h"
 #include "CryptoNoteCore/Mixins.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
@@ -48,6 +53,29 @@ std::vector<T> preallocateVector(size_t elements) {
 }
 UseGenesis addGenesisBlock = UseGenesis(true);
 
+Metrics::Histogram& addBlockStage(const std::string& stage) {
+  return Metrics::registry().histogram("core_add_block_stage_seconds", "Time spent in each stage of adding a block",
+    Metrics::latencyBuckets(), "stage=\"" + stage + "\"");
+}
+
+Metrics::Counter& addBlockResult(const std::string& result) {
+  return Metrics::registry().counter("core_add_block_total", "Blocks submitted to the core, by result", "result=\"" + result + "\"");
+}
+
+// the same as Common::medianValue, for values which are already sorted
+uint64_t sortedMedian(const std::vector<uint64_t>& values) {
+  if (values.empty()) {
+    return 0;
+  }
+
+  size_t n = values.size() / 2;
+  if (values.size() % 2) {
+    return values[n];
+  }
+
+  return (values[n - 1] + values[n]) / 2;
+}
+
 class TransactionSpentInputsChecker {
 public:
   bool haveSpentInputs(const Transaction& transaction) {
@@ -181,13 +209,115 @@ uint32_t findCommonRoot(IMainChainStorage& storage, IBlockchainCache& rootSegmen
 
 const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+// how often the transaction pool is written to its file, besides on save()
+const std::chrono::seconds TRANSACTION_POOL_SAVING_INTERVAL = std::chrono::seconds(300);
+
+// blocks read and decoded ahead of the ones being pushed when importing blocks.bin
+const uint32_t IMPORT_BLOCKS_CHUNK_SIZE = 1000;
+
+struct ImportedBlock {
+  RawBlock rawBlock;
+  BlockTemplate blockTemplate;
+  // refers to blockTemplate, so an ImportedBlock must not move once decoded
+  boost::optional<CachedBlock> cachedBlock;
+  std::vector<CachedTransaction> transactions;
+  uint64_t cumulativeSize = 0;
+  uint64_t cumulativeFee = 0;
+};
+
+// does all the work on a block which doesn't depend on the blocks before it
+void decodeImportedBlock(ImportedBlock& block, const Currency& currency) {
+  block.blockTemplate = extractBlockTemplate(block.rawBlock);
+  block.cachedBlock.emplace(block.blockTemplate);
+  block.cachedBlock->getBlockHash();
+
+  block.transactions.reserve(block.rawBlock.transactions.size());
+
+  try {
+    for (const auto& rawTransaction : block.rawBlock.transactions) {
+      if (rawTransaction.size() > currency.maxTxSize()) {
+        throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+      }
+
+      block.cumulativeSize += rawTransaction.size();
+      block.transactions.emplace_back(rawTransaction);
+      block.cumulativeFee += block.transactions.back().getTransactionFee();
+    }
+  } catch (std::runtime_error&) {
+    throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+  }
+
+  CachedTransaction::computeTransactionHashes(block.transactions);
+
+  block.cumulativeSize += getObjectBinarySize(block.blockTemplate.baseTransaction);
+}
+
+// checks the signatures split into threadCount parts, the first one on the calling thread and the
+// others on the pool. Returns the index of the first invalid one or count.
+size_t checkRingSignatures(const Crypto::RingSignatureCheck* checks, size_t count, size_t threadCount, System::ThreadPool& pool) {
+  const size_t partSize = (count + threadCount - 1) / std::max<size_t>(threadCount, 1);
+  if (threadCount <= 1 || partSize < 2) {
+    return Crypto::check_ring_signatures(checks, count);
+  }
+
+  std::vector<std::future<size_t>> parts;
+  for (size_t start = partSize; start < count; start += partSize) {
+    const size_t partCount = std::min(partSize, count - start);
+    auto part = std::make_shared<std::packaged_task<size_t()>>([checks, start, partCount] {
+      return start + Crypto::check_ring_signatures(checks + start, partCount);
+    });
+
+    parts.push_back(part->get_future());
+    pool.submit([part] { (*part)(); });
+  }
+
+  // wait for all of the parts before rethrowing, they refer to checks
+  size_t invalidSignature = count;
+  std::exception_ptr error;
+  try {
+    invalidSignature = Crypto::check_ring_signatures(checks, std::min(partSize, count));
+    if (invalidSignature == std::min(partSize, count)) {
+      invalidSignature = count;
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  for (size_t i = 0; i < parts.size(); ++i) {
+    try {
+      const size_t result = parts[i].get();
+      const size_t end = std::min((i + 2) * partSize, count);
+      if (result != end && invalidSignature == count) {
+        invalidSignature = result;
+      }
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  return invalidSignature;
+}
+
+double toSeconds(std::chrono::nanoseconds duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
 }
 
 Core::Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
            std::unique_ptr<IBlockchainCacheFactory>&& blockchainCacheFactory, std::unique_ptr<IMainChainStorage>&& mainchainStorage)
     : currency(currency), dispatcher(dispatcher), contextGroup(dispatcher), logger(logger, "Core"), checkpoints(std::move(checkpoints)),
       upgradeManager(new UpgradeManager()), blockchainCacheFactory(std::move(blockchainCacheFactory)),
-      mainChainStorage(std::move(mainchainStorage)), initialized(false) {
+      mainChainStorage(std::move(mainchainStorage)), initialized(false),
+      ringMemberCache(RING_MEMBER_CACHE_DEFAULT_SIZE), blockDetailsCache(BLOCK_DETAILS_CACHE_DEFAULT_SIZE),
+      signatureCheckPool(std::max(1u, std::thread::hardware_concurrency())),
+      verifyImportedBlocks(false) {
 
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
   upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -924,6 +1054,22 @@ std::vector<Crypto::Hash> Core::findBlockchainSupplement(const std::vector<Crypt
 
 std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlock) {
   throwIfNotInitialized();
+
+  static auto& deserializeStage = addBlockStage("deserialize");
+  static auto& validateBlockStage = addBlockStage("validate_block");
+  static auto& validateTransactionsStage = addBlockStage("validate_transactions");
+  static auto& ringSignaturesStage = addBlockStage("ring_signatures");
+  static auto& pushStage = addBlockStage("push");
+  static auto& notifyStage = addBlockStage("notify");
+  static auto& rejected = addBlockResult("rejected");
+  static auto& addedToMain = addBlockResult("added_to_main");
+  static auto& addedToAlternative = addBlockResult("added_to_alternative");
+
+  Metrics::Timer stageTimer;
+  // counts the block as rejected unless it gets to the end
+  auto* result = &rejected;
+  Tools::ScopeExit countResult([&result] { result->increment(); });
+
   uint32_t blockIndex = cachedBlock.getBlockIndex();
   Crypto::Hash blockHash = cachedBlock.getBlockHash();
   std::ostringstream os;
@@ -954,6 +1100,8 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     return error::AddBlockErrorCode::DESERIALIZATION_FAILED;
   }
 
+  stageTimer.record(deserializeStage);
+
   auto coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
   assert(coinbaseTransactionSize < std::numeric_limits<decltype(coinbaseTransactionSize)>::max());
   auto cumulativeBlockSize = coinbaseTransactionSize + cumulativeSize;
@@ -1006,17 +1154,35 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
 
   uint64_t cumulativeFee = 0;
 
+  stageTimer.record(validateBlockStage);
+
+  /* The ring signatures of the whole block are checked together once everything else is known to be valid */
+  std::vector<Crypto::RingSignatureCheck> ringSignatures;
+  std::vector<Crypto::Hash> ringSignatureTransactions;
+
   for (const auto& transaction : transactions) {
     uint64_t fee = 0;
-    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex);
+    auto transactionValidationResult = validateTransaction(transaction, validatorState, cache, fee, previousBlockIndex, &ringSignatures);
     if (transactionValidationResult) {
       logger(Logging::DEBUGGING) << "Failed to validate transaction " << transaction.getTransactionHash() << ": " << transactionValidationResult.message();
       return transactionValidationResult;
     }
 
+    ringSignatureTransactions.resize(ringSignatures.size(), transaction.getTransactionHash());
+
     cumulativeFee += fee;
   }
 
+  stageTimer.record(validateTransactionsStage);
+
+  const size_t invalidSignature = Crypto::check_ring_signatures(ringSignatures);
+  if (invalidSignature != ringSignatures.size()) {
+    logger(Logging::DEBUGGING) << "Failed to validate transaction " << ringSignatureTransactions[invalidSignature] << ": invalid ring signature";
+    return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+  }
+
+  stageTimer.record(ringSignaturesStage);
+
   uint64_t reward = 0;
   int64_t emissionChange = 0;
   auto alreadyGeneratedCoins = cache->getAlreadyGeneratedCoins(previousBlockIndex);
@@ -1144,9 +1310,14 @@ std::error_code Core::addBlock(const CachedBlock& cachedBlock, RawBlock&& rawBlo
     updateMainChainSet();
   }
 
+  stageTimer.record(pushStage);
+
   logger(Logging::DEBUGGING) << "Block: " << blockStr << " successfully added";
   notifyOnSuccess(ret, previousBlockIndex, cachedBlock, *cache);
 
+  stageTimer.record(notifyStage);
+  result = ret == error::AddBlockErrorCode::ADDED_TO_MAIN ? &addedToMain : &addedToAlternative;
+
   return ret;
 }
 
@@ -1183,14 +1354,10 @@ void Core::actualizePoolTransactionsLite(const TransactionValidatorState& valida
 void Core::switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain) {
   assert(mainChainStorage->getBlockCount() > splitBlockIndex);
 
-  auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
-  for (size_t i = 0; i < blocksToPop; ++i) {
-    mainChainStorage->popBlock();
-  }
+  blockDetailsCache.removeFrom(splitBlockIndex);
 
-  for (uint32_t index = splitBlockIndex; index <= newChain.getTopBlockIndex(); ++index) {
-    mainChainStorage->pushBlock(newChain.getBlockByIndex(index));
-  }
+  mainChainStorage->truncate(splitBlockIndex);
+  mainChainStorage->pushBlocks(newChain.getBlocksByHeight(splitBlockIndex, newChain.getTopBlockIndex() + 1));
 }
 
 void Core::notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex,
@@ -1396,7 +1563,8 @@ bool Core::addTransactionToPool(CachedTransaction&& cachedTransaction) {
   return true;
 }
 
-bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState) {
+bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+                                      std::vector<Crypto::RingSignatureCheck>* deferredSignatures) {
   auto [success, err] = Mixins::validate({cachedTransaction}, getTopBlockIndex());
 
   if (!success)
@@ -1406,7 +1574,7 @@ bool Core::isTransactionValidForPool(const CachedTransaction& cachedTransaction,
 
   uint64_t fee;
 
-  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex())) {
+  if (auto validationResult = validateTransaction(cachedTransaction, validatorState, chainsLeaves[0], fee, getTopBlockIndex(), deferredSignatures)) {
     logger(Logging::DEBUGGING) << "Transaction " << cachedTransaction.getTransactionHash()
       << " is not valid. Reason: " << validationResult.message();
     return false;
@@ -1722,11 +1890,16 @@ bool Core::extractTransactions(const std::vector<BinaryArray>& rawTransactions,
     return false;
   }
 
+  CachedTransaction::computeTransactionHashes(transactions);
+
   return true;
 }
 
+/* If deferredSignatures is given, the ring signatures are not checked here but appended to it, so the
+   caller can check the signatures of many transactions in one batch */
 std::error_code Core::validateTransaction(const CachedTransaction& cachedTransaction, TransactionValidatorState& state,
-                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex) {
+                                          IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+                                          std::vector<Crypto::RingSignatureCheck>* deferredSignatures) {
   // TransactionValidatorState currentState;
   const auto& transaction = cachedTransaction.getTransaction();
 auto error = validateSemantic(transaction, fee, blockIndex);
@@ -1765,9 +1938,28 @@ auto error = validateSemantic(transaction, fee, blockIndex);
           return error::TransactionValidationError::INPUT_SPEND_LOCKED_OUT;
         }
 
-        std::vector<const Crypto::PublicKey*> outputKeyPointers;
-        outputKeyPointers.reserve(outputKeys.size());
-        std::for_each(outputKeys.begin(), outputKeys.end(), [&outputKeyPointers] (const Crypto::PublicKey& key) { outputKeyPointers.push_back(&key); });
+        /* Decoys are shared between many rings, so reuse their decoded points where we can */
+        std::vector<Crypto::DecodedPublicKey> decodedKeys;
+        if (!ringMemberCache.decode(outputKeys, decodedKeys)) {
+          return error::TransactionValidationError::INPUT_INVALID_SIGNATURES;
+        }
+
+        if (deferredSignatures != nullptr) {
+          Crypto::RingSignatureCheck check;
+          check.prefixHash = cachedTransaction.getTransactionPrefixHash();
+          check.keyImage = in.keyImage;
+          check.publicKeys = std::move(decodedKeys);
+          check.signatures = transaction.signatures[inputIndex].data();
+          check.checkKeyImage = blockIndex > parameters::KEY_IMAGE_CHECKING_BLOCK_INDEX;
+          deferredSignatures->push_back(std::move(check));
+
+          inputIndex++;
+          continue;
+        }
+
+        std::vector<const Crypto::DecodedPublicKey*> outputKeyPointers;
+        outputKeyPointers.reserve(decodedKeys.size());
+        std::for_each(decodedKeys.begin(), decodedKeys.end(), [&outputKeyPointers] (const Crypto::DecodedPublicKey& key) { outputKeyPointers.push_back(&key); });
         if (!Crypto::check_ring_signature(cachedTransaction.getTransactionPrefixHash(), in.keyImage, outputKeyPointers.data(),
                                           outputKeyPointers.size(), transaction.signatures[inputIndex].data(),
                                           blockIndex > parameters::KEY_IMAGE_CHECKING_BLOCK_INDEX)) {
@@ -1975,6 +2167,8 @@ void Core::save() {
   deleteAlternativeChains();
   mergeMainChainSegments();
   chainsLeaves[0]->save();
+
+  savePoolTransactions();
 }
 
 void Core::load() {
@@ -1989,25 +2183,35 @@ void Core::load() {
 
   assert(storageBlocksCount != 0); //we assume the storage has at least genesis block
 
-  if (storageBlocksCount > dbBlocksCount) {
+  /* blocks.bin is the source of the raw blocks, so the DB is cut back to it. It can be ahead
+     after a power loss, as blocks.bin is flushed but not synced. Cutting the root segment only
+     reads the DB, so this fails only if the DB itself is damaged. */
+  auto commonIndex = findCommonRoot(*mainChainStorage, *chainsLeaves[0]);
+  if (storageBlocksCount > commonIndex + 1) {
     logger(Logging::INFO) << "Importing blocks from blockchain storage";
     importBlocksFromStorage();
-  } else if (storageBlocksCount < dbBlocksCount) {
-    auto cutFrom = findCommonRoot(*mainChainStorage, *chainsLeaves[0]) + 1;
-
-    logger(Logging::INFO) << "DB has more blocks than blockchain storage, cutting from block index: " << cutFrom;
-    cutSegment(*chainsLeaves[0], cutFrom);
+  } else if (dbBlocksCount > commonIndex + 1) {
+    logger(Logging::INFO) << "DB has more blocks than blockchain storage, cutting from block index: " << commonIndex + 1;
+
+    try {
+      cutSegment(*chainsLeaves[0], commonIndex + 1);
+    } catch (std::exception& e) {
+      logger(Logging::ERROR) << "Failed to cut DB to blockchain storage: " << e.what()
+                             << ". Restart the daemon with --import-blockchain to rebuild the DB from blockchain storage";
+      throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+    }
 
     assert(chainsLeaves[0]->getTopBlockIndex() + 1 == mainChainStorage->getBlockCount());
-  } else if (getBlockHash(mainChainStorage->getBlockByIndex(storageBlocksCount - 1)) != chainsLeaves[0]->getTopBlockHash()) {
-    logger(Logging::INFO) << "Blockchain storage and root segment are on different chains. "
-                             << "Cutting root segment to common block index " << findCommonRoot(*mainChainStorage, *chainsLeaves[0]) << " and reimporting blocks";
-    importBlocksFromStorage();
   } else {
     logger(Logging::DEBUGGING) << "Blockchain storage and root segment are on the same height and chain";
   }
 
   initialized = true;
+
+  if (!transactionPoolFile.empty()) {
+    loadPoolTransactions();
+    contextGroup.spawn(std::bind(&Core::transactionPoolSavingProcedure, this));
+  }
 }
 
 void Core::initRootSegment() {
@@ -2025,60 +2229,172 @@ void Core::initRootSegment() {
   chainsLeaves[0]->load();
 }
 
+/* Blocks are read from blocks.bin and decoded a chunk ahead of the ones being verified and pushed.
+   Reading stays on one thread, locked against the flushes of the DB commits made while pushing,
+   but decoding is spread over all cores. */
 void Core::importBlocksFromStorage() {
+  const auto importStart = std::chrono::steady_clock::now();
+
   uint32_t commonIndex = findCommonRoot(*mainChainStorage, *chainsLeaves[0]);
   assert(commonIndex <= mainChainStorage->getBlockCount());
 
   cutSegment(*chainsLeaves[0], commonIndex + 1);
 
+  importStatistics = ImportStatistics();
+  importStatistics.decodingThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  const size_t threadCount = importStatistics.decodingThreads;
+
+  auto readAndDecode = [this, threadCount] (uint32_t startIndex, uint32_t endIndex) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<ImportedBlock> blocks(endIndex - startIndex);
+    for (uint32_t i = startIndex; i < endIndex; ++i) {
+      blocks[i - startIndex].rawBlock = mainChainStorage->getBlockByIndex(i);
+    }
+
+    importStatistics.readTime += std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+
+    std::vector<std::future<void>> decoders;
+    for (size_t thread = 0; thread < threadCount; ++thread) {
+      decoders.push_back(std::async(std::launch::async, [&blocks, thread, threadCount, this] {
+        for (size_t i = thread; i < blocks.size(); i += threadCount) {
+          decodeImportedBlock(blocks[i], currency);
+        }
+      }));
+    }
+
+    // wait for all of them before rethrowing, they refer to blocks
+    for (auto& decoder : decoders) {
+      decoder.wait();
+    }
+
+    for (auto& decoder : decoders) {
+      decoder.get();
+    }
+
+    importStatistics.decodeTime += std::chrono::steady_clock::now() - start;
+
+    return blocks;
+  };
+
   auto previousBlockHash = getBlockHash(mainChainStorage->getBlockByIndex(commonIndex));
   auto blockCount = mainChainStorage->getBlockCount();
-  for (uint32_t i = commonIndex + 1; i < blockCount; ++i) {
-    RawBlock rawBlock = mainChainStorage->getBlockByIndex(i);
-    auto blockTemplate = extractBlockTemplate(rawBlock);
-    CachedBlock cachedBlock(blockTemplate);
-
-    if (blockTemplate.previousBlockHash != previousBlockHash) {
-      logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
-                             << " has previous block hash " << blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
-                             << ". Resynchronize your daemon please.";
-      throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+
+  std::future<std::vector<ImportedBlock>> nextChunk;
+  if (commonIndex + 1 < blockCount) {
+    nextChunk = std::async(std::launch::async, readAndDecode, commonIndex + 1, std::min(commonIndex + 1 + IMPORT_BLOCKS_CHUNK_SIZE, blockCount));
+  }
+
+  for (uint32_t chunkStart = commonIndex + 1; chunkStart < blockCount; chunkStart += IMPORT_BLOCKS_CHUNK_SIZE) {
+    std::vector<ImportedBlock> chunk;
+    try {
+      chunk = nextChunk.get();
+    } catch (std::system_error&) {
+      logger(Logging::ERROR) << "Couldn't deserialize the blocks from index " << chunkStart << " in blockchain storage. Resynchronize your daemon please.";
+      throw;
     }
 
-    previousBlockHash = cachedBlock.getBlockHash();
+    const uint32_t nextChunkStart = chunkStart + IMPORT_BLOCKS_CHUNK_SIZE;
+    if (nextChunkStart < blockCount) {
+      nextChunk = std::async(std::launch::async, readAndDecode, nextChunkStart, std::min(nextChunkStart + IMPORT_BLOCKS_CHUNK_SIZE, blockCount));
+    }
 
-    std::vector<CachedTransaction> transactions;
-    uint64_t cumulativeSize = 0;
-    if (!extractTransactions(rawBlock.transactions, transactions, cumulativeSize)) {
-      logger(Logging::ERROR) << "Couldn't deserialize raw block transactions in block " << cachedBlock.getBlockHash();
-      throw std::system_error(make_error_code(error::AddBlockErrorCode::DESERIALIZATION_FAILED));
+    for (uint32_t i = chunkStart; i < chunkStart + chunk.size(); ++i) {
+      ImportedBlock& block = chunk[i - chunkStart];
+      const CachedBlock& cachedBlock = *block.cachedBlock;
+
+      if (block.blockTemplate.previousBlockHash != previousBlockHash) {
+        logger(Logging::ERROR) << "Corrupted blockchain. Block with index " << i << " and hash " << cachedBlock.getBlockHash()
+                               << " has previous block hash " << block.blockTemplate.previousBlockHash << ", but parent has hash " << previousBlockHash
+                               << ". Resynchronize your daemon please.";
+        throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+      }
+
+      previousBlockHash = cachedBlock.getBlockHash();
+
+      if (verifyImportedBlocks && !checkpoints.isInCheckpointZone(i)) {
+        const auto start = std::chrono::steady_clock::now();
+        verifyImportedBlock(cachedBlock, block.transactions, threadCount);
+        importStatistics.verifyTime += std::chrono::steady_clock::now() - start;
+        importStatistics.verifiedBlocks++;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+
+      TransactionValidatorState spentOutputs = extractSpentOutputs(block.transactions);
+      auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+
+      int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, block.cumulativeSize, block.cumulativeFee);
+      chainsLeaves[0]->pushBlock(cachedBlock, block.transactions, spentOutputs, block.cumulativeSize, emissionChange, currentDifficulty, std::move(block.rawBlock));
+
+      importStatistics.pushTime += std::chrono::steady_clock::now() - start;
+      importStatistics.blocks++;
+      importStatistics.transactions += block.transactions.size() + 1;
+
+      if (i % 1000 == 0) {
+        logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
+      }
     }
+  }
 
-    cumulativeSize += getObjectBinarySize(blockTemplate.baseTransaction);
-    TransactionValidatorState spentOutputs = extractSpentOutputs(transactions);
-    auto currentDifficulty = chainsLeaves[0]->getDifficultyForNextBlock(i - 1);
+  importStatistics.totalTime = std::chrono::steady_clock::now() - importStart;
 
-    uint64_t cumulativeFee = std::accumulate(transactions.begin(), transactions.end(), UINT64_C(0), [] (uint64_t fee, const CachedTransaction& transaction) {
-      return fee + transaction.getTransactionFee();
-    });
+  logger(Logging::INFO) << "Imported " << importStatistics.blocks << " blocks and " << importStatistics.transactions << " transactions in "
+                        << toSeconds(importStatistics.totalTime) << " s (" << importStatistics.blocks / std::max(toSeconds(importStatistics.totalTime), 1e-9)
+                        << " blocks/s). Read: " << toSeconds(importStatistics.readTime) << " s, decode: " << toSeconds(importStatistics.decodeTime)
+                        << " s on " << importStatistics.decodingThreads << " threads, verify: " << toSeconds(importStatistics.verifyTime)
+                        << " s (" << importStatistics.verifiedBlocks << " blocks), push: " << toSeconds(importStatistics.pushTime) << " s";
+}
 
-    int64_t emissionChange = getEmissionChange(currency, *chainsLeaves[0], i - 1, cachedBlock, cumulativeSize, cumulativeFee);
-    chainsLeaves[0]->pushBlock(cachedBlock, transactions, spentOutputs, cumulativeSize, emissionChange, currentDifficulty, std::move(rawBlock));
+void Core::verifyImportedBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& transactions, size_t threadCount) {
+  const uint32_t previousBlockIndex = cachedBlock.getBlockIndex() - 1;
 
-    if (i % 1000 == 0) {
-      logger(Logging::INFO) << "Imported block with index " << i << " / " << (blockCount - 1);
+  TransactionValidatorState validatorState;
+  std::vector<Crypto::RingSignatureCheck> ringSignatures;
+  std::vector<Crypto::Hash> ringSignatureTransactions;
+
+  for (const auto& transaction : transactions) {
+    uint64_t fee = 0;
+    auto transactionValidationResult = validateTransaction(transaction, validatorState, chainsLeaves[0], fee, previousBlockIndex, &ringSignatures);
+    if (transactionValidationResult) {
+      logger(Logging::ERROR) << "Imported block " << cachedBlock.getBlockHash() << " has invalid transaction " << transaction.getTransactionHash()
+                             << ": " << transactionValidationResult.message() << ". Resynchronize your daemon please.";
+      throw std::system_error(transactionValidationResult);
     }
+
+    ringSignatureTransactions.resize(ringSignatures.size(), transaction.getTransactionHash());
+  }
+
+  const size_t invalidSignature = checkRingSignatures(ringSignatures.data(), ringSignatures.size(), threadCount, signatureCheckPool);
+  if (invalidSignature != ringSignatures.size()) {
+    logger(Logging::ERROR) << "Imported block " << cachedBlock.getBlockHash() << " has invalid transaction " << ringSignatureTransactions[invalidSignature]
+                           << ": invalid ring signature. Resynchronize your daemon please.";
+    throw std::system_error(make_error_code(error::TransactionValidationError::INPUT_INVALID_SIGNATURES));
   }
 }
 
+void Core::setImportVerification(bool verify) {
+  verifyImportedBlocks = verify;
+}
+
+void Core::setTransactionPoolFile(const std::string& filename) {
+  transactionPoolFile = filename;
+}
+
+ImportStatistics Core::getImportStatistics() const {
+  return importStatistics;
+}
+
 void Core::cutSegment(IBlockchainCache& segment, uint32_t startIndex) {
   if (segment.getTopBlockIndex() < startIndex) {
     return;
   }
 
   logger(Logging::INFO) << "Cutting root segment from index " << startIndex;
-  auto childCache = segment.split(startIndex);
-  segment.deleteChild(childCache.get());
+  blockDetailsCache.removeFrom(startIndex);
+  segment.cut(startIndex);
 }
 
 void Core::updateMainChainSet() {
@@ -2294,10 +2610,10 @@ void Core::fillQueryBlockDetails(uint32_t fullOffset, uint32_t currentIndex, siz
   uint32_t fullBlocksCount = static_cast<uint32_t>(std::min(static_cast<uint32_t>(maxItemsCount), currentIndex - fullOffset + 1));
   entries.reserve(entries.size() + fullBlocksCount);
 
-  for (uint32_t blockIndex = fullOffset; blockIndex < fullOffset + fullBlocksCount; ++blockIndex) {
-    IBlockchainCache* segment = findMainChainSegmentContainingBlock(blockIndex);
-    Crypto::Hash blockHash = segment->getBlockHash(blockIndex);
-    BlockDetails block = getBlockDetails(blockHash);
+  std::vector<uint32_t> blockIndexes(fullBlocksCount);
+  std::iota(blockIndexes.begin(), blockIndexes.end(), fullOffset);
+
+  for (BlockDetails& block : getBlocksDetails(blockIndexes)) {
     entries.emplace_back(std::move(block));
   }
 }
@@ -2505,73 +2821,228 @@ BlockDetails Core::getBlockDetails(const Crypto::Hash& blockHash) const {
   }
 
   uint32_t blockIndex = segment->getBlockIndex(blockHash);
-  BlockTemplate blockTemplate = restoreBlockTemplate(segment, blockIndex);
+  bool isMainChain = mainChainSet.count(segment) != 0;
 
   BlockDetails blockDetails;
-  blockDetails.majorVersion = blockTemplate.majorVersion;
-  blockDetails.minorVersion = blockTemplate.minorVersion;
-  blockDetails.timestamp = blockTemplate.timestamp;
-  blockDetails.prevBlockHash = blockTemplate.previousBlockHash;
-  blockDetails.nonce = blockTemplate.nonce;
-  blockDetails.hash = blockHash;
+  if (isMainChain && blockDetailsCache.find(blockIndex, blockDetails) && blockDetails.hash == blockHash) {
+    return blockDetails;
+  }
+
+  blockDetails = std::move(buildBlocksDetails(segment, blockIndex, 1).front());
+  if (isMainChain) {
+    cacheBlockDetails(blockDetails);
+  }
+
+  return blockDetails;
+}
+
+std::vector<BlockDetails> Core::getBlocksDetails(const std::vector<uint32_t>& blockHeights) const {
+  throwIfNotInitialized();
+
+  IBlockchainCache* mainChain = chainsLeaves[0];
+
+  std::vector<BlockDetails> blocksDetails(blockHeights.size());
+  std::vector<bool> cached(blockHeights.size(), false);
+  std::vector<uint32_t> missedHeights;
+
+  for (size_t i = 0; i < blockHeights.size(); ++i) {
+    if (blockHeights[i] > mainChain->getTopBlockIndex()) {
+      throw std::runtime_error("Requested block height wasn't found in blockchain.");
+    }
 
-  blockDetails.reward = 0;
-  for (const TransactionOutput& out : blockTemplate.baseTransaction.outputs) {
-    blockDetails.reward += out.amount;
+    cached[i] = blockDetailsCache.find(blockHeights[i], blocksDetails[i]);
+    if (!cached[i]) {
+      missedHeights.push_back(blockHeights[i]);
+    }
   }
 
-  blockDetails.index = blockIndex;
-  blockDetails.isAlternative = mainChainSet.count(segment) == 0;
+  std::sort(missedHeights.begin(), missedHeights.end());
+  missedHeights.erase(std::unique(missedHeights.begin(), missedHeights.end()), missedHeights.end());
 
-  blockDetails.difficulty = getBlockDifficulty(blockIndex);
+  // each run of consecutive heights is assembled in one go, sharing the reads and the size median window
+  std::vector<BlockDetails> missedDetails;
+  missedDetails.reserve(missedHeights.size());
+  for (size_t runStart = 0; runStart < missedHeights.size();) {
+    size_t runEnd = runStart + 1;
+    while (runEnd < missedHeights.size() && missedHeights[runEnd] == missedHeights[runEnd - 1] + 1) {
+      ++runEnd;
+    }
 
-  std::vector<uint64_t> sizes = segment->getLastBlocksSizes(1, blockDetails.index, addGenesisBlock);
-  assert(sizes.size() == 1);
-  blockDetails.transactionsCumulativeSize = sizes.front();
+    for (BlockDetails& blockDetails : buildBlocksDetails(mainChain, missedHeights[runStart], static_cast<uint32_t>(runEnd - runStart))) {
+      cacheBlockDetails(blockDetails);
+      missedDetails.push_back(std::move(blockDetails));
+    }
 
-  uint64_t blockBlobSize = getObjectBinarySize(blockTemplate);
-  uint64_t coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
-  blockDetails.blockSize = blockBlobSize + blockDetails.transactionsCumulativeSize - coinbaseTransactionSize;
+    runStart = runEnd;
+  }
 
-  blockDetails.alreadyGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index);
-  blockDetails.alreadyGeneratedTransactions = segment->getAlreadyGeneratedTransactions(blockDetails.index);
+  for (size_t i = 0; i < blockHeights.size(); ++i) {
+    if (!cached[i]) {
+      auto it = std::lower_bound(missedHeights.begin(), missedHeights.end(), blockHeights[i]);
+      blocksDetails[i] = missedDetails[std::distance(missedHeights.begin(), it)];
+    }
+  }
+
+  return blocksDetails;
+}
 
-  uint64_t prevBlockGeneratedCoins = 0;
-  blockDetails.sizeMedian = 0;
-  if (blockDetails.index > 0) {
-    auto lastBlocksSizes = segment->getLastBlocksSizes(currency.rewardBlocksWindow(), blockDetails.index - 1, addGenesisBlock);
-    blockDetails.sizeMedian = Common::medianValue(lastBlocksSizes);
-    prevBlockGeneratedCoins = segment->getAlreadyGeneratedCoins(blockDetails.index - 1);
+BlockDetailsCacheStatistics Core::getBlockDetailsCacheStatistics() const {
+  return blockDetailsCache.getStatistics();
+}
+
+void Core::cacheBlockDetails(const BlockDetails& blockDetails) const {
+  // blocks close to the top may still be replaced by an alternative chain
+  if (blockDetails.index + BLOCK_DETAILS_CACHE_MIN_CONFIRMATIONS <= chainsLeaves[0]->getTopBlockIndex()) {
+    blockDetailsCache.insert(blockDetails);
   }
+}
 
-  int64_t emissionChange = 0;
-  bool result = currency.getBlockReward(blockDetails.majorVersion, blockDetails.sizeMedian, 0, prevBlockGeneratedCoins, 0, blockDetails.baseReward, emissionChange);
-  if (result) {}
-  assert(result);
+std::vector<BlockDetails> Core::buildBlocksDetails(IBlockchainCache* segment, uint32_t startIndex, uint32_t count) const {
+  assert(count > 0);
+  uint32_t endIndex = startIndex + count - 1;
+  assert(endIndex <= segment->getTopBlockIndex());
 
-  uint64_t currentReward = 0;
-  result = currency.getBlockReward(blockDetails.majorVersion, blockDetails.sizeMedian, blockDetails.transactionsCumulativeSize,
-                                   prevBlockGeneratedCoins, 0, currentReward, emissionChange);
-  assert(result);
+  const uint32_t sizesWindow = static_cast<uint32_t>(currency.rewardBlocksWindow());
+  const uint32_t firstIndex = startIndex > sizesWindow ? startIndex - sizesWindow : 0;
 
-  if (blockDetails.baseReward == 0 && currentReward == 0) {
-    blockDetails.penalty = static_cast<double>(0);
-  } else {
-    assert(blockDetails.baseReward >= currentReward);
-    blockDetails.penalty = static_cast<double>(blockDetails.baseReward - currentReward) / static_cast<double>(blockDetails.baseReward);
+  // the infos of the blocks in the range, and of the ones in the size median window before it, in a single read
+  std::vector<CachedBlockInfo> blockInfos;
+  blockInfos.reserve(endIndex - firstIndex + 1);
+  segment->getLastUnits(endIndex - firstIndex + 1, endIndex, addGenesisBlock, [&blockInfos](const CachedBlockInfo& info) {
+    blockInfos.push_back(info);
+    return static_cast<uint64_t>(0);
+  });
+  assert(blockInfos.size() == endIndex - firstIndex + 1);
+
+  auto blockInfo = [&blockInfos, firstIndex](uint32_t blockIndex) -> const CachedBlockInfo& {
+    return blockInfos[blockIndex - firstIndex];
+  };
+
+  // sizes of the sizesWindow blocks before the current one, kept sorted while the window slides
+  std::vector<uint64_t> windowSizes;
+  windowSizes.reserve(sizesWindow + 1);
+  for (uint32_t blockIndex = firstIndex; blockIndex < startIndex; ++blockIndex) {
+    uint64_t size = blockInfo(blockIndex).blockSize;
+    windowSizes.insert(std::upper_bound(windowSizes.begin(), windowSizes.end(), size), size);
+  }
+
+  std::vector<BlockDetails> blocksDetails(count);
+  std::vector<std::vector<CachedTransaction>> blocksTransactions(count);
+  std::vector<Crypto::Hash> transactionHashes;
+
+  for (uint32_t blockIndex = startIndex; blockIndex <= endIndex; ++blockIndex) {
+    BlockDetails& blockDetails = blocksDetails[blockIndex - startIndex];
+    const CachedBlockInfo& info = blockInfo(blockIndex);
+
+    RawBlock rawBlock = segment->getBlockByIndex(blockIndex);
+    BlockTemplate blockTemplate;
+    if (!fromBinaryArray(blockTemplate, rawBlock.block)) {
+      throw std::runtime_error("Couldn't deserialize BlockTemplate");
+    }
+
+    blockDetails.majorVersion = blockTemplate.majorVersion;
+    blockDetails.minorVersion = blockTemplate.minorVersion;
+    blockDetails.timestamp = blockTemplate.timestamp;
+    blockDetails.prevBlockHash = blockTemplate.previousBlockHash;
+    blockDetails.nonce = blockTemplate.nonce;
+    blockDetails.hash = info.blockHash;
+
+    blockDetails.reward = 0;
+    for (const TransactionOutput& out : blockTemplate.baseTransaction.outputs) {
+      blockDetails.reward += out.amount;
+    }
+
+    blockDetails.index = blockIndex;
+    blockDetails.isAlternative = mainChainSet.count(segment) == 0;
+
+    blockDetails.difficulty = blockIndex > 0 ? info.cumulativeDifficulty - blockInfo(blockIndex - 1).cumulativeDifficulty : info.cumulativeDifficulty;
+
+    blockDetails.transactionsCumulativeSize = info.blockSize;
+
+    uint64_t blockBlobSize = rawBlock.block.size();
+    uint64_t coinbaseTransactionSize = getObjectBinarySize(blockTemplate.baseTransaction);
+    blockDetails.blockSize = blockBlobSize + blockDetails.transactionsCumulativeSize - coinbaseTransactionSize;
+
+    blockDetails.alreadyGeneratedCoins = info.alreadyGeneratedCoins;
+    blockDetails.alreadyGeneratedTransactions = info.alreadyGeneratedTransactions;
+
+    uint64_t prevBlockGeneratedCoins = 0;
+    blockDetails.sizeMedian = 0;
+    if (blockIndex > 0) {
+      blockDetails.sizeMedian = sortedMedian(windowSizes);
+      prevBlockGeneratedCoins = blockInfo(blockIndex - 1).alreadyGeneratedCoins;
+    }
+
+    windowSizes.insert(std::upper_bound(windowSizes.begin(), windowSizes.end(), info.blockSize), info.blockSize);
+    if (blockIndex >= sizesWindow) {
+      windowSizes.erase(std::lower_bound(windowSizes.begin(), windowSizes.end(), blockInfo(blockIndex - sizesWindow).blockSize));
+    }
+
+    int64_t emissionChange = 0;
+    bool result = currency.getBlockReward(blockDetails.majorVersion, blockDetails.sizeMedian, 0, prevBlockGeneratedCoins, 0, blockDetails.baseReward, emissionChange);
+    if (result) {}
+    assert(result);
+
+    uint64_t currentReward = 0;
+    result = currency.getBlockReward(blockDetails.majorVersion, blockDetails.sizeMedian, blockDetails.transactionsCumulativeSize,
+                                     prevBlockGeneratedCoins, 0, currentReward, emissionChange);
+    assert(result);
+
+    if (blockDetails.baseReward == 0 && currentReward == 0) {
+      blockDetails.penalty = static_cast<double>(0);
+    } else {
+      assert(blockDetails.baseReward >= currentReward);
+      blockDetails.penalty = static_cast<double>(blockDetails.baseReward - currentReward) / static_cast<double>(blockDetails.baseReward);
+    }
+
+    std::vector<CachedTransaction>& transactions = blocksTransactions[blockIndex - startIndex];
+    if (!Utils::restoreCachedTransactions(rawBlock.transactions, transactions)) {
+      throw std::runtime_error("Couldn't deserialize transactions");
+    }
+
+    transactions.emplace(transactions.begin(), std::move(blockTemplate.baseTransaction));
+    for (const CachedTransaction& transaction : transactions) {
+      transactionHashes.push_back(transaction.getTransactionHash());
+    }
   }
 
-  blockDetails.transactions.reserve(blockTemplate.transactionHashes.size() + 1);
-  CachedTransaction cachedBaseTx(std::move(blockTemplate.baseTransaction));
-  blockDetails.transactions.push_back(getTransactionDetails(cachedBaseTx.getTransactionHash(), segment, false));
+  // the global output indexes of all the transactions in the range, in a single read
+  auto globalIndexes = segment->getGlobalIndexes(transactionHashes);
+
+  for (uint32_t blockIndex = startIndex; blockIndex <= endIndex; ++blockIndex) {
+    BlockDetails& blockDetails = blocksDetails[blockIndex - startIndex];
+    const std::vector<CachedTransaction>& transactions = blocksTransactions[blockIndex - startIndex];
 
-  blockDetails.totalFeeAmount = 0;
-  for (const Crypto::Hash& transactionHash : blockTemplate.transactionHashes) {
-    blockDetails.transactions.push_back(getTransactionDetails(transactionHash, segment, false));
-    blockDetails.totalFeeAmount += blockDetails.transactions.back().fee;
+    blockDetails.totalFeeAmount = 0;
+    blockDetails.transactions.reserve(transactions.size());
+    for (const CachedTransaction& transaction : transactions) {
+      TransactionDetails transactionDetails;
+      transactionDetails.inBlockchain = true;
+      transactionDetails.blockIndex = blockIndex;
+      transactionDetails.blockHash = blockDetails.hash;
+      transactionDetails.timestamp = blockInfo(blockIndex).timestamp;
+      transactionDetails.size = transaction.getTransactionBinaryArray().size();
+      transactionDetails.fee = transaction.getTransactionFee();
+      transactionDetails.hash = transaction.getTransactionHash();
+
+      std::vector<uint32_t> transactionGlobalIndexes;
+      auto it = globalIndexes.find(transactionDetails.hash);
+      if (it != globalIndexes.end()) {
+        transactionGlobalIndexes.assign(it->second.begin(), it->second.end());
+      }
+
+      fillTransactionDetails(transaction.getTransaction(), segment, std::move(transactionGlobalIndexes), transactionDetails);
+
+      // the base transaction comes first, and has no fee
+      if (!blockDetails.transactions.empty()) {
+        blockDetails.totalFeeAmount += transactionDetails.fee;
+      }
+
+      blockDetails.transactions.push_back(std::move(transactionDetails));
+    }
   }
 
-  return blockDetails;
+  return blocksDetails;
 }
 
 TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHash) const {
@@ -2592,9 +3063,9 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     segment = chainsLeaves[0];
   }
 
-  std::unique_ptr<ITransaction> transaction;
   Transaction rawTransaction;
   TransactionDetails transactionDetails;
+  std::vector<uint32_t> globalIndexes;
   if (!foundInPool) {
     std::vector<Crypto::Hash> transactionsHashes;
     std::vector<BinaryArray> rawTransactions;
@@ -2621,7 +3092,10 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     transactionDetails.fee = transactions.back().getTransactionFee();
 
     rawTransaction = transactions.back().getTransaction();
-    transaction = createTransaction(rawTransaction);
+
+    if (!getTransactionGlobalIndexes(transactionHash, globalIndexes)) {
+      globalIndexes.clear();
+    }
   } else {
     transactionDetails.inBlockchain = false;
     transactionDetails.timestamp = transactionPool->getTransactionReceiveTime(transactionHash);
@@ -2630,10 +3104,18 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     transactionDetails.fee = transactionPool->getTransaction(transactionHash).getTransactionFee();
 
     rawTransaction = transactionPool->getTransaction(transactionHash).getTransaction();
-    transaction = createTransaction(rawTransaction);
   }
 
   transactionDetails.hash = transactionHash;
+  fillTransactionDetails(rawTransaction, segment, std::move(globalIndexes), transactionDetails);
+
+  return transactionDetails;
+}
+
+void Core::fillTransactionDetails(const Transaction& rawTransaction, IBlockchainCache* segment, std::vector<uint32_t>&& globalIndexes,
+                                  TransactionDetails& transactionDetails) const {
+  std::unique_ptr<ITransaction> transaction = createTransaction(rawTransaction);
+
   transactionDetails.unlockTime = transaction->getUnlockTime();
 
   transactionDetails.totalOutputsAmount = transaction->getOutputTotalAmount();
@@ -2693,12 +3175,10 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
   }
 
   transactionDetails.outputs.reserve(transaction->getOutputCount());
-  std::vector<uint32_t> globalIndexes;
-  globalIndexes.reserve(transaction->getOutputCount());
-  if (!transactionDetails.inBlockchain || !getTransactionGlobalIndexes(transactionDetails.hash, globalIndexes)) {
-    for (size_t i = 0; i < transaction->getOutputCount(); ++i) {
-      globalIndexes.push_back(0);
-    }
+
+  // global indexes are unknown for pool transactions
+  if (globalIndexes.empty()) {
+    globalIndexes.assign(transaction->getOutputCount(), 0);
   }
 
   assert(transaction->getOutputCount() == globalIndexes.size());
@@ -2708,8 +3188,6 @@ TransactionDetails Core::getTransactionDetails(const Crypto::Hash& transactionHa
     txOutDetails.globalIndex = globalIndexes[i];
     transactionDetails.outputs.push_back(std::move(txOutDetails));
   }
-
-  return transactionDetails;
 }
 
 std::vector<Crypto::Hash> Core::getAlternativeBlockHashesByIndex(uint32_t blockIndex) const {
@@ -2829,6 +3307,143 @@ void Core::transactionPoolCleaningProcedure() {
   }
 }
 
+void Core::transactionPoolSavingProcedure() {
+  System::Timer timer(dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(TRANSACTION_POOL_SAVING_INTERVAL);
+      savePoolTransactions();
+    }
+  } catch (System::InterruptedException&) {
+    logger(Logging::DEBUGGING) << "transactionPoolSavingProcedure has been interrupted";
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Error occurred while saving transactions pool: " << e.what();
+  }
+}
+
+void Core::savePoolTransactions() {
+  if (transactionPoolFile.empty()) {
+    return;
+  }
+
+  std::vector<StoredPoolTransaction> transactions;
+  for (const auto& hash : transactionPool->getTransactionHashes()) {
+    transactions.push_back({transactionPool->getTransactionReceiveTime(hash), transactionPool->getTransaction(hash).getTransactionBinaryArray()});
+  }
+
+  /* Oldest first, so they are pushed back in the order they arrived */
+  std::stable_sort(transactions.begin(), transactions.end(), [](const StoredPoolTransaction& left, const StoredPoolTransaction& right) {
+    return left.receiveTime < right.receiveTime;
+  });
+
+  if (!saveTransactionPool(transactionPoolFile, transactions)) {
+    logger(Logging::WARNING) << "Failed to save transaction pool to " << transactionPoolFile;
+    return;
+  }
+
+  logger(Logging::DEBUGGING) << "Saved " << transactions.size() << " pool transactions to " << transactionPoolFile;
+}
+
+/* The stored transactions are checked against the current top block the same way as new ones,
+   except that the ring signatures of all of them are checked together, spread over all cores.
+   Transactions which were mined or double spent while the daemon was down, or which have
+   outlived the pool timeout, are dropped. */
+void Core::loadPoolTransactions() {
+  std::vector<StoredPoolTransaction> storedTransactions;
+  const auto loadResult = loadTransactionPool(transactionPoolFile, storedTransactions);
+  if (loadResult == TransactionPoolLoadResult::NOT_FOUND) {
+    logger(Logging::DEBUGGING) << "No transaction pool loaded from " << transactionPoolFile;
+    return;
+  }
+
+  if (loadResult == TransactionPoolLoadResult::INVALID) {
+    logger(Logging::WARNING) << "Stored transaction pool in " << transactionPoolFile
+      << " is truncated or corrupt, starting with an empty pool";
+    return;
+  }
+
+  const auto loadStart = std::chrono::steady_clock::now();
+  const uint64_t now = static_cast<uint64_t>(time(nullptr));
+
+  struct PendingPoolTransaction {
+    CachedTransaction cachedTransaction;
+    TransactionValidatorState validatorState;
+    uint64_t receiveTime;
+    size_t signaturesBegin;
+    size_t signaturesEnd;
+    bool valid;
+  };
+
+  std::vector<PendingPoolTransaction> pending;
+  std::vector<Crypto::RingSignatureCheck> ringSignatures;
+
+  for (const auto& stored : storedTransactions) {
+    if (stored.receiveTime + currency.mempoolTxLiveTime() <= now) {
+      continue;
+    }
+
+    try {
+      CachedTransaction cachedTransaction(stored.transaction);
+
+      if (findSegmentContainingTransaction(cachedTransaction.getTransactionHash()) != nullptr) {
+        continue;
+      }
+
+      const size_t signaturesBegin = ringSignatures.size();
+
+      TransactionValidatorState validatorState;
+      if (!isTransactionValidForPool(cachedTransaction, validatorState, &ringSignatures)) {
+        ringSignatures.erase(ringSignatures.begin() + signaturesBegin, ringSignatures.end());
+        continue;
+      }
+
+      pending.push_back({std::move(cachedTransaction), std::move(validatorState), stored.receiveTime, signaturesBegin, ringSignatures.size(), true});
+    } catch (std::runtime_error&) {
+      continue;
+    }
+  }
+
+  /* Find the invalid signatures one after the other, restarting after the transaction owning each */
+  const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+  size_t checkedSignatures = 0;
+
+  while (checkedSignatures < ringSignatures.size()) {
+    const size_t invalidSignature = checkedSignatures + checkRingSignatures(ringSignatures.data() + checkedSignatures,
+      ringSignatures.size() - checkedSignatures, threadCount, signatureCheckPool);
+    if (invalidSignature == ringSignatures.size()) {
+      break;
+    }
+
+    auto owner = std::find_if(pending.begin(), pending.end(), [invalidSignature](const PendingPoolTransaction& transaction) {
+      return transaction.signaturesBegin <= invalidSignature && invalidSignature < transaction.signaturesEnd;
+    });
+
+    assert(owner != pending.end());
+    owner->valid = false;
+    checkedSignatures = owner->signaturesEnd;
+  }
+
+  std::vector<Crypto::Hash> addedTransactions;
+  for (auto& transaction : pending) {
+    if (!transaction.valid) {
+      continue;
+    }
+
+    const auto transactionHash = transaction.cachedTransaction.getTransactionHash();
+    if (transactionPool->pushTransaction(std::move(transaction.cachedTransaction), std::move(transaction.validatorState), transaction.receiveTime)) {
+      addedTransactions.push_back(transactionHash);
+    }
+  }
+
+  logger(Logging::INFO) << "Loaded " << addedTransactions.size() << " of " << storedTransactions.size() << " stored pool transactions in "
+                        << toSeconds(std::chrono::steady_clock::now() - loadStart) << " s";
+
+  if (!addedTransactions.empty()) {
+    notifyObservers(makeAddTransactionMessage(std::move(addedTransactions)));
+  }
+}
+
 void Core::updateBlockMedianSize() {
   auto mainChain = chainsLeaves[0];
 
@@ -2850,5 +3465,10 @@ std::time_t Core::getStartTime() const
   return start_time;
 }
 
+RingMemberCacheStatistics Core::getRingMemberCacheStatistics() const
+{
+  return ringMemberCache.getStatistics();
+}
+
 }
 
@@ -4,10 +4,12 @@
 // Please see the included LICENSE file for more information.
 
 #pragma once
+#include <chrono>
 #include <ctime>
 #include <vector>
 #include <unordered_map>
 #include "BlockchainCache.h"
+#include "BlockDetailsCache.h"
 #include "BlockchainMessages.h"
 #include "CachedBlock.h"
 #include "CachedTransaction.h"
@@ -23,15 +25,32 @@
 #include "IUpgradeManager.h"
 #include <Logging/LoggerMessage.h>
 #include "MessageQueue.h"
+#include "RingMemberCache.h"
 #include "TransactionValidatiorState.h"
 #include "SwappedVector.h"
 
 #include <System/ContextGroup.h>
+#include <System/ThreadPool.h>
 
 #include <WalletTypes.h>
 
 namespace CryptoNote {
 
+/* How long each stage of the last import of blocks.bin into the database took. Reading and
+   decoding run ahead of verifying and pushing, so the stages overlap. */
+struct ImportStatistics {
+  uint32_t blocks = 0;
+  uint64_t transactions = 0;
+  uint32_t verifiedBlocks = 0;
+  size_t decodingThreads = 0;
+
+  std::chrono::nanoseconds readTime{0};
+  std::chrono::nanoseconds decodeTime{0};
+  std::chrono::nanoseconds verifyTime{0};
+  std::chrono::nanoseconds pushTime{0};
+  std::chrono::nanoseconds totalTime{0};
+};
+
 class Core : public ICore, public ICoreInformation {
 public:
   Core(const Currency& currency, Logging::ILogger& logger, Checkpoints&& checkpoints, System::Dispatcher& dispatcher,
@@ -123,6 +142,9 @@ public:
 
   virtual BlockDetails getBlockDetails(const Crypto::Hash& blockHash) const override;
   BlockDetails getBlockDetails(const uint32_t blockHeight) const;
+  /* Details of the main chain blocks at the given heights, in the same order. Consecutive heights
+     are assembled together, and deeply confirmed blocks are served from a cache. */
+  std::vector<BlockDetails> getBlocksDetails(const std::vector<uint32_t>& blockHeights) const;
   virtual TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash) const override;
   virtual std::vector<Crypto::Hash> getAlternativeBlockHashesByIndex(uint32_t blockIndex) const override;
   virtual std::vector<Crypto::Hash> getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const override;
@@ -130,6 +152,19 @@ public:
 
   virtual uint64_t get_current_blockchain_height() const;
 
+  RingMemberCacheStatistics getRingMemberCacheStatistics() const;
+  BlockDetailsCacheStatistics getBlockDetailsCacheStatistics() const;
+
+  /* Whether blocks imported from blocks.bin on load() have their transactions validated, ring
+     signatures included. Blocks in the checkpoint zone are always trusted. Off by default. */
+  void setImportVerification(bool verify);
+  ImportStatistics getImportStatistics() const;
+
+  /* File the transaction pool is kept in across restarts. It is written on save() and
+     periodically, and reloaded and revalidated against the chain on load(). Empty, the
+     default, keeps the pool in memory only. */
+  void setTransactionPoolFile(const std::string& filename);
+
 private:
   const Currency& currency;
   System::Dispatcher& dispatcher;
@@ -137,27 +172,40 @@ private:
   Logging::LoggerRef logger;
   Checkpoints checkpoints;
   std::unique_ptr<IUpgradeManager> upgradeManager;
+  // declared before the chains so they outlive them: a DatabaseBlockchainCache commits, and so flushes
+  // the main chain storage, when it is destroyed
+  std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
+  std::unique_ptr<IMainChainStorage> mainChainStorage;
   std::vector<std::unique_ptr<IBlockchainCache>> chainsStorage;
   std::vector<IBlockchainCache*> chainsLeaves;
   std::unique_ptr<ITransactionPoolCleanWrapper> transactionPool;
   std::unordered_set<IBlockchainCache*> mainChainSet;
 
   std::string dataFolder;
+  std::string transactionPoolFile;
 
   IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
-  std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
-  std::unique_ptr<IMainChainStorage> mainChainStorage;
   bool initialized;
 
   time_t start_time;
 
   size_t blockMedianSize;
 
+  RingMemberCache ringMemberCache;
+  mutable BlockDetailsCache blockDetailsCache;
+
+  // checks the ring signatures of imported blocks and of the reloaded pool in parallel
+  System::ThreadPool signatureCheckPool;
+
+  bool verifyImportedBlocks;
+  ImportStatistics importStatistics;
+
   void throwIfNotInitialized() const;
   bool extractTransactions(const std::vector<BinaryArray>& rawTransactions, std::vector<CachedTransaction>& transactions, uint64_t& cumulativeSize);
 
   std::error_code validateSemantic(const Transaction& transaction, uint64_t& fee, uint32_t blockIndex);
-  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex);
+  std::error_code validateTransaction(const CachedTransaction& transaction, TransactionValidatorState& state, IBlockchainCache* cache, uint64_t& fee, uint32_t blockIndex,
+    std::vector<Crypto::RingSignatureCheck>* deferredSignatures = nullptr);
 
   uint32_t findBlockchainSupplement(const std::vector<Crypto::Hash>& remoteBlockIds) const;
   std::vector<Crypto::Hash> getBlockHashes(uint32_t startBlockIndex, uint32_t maxCount) const;
@@ -199,6 +247,10 @@ private:
   void mergeMainChainSegments();
   void mergeSegments(IBlockchainCache* acceptingSegment, IBlockchainCache* segment);
   TransactionDetails getTransactionDetails(const Crypto::Hash& transactionHash, IBlockchainCache* segment, bool foundInPool) const;
+  void fillTransactionDetails(const Transaction& rawTransaction, IBlockchainCache* segment, std::vector<uint32_t>&& globalIndexes,
+                              TransactionDetails& transactionDetails) const;
+  std::vector<BlockDetails> buildBlocksDetails(IBlockchainCache* segment, uint32_t startIndex, uint32_t count) const;
+  void cacheBlockDetails(const BlockDetails& blockDetails) const;
   void notifyOnSuccess(error::AddBlockErrorCode opResult, uint32_t previousBlockIndex, const CachedBlock& cachedBlock,
                        const IBlockchainCache& cache);
   void copyTransactionsToPool(IBlockchainCache* alt);
@@ -207,12 +259,17 @@ private:
   void actualizePoolTransactionsLite(const TransactionValidatorState& validatorState); //Checks pool txs only for double spend.
 
   void transactionPoolCleaningProcedure();
+  void transactionPoolSavingProcedure();
+  void savePoolTransactions();
+  void loadPoolTransactions();
   void updateBlockMedianSize();
   bool addTransactionToPool(CachedTransaction&& cachedTransaction);
-  bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState);
+  bool isTransactionValidForPool(const CachedTransaction& cachedTransaction, TransactionValidatorState& validatorState,
+    std::vector<Crypto::RingSignatureCheck>* deferredSignatures = nullptr);
 
   void initRootSegment();
   void importBlocksFromStorage();
+  void verifyImportedBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& transactions, size_t threadCount);
   void cutSegment(IBlockchainCache& segment, uint32_t startIndex);
 
   void switchMainChainStorage(uint32_t splitBlockIndex, IBlockchainCache& newChain);
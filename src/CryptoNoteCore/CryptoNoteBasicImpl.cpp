@@ -16,6 +16,9 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "CryptoNoteBasicImpl.h"
+
+#include <cstring>
+
 #include "CryptoNoteFormatUtils.h"
 #include "CryptoNoteTools.h"
 #include "CryptoNoteSerialization.h"
@@ -62,11 +65,12 @@ namespace CryptoNote {
   }
   //-----------------------------------------------------------------------
   std::string getAccountAddressAsStr(uint64_t prefix, const AccountPublicAddress& adr) {
-    BinaryArray ba;
-    bool r = toBinaryArray(adr, ba);
-    if (r) {}
-    assert(r);
-    return Tools::Base58::encode_addr(prefix, Common::asString(ba));
+    /* Same layout as the binary serialization of the address */
+    uint8_t keys[sizeof(adr.spendPublicKey) + sizeof(adr.viewPublicKey)];
+    memcpy(keys, &adr.spendPublicKey, sizeof(adr.spendPublicKey));
+    memcpy(keys + sizeof(adr.spendPublicKey), &adr.viewPublicKey, sizeof(adr.viewPublicKey));
+
+    return Tools::Base58::encode_addr(prefix, keys, sizeof(keys));
   }
   //-----------------------------------------------------------------------
   bool is_coinbase(const Transaction& tx) {
@@ -82,14 +86,17 @@ namespace CryptoNote {
   }
   //-----------------------------------------------------------------------
   bool parseAccountAddressString(uint64_t& prefix, AccountPublicAddress& adr, const std::string& str) {
-    std::string data;
-
-    return
-      Tools::Base58::decode_addr(str, prefix, data) &&
-      fromBinaryArray(adr, asBinaryArray(data)) &&
-      // ::serialization::parse_binary(data, adr) &&
-      check_key(adr.spendPublicKey) &&
-      check_key(adr.viewPublicKey);
+    uint8_t keys[sizeof(adr.spendPublicKey) + sizeof(adr.viewPublicKey)];
+    size_t size;
+
+    if (!Tools::Base58::decode_addr(str, prefix, keys, sizeof(keys), size) || size != sizeof(keys)) {
+      return false;
+    }
+
+    memcpy(&adr.spendPublicKey, keys, sizeof(adr.spendPublicKey));
+    memcpy(&adr.viewPublicKey, keys + sizeof(adr.spendPublicKey), sizeof(adr.viewPublicKey));
+
+    return check_key(adr.spendPublicKey) && check_key(adr.viewPublicKey);
   }
   ////-----------------------------------------------------------------------
   //bool operator ==(const CryptoNote::Transaction& a, const CryptoNote::Transaction& b) {
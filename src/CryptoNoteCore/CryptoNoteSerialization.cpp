@@ -62,28 +62,83 @@ struct BinaryVariantTagGetter: boost::static_visitor<uint8_t> {
   uint8_t operator()(const CryptoNote::BlockTemplate) { return  0xbb; }
 };
 
+template <typename T, typename S>
+bool serializePod(T& v, Common::StringView name, S& serializer) {
+  return serializer.binary(&v, sizeof(v), name);
+}
+
+// The same calls as ISerializer::operator() makes for an object, without going through ISerializer
+template <typename T, typename S>
+bool serializeField(T& value, Common::StringView name, S& serializer) {
+  if (!serializer.beginObject(name)) {
+    return false;
+  }
+
+  serialize(value, serializer);
+  serializer.endObject();
+  return true;
+}
+
+template <typename S>
+bool serializeField(Crypto::Hash& value, Common::StringView name, S& serializer) {
+  return serializePod(value, name, serializer);
+}
+
+template <typename S>
+bool serializeField(Crypto::PublicKey& value, Common::StringView name, S& serializer) {
+  return serializePod(value, name, serializer);
+}
+
+template <typename S>
+bool serializeField(Crypto::KeyImage& value, Common::StringView name, S& serializer) {
+  return serializePod(value, name, serializer);
+}
+
+template <typename T, typename S>
+bool serializeVector(std::vector<T>& value, Common::StringView name, S& serializer) {
+  uint64_t size = value.size();
+  if (!serializer.beginArray(size, name)) {
+    if (serializer.type() == ISerializer::INPUT) {
+      value.clear();
+    }
+
+    return false;
+  }
+
+  value.resize(size);
+
+  for (auto& item : value) {
+    serializeField(item, "", serializer);
+  }
+
+  serializer.endArray();
+  return true;
+}
+
+template <typename S>
 struct VariantSerializer : boost::static_visitor<> {
-  VariantSerializer(CryptoNote::ISerializer& serializer, const std::string& name) : s(serializer), name(name) {}
+  VariantSerializer(S& serializer, Common::StringView name) : s(serializer), name(name) {}
 
   template <typename T>
-  void operator() (T& param) { s(param, name); }
+  void operator() (T& param) { serializeField(param, name, s); }
 
-  CryptoNote::ISerializer& s;
-  std::string name;
+  S& s;
+  Common::StringView name;
 };
 
-void getVariantValue(CryptoNote::ISerializer& serializer, uint8_t tag, CryptoNote::TransactionInput& in) {
+template <typename S>
+void getVariantValue(S& serializer, uint8_t tag, CryptoNote::TransactionInput& in) {
   switch(tag) {
   case 0xff: {
     CryptoNote::BaseInput v;
-    serializer(v, "value");
+    serializeField(v, "value", serializer);
     in = v;
     break;
   }
   case 0x2: {
     CryptoNote::KeyInput v;
-    serializer(v, "value");
-    in = v;
+    serializeField(v, "value", serializer);
+    in = std::move(v);
     break;
   }
   default:
@@ -91,11 +146,12 @@ void getVariantValue(CryptoNote::ISerializer& serializer, uint8_t tag, CryptoNot
   }
 }
 
-void getVariantValue(CryptoNote::ISerializer& serializer, uint8_t tag, CryptoNote::TransactionOutputTarget& out) {
+template <typename S>
+void getVariantValue(S& serializer, uint8_t tag, CryptoNote::TransactionOutputTarget& out) {
   switch(tag) {
   case 0x2: {
     CryptoNote::KeyOutput v;
-    serializer(v, "data");
+    serializeField(v, "data", serializer);
     out = v;
     break;
   }
@@ -104,12 +160,8 @@ void getVariantValue(CryptoNote::ISerializer& serializer, uint8_t tag, CryptoNot
   }
 }
 
-template <typename T>
-bool serializePod(T& v, Common::StringView name, CryptoNote::ISerializer& serializer) {
-  return serializer.binary(&v, sizeof(v), name);
-}
-
-bool serializeVarintVector(std::vector<uint32_t>& vector, CryptoNote::ISerializer& serializer, Common::StringView name) {
+template <typename S>
+bool serializeVarintVector(std::vector<uint32_t>& vector, S& serializer, Common::StringView name) {
   uint64_t size = vector.size();
   
   if (!serializer.beginArray(size, name)) {
@@ -167,7 +219,10 @@ bool serialize(EllipticCurvePoint& ecPoint, Common::StringView name, CryptoNote:
 
 namespace CryptoNote {
 
-void serialize(TransactionPrefix& txP, ISerializer& serializer) {
+namespace {
+
+template <typename S>
+void serializeTransactionPrefix(TransactionPrefix& txP, S& serializer) {
   serializer(txP.version, "version");
 
   if (CURRENT_TRANSACTION_VERSION < txP.version && serializer.type() == ISerializer::INPUT) {
@@ -175,16 +230,17 @@ void serialize(TransactionPrefix& txP, ISerializer& serializer) {
   }
 
   serializer(txP.unlockTime, "unlock_time");
-  serializer(txP.inputs, "vin");
-  serializer(txP.outputs, "vout");
+  serializeVector(txP.inputs, "vin", serializer);
+  serializeVector(txP.outputs, "vout", serializer);
   serializeAsBinary(txP.extra, "extra", serializer);
 }
 
-void serialize(BaseTransaction& tx, ISerializer& serializer) {
+template <typename S>
+void serializeBaseTransaction(BaseTransaction& tx, S& serializer) {
   serializer(tx.version, "version");
   serializer(tx.unlockTime, "unlock_time");
-  serializer(tx.inputs, "vin");
-  serializer(tx.outputs, "vout");
+  serializeVector(tx.inputs, "vin", serializer);
+  serializeVector(tx.outputs, "vout", serializer);
   serializeAsBinary(tx.extra, "extra", serializer);
 
   if (tx.version >= TRANSACTION_VERSION_2) {
@@ -193,8 +249,9 @@ void serialize(BaseTransaction& tx, ISerializer& serializer) {
   }
 }
 
-void serialize(Transaction& tx, ISerializer& serializer) {
-  serialize(static_cast<TransactionPrefix&>(tx), serializer);
+template <typename S>
+void serializeTransaction(Transaction& tx, S& serializer) {
+  serializeTransactionPrefix(static_cast<TransactionPrefix&>(tx), serializer);
 
   uint64_t sigSize = tx.inputs.size();
   //TODO: make arrays without sizes
@@ -241,13 +298,14 @@ void serialize(Transaction& tx, ISerializer& serializer) {
 //  serializer.endArray();
 }
 
-void serialize(TransactionInput& in, ISerializer& serializer) {
+template <typename S>
+void serializeTransactionInput(TransactionInput& in, S& serializer) {
   if (serializer.type() == ISerializer::OUTPUT) {
     BinaryVariantTagGetter tagGetter;
     uint8_t tag = boost::apply_visitor(tagGetter, in);
     serializer.binary(&tag, sizeof(tag), "type");
 
-    VariantSerializer visitor(serializer, "value");
+    VariantSerializer<S> visitor(serializer, "value");
     boost::apply_visitor(visitor, in);
   } else {
     uint8_t tag;
@@ -257,28 +315,32 @@ void serialize(TransactionInput& in, ISerializer& serializer) {
   }
 }
 
-void serialize(BaseInput& gen, ISerializer& serializer) {
+template <typename S>
+void serializeBaseInput(BaseInput& gen, S& serializer) {
   serializer(gen.blockIndex, "height");
 }
 
-void serialize(KeyInput& key, ISerializer& serializer) {
+template <typename S>
+void serializeKeyInput(KeyInput& key, S& serializer) {
   serializer(key.amount, "amount");
   serializeVarintVector(key.outputIndexes, serializer, "key_offsets");
-  serializer(key.keyImage, "k_image");
+  serializeField(key.keyImage, "k_image", serializer);
 }
 
-void serialize(TransactionOutput& output, ISerializer& serializer) {
+template <typename S>
+void serializeTransactionOutput(TransactionOutput& output, S& serializer) {
   serializer(output.amount, "amount");
-  serializer(output.target, "target");
+  serializeField(output.target, "target", serializer);
 }
 
-void serialize(TransactionOutputTarget& output, ISerializer& serializer) {
+template <typename S>
+void serializeTransactionOutputTarget(TransactionOutputTarget& output, S& serializer) {
   if (serializer.type() == ISerializer::OUTPUT) {
     BinaryVariantTagGetter tagGetter;
     uint8_t tag = boost::apply_visitor(tagGetter, output);
     serializer.binary(&tag, sizeof(tag), "type");
 
-    VariantSerializer visitor(serializer, "data");
+    VariantSerializer<S> visitor(serializer, "data");
     boost::apply_visitor(visitor, output);
   } else {
     uint8_t tag;
@@ -288,16 +350,18 @@ void serialize(TransactionOutputTarget& output, ISerializer& serializer) {
   }
 }
 
-void serialize(KeyOutput& key, ISerializer& serializer) {
-  serializer(key.key, "key");
+template <typename S>
+void serializeKeyOutput(KeyOutput& key, S& serializer) {
+  serializeField(key.key, "key", serializer);
 }
 
-void serialize(ParentBlockSerializer& pbs, ISerializer& serializer) {
+template <typename S>
+void serializeParentBlock(ParentBlockSerializer& pbs, S& serializer) {
   serializer(pbs.m_parentBlock.majorVersion, "majorVersion");
 
   serializer(pbs.m_parentBlock.minorVersion, "minorVersion");
   serializer(pbs.m_timestamp, "timestamp");
-  serializer(pbs.m_parentBlock.previousBlockHash, "prevId");
+  serializeField(pbs.m_parentBlock.previousBlockHash, "prevId", serializer);
   serializer.binary(&pbs.m_nonce, sizeof(pbs.m_nonce), "nonce");
 
   if (pbs.m_hashingSerialization) {
@@ -309,7 +373,7 @@ void serialize(ParentBlockSerializer& pbs, ISerializer& serializer) {
     Crypto::Hash merkleRoot;
     Crypto::tree_hash_from_branch(pbs.m_parentBlock.baseTransactionBranch.data(), pbs.m_parentBlock.baseTransactionBranch.size(), minerTxHash, 0, merkleRoot);
 
-    serializer(merkleRoot, "merkleRoot");
+    serializeField(merkleRoot, "merkleRoot", serializer);
   }
 
   uint64_t txNum = static_cast<uint64_t>(pbs.m_parentBlock.transactionCount);
@@ -335,10 +399,10 @@ void serialize(ParentBlockSerializer& pbs, ISerializer& serializer) {
 //  serializer(m_parentBlock.baseTransactionBranch, "baseTransactionBranch");
   //TODO: Make arrays with computable size! This code won't work with json serialization!
   for (Crypto::Hash& hash: pbs.m_parentBlock.baseTransactionBranch) {
-    serializer(hash, "");
+    serializeField(hash, "", serializer);
   }
 
-  serializer(pbs.m_parentBlock.baseTransaction, "minerTx");
+  serializeField(pbs.m_parentBlock.baseTransaction, "minerTx", serializer);
 
   TransactionExtraMergeMiningTag mmTag;
   if (!getMergeMiningTagFromExtra(pbs.m_parentBlock.baseTransaction.extra, mmTag)) {
@@ -360,11 +424,12 @@ void serialize(ParentBlockSerializer& pbs, ISerializer& serializer) {
 //  serializer(m_parentBlock.blockchainBranch, "blockchainBranch");
   //TODO: Make arrays with computable size! This code won't work with json serialization!
   for (Crypto::Hash& hash: pbs.m_parentBlock.blockchainBranch) {
-    serializer(hash, "");
+    serializeField(hash, "", serializer);
   }
 }
 
-void serializeBlockHeader(BlockHeader& header, ISerializer& serializer) {
+template <typename S>
+void serializeBlockHeader(BlockHeader& header, S& serializer) {
   serializer(header.majorVersion, "major_version");
   if (header.majorVersion > BLOCK_MAJOR_VERSION_4) {
     throw std::runtime_error("Wrong major version");
@@ -373,29 +438,209 @@ void serializeBlockHeader(BlockHeader& header, ISerializer& serializer) {
   serializer(header.minorVersion, "minor_version");
   if (header.majorVersion == BLOCK_MAJOR_VERSION_1) {
     serializer(header.timestamp, "timestamp");
-    serializer(header.previousBlockHash, "prev_id");
+    serializeField(header.previousBlockHash, "prev_id", serializer);
     serializer.binary(&header.nonce, sizeof(header.nonce), "nonce");
   } else if (header.majorVersion >= BLOCK_MAJOR_VERSION_2) {
-    serializer(header.previousBlockHash, "prev_id");
+    serializeField(header.previousBlockHash, "prev_id", serializer);
   } else {
     throw std::runtime_error("Wrong major version");
   }
 }
 
+template <typename S>
+void serializeBlockTemplate(BlockTemplate& block, S& serializer) {
+  serializeBlockHeader(block, serializer);
+
+  if (block.majorVersion >= BLOCK_MAJOR_VERSION_2) {
+    auto parentBlockSerializer = makeParentBlockSerializer(block, false, false);
+    serializeField(parentBlockSerializer, "parent_block", serializer);
+  }
+
+  serializeField(block.baseTransaction, "miner_tx", serializer);
+  serializeVector(block.transactionHashes, "tx_hashes", serializer);
+}
+
+// unpack to strings to maintain protocol compatibility with older versions
+template <typename S>
+void serializeRawBlock(RawBlock& rawBlock, S& serializer) {
+  if (serializer.type() == ISerializer::INPUT) {
+    uint64_t blockSize;
+    serializer(blockSize, "block_size");
+    rawBlock.block.resize(static_cast<uint64_t>(blockSize));
+  } else {
+    uint64_t blockSize = rawBlock.block.size();
+    serializer(blockSize, "block_size");
+  }
+
+  serializer.binary(rawBlock.block.data(), rawBlock.block.size(), "block");
+
+  if (serializer.type() == ISerializer::INPUT) {
+    uint64_t txCount;
+    serializer(txCount, "tx_count");
+    rawBlock.transactions.resize(static_cast<uint64_t>(txCount));
+
+    for (auto& txBlob : rawBlock.transactions) {
+      uint64_t txSize;
+      serializer(txSize, "tx_size");
+      txBlob.resize(txSize);
+      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
+    }
+  } else {
+    uint64_t txCount = rawBlock.transactions.size();
+    serializer(txCount, "tx_count");
+
+    for (auto& txBlob : rawBlock.transactions) {
+      uint64_t txSize = txBlob.size();
+      serializer(txSize, "tx_size");
+      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
+    }
+  }
+}
+
+}
+
+void serialize(TransactionPrefix& txP, ISerializer& serializer) {
+  serializeTransactionPrefix(txP, serializer);
+}
+
+void serialize(TransactionPrefix& txP, BinaryInputStreamSerializer& serializer) {
+  serializeTransactionPrefix(txP, serializer);
+}
+
+void serialize(TransactionPrefix& txP, BinaryOutputStreamSerializer& serializer) {
+  serializeTransactionPrefix(txP, serializer);
+}
+
+void serialize(BaseTransaction& tx, ISerializer& serializer) {
+  serializeBaseTransaction(tx, serializer);
+}
+
+void serialize(BaseTransaction& tx, BinaryInputStreamSerializer& serializer) {
+  serializeBaseTransaction(tx, serializer);
+}
+
+void serialize(BaseTransaction& tx, BinaryOutputStreamSerializer& serializer) {
+  serializeBaseTransaction(tx, serializer);
+}
+
+void serialize(Transaction& tx, ISerializer& serializer) {
+  serializeTransaction(tx, serializer);
+}
+
+void serialize(Transaction& tx, BinaryInputStreamSerializer& serializer) {
+  serializeTransaction(tx, serializer);
+}
+
+void serialize(Transaction& tx, BinaryOutputStreamSerializer& serializer) {
+  serializeTransaction(tx, serializer);
+}
+
+void serialize(TransactionInput& in, ISerializer& serializer) {
+  serializeTransactionInput(in, serializer);
+}
+
+void serialize(TransactionInput& in, BinaryInputStreamSerializer& serializer) {
+  serializeTransactionInput(in, serializer);
+}
+
+void serialize(TransactionInput& in, BinaryOutputStreamSerializer& serializer) {
+  serializeTransactionInput(in, serializer);
+}
+
+void serialize(BaseInput& gen, ISerializer& serializer) {
+  serializeBaseInput(gen, serializer);
+}
+
+void serialize(BaseInput& gen, BinaryInputStreamSerializer& serializer) {
+  serializeBaseInput(gen, serializer);
+}
+
+void serialize(BaseInput& gen, BinaryOutputStreamSerializer& serializer) {
+  serializeBaseInput(gen, serializer);
+}
+
+void serialize(KeyInput& key, ISerializer& serializer) {
+  serializeKeyInput(key, serializer);
+}
+
+void serialize(KeyInput& key, BinaryInputStreamSerializer& serializer) {
+  serializeKeyInput(key, serializer);
+}
+
+void serialize(KeyInput& key, BinaryOutputStreamSerializer& serializer) {
+  serializeKeyInput(key, serializer);
+}
+
+void serialize(TransactionOutput& output, ISerializer& serializer) {
+  serializeTransactionOutput(output, serializer);
+}
+
+void serialize(TransactionOutput& output, BinaryInputStreamSerializer& serializer) {
+  serializeTransactionOutput(output, serializer);
+}
+
+void serialize(TransactionOutput& output, BinaryOutputStreamSerializer& serializer) {
+  serializeTransactionOutput(output, serializer);
+}
+
+void serialize(TransactionOutputTarget& output, ISerializer& serializer) {
+  serializeTransactionOutputTarget(output, serializer);
+}
+
+void serialize(TransactionOutputTarget& output, BinaryInputStreamSerializer& serializer) {
+  serializeTransactionOutputTarget(output, serializer);
+}
+
+void serialize(TransactionOutputTarget& output, BinaryOutputStreamSerializer& serializer) {
+  serializeTransactionOutputTarget(output, serializer);
+}
+
+void serialize(KeyOutput& key, ISerializer& serializer) {
+  serializeKeyOutput(key, serializer);
+}
+
+void serialize(KeyOutput& key, BinaryInputStreamSerializer& serializer) {
+  serializeKeyOutput(key, serializer);
+}
+
+void serialize(KeyOutput& key, BinaryOutputStreamSerializer& serializer) {
+  serializeKeyOutput(key, serializer);
+}
+
+void serialize(ParentBlockSerializer& pbs, ISerializer& serializer) {
+  serializeParentBlock(pbs, serializer);
+}
+
+void serialize(ParentBlockSerializer& pbs, BinaryInputStreamSerializer& serializer) {
+  serializeParentBlock(pbs, serializer);
+}
+
+void serialize(ParentBlockSerializer& pbs, BinaryOutputStreamSerializer& serializer) {
+  serializeParentBlock(pbs, serializer);
+}
+
 void serialize(BlockHeader& header, ISerializer& serializer) {
   serializeBlockHeader(header, serializer);
 }
 
+void serialize(BlockHeader& header, BinaryInputStreamSerializer& serializer) {
+  serializeBlockHeader(header, serializer);
+}
+
+void serialize(BlockHeader& header, BinaryOutputStreamSerializer& serializer) {
+  serializeBlockHeader(header, serializer);
+}
+
 void serialize(BlockTemplate& block, ISerializer& serializer) {
-  serializeBlockHeader(block, serializer);
+  serializeBlockTemplate(block, serializer);
+}
 
-  if (block.majorVersion >= BLOCK_MAJOR_VERSION_2) {
-    auto parentBlockSerializer = makeParentBlockSerializer(block, false, false);
-    serializer(parentBlockSerializer, "parent_block");
-  }
+void serialize(BlockTemplate& block, BinaryInputStreamSerializer& serializer) {
+  serializeBlockTemplate(block, serializer);
+}
 
-  serializer(block.baseTransaction, "miner_tx");
-  serializer(block.transactionHashes, "tx_hashes");
+void serialize(BlockTemplate& block, BinaryOutputStreamSerializer& serializer) {
+  serializeBlockTemplate(block, serializer);
 }
 
 void serialize(AccountPublicAddress& address, ISerializer& serializer) {
@@ -437,40 +682,16 @@ void serialize(KeyPair& keyPair, ISerializer& serializer) {
   serializer(keyPair.publicKey, "public_key");
 }
 
-// unpack to strings to maintain protocol compatibility with older versions
 void serialize(RawBlock& rawBlock, ISerializer& serializer) {
-  if (serializer.type() == ISerializer::INPUT) {
-    uint64_t blockSize;
-    serializer(blockSize, "block_size");
-    rawBlock.block.resize(static_cast<uint64_t>(blockSize));
-  } else {
-    uint64_t blockSize = rawBlock.block.size();
-    serializer(blockSize, "block_size");
-  }
-
-  serializer.binary(rawBlock.block.data(), rawBlock.block.size(), "block");
-
-  if (serializer.type() == ISerializer::INPUT) {
-    uint64_t txCount;
-    serializer(txCount, "tx_count");
-    rawBlock.transactions.resize(static_cast<uint64_t>(txCount));
+  serializeRawBlock(rawBlock, serializer);
+}
 
-    for (auto& txBlob : rawBlock.transactions) {
-      uint64_t txSize;
-      serializer(txSize, "tx_size");
-      txBlob.resize(txSize);
-      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
-    }
-  } else {
-    uint64_t txCount = rawBlock.transactions.size();
-    serializer(txCount, "tx_count");
+void serialize(RawBlock& rawBlock, BinaryInputStreamSerializer& serializer) {
+  serializeRawBlock(rawBlock, serializer);
+}
 
-    for (auto& txBlob : rawBlock.transactions) {
-      uint64_t txSize = txBlob.size();
-      serializer(txSize, "tx_size");
-      serializer.binary(txBlob.data(), txBlob.size(), "transaction");
-    }
-  }
+void serialize(RawBlock& rawBlock, BinaryOutputStreamSerializer& serializer) {
+  serializeRawBlock(rawBlock, serializer);
 }
 
 } //namespace CryptoNote
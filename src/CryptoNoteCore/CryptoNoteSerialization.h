@@ -39,6 +39,8 @@ namespace CryptoNote {
 
 struct AccountKeys;
 struct TransactionExtraMergeMiningTag;
+class BinaryInputStreamSerializer;
+class BinaryOutputStreamSerializer;
 
 enum class SerializationTag : uint8_t { Base = 0xff, Key = 0x2, Transaction = 0xcc, Block = 0xbb };
 
@@ -66,4 +68,35 @@ void serialize(AccountKeys& keys, ISerializer& s);
 void serialize(KeyPair& keyPair, ISerializer& serializer);
 void serialize(RawBlock& rawBlock, ISerializer& serializer);
 
+// Overloads for the binary formats. They share the implementation of the ISerializer overloads above,
+// but it is instantiated for the concrete serializer, so the calls for each field are not virtual.
+
+void serialize(TransactionPrefix& txP, BinaryInputStreamSerializer& serializer);
+void serialize(BaseTransaction& tx, BinaryInputStreamSerializer& serializer);
+void serialize(Transaction& tx, BinaryInputStreamSerializer& serializer);
+void serialize(TransactionInput& in, BinaryInputStreamSerializer& serializer);
+void serialize(BaseInput& gen, BinaryInputStreamSerializer& serializer);
+void serialize(KeyInput& key, BinaryInputStreamSerializer& serializer);
+void serialize(TransactionOutput& output, BinaryInputStreamSerializer& serializer);
+void serialize(TransactionOutputTarget& output, BinaryInputStreamSerializer& serializer);
+void serialize(KeyOutput& key, BinaryInputStreamSerializer& serializer);
+void serialize(ParentBlockSerializer& pbs, BinaryInputStreamSerializer& serializer);
+void serialize(BlockHeader& header, BinaryInputStreamSerializer& serializer);
+void serialize(BlockTemplate& block, BinaryInputStreamSerializer& serializer);
+void serialize(RawBlock& rawBlock, BinaryInputStreamSerializer& serializer);
+
+void serialize(TransactionPrefix& txP, BinaryOutputStreamSerializer& serializer);
+void serialize(BaseTransaction& tx, BinaryOutputStreamSerializer& serializer);
+void serialize(Transaction& tx, BinaryOutputStreamSerializer& serializer);
+void serialize(TransactionInput& in, BinaryOutputStreamSerializer& serializer);
+void serialize(BaseInput& gen, BinaryOutputStreamSerializer& serializer);
+void serialize(KeyInput& key, BinaryOutputStreamSerializer& serializer);
+void serialize(TransactionOutput& output, BinaryOutputStreamSerializer& serializer);
+void serialize(TransactionOutputTarget& output, BinaryOutputStreamSerializer& serializer);
+void serialize(KeyOutput& key, BinaryOutputStreamSerializer& serializer);
+void serialize(ParentBlockSerializer& pbs, BinaryOutputStreamSerializer& serializer);
+void serialize(BlockHeader& header, BinaryOutputStreamSerializer& serializer);
+void serialize(BlockTemplate& block, BinaryOutputStreamSerializer& serializer);
+void serialize(RawBlock& rawBlock, BinaryOutputStreamSerializer& serializer);
+
 }
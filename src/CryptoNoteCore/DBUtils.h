@@ -33,7 +33,7 @@ namespace DB {
   const std::string BLOCK_INDEX_TO_KEY_IMAGE_PREFIX = "0";
   const std::string BLOCK_INDEX_TO_TX_HASHES_PREFIX = "1";
   const std::string BLOCK_INDEX_TO_TRANSACTION_INFO_PREFIX = "2";
-  const std::string BLOCK_INDEX_TO_RAW_BLOCK_PREFIX = "4";
+  // "4" held the raw blocks, which are kept in blocks.bin only now. Don't reuse it for other data.
 
   const std::string BLOCK_HASH_TO_BLOCK_INDEX_PREFIX = "5";
   const std::string BLOCK_INDEX_TO_BLOCK_INFO_PREFIX = "6";
@@ -48,6 +48,8 @@ namespace DB {
   const std::string CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX = "e";
 
   const std::string PAYMENT_ID_TO_TX_HASH_PREFIX = "f";
+  // lets a transaction's payment id be removed without its raw block
+  const std::string TX_HASH_TO_PAYMENT_ID_PREFIX = "c";
 
   const std::string TIMESTAMP_TO_BLOCKHASHES_PREFIX = "g";
 
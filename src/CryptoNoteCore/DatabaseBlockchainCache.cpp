@@ -8,6 +8,7 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <unordered_set>
 
 #include <boost/iterator/iterator_facade.hpp>
 
@@ -19,6 +20,7 @@
 
 #include <CryptoNoteCore/BlockchainStorage.h>
 #include <CryptoNoteCore/CryptoNoteTools.h>
+#include <CryptoNoteCore/CoreErrors.h>
 #include <CryptoNoteCore/CryptoNoteBasicImpl.h>
 #include "CryptoNoteCore/TransactionExtra.h"
 
@@ -29,6 +31,11 @@ namespace {
 const uint32_t ONE_DAY_SECONDS = 60 * 60 * 24;
 const CachedBlockInfo NULL_CACHED_BLOCK_INFO {NULL_HASH, 0, 0, 0, 0, 0};
 
+// pushed blocks are committed to the database together, at most this many at once
+const uint32_t MAX_UNCOMMITTED_BLOCKS_COUNT = 100;
+// a block is committed right away if the previous commit is older than this
+const std::chrono::seconds BLOCKS_COMMIT_INTERVAL = std::chrono::seconds(1);
+
 bool requestPackedOutputs(IBlockchainCache::Amount amount, Common::ArrayView<uint32_t> globalIndexes, IDataBase& database, std::vector<PackedOutIndex>& result) {
   BlockchainReadBatch readBatch;
   result.reserve(result.size() + globalIndexes.getSize());
@@ -86,29 +93,6 @@ bool requestTransactionHashesForGlobalOutputIndexes(const std::vector<PackedOutI
   return true;
 }
 
-bool requestCachedTransactionInfos(const std::vector<Crypto::Hash>& transactionHashes, IDataBase& database, std::vector<CachedTransactionInfo>& result) {
-  result.reserve(result.size() + transactionHashes.size());
-
-  BlockchainReadBatch transactionsBatch;
-  std::for_each(transactionHashes.begin(), transactionHashes.end(), [&transactionsBatch] (const Crypto::Hash& hash) { transactionsBatch.requestCachedTransaction(hash); });
-  auto dbResult = database.read(transactionsBatch);
-  if (dbResult) {
-    return false;
-  }
-
-  auto readResult = transactionsBatch.extractResult();
-  const auto& transactions = readResult.getCachedTransactions();
-  if (transactions.size() != transactionHashes.size()) {
-    return false;
-  }
-
-  for (const auto& hash: transactionHashes) {
-    result.push_back(transactions.at(hash));
-  }
-
-  return true;
-}
-
 //returns CachedTransactionInfos in the same or as packedOuts are
 /*
 bool requestCachedTransactionInfos(const std::vector<PackedOutIndex>& packedOuts, IDataBase& database, std::vector<CachedTransactionInfo>& result) {
@@ -183,44 +167,6 @@ std::pair<boost::optional<uint32_t>, bool> requestClosestBlockIndexByTimestamp(u
   return result;
 }
 
-bool requestRawBlock(IDataBase& database, uint32_t blockIndex, RawBlock& block) {
-  auto batch = BlockchainReadBatch().requestRawBlock(blockIndex);
-
-  auto error = database.read(batch);
-  if (error) {
-    //may be throw in all similiar functions???
-    return false;
-  }
-
-  auto result = batch.extractResult();
-  if (result.getRawBlocks().count(blockIndex) == 0) {
-    return false;
-  }
-
-  block = result.getRawBlocks().at(blockIndex);
-  return true;
-}
-
-Transaction extractTransaction(const RawBlock& block, uint32_t transactionIndex) {
-  assert(transactionIndex < block.transactions.size() + 1);
-
-  if (transactionIndex != 0) {
-    Transaction transaction;
-    bool r = fromBinaryArray(transaction, block.transactions[transactionIndex - 1]);
-    if (r) {}
-    assert(r);
-
-    return transaction;
-  }
-
-  BlockTemplate blockTemplate;
-  bool r = fromBinaryArray(blockTemplate, block.block);
-  if (r) {}
-  assert(r);
-
-  return blockTemplate.baseTransaction;
-}
-
 size_t requestPaymentIdTransactionsCount(IDataBase& database, const Crypto::Hash& paymentId) {
   auto batch = BlockchainReadBatch().requestTransactionCountByPaymentId(paymentId);
   auto error = database.read(batch);
@@ -236,26 +182,6 @@ size_t requestPaymentIdTransactionsCount(IDataBase& database, const Crypto::Hash
   return result.getTransactionCountByPaymentIds().at(paymentId);
 }
 
-bool requestPaymentId(IDataBase& database, const Crypto::Hash& transactionHash, Crypto::Hash& paymentId) {
-  std::vector<CachedTransactionInfo> cachedTransactions;
-
-  if (!requestCachedTransactionInfos({transactionHash}, database, cachedTransactions)) {
-    return false;
-  }
-
-  if (cachedTransactions.empty()) {
-    return false;
-  }
-
-  RawBlock block;
-  if (!requestRawBlock(database, cachedTransactions[0].blockIndex, block)) {
-    return false;
-  }
-
-  Transaction transaction = extractTransaction(block, cachedTransactions[0].transactionIndex);
-  return getPaymentIdFromTxExtra(transaction.extra, paymentId);
-}
-
 uint32_t requestKeyOutputGlobalIndexesCountForAmount(IBlockchainCache::Amount amount, IDataBase& database) {
   auto batch = BlockchainReadBatch().requestKeyOutputGlobalIndexesCountForAmount(amount);
   auto dbError = database.read(batch);
@@ -415,7 +341,7 @@ private:
   uint32_t schemeVersion;
 };
 
-const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+const uint32_t CURRENT_DB_SCHEME_VERSION = 3;
 
 }
 
@@ -425,8 +351,10 @@ struct DatabaseBlockchainCache::ExtendedPushedBlockInfo {
 };
 
 
-DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger)
-    : currency(curr), database(dataBase), blockchainCacheFactory(blockchainCacheFactory), logger(_logger, "DatabaseBlockchainCache") {
+DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase& dataBase, IMainChainStorage& mainChainStorage,
+                                                 IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& _logger)
+    : currency(curr), database(dataBase), mainChainStorage(mainChainStorage), blockchainCacheFactory(blockchainCacheFactory),
+      logger(_logger, "DatabaseBlockchainCache"), uncommittedBlocksCount(0), lastCommitTime(std::chrono::steady_clock::now()) {
   DatabaseVersionReadBatch readBatch;
   auto ec = database.read(readBatch);
   if (ec) {
@@ -450,6 +378,16 @@ DatabaseBlockchainCache::DatabaseBlockchainCache(const Currency& curr, IDataBase
     logger(Logging::DEBUGGING) << "top block index is nill, add genesis block";
     addGenesisBlock(CachedBlock (currency.genesisBlock()));
   }
+
+  commitBlocks();
+}
+
+DatabaseBlockchainCache::~DatabaseBlockchainCache() {
+  try {
+    commitBlocks();
+  } catch (std::exception& e) {
+    logger(Logging::ERROR) << "Failed to commit blocks on exit: " << e.what();
+  }
 }
 
 bool DatabaseBlockchainCache::checkDBSchemeVersion(IDataBase& database, Logging::ILogger& _logger) {
@@ -516,32 +454,60 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
 
   auto cache = blockchainCacheFactory.createBlockchainCache(currency, this, splitBlockIndex);
 
-  using DeleteBlockInfo = std::tuple<uint32_t, Crypto::Hash, TransactionValidatorState, uint64_t>;
-  std::vector<DeleteBlockInfo> deletingBlocks;
-
-  BlockchainWriteBatch writeBatch;
   auto currentTop = getTopBlockIndex();
   for (uint32_t blockIndex = splitBlockIndex; blockIndex <= currentTop; ++blockIndex) {
     ExtendedPushedBlockInfo extendedInfo = getExtendedPushedBlockInfo(blockIndex);
 
-    auto validatorState = extendedInfo.pushedBlockInfo.validatorState;
     logger(Logging::DEBUGGING) << "pushing block " << blockIndex << " to child segment";
-    auto blockHash = pushBlockToAnotherCache(*cache, std::move(extendedInfo.pushedBlockInfo));
+    pushBlockToAnotherCache(*cache, std::move(extendedInfo.pushedBlockInfo));
+  }
+
+  // all data and indexes are now copied, no errors detected, can now erase data from database
+  removeBlocksFrom(splitBlockIndex);
+
+  children.push_back(cache.get());
+
+  logger(Logging::DEBUGGING) << "split completed";
+  // return new cache
+  return cache;
+}
+
+void DatabaseBlockchainCache::cut(uint32_t startIndex) {
+  assert(startIndex <= getTopBlockIndex());
+  logger(Logging::DEBUGGING) << "cut at index " << startIndex << " started, top block index: " << getTopBlockIndex();
+
+  removeBlocksFrom(startIndex);
 
-    deletingBlocks.emplace_back(blockIndex, blockHash, validatorState, extendedInfo.timestamp);
+  logger(Logging::DEBUGGING) << "cut completed";
+}
+
+// Only reads the DB, so it works for blocks which are gone from the main chain storage, too
+void DatabaseBlockchainCache::removeBlocksFrom(uint32_t splitBlockIndex) {
+  auto currentTop = getTopBlockIndex();
+
+  BlockchainReadBatch readBatch;
+  readBatch.requestCachedBlocks(splitBlockIndex, currentTop + 1);
+  for (uint32_t blockIndex = splitBlockIndex; blockIndex <= currentTop; ++blockIndex) {
+    readBatch.requestSpentKeyImagesByBlock(blockIndex);
   }
 
-  for (auto it = deletingBlocks.rbegin(); it != deletingBlocks.rend(); ++it) {
-    auto blockIndex = std::get<0>(*it);
-    auto blockHash = std::get<1>(*it);
-    auto& validatorState = std::get<2>(*it);
-    uint64_t timestamp = std::get<3>(*it);
+  auto blocksResult = readDatabase(readBatch);
+  const auto& cachedBlocks = blocksResult.getCachedBlocks();
+  const auto& spentKeyImagesByBlock = blocksResult.getSpentKeyImagesByBlock();
+
+  BlockchainWriteBatch writeBatch;
+  for (uint32_t blockIndex = currentTop + 1; blockIndex-- > splitBlockIndex;) {
+    const CachedBlockInfo& blockInfo = cachedBlocks.at(blockIndex);
 
-    writeBatch.removeCachedBlock(blockHash, blockIndex).removeRawBlock(blockIndex);
+    TransactionValidatorState validatorState;
+    const auto& spentKeyImages = spentKeyImagesByBlock.at(blockIndex);
+    validatorState.spentKeyImages.insert(spentKeyImages.begin(), spentKeyImages.end());
+
+    writeBatch.removeCachedBlock(blockInfo.blockHash, blockIndex);
     requestDeleteSpentOutputs(writeBatch,
                               blockIndex,
                               validatorState);
-    requestRemoveTimestamp(writeBatch, timestamp, blockHash);
+    requestRemoveTimestamp(writeBatch, blockInfo.timestamp, blockInfo.blockHash);
   }
 
   auto deletingTransactionHashes = requestTransactionHashesFromBlockIndex(splitBlockIndex);
@@ -550,7 +516,7 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
 
   std::vector<ExtendedTransactionInfo> extendedTransactions;
   if (!requestExtendedTransactionInfos(deletingTransactionHashes, database, extendedTransactions)) {
-    logger(Logging::ERROR) << "Error while split: failed to request extended transaction info";
+    logger(Logging::ERROR) << "Error while removing blocks: failed to request extended transaction info";
     throw std::runtime_error("failed to request extended transaction info"); //TODO: make error codes
   }
 
@@ -566,26 +532,23 @@ std::unique_ptr<IBlockchainCache> DatabaseBlockchainCache::split(uint32_t splitB
   deleteClosestTimestampBlockIndex(writeBatch, splitBlockIndex);
 
   logger(Logging::DEBUGGING) << "Performing delete operations";
-  // all data and indexes are now copied, no errors detected, can now erase data from database
   auto err = database.write(writeBatch);
   if (err) {
-    logger(Logging::ERROR) << "split write failed, " << err.message();
+    logger(Logging::ERROR) << "removing blocks write failed, " << err.message();
     throw std::runtime_error(err.message());
   }
 
+  commitBlocks();
+
   cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
+  closestTimestampDay = boost::none;
 
-  children.push_back(cache.get());
   logger(Logging::TRACE) << "Delete successfull";
 
   // invalidate top block index and hash
   topBlockIndex = boost::none;
   topBlockHash = boost::none;
   transactionsCount = boost::none;
-
-  logger(Logging::DEBUGGING) << "split completed";
-  // return new cache
-  return cache;
 }
 
 //returns hash of pushed block
@@ -641,15 +604,21 @@ void DatabaseBlockchainCache::requestDeleteTransactions(BlockchainWriteBatch& wr
 }
 
 void DatabaseBlockchainCache::requestDeletePaymentIds(BlockchainWriteBatch& writeBatch, const std::vector<Crypto::Hash>& transactionHashes) {
-  std::unordered_map<Crypto::Hash, size_t> paymentCounts;
+  if (transactionHashes.empty()) {
+    return;
+  }
 
+  // read from the DB, the raw blocks of the transactions may already be gone from the main chain storage
+  BlockchainReadBatch readBatch;
   for (const auto& hash: transactionHashes) {
-    Crypto::Hash paymentId;
-    if (!requestPaymentId(database, hash, paymentId)) {
-      continue;
-    }
+    readBatch.requestPaymentIdByTransactionHash(hash);
+  }
+
+  std::unordered_map<Crypto::Hash, size_t> paymentCounts;
 
-    paymentCounts[paymentId] += 1;
+  auto dbResult = readDatabase(readBatch);
+  for (const auto& kv: dbResult.getPaymentIdsByTransactionHashes()) {
+    paymentCounts[kv.second] += 1;
   }
 
   for (const auto& kv: paymentCounts) {
@@ -807,14 +776,22 @@ void DatabaseBlockchainCache::pushTransaction(const CachedTransaction& cachedTra
 uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t diff) const {
   auto it = keyOutputCountsForAmounts.find(amount);
   if (it == keyOutputCountsForAmounts.end()) {
-    logger(Logging::TRACE) << "updateKeyOutputCount: failed to found key for amount, request database";
-
     BlockchainReadBatch batch;
-    auto result = readDatabase(batch.requestKeyOutputGlobalIndexesCountForAmount(amount));
-    auto found = result.getKeyOutputGlobalIndexesCountForAmounts().find(amount);
-    auto val = found != result.getKeyOutputGlobalIndexesCountForAmounts().end() ? found->second : 0;
+    uint32_t val = 0;
+
+    auto prefetched = pushedBlockKeyOutputCounts.find(amount);
+    if (prefetched != pushedBlockKeyOutputCounts.end()) {
+      val = prefetched->second;
+    } else {
+      logger(Logging::TRACE) << "updateKeyOutputCount: failed to found key for amount, request database";
+
+      auto result = readDatabase(batch.requestKeyOutputGlobalIndexesCountForAmount(amount));
+      auto found = result.getKeyOutputGlobalIndexesCountForAmounts().find(amount);
+      val = found != result.getKeyOutputGlobalIndexesCountForAmounts().end() ? found->second : 0;
+      logger(Logging::TRACE) << "updateKeyOutputCount: database replied: amount " << amount << " value " << val;
+    }
+
     it = keyOutputCountsForAmounts.insert({ amount, val }).first;
-    logger(Logging::TRACE) << "updateKeyOutputCount: database replied: amount " << amount << " value " << val;
 
     if (val == 0) {
       if (!keyOutputAmountsCount) {
@@ -835,33 +812,129 @@ uint32_t DatabaseBlockchainCache::updateKeyOutputCount(Amount amount, int32_t di
 }
 
 void DatabaseBlockchainCache::insertPaymentId(BlockchainWriteBatch& batch, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId) {
-  BlockchainReadBatch readBatch;
-  uint32_t count = 0;
+  auto it = pushedBlockPaymentIdCounts.find(paymentId);
+  if (it == pushedBlockPaymentIdCounts.end()) {
+    BlockchainReadBatch readBatch;
+    uint32_t count = 0;
+
+    auto readResult = readDatabase(readBatch.requestTransactionCountByPaymentId(paymentId));
+    if (readResult.getTransactionCountByPaymentIds().count(paymentId) != 0) {
+      count = readResult.getTransactionCountByPaymentIds().at(paymentId);
+    }
 
-  auto readResult = readDatabase(readBatch.requestTransactionCountByPaymentId(paymentId));
-  if (readResult.getTransactionCountByPaymentIds().count(paymentId) != 0) {
-    count = readResult.getTransactionCountByPaymentIds().at(paymentId);
+    it = pushedBlockPaymentIdCounts.insert({ paymentId, count }).first;
   }
 
-  count += 1;
+  // counted here too, so two transactions of one block with the same payment id get different indexes
+  it->second += 1;
 
-  batch.insertPaymentId(transactionHash, paymentId, count);
+  batch.insertPaymentId(transactionHash, paymentId, it->second);
 }
 
-void DatabaseBlockchainCache::insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, const Crypto::Hash& blockHash) {
+void DatabaseBlockchainCache::insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, std::vector<Crypto::Hash>&& blockHashes,
+                                                   const Crypto::Hash& blockHash) {
+  blockHashes.emplace_back(blockHash);
+
+  batch.insertTimestamp(timestamp, blockHashes);
+}
+
+/*
+ * Everything pushBlock needs from the database which isn't known in memory is read in one batch:
+ * the key output counts of new amounts, the transaction counts of payment ids, and the timestamp
+ * indexes. Returns the hashes of the blocks which already have the timestamp of the pushed block.
+ *
+ * This is still one read per pushed block, not none. The blocks sharing a timestamp and the
+ * payment id counts are indexes over the whole chain, and keeping them in memory would cost as
+ * much as the indexes themselves. Keys written by blocks which aren't committed yet are answered
+ * by the write-behind buffer of the database, so only the rest reach RocksDB.
+ */
+std::vector<Crypto::Hash> DatabaseBlockchainCache::requestPushedBlockData(const CachedBlock& cachedBlock,
+                                                                          const CachedTransaction& cachedBaseTransaction,
+                                                                          const std::vector<CachedTransaction>& cachedTransactions) {
+  const uint64_t timestamp = cachedBlock.getBlock().timestamp;
+  const uint64_t midnight = roundToMidnight(timestamp);
+
+  pushedBlockKeyOutputCounts.clear();
+  pushedBlockPaymentIdCounts.clear();
+
   BlockchainReadBatch readBatch;
   readBatch.requestBlockHashesByTimestamp(timestamp);
 
-  std::vector<Crypto::Hash> blockHashes;
+  if (closestTimestampDay != midnight) {
+    readBatch.requestClosestTimestampBlockIndex(midnight);
+  }
+
+  if (!keyOutputAmountsCount) {
+    readBatch.requestKeyOutputAmountsCount();
+  }
+
+  std::unordered_set<Amount> amounts;
+  std::unordered_set<Crypto::Hash> paymentIds;
+
+  auto requestTransactionData = [&](const Transaction& transaction) {
+    for (const auto& output : transaction.outputs) {
+      if (output.target.type() == typeid(KeyOutput) && keyOutputCountsForAmounts.count(output.amount) == 0 &&
+          amounts.insert(output.amount).second) {
+        readBatch.requestKeyOutputGlobalIndexesCountForAmount(output.amount);
+      }
+    }
+
+    Crypto::Hash paymentId;
+    if (getPaymentIdFromTxExtra(transaction.extra, paymentId) && paymentIds.insert(paymentId).second) {
+      readBatch.requestTransactionCountByPaymentId(paymentId);
+    }
+  };
+
+  requestTransactionData(cachedBaseTransaction.getTransaction());
+  for (const auto& transaction: cachedTransactions) {
+    requestTransactionData(transaction.getTransaction());
+  }
+
   auto readResult = readDatabase(readBatch);
 
+  if (!keyOutputAmountsCount) {
+    keyOutputAmountsCount = readResult.getKeyOutputAmountsCount();
+  }
+
+  // keys which aren't in the database are counted as zero
+  const auto& keyOutputCounts = readResult.getKeyOutputGlobalIndexesCountForAmounts();
+  for (auto amount: amounts) {
+    auto it = keyOutputCounts.find(amount);
+    pushedBlockKeyOutputCounts[amount] = it != keyOutputCounts.end() ? it->second : 0;
+  }
+
+  const auto& paymentIdCounts = readResult.getTransactionCountByPaymentIds();
+  for (const auto& paymentId: paymentIds) {
+    auto it = paymentIdCounts.find(paymentId);
+    pushedBlockPaymentIdCounts[paymentId] = it != paymentIdCounts.end() ? it->second : 0;
+  }
+
+  if (closestTimestampDay != midnight) {
+    if (readResult.getClosestTimestampBlockIndex().count(midnight) != 0) {
+      closestTimestampDay = midnight;
+    }
+  }
+
+  std::vector<Crypto::Hash> blockHashes;
   if (readResult.getBlockHashesByTimestamp().count(timestamp) != 0) {
     blockHashes = readResult.getBlockHashesByTimestamp().at(timestamp);
   }
 
-  blockHashes.emplace_back(blockHash);
+  return blockHashes;
+}
 
-  batch.insertTimestamp(timestamp, blockHashes);
+void DatabaseBlockchainCache::commitBlocks() {
+  // the raw blocks live in the main chain storage only, so they must be written out before the DB refers to them
+  mainChainStorage.flush();
+
+  auto error = database.flush();
+  if (error) {
+    logger(Logging::ERROR) << "Failed to commit " << uncommittedBlocksCount << " blocks to database: " << error.message();
+    throw std::runtime_error(error.message());
+  }
+
+  uncommittedBlocksCount = 0;
+  lastCommitTime = std::chrono::steady_clock::now();
 }
 
 void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
@@ -895,8 +968,11 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
   // base transaction's hash is always the first one in index for this block
   txHashes.insert(txHashes.begin(), cachedBaseTransaction.getTransactionHash());
 
+  auto timestampBlockHashes = requestPushedBlockData(cachedBlock, cachedBaseTransaction, cachedTransactions);
+
+  // the raw block itself is kept by the main chain storage only
+  assert(mainChainStorage.getBlockCount() > getTopBlockIndex() + 1);
   batch.insertCachedBlock(blockInfo, getTopBlockIndex() + 1, txHashes);
-  batch.insertRawBlock(getTopBlockIndex() + 1, std::move(rawBlock));
 
   auto transactionIndex = 0;
   pushTransaction(cachedBaseTransaction, getTopBlockIndex() + 1, transactionIndex++, batch);
@@ -905,17 +981,16 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
     pushTransaction(transaction, getTopBlockIndex() + 1, transactionIndex++, batch);
   }
 
-  auto closestBlockIndexDb = requestClosestBlockIndexByTimestamp(roundToMidnight(cachedBlock.getBlock().timestamp), database);
-  if (!closestBlockIndexDb.second) {
-    logger(Logging::ERROR) << "push block " << cachedBlock.getBlockHash() << " request closest block index by timestamp failed";
-    throw std::runtime_error("Couldn't get closest to timestamp block index");
-  }
+  pushedBlockKeyOutputCounts.clear();
+  pushedBlockPaymentIdCounts.clear();
 
-  if (!closestBlockIndexDb.first) {
-    batch.insertClosestTimestampBlockIndex(roundToMidnight(cachedBlock.getBlock().timestamp), getTopBlockIndex() + 1);
+  auto midnight = roundToMidnight(cachedBlock.getBlock().timestamp);
+  if (closestTimestampDay != midnight) {
+    batch.insertClosestTimestampBlockIndex(midnight, getTopBlockIndex() + 1);
+    closestTimestampDay = midnight;
   }
 
-  insertBlockTimestamp(batch, cachedBlock.getBlock().timestamp, cachedBlock.getBlockHash());
+  insertBlockTimestamp(batch, cachedBlock.getBlock().timestamp, std::move(timestampBlockHashes), cachedBlock.getBlockHash());
 
   auto res = database.write(batch);
   if (res) {
@@ -923,6 +998,11 @@ void DatabaseBlockchainCache::pushBlock(const CachedBlock& cachedBlock,
     throw std::runtime_error(res.message());
   }
 
+  ++uncommittedBlocksCount;
+  if (uncommittedBlocksCount >= MAX_UNCOMMITTED_BLOCKS_COUNT || std::chrono::steady_clock::now() - lastCommitTime >= BLOCKS_COMMIT_INTERVAL) {
+    commitBlocks();
+  }
+
   topBlockIndex = *topBlockIndex + 1;
   topBlockHash = cachedBlock.getBlockHash();
   logger(Logging::DEBUGGING) << "push block " << cachedBlock.getBlockHash() << " completed";
@@ -1421,6 +1501,7 @@ size_t DatabaseBlockchainCache::getChildCount() const {
 }
 
 void DatabaseBlockchainCache::save() {
+  commitBlocks();
 }
 
 void DatabaseBlockchainCache::load() {
@@ -1451,15 +1532,17 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
   }
 
   auto res = readDatabase(batch);
+
+  // each block is read from the main chain storage once, however many of its transactions are requested
+  std::unordered_map<uint32_t, RawBlock> blocksMap;
   for (auto& tx : res.getCachedTransactions()) {
-    batch.requestRawBlock(tx.second.blockIndex);
+    if (tx.second.blockIndex < mainChainStorage.getBlockCount() && blocksMap.count(tx.second.blockIndex) == 0) {
+      blocksMap.emplace(tx.second.blockIndex, mainChainStorage.getBlockByIndex(tx.second.blockIndex));
+    }
   }
 
-  auto blocks = readDatabase(batch);
-
   foundTransactions.reserve(foundTransactions.size() + transactions.size());
   auto& hashesMap = res.getCachedTransactions();
-  auto& blocksMap = blocks.getRawBlocks();
   for (const auto& hash: transactions) {
     auto transactionIt = hashesMap.find(hash);
     if (transactionIt == hashesMap.end()) {
@@ -1486,9 +1569,7 @@ void DatabaseBlockchainCache::getRawTransactions(const std::vector<Crypto::Hash>
 }
 
 RawBlock DatabaseBlockchainCache::getBlockByIndex(uint32_t index) const {
-  auto batch = BlockchainReadBatch().requestRawBlock(index);
-  auto res = readDatabase(batch);
-  return std::move(res.getRawBlocks().at(index));
+  return getRawBlock(index);
 }
 
 BinaryArray DatabaseBlockchainCache::getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const {
@@ -1633,17 +1714,20 @@ std::vector<Crypto::Hash> DatabaseBlockchainCache::getBlockHashesByTimestamps(ui
 std::vector<RawBlock> DatabaseBlockchainCache::getBlocksByHeight(
     const uint64_t startHeight, const uint64_t endHeight) const
 {
-    auto blockBatch = BlockchainReadBatch().requestRawBlocks(startHeight, endHeight);
+    /* Blocks past the top of the database aren't part of this segment */
+    const uint64_t end = std::min<uint64_t>(endHeight, getTopBlockIndex() + 1);
 
-    /* Get the info from the DB */
-    auto rawBlocks = readDatabase(blockBatch).getRawBlocks();
-    
     std::vector<RawBlock> orderedBlocks;
 
-    /* Order, and convert from map, to vector */
-    for (uint64_t height = startHeight; height < startHeight + rawBlocks.size(); height++)
+    if (startHeight < end)
     {
-        orderedBlocks.push_back(rawBlocks.at(height));
+        orderedBlocks.reserve(end - startHeight);
+    }
+
+    /* The raw blocks live in the main chain storage, already in height order */
+    for (uint64_t height = startHeight; height < end; height++)
+    {
+        orderedBlocks.push_back(getRawBlock(static_cast<uint32_t>(height)));
     }
 
     return orderedBlocks;
@@ -1672,7 +1756,6 @@ DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExt
   assert(blockIndex <= getTopBlockIndex());
 
   auto batch = BlockchainReadBatch()
-    .requestRawBlock(blockIndex)
     .requestCachedBlock(blockIndex)
     .requestSpentKeyImagesByBlock(blockIndex);
 
@@ -1686,7 +1769,7 @@ DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExt
 
   ExtendedPushedBlockInfo extendedInfo;
 
-  extendedInfo.pushedBlockInfo.rawBlock = dbResult.getRawBlocks().at(blockIndex);
+  extendedInfo.pushedBlockInfo.rawBlock = getRawBlock(blockIndex);
   extendedInfo.pushedBlockInfo.blockSize = blockInfo.blockSize;
   extendedInfo.pushedBlockInfo.blockDifficulty = blockInfo.cumulativeDifficulty - previousBlockInfo.cumulativeDifficulty;
   extendedInfo.pushedBlockInfo.generatedCoins = blockInfo.alreadyGeneratedCoins - previousBlockInfo.alreadyGeneratedCoins;
@@ -1700,6 +1783,17 @@ DatabaseBlockchainCache::ExtendedPushedBlockInfo DatabaseBlockchainCache::getExt
   return extendedInfo;
 }
 
+RawBlock DatabaseBlockchainCache::getRawBlock(uint32_t blockIndex) const {
+  assert(blockIndex <= getTopBlockIndex());
+
+  if (blockIndex >= mainChainStorage.getBlockCount()) {
+    logger(Logging::ERROR) << "Block " << blockIndex << " is missing from blockchain storage, blocks count: " << mainChainStorage.getBlockCount();
+    throw std::system_error(make_error_code(error::CoreErrorCode::CORRUPTED_BLOCKCHAIN));
+  }
+
+  return mainChainStorage.getBlockByIndex(blockIndex);
+}
+
 void DatabaseBlockchainCache::setParent(IBlockchainCache* ptr) {
   assert(false);
 }
@@ -1749,7 +1843,6 @@ void DatabaseBlockchainCache::addGenesisBlock(CachedBlock&& genesisBlock) {
   pushTransaction(cachedBaseTransaction, 0, 0, batch);
 
   batch.insertCachedBlock(blockInfo, 0, {cachedBaseTransaction.getTransactionHash()});
-  batch.insertRawBlock(0, {toBinaryArray(genesisBlock.getBlock()), {}});
   batch.insertClosestTimestampBlockIndex(roundToMidnight(genesisBlock.getBlock().timestamp), 0);
 
   auto res = database.write(batch);
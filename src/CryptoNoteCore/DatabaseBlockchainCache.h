@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "Common/StringView.h"
 #include "Currency.h"
 #include "IBlockchainCache.h"
@@ -24,8 +26,10 @@
 #include <IDataBase.h>
 #include <CryptoNoteCore/BlockchainReadBatch.h>
 #include <CryptoNoteCore/BlockchainWriteBatch.h>
+#include <CryptoNoteCore/BufferedDataBase.h>
 #include <CryptoNoteCore/DatabaseCacheData.h>
 #include <CryptoNoteCore/IBlockchainCacheFactory.h>
+#include <CryptoNoteCore/IMainChainStorage.h>
 
 namespace CryptoNote {
 
@@ -34,6 +38,10 @@ namespace CryptoNote {
  * Current implementation is designed to always be the root of blockchain, ie
  * start index is always zero, parent is always nullptr, no methods
  * do recursive calls to parent.
+ * Raw blocks are not kept in the database, they are read from the main chain
+ * storage, which always holds the blocks of the root segment.
+ * Pushed blocks are committed to the database in groups. Blocks which weren't
+ * committed before a crash are imported again from the main chain storage.
  */
 class DatabaseBlockchainCache : public IBlockchainCache {
 public:
@@ -45,8 +53,9 @@ public:
    * Constructs new DatabaseBlockchainCache object. Currnetly, only factories that produce 
    * BlockchainCache objects as children are supported.
    */
-  DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase,
+  DatabaseBlockchainCache(const Currency& currency, IDataBase& dataBase, IMainChainStorage& mainChainStorage,
                           IBlockchainCacheFactory& blockchainCacheFactory, Logging::ILogger& logger);
+  virtual ~DatabaseBlockchainCache();
 
   static bool checkDBSchemeVersion(IDataBase& dataBase, Logging::ILogger& logger);
 
@@ -56,6 +65,7 @@ public:
    * BlockchainCache type.
    */
   std::unique_ptr<IBlockchainCache> split(uint32_t splitBlockIndex) override;
+  void cut(uint32_t startIndex) override;
   void pushBlock(const CachedBlock& cachedBlock, const std::vector<CachedTransaction>& cachedTransactions,
                  const TransactionValidatorState& validatorState, size_t blockSize, uint64_t generatedCoins,
                  uint64_t blockDifficulty, RawBlock&& rawBlock) override;
@@ -169,7 +179,8 @@ public:
 
 private:
   const Currency& currency;
-  IDataBase& database;
+  mutable BufferedDataBase database;
+  IMainChainStorage& mainChainStorage;
   IBlockchainCacheFactory& blockchainCacheFactory;
   mutable boost::optional<uint32_t> topBlockIndex;
   mutable boost::optional<Crypto::Hash> topBlockHash;
@@ -181,8 +192,21 @@ private:
   std::deque<CachedBlockInfo> unitsCache;
   const size_t unitsCacheSize = 1000;
 
+  uint32_t uncommittedBlocksCount;
+  std::chrono::steady_clock::time_point lastCommitTime;
+  // midnight of a day which is known to have a closest timestamp block index
+  boost::optional<uint64_t> closestTimestampDay;
+  // counts read ahead for the block being pushed
+  std::unordered_map<Amount, uint32_t> pushedBlockKeyOutputCounts;
+  std::unordered_map<Crypto::Hash, uint32_t> pushedBlockPaymentIdCounts;
+
   struct ExtendedPushedBlockInfo;
   ExtendedPushedBlockInfo getExtendedPushedBlockInfo(uint32_t blockIndex) const;
+  RawBlock getRawBlock(uint32_t blockIndex) const;
+
+  void commitBlocks();
+  std::vector<Crypto::Hash> requestPushedBlockData(const CachedBlock& cachedBlock, const CachedTransaction& cachedBaseTransaction,
+                                                   const std::vector<CachedTransaction>& cachedTransactions);
 
   void deleteClosestTimestampBlockIndex(BlockchainWriteBatch& writeBatch, uint32_t splitBlockIndex);
   CachedBlockInfo getCachedBlockInfo(uint32_t index) const;
@@ -197,7 +221,7 @@ private:
   uint32_t insertKeyOutputToGlobalIndex(uint64_t amount, PackedOutIndex output); //TODO not implemented. Should it be removed?
   uint32_t updateKeyOutputCount(Amount amount, int32_t diff) const;
   void insertPaymentId(BlockchainWriteBatch& batch, const Crypto::Hash& transactionHash, const Crypto::Hash& paymentId);
-  void insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, const Crypto::Hash& blockHash);
+  void insertBlockTimestamp(BlockchainWriteBatch& batch, uint64_t timestamp, std::vector<Crypto::Hash>&& blockHashes, const Crypto::Hash& blockHash);
 
   void addGenesisBlock(CachedBlock&& genesisBlock);
 
@@ -206,6 +230,7 @@ private:
   TransactionValidatorState fillOutputsSpentByBlock(uint32_t blockIndex) const;
 
   Crypto::Hash pushBlockToAnotherCache(IBlockchainCache& segment, PushedBlockInfo&& pushedBlockInfo);
+  void removeBlocksFrom(uint32_t splitBlockIndex);
   void requestDeleteSpentOutputs(BlockchainWriteBatch& writeBatch, uint32_t splitBlockIndex, const TransactionValidatorState& spentOutputs);
   std::vector<Crypto::Hash> requestTransactionHashesFromBlockIndex(uint32_t splitBlockIndex);
   void requestDeleteTransactions(BlockchainWriteBatch& writeBatch, const std::vector<Crypto::Hash>& transactionHashes);
@@ -23,10 +23,11 @@
 namespace CryptoNote {
 
 class IDataBase;
+class IMainChainStorage;
 
 class DatabaseBlockchainCacheFactory: public IBlockchainCacheFactory {
 public:
-  explicit DatabaseBlockchainCacheFactory(IDataBase& database, Logging::ILogger& logger);
+  DatabaseBlockchainCacheFactory(IDataBase& database, IMainChainStorage& mainChainStorage, Logging::ILogger& logger);
   virtual ~DatabaseBlockchainCacheFactory();
 
   virtual std::unique_ptr<IBlockchainCache> createRootBlockchainCache(const Currency& currency) override;
@@ -34,6 +35,7 @@ public:
 
 private:
   IDataBase& database;
+  IMainChainStorage& mainChainStorage;
   Logging::ILogger& logger;
 };
 
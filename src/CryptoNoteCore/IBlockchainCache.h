@@ -86,6 +86,8 @@ public:
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
   virtual BinaryArray getRawTransaction(uint32_t blockIndex, uint32_t transactionIndex) const = 0;
   virtual std::unique_ptr<IBlockchainCache> split(uint32_t splitBlockIndex) = 0;
+  // Removes the blocks from startIndex on for good. Unlike split, doesn't need their raw blocks
+  virtual void cut(uint32_t startIndex) = 0;
   virtual void pushBlock(
       const CachedBlock& cachedBlock,
       const std::vector<CachedTransaction>& cachedTransactions,
@@ -28,6 +28,13 @@ public:
   virtual void pushBlock(const RawBlock& rawBlock) = 0;
   virtual void popBlock() = 0;
 
+  /* Bulk versions of popBlock() and pushBlock() for switching to another chain */
+  virtual void truncate(uint32_t blockCount) = 0;
+  virtual void pushBlocks(const std::vector<RawBlock>& rawBlocks) = 0;
+
+  /* Writes out the blocks pushed so far, so they reach the disk before anything which refers to them */
+  virtual void flush() = 0;
+
   virtual RawBlock getBlockByIndex(uint32_t index) const = 0;
   virtual uint32_t getBlockCount() const = 0;
 
@@ -27,6 +27,7 @@ public:
   virtual ~ITransactionPool() {};
 
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) = 0;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) = 0;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const = 0;
   virtual bool removeTransaction(const Crypto::Hash& hash) = 0;
 
@@ -36,14 +36,38 @@ MainChainStorage::~MainChainStorage() {
 }
 
 void MainChainStorage::pushBlock(const RawBlock& rawBlock) {
+  std::lock_guard<std::mutex> lock(mutex);
+
   storage.push_back(rawBlock);
 }
 
 void MainChainStorage::popBlock() {
+  std::lock_guard<std::mutex> lock(mutex);
+
   storage.pop_back();
 }
 
+void MainChainStorage::truncate(uint32_t blockCount) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  storage.truncate(blockCount);
+}
+
+void MainChainStorage::pushBlocks(const std::vector<RawBlock>& rawBlocks) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  storage.append(rawBlocks);
+}
+
+void MainChainStorage::flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  storage.flush();
+}
+
 RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
+  std::lock_guard<std::mutex> lock(mutex);
+
   if (index >= storage.size()) {
     throw std::out_of_range("Block index " + std::to_string(index) + " is out of range. Blocks count: " + std::to_string(storage.size()));
   }
@@ -52,10 +76,14 @@ RawBlock MainChainStorage::getBlockByIndex(uint32_t index) const {
 }
 
 uint32_t MainChainStorage::getBlockCount() const {
+  std::lock_guard<std::mutex> lock(mutex);
+
   return static_cast<uint32_t>(storage.size());
 }
 
 void MainChainStorage::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+
   storage.clear();
 }
 
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "IMainChainStorage.h"
 #include "Currency.h"
 #include "SwappedVector.h"
@@ -31,12 +33,20 @@ public:
   virtual void pushBlock(const RawBlock& rawBlock) override;
   virtual void popBlock() override;
 
+  virtual void truncate(uint32_t blockCount) override;
+  virtual void pushBlocks(const std::vector<RawBlock>& rawBlocks) override;
+
+  virtual void flush() override;
+
   virtual RawBlock getBlockByIndex(uint32_t index) const override;
   virtual uint32_t getBlockCount() const override;
 
   virtual void clear() override;
 
 private:
+  // SwappedVector isn't thread safe, even for reads, while the import reads ahead on its own
+  // thread and the DB commits flush the storage on the importing one
+  mutable std::mutex mutex;
   mutable SwappedVector<RawBlock> storage;
 };
 
@@ -0,0 +1,31 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RingMemberCache.h"
+
+namespace CryptoNote {
+
+RingMemberCache::RingMemberCache(size_t capacity) : LruCache(capacity) {
+}
+
+bool RingMemberCache::decode(const std::vector<Crypto::PublicKey>& keys, std::vector<Crypto::DecodedPublicKey>& decoded) {
+  decoded.resize(keys.size());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (find(keys[i], decoded[i])) {
+      continue;
+    }
+
+    /* Decode outside of the lock, this is the expensive part */
+    if (!Crypto::decode_public_key(keys[i], decoded[i])) {
+      return false;
+    }
+
+    insert(keys[i], decoded[i]);
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,32 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <vector>
+
+#include <CryptoTypes.h>
+
+#include "Common/LruCache.h"
+#include "crypto/crypto.h"
+
+namespace CryptoNote {
+
+using RingMemberCacheStatistics = Common::LruCacheStatistics;
+
+/* Bounded LRU cache of decoded ring member keys. Popular outputs are used as
+   decoys in many rings, so caching the decompressed point and its hash_to_ec
+   point saves both operations for every ring the output appears in after the
+   first one. Safe to use from several threads. */
+class RingMemberCache : public Common::LruCache<Crypto::PublicKey, Crypto::DecodedPublicKey> {
+public:
+  explicit RingMemberCache(size_t capacity);
+
+  /* Decodes the given keys, serving what it can from the cache. Returns false
+     if any of the keys is not a valid point, in which case decoded is left in
+     an unspecified state. */
+  bool decode(const std::vector<Crypto::PublicKey>& keys, std::vector<Crypto::DecodedPublicKey>& decoded);
+};
+
+}
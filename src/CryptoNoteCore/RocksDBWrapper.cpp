@@ -32,7 +32,7 @@ namespace {
   const std::string TESTNET_DB_NAME = "testnet_DB";
 }
 
-RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED){
+RocksDBWrapper::RocksDBWrapper(Logging::ILogger& logger) : logger(logger, "RocksDBWrapper"), state(NOT_INITIALIZED), writeAheadLog(true) {
 
 }
 
@@ -126,6 +126,7 @@ std::error_code RocksDBWrapper::writeSync(IWriteBatch& batch) {
 std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
   rocksdb::WriteOptions writeOptions;
   writeOptions.sync = sync;
+  writeOptions.disableWAL = !writeAheadLog.load();
 
   rocksdb::WriteBatch rocksdbBatch;
   std::vector<std::pair<std::string, std::string>> rawData(batch.extractRawDataToInsert());
@@ -148,6 +149,29 @@ std::error_code RocksDBWrapper::write(IWriteBatch& batch, bool sync) {
   }
 }
 
+void RocksDBWrapper::setWriteAheadLog(bool enabled) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::NOT_INITIALIZED));
+  }
+
+  if (enabled && !writeAheadLog.load()) {
+    // the writes made without the log only live in the memtables until they are flushed
+    rocksdb::Status status = db->Flush(rocksdb::FlushOptions());
+    if (!status.ok()) {
+      logger(ERROR) << "Can't flush DB. " << status.ToString();
+      throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+    }
+
+    status = db->SyncWAL();
+    if (!status.ok()) {
+      logger(ERROR) << "Can't sync DB write-ahead log. " << status.ToString();
+      throw std::system_error(make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR));
+    }
+  }
+
+  writeAheadLog.store(enabled);
+}
+
 std::error_code RocksDBWrapper::read(IReadBatch& batch) {
   if (state.load() != INITIALIZED) {
     throw std::runtime_error("Not initialized.");
@@ -49,6 +49,10 @@ public:
   std::error_code writeSync(IWriteBatch& batch) override;
   std::error_code read(IReadBatch& batch) override;
 
+  /* Bulk loads which are redone if interrupted, such as importing blocks.bin, can skip the
+     write-ahead log. Turning it back on flushes everything written without it to disk and syncs the log. */
+  void setWriteAheadLog(bool enabled);
+
 private:
   std::error_code write(IWriteBatch& batch, bool sync);
 
@@ -63,5 +67,6 @@ private:
   Logging::LoggerRef logger;
   std::unique_ptr<rocksdb::DB> db;
   std::atomic<State> state;
+  std::atomic<bool> writeAheadLog;
 };
 }
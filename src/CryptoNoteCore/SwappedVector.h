@@ -29,6 +29,7 @@
 
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
+#include "Common/StringOutputStream.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
 
@@ -162,6 +163,13 @@ public:
   void pop_back();
   void push_back(const T& item);
 
+  // drops the items from count on, rewriting only the item count
+  void truncate(uint64_t count);
+  // writes all the items with one sequential write to each file
+  void append(const std::vector<T>& items);
+  // hands the buffered writes of push_back to the OS, items before indexes
+  void flush();
+
 private:
   struct ItemEntry;
   struct CacheEntry;
@@ -393,6 +401,99 @@ template<class T> void SwappedVector<T>::push_back(const T& item) {
   *newItem = item;
 }
 
+template<class T> void SwappedVector<T>::truncate(uint64_t count) {
+  if (count >= m_offsets.size()) {
+    return;
+  }
+
+  if (!m_indexesFile) {
+    throw std::runtime_error("SwappedVector::truncate");
+  }
+
+  m_indexesFile.seekp(0);
+  m_indexesFile.write(reinterpret_cast<char*>(&count), sizeof count);
+  m_indexesFile.flush();
+  if (!m_indexesFile) {
+    throw std::runtime_error("SwappedVector::truncate");
+  }
+
+  m_itemsFileSize = m_offsets[count];
+  m_offsets.resize(count);
+
+  for (auto itemIter = m_items.lower_bound(count); itemIter != m_items.end();) {
+    m_cache.erase(itemIter->second.cacheIter);
+    itemIter = m_items.erase(itemIter);
+  }
+}
+
+template<class T> void SwappedVector<T>::append(const std::vector<T>& items) {
+  if (items.empty()) {
+    return;
+  }
+
+  std::string buffer;
+  std::vector<uint32_t> itemSizes;
+  itemSizes.reserve(items.size());
+
+  {
+    Common::StringOutputStream stream(buffer);
+    CryptoNote::BinaryOutputStreamSerializer archive(stream);
+    for (const auto& item : items) {
+      const size_t itemStart = buffer.size();
+      serialize(const_cast<T&>(item), archive);
+      itemSizes.push_back(static_cast<uint32_t>(buffer.size() - itemStart));
+    }
+  }
+
+  {
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::append");
+    }
+
+    m_itemsFile.seekp(m_itemsFileSize);
+    m_itemsFile.write(buffer.data(), buffer.size());
+    m_itemsFile.flush();
+    if (!m_itemsFile) {
+      throw std::runtime_error("SwappedVector::append");
+    }
+  }
+
+  {
+    if (!m_indexesFile) {
+      throw std::runtime_error("SwappedVector::append");
+    }
+
+    m_indexesFile.seekp(sizeof(uint64_t) + sizeof(uint32_t) * m_offsets.size());
+    m_indexesFile.write(reinterpret_cast<char*>(itemSizes.data()), sizeof(uint32_t) * itemSizes.size());
+
+    // the count goes last, so the new items only become visible once they are all written
+    m_indexesFile.seekp(0);
+    uint64_t count = m_offsets.size() + items.size();
+    m_indexesFile.write(reinterpret_cast<char*>(&count), sizeof count);
+    m_indexesFile.flush();
+    if (!m_indexesFile) {
+      throw std::runtime_error("SwappedVector::append");
+    }
+  }
+
+  for (uint32_t itemSize : itemSizes) {
+    m_offsets.push_back(m_itemsFileSize);
+    m_itemsFileSize += itemSize;
+  }
+}
+
+template<class T> void SwappedVector<T>::flush() {
+  m_itemsFile.flush();
+  if (!m_itemsFile) {
+    throw std::runtime_error("SwappedVector::flush");
+  }
+
+  m_indexesFile.flush();
+  if (!m_indexesFile) {
+    throw std::runtime_error("SwappedVector::flush");
+  }
+}
+
 template<class T> T* SwappedVector<T>::prepare(uint64_t index) {
   if (m_items.size() == m_poolSize) {
     auto cacheIter = m_cache.begin();
@@ -65,7 +65,11 @@ TransactionPool::TransactionPool(Logging::ILogger& logger) :
 }
 
 bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) {
-  auto pendingTx = PendingTransactionInfo{static_cast<uint64_t>(time(nullptr)), std::move(transaction)};
+  return pushTransaction(std::move(transaction), std::move(transactionState), static_cast<uint64_t>(time(nullptr)));
+}
+
+bool TransactionPool::pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  auto pendingTx = PendingTransactionInfo{receiveTime, std::move(transaction)};
 
   Crypto::Hash paymentId;
   if(getPaymentIdFromTxExtra(pendingTx.cachedTransaction.getTransaction().extra, paymentId)) {
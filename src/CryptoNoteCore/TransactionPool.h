@@ -39,6 +39,7 @@ public:
   TransactionPool(Logging::ILogger& logger);
 
   virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& transaction, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
@@ -35,6 +35,10 @@ bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, Transa
   return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState));
 }
 
+bool TransactionPoolCleanWrapper::pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) {
+  return !isTransactionRecentlyDeleted(tx.getTransactionHash()) && transactionPool->pushTransaction(std::move(tx), std::move(transactionState), receiveTime);
+}
+
 const CachedTransaction& TransactionPoolCleanWrapper::getTransaction(const Crypto::Hash& hash) const {
   return transactionPool->getTransaction(hash);
 }
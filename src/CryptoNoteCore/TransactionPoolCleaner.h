@@ -38,6 +38,7 @@ public:
   virtual ~TransactionPoolCleanWrapper();
 
   virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState) override;
+  virtual bool pushTransaction(CachedTransaction&& tx, TransactionValidatorState&& transactionState, uint64_t receiveTime) override;
   virtual const CachedTransaction& getTransaction(const Crypto::Hash& hash) const override;
   virtual bool removeTransaction(const Crypto::Hash& hash) override;
 
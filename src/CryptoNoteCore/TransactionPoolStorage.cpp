@@ -0,0 +1,105 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "TransactionPoolStorage.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Common/StringTools.h"
+#include "Common/Util.h"
+#include "CryptoNoteTools.h"
+#include "Serialization/ISerializer.h"
+
+namespace CryptoNote {
+
+namespace {
+
+const uint32_t TRANSACTION_POOL_STORAGE_VERSION = 1;
+
+struct StoredTransactionPool {
+  uint32_t version;
+  std::vector<StoredPoolTransaction> transactions;
+};
+
+void serialize(StoredTransactionPool& pool, ISerializer& serializer) {
+  serializer(pool.version, "version");
+
+  if (pool.version != TRANSACTION_POOL_STORAGE_VERSION) {
+    throw std::runtime_error("Unsupported transaction pool storage version");
+  }
+
+  uint64_t count = pool.transactions.size();
+  serializer(count, "count");
+
+  if (serializer.type() == ISerializer::INPUT) {
+    pool.transactions.resize(static_cast<size_t>(count));
+  }
+
+  for (auto& transaction : pool.transactions) {
+    serialize(transaction, serializer);
+  }
+}
+
+}
+
+void serialize(StoredPoolTransaction& transaction, ISerializer& serializer) {
+  serializer(transaction.receiveTime, "receive_time");
+
+  uint64_t size = transaction.transaction.size();
+  serializer(size, "size");
+
+  if (serializer.type() == ISerializer::INPUT) {
+    transaction.transaction.resize(static_cast<size_t>(size));
+  }
+
+  serializer.binary(transaction.transaction.data(), transaction.transaction.size(), "transaction");
+}
+
+bool saveTransactionPool(const std::string& filename, const std::vector<StoredPoolTransaction>& transactions) {
+  StoredTransactionPool pool{TRANSACTION_POOL_STORAGE_VERSION, transactions};
+
+  BinaryArray data = toBinaryArray(pool);
+
+  const Crypto::Hash checksum = getBinaryArrayHash(data);
+  data.insert(data.end(), std::begin(checksum.data), std::end(checksum.data));
+
+  const std::string temporaryFilename = filename + ".tmp";
+  if (!Common::saveStringToFile(temporaryFilename, std::string(data.begin(), data.end()))) {
+    return false;
+  }
+
+  /* Swaps the file in atomically, a crash leaves either the old or the new pool */
+  return !Tools::replace_file(temporaryFilename, filename);
+}
+
+TransactionPoolLoadResult loadTransactionPool(const std::string& filename, std::vector<StoredPoolTransaction>& transactions) {
+  std::string contents;
+  if (!Common::loadFileToString(filename, contents)) {
+    return TransactionPoolLoadResult::NOT_FOUND;
+  }
+
+  if (contents.size() < sizeof(Crypto::Hash)) {
+    return TransactionPoolLoadResult::INVALID;
+  }
+
+  BinaryArray data(contents.begin(), contents.end() - sizeof(Crypto::Hash));
+
+  Crypto::Hash checksum;
+  std::copy(contents.end() - sizeof(Crypto::Hash), contents.end(), checksum.data);
+
+  if (getBinaryArrayHash(data) != checksum) {
+    return TransactionPoolLoadResult::INVALID;
+  }
+
+  StoredTransactionPool pool;
+  if (!fromBinaryArray(pool, data)) {
+    return TransactionPoolLoadResult::INVALID;
+  }
+
+  transactions = std::move(pool.transactions);
+  return TransactionPoolLoadResult::LOADED;
+}
+
+}
@@ -0,0 +1,33 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <CryptoNote.h>
+
+namespace CryptoNote {
+
+class ISerializer;
+
+struct StoredPoolTransaction {
+  uint64_t receiveTime;
+  BinaryArray transaction;
+};
+
+void serialize(StoredPoolTransaction& transaction, ISerializer& serializer);
+
+enum class TransactionPoolLoadResult : uint8_t { LOADED, NOT_FOUND, INVALID };
+
+/* The pool is stored as a version, the raw transactions with their receive times, and a
+   trailing hash of everything before it, so a truncated or damaged file is detected and
+   ignored instead of being half loaded. The file is written to a temporary name first
+   and then renamed over the old one. Loading tells a file that could not be opened apart
+   from one that failed its checksum or did not parse. */
+bool saveTransactionPool(const std::string& filename, const std::vector<StoredPoolTransaction>& transactions);
+TransactionPoolLoadResult loadTransactionPool(const std::string& filename, std::vector<StoredPoolTransaction>& transactions);
+
+}
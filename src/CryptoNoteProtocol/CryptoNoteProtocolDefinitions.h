@@ -95,6 +95,10 @@ namespace CryptoNote
     uint32_t current_blockchain_height;
   };
 
+  // defined in CryptoNoteProtocolHandler.cpp
+  void serialize(RawBlockLegacy& rawBlock, ISerializer& serializer);
+  void serialize(NOTIFY_RESPONSE_GET_OBJECTS_request& request, ISerializer& s);
+
   struct NOTIFY_RESPONSE_GET_OBJECTS
   {
     const static int ID = BC_COMMANDS_POOL_BASE + 4;
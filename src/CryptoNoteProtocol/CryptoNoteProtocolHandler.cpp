@@ -17,6 +17,7 @@
 #include "P2p/LevinProtocol.h"
 
 #include <Common/FormatTools.h>
+#include <Common/Metrics.h>
 
 #include <config/Ascii.h>
 #include <config/CryptoNoteConfig.h>
@@ -64,7 +65,7 @@ std::vector<RawBlock> convertRawBlocksLegacyToRawBlocks(const std::vector<RawBlo
 }
 
 // unpack to strings to maintain protocol compatibility with older versions
-static inline void serialize(RawBlockLegacy& rawBlock, ISerializer& serializer) {
+void serialize(RawBlockLegacy& rawBlock, ISerializer& serializer) {
   std::string block;
   std::vector<std::string> transactions;
   if (serializer.type() == ISerializer::INPUT) {
@@ -112,7 +113,7 @@ static inline void serialize(NOTIFY_NEW_TRANSACTIONS_request& request, ISerializ
   }
 }
 
-static inline void serialize(NOTIFY_RESPONSE_GET_OBJECTS_request& request, ISerializer& s) {
+void serialize(NOTIFY_RESPONSE_GET_OBJECTS_request& request, ISerializer& s) {
   s(request.txs, "txs");
   s(request.blocks, "blocks");
   serializeAsBinary(request.missed_ids, "missed_ids", s);
@@ -303,11 +304,15 @@ bool CryptoNoteProtocolHandler::get_payload_sync_data(CORE_SYNC_DATA& hshd) {
 }
 
 template <typename Command, typename Handler>
-int notifyAdaptor(const BinaryArray& reqBuf, CryptoNoteConnectionContext& ctx, Handler handler) {
+int notifyAdaptor(const BinaryArray& reqBuf, CryptoNoteConnectionContext& ctx, const char* name, Handler handler) {
 
   typedef typename Command::request Request;
   int command = Command::ID;
 
+  static auto& duration = Metrics::registry().histogram("p2p_protocol_message_seconds", "Time spent handling each protocol message",
+    Metrics::latencyBuckets(), "command=\"" + std::string(name) + "\"");
+  Metrics::ScopedTimer timer(duration);
+
   Request req = boost::value_initialized<Request>();
   if (!LevinProtocol::decode(reqBuf, req)) {
     throw std::runtime_error("Failed to load_from_binary in command " + std::to_string(command));
@@ -317,7 +322,7 @@ int notifyAdaptor(const BinaryArray& reqBuf, CryptoNoteConnectionContext& ctx, H
 }
 
 // Changed std::bind -> lambda, for better debugging, remove it ASAP
-#define HANDLE_NOTIFY(CMD, Handler) case CMD::ID: { ret = notifyAdaptor<CMD>(in, ctx, [this](int a1, CMD::request& a2, CryptoNoteConnectionContext& a3) { return Handler(a1, a2, a3); }); break; }
+#define HANDLE_NOTIFY(CMD, Handler) case CMD::ID: { ret = notifyAdaptor<CMD>(in, ctx, #CMD, [this](int a1, CMD::request& a2, CryptoNoteConnectionContext& a3) { return Handler(a1, a2, a3); }); break; }
 
 int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const BinaryArray& in, BinaryArray& out, CryptoNoteConnectionContext& ctx, bool& handled) {
   int ret = 0;
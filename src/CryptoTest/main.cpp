@@ -13,6 +13,7 @@
 
 #include "CryptoNote.h"
 #include "CryptoTypes.h"
+#include "Common/Base58.h"
 #include "Common/StringTools.h"
 #include "crypto/crypto.h"
 
@@ -93,6 +94,102 @@ const std::string CN_SOFT_SHELL_V2[] = {
   "b2172ec9466e1aee70ec8572a14c233ee354582bcb93f869d429744de5726a26"
 };
 
+/* Roots of trees of 1, 2, 3, 4, 5, 8, 13, 64, 100 and 257 leaves, where leaf i is
+   the cn_fast_hash of the single byte i */
+const size_t TREE_HASH_LEAF_COUNTS[] = { 1, 2, 3, 4, 5, 8, 13, 64, 100, 257 };
+
+const std::string TREE_HASH[] = {
+  "bc36789e7a1e281436464229828f817d6612f7b477d66591ff96a9e064bcc98a",
+  "57d772147cdf27f5f67d679f0f3a513f8b87622ce598a3cf0b048ab178ddfc6e",
+  "31ea648480acca9d46c5cfd2fd5ecf576ce7a797bdd582869c38deeacf6d17d4",
+  "dd5115b5dcca3db0bffa31064a0d21f21362cd02e1263e47d69e38bbeec1d359",
+  "3b85b9b4e7171846e3dd41d242f99cdc136467ff276a272d5d8f960b2c447d67",
+  "791521f02a712f28265f5200914f9772b133bc2692260f8c8f426e176b1713ed",
+  "bc35ba2d541045a10ba7e7fe75b3a80505e1455d88552cafdf50dbc99237310a",
+  "fc61b646f502f97300b88afe15feaf046f90c8456f658273657d8a55e7fc79df",
+  "4491ba5a5c8ca6dab487ac6a6ba5c48d39d98c0b5201bb6bd304326390bbe971",
+  "a5cc3ef58ca55b1b0475cf6de3cc0940356b00422f58742f787515a29b5d2e35"
+};
+
+/* Known answers for the elliptic curve operations, produced by the ref10 field
+   arithmetic. Whichever field backend crypto-ops was built with must match them. */
+const std::string EC_VIEW_PUBLIC_KEY = "6fa355c3ff402a5e48d9ce2cbb21758f940d463a925dd9728838626dce9be69b";
+const std::string EC_SPEND_SECRET_KEY = "7c9ee606b5755183d0202175ec24313dbe82ef96e71ccad7614af471102df804";
+const std::string EC_SPEND_PUBLIC_KEY = "310a82b52b7f0ebe04397f58dad1f36a9c46cbd128df366721c61de9576d265d";
+
+const std::string EC_KEY_DERIVATION = "3d18033991840c9c5d7ad68ae2ec511a8bc364d2c6033954b76cf677dd3aa80c";
+const std::string EC_DERIVED_PUBLIC_KEY = "c2114383d98fd37ac3acb306e3ad0c5303d2ea2c266117f0a25ae4935e2cc5a3";
+const std::string EC_KEY_IMAGE = "788495c6a42f1aec63a25500f86a9e1d1e498c760986dc5970cba8f1073426f4";
+
+const std::string EC_RING_PREFIX_HASH = "cc2ecac32ac6bd6a527da49969a511318961a97dbb62bb39ed099699a6f882ed";
+
+const std::string EC_RING_PUBLIC_KEYS[] = {
+  "af205547d94d2a67f714c4b26d9daaaa6aa8a890505d2e01c6cd3d7655411de7",
+  "0e2eeccd0418fcb2793e13a26c4935f2dfdb74affca7762c110cce66e23b3563",
+  "c2114383d98fd37ac3acb306e3ad0c5303d2ea2c266117f0a25ae4935e2cc5a3",
+  "fe6683c59beb982ebc16622921e4dc86c47f9286699e46c223787e82c04fd2f7"
+};
+
+const std::string EC_RING_SIGNATURES[] = {
+  "ecf971b281d22924f520fbccbf24f5cdca63e7da537cdfe917dc1fdd9543600f5fee307acfa899a224cd46048424522506030634f9a5e551cd278c34d1c4870f",
+  "9e54431a08ebac9eff30968a85bff4bd9145bf8d1899ffc288b257bb2b362a04404da3e44a8b84ce0a9173ebd04cc6f1f3d28065c911d72ae8e87f96b268380a",
+  "8e7d1193f683d7fca8d3e80a510e947444baa10eb71d8207e50159e9e7e26f07007b8f80549764341f82e5e936dd3c74f080023cb280eba92de734780bff2f0d",
+  "e843f7d71a8502b602fbc862179019ef64f1fe59ad5e179ce9279aa0d9101c0948b9a9842f94b7a485d025a47b5f2078df5b0b48537bccbd4ee4f622fd2bde0b"
+};
+
+/* Base58 encodes 8 byte blocks as 11 digits, and a partial last block as only as many digits
+   as it needs, so leading zero bytes show up as leading '1's block by block */
+const std::pair<std::string, std::string> BASE58_ENCODINGS[] = {
+  { "", "" },
+  { "00", "11" },
+  { "39", "1z" },
+  { "ff", "5Q" },
+  { "0000", "111" },
+  { "0039", "11z" },
+  { "0100", "15R" },
+  { "ffff", "LUv" },
+  { "0000000000000000", "11111111111" },
+  { "0000000000000001", "11111111112" },
+  { "0000000000000039", "1111111111z" },
+  { "ffffffffffffffff", "jpXCZedGfVQ" },
+  { "06156013762879f7", "22222222222" },
+  { "05e022ba374b2a00", "1z111111111" },
+  { "000000000000000000", "1111111111111" },
+  { "06156013762879f7ff", "222222222225Q" },
+  { "00000000000000000000000000000000", "1111111111111111111111" }
+};
+
+/* Lengths no block encodes to, blocks too large for their size, and characters outside the alphabet */
+const std::string BASE58_INVALID[] = {
+  "1",
+  "1111",
+  "11111111",
+  "5R",
+  "LUw",
+  "jpXCZedGfVR",
+  "zzzzzzzzzzz",
+  "11111111111zzzzzzzzzzz",
+  "0",
+  "O1",
+  "1I",
+  "1l"
+};
+
+template <typename T>
+static inline T podFromHexOrDie(const std::string& hex)
+{
+  T result;
+  bool success = Common::podFromHex(hex, result);
+  assert(success);
+  return result;
+}
+
+template <typename T>
+static inline bool ComparePods(const T& left, const std::string& right)
+{
+  return Common::podToHex(left) == right;
+}
+
 static inline bool CompareHashes(const Hash leftHash, const std::string right)
 {
   Hash rightHash = Hash();
@@ -159,6 +256,57 @@ int main(int argc, char** argv) {
     std::cout << "cn_fast_hash: " << Common::toHex(&hash, sizeof(Hash)) << std::endl;
     assert(CompareHashes(hash, CN_FAST_HASH));
 
+    /* Every length up to a few Keccak blocks, so the inputs finish at different times */
+    BinaryArray batchInput;
+
+    while (batchInput.size() < 3 * HASH_DATA_AREA)
+    {
+      batchInput.insert(batchInput.end(), rawData.begin(), rawData.end());
+    }
+
+    std::vector<const void *> batchData;
+    std::vector<size_t> batchLengths;
+
+    for (size_t length = 0; length <= batchInput.size(); length++)
+    {
+      batchData.push_back(batchInput.data());
+      batchLengths.push_back(length);
+    }
+
+    std::vector<Hash> batchHashes(batchData.size());
+    cn_fast_hash_batch(batchData.data(), batchLengths.data(), batchData.size(), batchHashes.data());
+
+    for (size_t i = 0; i < batchHashes.size(); i++)
+    {
+      assert(batchHashes[i] == cn_fast_hash(batchData[i], batchLengths[i]));
+    }
+
+    std::cout << "cn_fast_hash_batch: " << batchHashes.size() << " inputs match cn_fast_hash" << std::endl;
+
+    for (size_t i = 0; i < sizeof(TREE_HASH_LEAF_COUNTS) / sizeof(TREE_HASH_LEAF_COUNTS[0]); i++)
+    {
+      std::vector<Hash> leaves(TREE_HASH_LEAF_COUNTS[i]);
+
+      for (size_t leaf = 0; leaf < leaves.size(); leaf++)
+      {
+        const uint8_t byte = static_cast<uint8_t>(leaf);
+        cn_fast_hash(&byte, 1, leaves[leaf]);
+      }
+
+      tree_hash(leaves.data(), leaves.size(), hash);
+      std::cout << "tree_hash (" << leaves.size() << "): " << Common::toHex(&hash, sizeof(Hash)) << std::endl;
+      assert(CompareHashes(hash, TREE_HASH[i]));
+
+      /* The branch of the first leaf has to lead back to the same root */
+      const size_t depth = tree_depth(leaves.size());
+      std::vector<Hash> branch(depth);
+      tree_branch(leaves.data(), leaves.size(), branch.data());
+
+      Hash branchRoot;
+      tree_hash_from_branch(branch.data(), depth, leaves[0], nullptr, branchRoot);
+      assert(branchRoot == hash);
+    }
+
     std::cout << std::endl;
 
     cn_slow_hash_v0(rawData.data(), rawData.size(), hash);
@@ -217,6 +365,92 @@ int main(int argc, char** argv) {
       }
     }
 
+    std::cout << std::endl;
+
+    const auto viewPublicKey = podFromHexOrDie<PublicKey>(EC_VIEW_PUBLIC_KEY);
+    const auto spendSecretKey = podFromHexOrDie<SecretKey>(EC_SPEND_SECRET_KEY);
+    const auto spendPublicKey = podFromHexOrDie<PublicKey>(EC_SPEND_PUBLIC_KEY);
+
+    KeyDerivation derivation;
+    generate_key_derivation(viewPublicKey, spendSecretKey, derivation);
+    std::cout << "generate_key_derivation: " << Common::podToHex(derivation) << std::endl;
+    assert(ComparePods(derivation, EC_KEY_DERIVATION));
+
+    PublicKey derivedPublicKey;
+    derive_public_key(derivation, 1, spendPublicKey, derivedPublicKey);
+    std::cout << "derive_public_key: " << Common::podToHex(derivedPublicKey) << std::endl;
+    assert(ComparePods(derivedPublicKey, EC_DERIVED_PUBLIC_KEY));
+
+    PublicKey underivedPublicKey;
+    underive_public_key(derivation, 1, derivedPublicKey, underivedPublicKey);
+    std::cout << "underive_public_key: " << Common::podToHex(underivedPublicKey) << std::endl;
+    assert(underivedPublicKey == spendPublicKey);
+
+    SecretKey derivedSecretKey;
+    derive_secret_key(derivation, 1, spendSecretKey, derivedSecretKey);
+
+    KeyImage keyImage;
+    generate_key_image(derivedPublicKey, derivedSecretKey, keyImage);
+    std::cout << "generate_key_image: " << Common::podToHex(keyImage) << std::endl;
+    assert(ComparePods(keyImage, EC_KEY_IMAGE));
+
+    const auto prefixHash = podFromHexOrDie<Hash>(EC_RING_PREFIX_HASH);
+
+    std::vector<PublicKey> ring;
+    std::vector<Signature> signatures;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+      ring.push_back(podFromHexOrDie<PublicKey>(EC_RING_PUBLIC_KEYS[i]));
+      signatures.push_back(podFromHexOrDie<Signature>(EC_RING_SIGNATURES[i]));
+    }
+
+    std::vector<const PublicKey *> ringPointers;
+
+    for (const auto &key : ring)
+    {
+      ringPointers.push_back(&key);
+    }
+
+    bool validRing = check_ring_signature(prefixHash, keyImage, ringPointers, signatures.data(), true);
+    std::cout << "check_ring_signature: " << (validRing ? "valid" : "invalid") << std::endl;
+    assert(validRing);
+
+    signatures[0].data[0] ^= 1;
+    assert(!check_ring_signature(prefixHash, keyImage, ringPointers, signatures.data(), true));
+
+    for (const auto& [hex, expected] : BASE58_ENCODINGS)
+    {
+      const BinaryArray data = Common::fromHex(hex);
+      std::string decoded;
+
+      assert(Tools::Base58::encode(Common::asString(data)) == expected);
+      assert(Tools::Base58::decode(expected, decoded) && decoded == Common::asString(data));
+
+      std::string encoded(Tools::Base58::encoded_size(data.size()), '\0');
+      Tools::Base58::encode(data.data(), data.size(), &encoded[0]);
+      assert(encoded == expected);
+
+      size_t decodedSize;
+      assert(Tools::Base58::decoded_size(expected.size(), decodedSize) && decodedSize == data.size());
+
+      BinaryArray decodedData(decodedSize);
+      assert(Tools::Base58::decode(expected.data(), expected.size(), decodedData.data()) && decodedData == data);
+    }
+
+    for (const auto& encoded : BASE58_INVALID)
+    {
+      std::string decoded;
+      assert(!Tools::Base58::decode(encoded, decoded));
+
+      size_t decodedSize;
+      BinaryArray decodedData(encoded.size());
+      assert(!Tools::Base58::decoded_size(encoded.size(), decodedSize) || !Tools::Base58::decode(encoded.data(), encoded.size(), decodedData.data()));
+    }
+
+    std::cout << "base58: " << sizeof(BASE58_ENCODINGS) / sizeof(BASE58_ENCODINGS[0]) << " encodings and "
+              << sizeof(BASE58_INVALID) / sizeof(BASE58_INVALID[0]) << " invalid inputs checked" << std::endl;
+
     if (o_benchmark)
     {
       std::cout <<  "\nPerformance Tests: Please wait, this may take a while depending on your system...\n\n";
@@ -8,6 +8,7 @@
 
 #include "DaemonConfiguration.h"
 #include "DaemonCommandsHandler.h"
+#include "Common/Metrics.h"
 #include "Common/ScopeExit.h"
 #include "Common/SignalHandler.h"
 #include "Common/StdOutputStream.h"
@@ -92,6 +93,10 @@ JsonValue buildLoggerConfiguration(Level level, const std::string& logfile) {
   JsonValue loggerConfiguration(JsonValue::OBJECT);
   loggerConfiguration.insert("globalLevel", static_cast<int64_t>(level));
 
+  // keep the P2P and core threads off the disk and console writes
+  JsonValue& asyncConfiguration = loggerConfiguration.insert("async", JsonValue::OBJECT);
+  asyncConfiguration.insert("overflowPolicy", "block");
+
   JsonValue& cfgLoggers = loggerConfiguration.insert("loggers", JsonValue::ARRAY);
 
   JsonValue& fileLogger = cfgLoggers.pushBack(JsonValue::OBJECT);
@@ -223,6 +228,8 @@ int main(int argc, char* argv[])
 
     logger(INFO) << "Program Working Directory: " << argv[0];
 
+    Metrics::setEnabled(!config.disableMetrics);
+
     //create objects and link them
     CryptoNote::CurrencyBuilder currencyBuilder(logManager);
     currencyBuilder.isBlockexplorer(config.enableBlockExplorer);
@@ -263,6 +270,12 @@ int main(int argc, char* argv[])
       config.exclusiveNodes, config.priorityNodes,
       config.seedNodes);
 
+    // The limits are given in kilobytes per second, 0 or less means no limit
+    netNodeConfig.setUploadLimit(static_cast<uint64_t>(std::max(config.p2pUploadLimit, 0)) * 1024);
+    netNodeConfig.setDownloadLimit(static_cast<uint64_t>(std::max(config.p2pDownloadLimit, 0)) * 1024);
+    netNodeConfig.setPeerUploadLimit(static_cast<uint64_t>(std::max(config.p2pPeerUploadLimit, 0)) * 1024);
+    netNodeConfig.setPeerDownloadLimit(static_cast<uint64_t>(std::max(config.p2pPeerDownloadLimit, 0)) * 1024);
+
     DataBaseConfig dbConfig;
     dbConfig.init(config.dataDirectory, config.dbThreads, config.dbMaxOpenFiles, config.dbWriteBufferSizeMB, config.dbReadCacheSizeMB);
 
@@ -281,6 +294,18 @@ int main(int argc, char* argv[])
       }
     }
 
+    /* blocks.bin is the only store of raw blocks, the database reads them from it */
+    std::unique_ptr<IMainChainStorage> mainChainStorage = createSwappedMainChainStorage(config.dataDirectory, currency);
+
+    /* Only the genesis block means blocks.bin is missing or empty, most likely the wrong data
+       directory. Importing it would reset the node to the genesis block. */
+    if (config.importBlockchain && mainChainStorage->getBlockCount() <= 1)
+    {
+      logger(ERROR, BRIGHT_RED) << "No blocks to import in " << Common::CombinePath(config.dataDirectory, currency.blocksFileName())
+                                << ", refusing to remove the database. Check --data-dir.";
+      return 1;
+    }
+
     RocksDBWrapper database(logManager);
     database.init(dbConfig);
     Tools::ScopeExit dbShutdownOnExit([&database] () { database.shutdown(); });
@@ -296,19 +321,86 @@ int main(int argc, char* argv[])
       dbShutdownOnExit.resume();
     }
 
+    if (config.importBlockchain)
+    {
+      logger(INFO) << "Removing the database, it will be rebuilt from blocks.bin";
+
+      dbShutdownOnExit.cancel();
+      database.shutdown();
+
+      database.destroy(dbConfig);
+
+      database.init(dbConfig);
+      dbShutdownOnExit.resume();
+    }
+
     System::Dispatcher dispatcher;
     logger(INFO) << "Initializing core...";
+
+    std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory(
+      new DatabaseBlockchainCacheFactory(database, *mainChainStorage, logger.getLogger()));
+
     CryptoNote::Core ccore(
       currency,
       logManager,
       std::move(checkpoints),
       dispatcher,
-      std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
-      createSwappedMainChainStorage(config.dataDirectory, currency));
+      std::move(blockchainCacheFactory),
+      std::move(mainChainStorage));
+
+    ccore.setImportVerification(config.importVerify);
+    ccore.setTransactionPoolFile(Common::CombinePath(config.dataDirectory, currency.txPoolFileName()));
+
+    /* The database was just emptied for the import, so it is written without the write-ahead
+       log. An interrupted import is redone from where the database stopped on the next start.
+       Turning the log back on flushes everything written without it. */
+    if (config.importBlockchain)
+    {
+      database.setWriteAheadLog(false);
+    }
+
+    {
+      Tools::ScopeExit writeAheadLogRestore([&database, &logger] () {
+        try
+        {
+          database.setWriteAheadLog(true);
+        }
+        catch (std::exception& e)
+        {
+          logger(ERROR, BRIGHT_RED) << "Failed to turn the database write-ahead log back on: " << e.what();
+        }
+      });
+
+      if (!config.importBlockchain)
+      {
+        writeAheadLogRestore.cancel();
+      }
+
+      ccore.load();
+    }
 
-    ccore.load();
     logger(INFO) << "Core initialized OK";
 
+    if (config.importBlockchain)
+    {
+      const auto stats = ccore.getImportStatistics();
+      const auto seconds = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double>(duration).count(); };
+
+      std::cout << std::endl
+        << "Imported blocks:       " << stats.blocks << std::endl
+        << "Imported transactions: " << stats.transactions << std::endl
+        << "Verified blocks:       " << stats.verifiedBlocks << std::endl
+        << "Total time:            " << seconds(stats.totalTime) << " s" << std::endl
+        << "Blocks per second:     " << (seconds(stats.totalTime) > 0 ? stats.blocks / seconds(stats.totalTime) : 0) << std::endl
+        << "Read time:             " << seconds(stats.readTime) << " s" << std::endl
+        << "Decode time:           " << seconds(stats.decodeTime) << " s (" << stats.decodingThreads << " threads)" << std::endl
+        << "Verify time:           " << seconds(stats.verifyTime) << " s" << std::endl
+        << "Push time:             " << seconds(stats.pushTime) << " s" << std::endl;
+
+      ccore.save();
+      return 0;
+    }
+
     CryptoNote::CryptoNoteProtocolHandler cprotocol(currency, dispatcher, ccore, nullptr, logManager);
     CryptoNote::NodeServer p2psrv(dispatcher, cprotocol, logManager);
     CryptoNote::RpcServer rpcServer(dispatcher, logManager, ccore, p2psrv, cprotocol);
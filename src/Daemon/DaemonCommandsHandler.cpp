@@ -325,6 +325,18 @@ bool DaemonCommandsHandler::status(const std::vector<std::string>& args)
   } 
 
   std::cout << Common::get_status_string(iresp) << std::endl;
+
+  const auto ringCache = m_core.getRingMemberCacheStatistics();
+  const uint64_t lookups = ringCache.hits + ringCache.misses;
+
+  std::cout << "Ring member cache: " << ringCache.size << "/" << ringCache.capacity << " keys, "
+            << ringCache.hits << " hits, " << ringCache.misses << " misses";
+
+  if (lookups != 0) {
+    std::cout << " (" << (ringCache.hits * 100 / lookups) << "% hit rate)";
+  }
+
+  std::cout << std::endl;
   
   return true;
 }
@@ -50,6 +50,7 @@ namespace DaemonConfig{
       ("save-config", "Save the configuration to the specified <file>", cxxopts::value<std::string>(), "<file>");
 
     options.add_options("RPC")
+      ("disable-metrics", "Disable the collection of metrics and the /metrics RPC path", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
       ("enable-blockexplorer", "Enable the Blockchain Explorer RPC", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
       ("enable-cors", "Adds header 'Access-Control-Allow-Origin' to the RPC responses using the <domain>. Uses the value specified as the domain. Use * for all.",
         cxxopts::value<std::vector<std::string>>(), "<domain>")
@@ -61,7 +62,11 @@ namespace DaemonConfig{
       ("hide-my-port", "Do not announce yourself as a peerlist candidate", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
       ("p2p-bind-ip", "Interface IP address for the P2P service", cxxopts::value<std::string>()->default_value(config.p2pInterface), "<ip>")
       ("p2p-bind-port", "TCP port for the P2P service", cxxopts::value<int>()->default_value(std::to_string(config.p2pPort)), "#")
+      ("p2p-download-limit", "Limit the P2P download rate of all peers together to # kilobytes (kB) per second, 0 for no limit", cxxopts::value<int>()->default_value("0"), "#")
       ("p2p-external-port", "External TCP port for the P2P service (NAT port forward)", cxxopts::value<int>()->default_value("0"), "#")
+      ("p2p-peer-download-limit", "Limit the P2P download rate of each peer to # kilobytes (kB) per second, 0 for no limit", cxxopts::value<int>()->default_value("0"), "#")
+      ("p2p-peer-upload-limit", "Limit the P2P upload rate to each peer to # kilobytes (kB) per second, 0 for no limit", cxxopts::value<int>()->default_value("0"), "#")
+      ("p2p-upload-limit", "Limit the P2P upload rate to all peers together to # kilobytes (kB) per second, 0 for no limit", cxxopts::value<int>()->default_value("0"), "#")
       ("rpc-bind-ip", "Interface IP address for the RPC service", cxxopts::value<std::string>()->default_value(config.rpcInterface), "<ip>")
       ("rpc-bind-port", "TCP port for the RPC service", cxxopts::value<int>()->default_value(std::to_string(config.rpcPort)), "#");
 
@@ -75,7 +80,10 @@ namespace DaemonConfig{
       ("db-max-open-files", "Number of files that can be used by the database at one time", cxxopts::value<int>()->default_value(std::to_string(config.dbMaxOpenFiles)), "#")
       ("db-read-buffer-size", "Size of the database read cache in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbReadCacheSizeMB)), "#")
       ("db-threads", "Number of background threads used for compaction and flush operations", cxxopts::value<int>()->default_value(std::to_string(config.dbThreads)), "#")
-      ("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#");
+      ("db-write-buffer-size", "Size of the database write buffer in megabytes (MB)", cxxopts::value<int>()->default_value(std::to_string(config.dbWriteBufferSizeMB)), "#")
+      ("import-blockchain", "Rebuild the database from the blocks stored in blocks.bin, print the import statistics and exit", cxxopts::value<bool>()->default_value("false")->implicit_value("true"))
+      ("import-verify", "Validate the transactions of the blocks imported from blocks.bin which are above the last checkpoint, ring signatures included",
+        cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
     try
     {
@@ -166,6 +174,16 @@ namespace DaemonConfig{
         config.dbWriteBufferSizeMB = cli["db-write-buffer-size"].as<int>();
       }
 
+      if (cli.count("import-blockchain") > 0)
+      {
+        config.importBlockchain = cli["import-blockchain"].as<bool>();
+      }
+
+      if (cli.count("import-verify") > 0)
+      {
+        config.importVerify = cli["import-verify"].as<bool>();
+      }
+
       if (cli.count("local-ip") > 0)
       {
         config.localIp = cli["local-ip"].as<bool>();
@@ -191,6 +209,26 @@ namespace DaemonConfig{
         config.p2pExternalPort = cli["p2p-external-port"].as<int>();
       }
 
+      if (cli.count("p2p-upload-limit") > 0)
+      {
+        config.p2pUploadLimit = cli["p2p-upload-limit"].as<int>();
+      }
+
+      if (cli.count("p2p-download-limit") > 0)
+      {
+        config.p2pDownloadLimit = cli["p2p-download-limit"].as<int>();
+      }
+
+      if (cli.count("p2p-peer-upload-limit") > 0)
+      {
+        config.p2pPeerUploadLimit = cli["p2p-peer-upload-limit"].as<int>();
+      }
+
+      if (cli.count("p2p-peer-download-limit") > 0)
+      {
+        config.p2pPeerDownloadLimit = cli["p2p-peer-download-limit"].as<int>();
+      }
+
       if (cli.count("rpc-bind-ip") > 0)
       {
         config.rpcInterface = cli["rpc-bind-ip"].as<std::string>();
@@ -226,6 +264,11 @@ namespace DaemonConfig{
         config.enableBlockExplorer = cli["enable-blockexplorer"].as<bool>();
       }
 
+      if (cli.count("disable-metrics") > 0)
+      {
+        config.disableMetrics = cli["disable-metrics"].as<bool>();
+      }
+
       if (cli.count("enable-cors") > 0)
       {
         config.enableCors = cli["enable-cors"].as<std::vector<std::string>>();
@@ -422,6 +465,54 @@ namespace DaemonConfig{
             throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
           }
         }
+        else if (cfgKey.compare("p2p-upload-limit") == 0)
+        {
+          try
+          {
+            config.p2pUploadLimit = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("p2p-download-limit") == 0)
+        {
+          try
+          {
+            config.p2pDownloadLimit = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("p2p-peer-upload-limit") == 0)
+        {
+          try
+          {
+            config.p2pPeerUploadLimit = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
+        else if (cfgKey.compare("p2p-peer-download-limit") == 0)
+        {
+          try
+          {
+            config.p2pPeerDownloadLimit = std::stoi(cfgValue);
+            updated = true;
+          }
+          catch(std::exception& e)
+          {
+            throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey );
+          }
+        }
         else if (cfgKey.compare("rpc-bind-ip") == 0)
         {
           config.rpcInterface = cfgValue;
@@ -469,6 +560,11 @@ namespace DaemonConfig{
           config.enableBlockExplorer =  cfgValue.at(0) == '1' ? true : false;
           updated = true;
         }
+        else if (cfgKey.compare("disable-metrics") == 0)
+        {
+          config.disableMetrics = cfgValue.at(0) == '1' ? true : false;
+          updated = true;
+        }
         else if (cfgKey.compare("enable-cors") == 0)
         {
           cors.push_back(cfgValue);
@@ -606,6 +702,26 @@ namespace DaemonConfig{
       config.p2pExternalPort = j["p2p-external-port"].get<int>();
     }
 
+    if (j.find("p2p-upload-limit") != j.end())
+    {
+      config.p2pUploadLimit = j["p2p-upload-limit"].get<int>();
+    }
+
+    if (j.find("p2p-download-limit") != j.end())
+    {
+      config.p2pDownloadLimit = j["p2p-download-limit"].get<int>();
+    }
+
+    if (j.find("p2p-peer-upload-limit") != j.end())
+    {
+      config.p2pPeerUploadLimit = j["p2p-peer-upload-limit"].get<int>();
+    }
+
+    if (j.find("p2p-peer-download-limit") != j.end())
+    {
+      config.p2pPeerDownloadLimit = j["p2p-peer-download-limit"].get<int>();
+    }
+
     if (j.find("rpc-bind-ip") != j.end())
     {
       config.rpcInterface = j["rpc-bind-ip"].get<std::string>();
@@ -641,6 +757,11 @@ namespace DaemonConfig{
       config.enableBlockExplorer = j["enable-blockexplorer"].get<bool>();
     }
 
+    if (j.find("disable-metrics") != j.end())
+    {
+      config.disableMetrics = j["disable-metrics"].get<bool>();
+    }
+
     if (j.find("enable-cors") != j.end())
     {
       config.enableCors = j["enable-cors"].get<std::vector<std::string>>();
@@ -674,6 +795,10 @@ namespace DaemonConfig{
       {"p2p-bind-ip", config.p2pInterface},
       {"p2p-bind-port", config.p2pPort},
       {"p2p-external-port", config.p2pExternalPort},
+      {"p2p-upload-limit", config.p2pUploadLimit},
+      {"p2p-download-limit", config.p2pDownloadLimit},
+      {"p2p-peer-upload-limit", config.p2pPeerUploadLimit},
+      {"p2p-peer-download-limit", config.p2pPeerDownloadLimit},
       {"rpc-bind-ip", config.rpcInterface},
       {"rpc-bind-port", config.rpcPort},
       {"add-exclusive-node", config.exclusiveNodes},
@@ -681,6 +806,7 @@ namespace DaemonConfig{
       {"add-priority-node", config.priorityNodes},
       {"seed-node", config.seedNodes},
       {"enable-blockexplorer", config.enableBlockExplorer},
+      {"disable-metrics", config.disableMetrics},
       {"enable-cors", config.enableCors},
       {"fee-address", config.feeAddress},
       {"fee-amount", config.feeAmount},
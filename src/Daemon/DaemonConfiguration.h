@@ -31,10 +31,15 @@ namespace DaemonConfig {
       p2pInterface = "0.0.0.0";
       p2pPort = CryptoNote::P2P_DEFAULT_PORT;
       p2pExternalPort = 0;
+      p2pUploadLimit = 0;
+      p2pDownloadLimit = 0;
+      p2pPeerUploadLimit = 0;
+      p2pPeerDownloadLimit = 0;
       rpcInterface = "127.0.0.1";
       rpcPort = CryptoNote::RPC_DEFAULT_PORT;
       noConsole = false;
       enableBlockExplorer = false;
+      disableMetrics = false;
       localIp = false;
       hideMyPort = false;
       help = false;
@@ -42,6 +47,8 @@ namespace DaemonConfig {
       osVersion = false;
       printGenesisTx = false;
       dumpConfig = false; 
+      importBlockchain = false;
+      importVerify = false;
     }
 
     std::string dataDirectory;
@@ -62,6 +69,10 @@ namespace DaemonConfig {
     int rpcPort;
     int p2pPort;
     int p2pExternalPort;
+    int p2pUploadLimit;
+    int p2pDownloadLimit;
+    int p2pPeerUploadLimit;
+    int p2pPeerDownloadLimit;
     int dbThreads;
     int dbMaxOpenFiles;
     int dbWriteBufferSizeMB;
@@ -69,6 +80,7 @@ namespace DaemonConfig {
 
     bool noConsole;
     bool enableBlockExplorer;
+    bool disableMetrics;
     bool localIp;
     bool hideMyPort;
 
@@ -80,6 +92,8 @@ namespace DaemonConfig {
     bool osVersion;
     bool printGenesisTx;
     bool dumpConfig;
+    bool importBlockchain;
+    bool importVerify;
   };
 
   DaemonConfiguration initConfiguration(const char* path);
@@ -0,0 +1,178 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "AsyncLogger.h"
+
+#include <chrono>
+
+namespace Logging {
+
+namespace {
+
+// the most messages delivered between two flushes of the target
+const size_t MAX_BATCH_SIZE = 1024;
+
+// a lost wakeup costs at most this much latency
+const auto WRITER_IDLE_TIMEOUT = std::chrono::milliseconds(100);
+
+const auto BLOCKED_TIMEOUT = std::chrono::milliseconds(1);
+
+size_t roundUpToPowerOfTwo(size_t value) {
+  size_t result = 2;
+  while (result < value) {
+    result <<= 1;
+  }
+
+  return result;
+}
+
+}
+
+AsyncLogger::AsyncLogger(ILogger& target, size_t queueSize, OverflowPolicy overflowPolicy) :
+  target(target),
+  overflowPolicy(overflowPolicy),
+  slots(new Slot[roundUpToPowerOfTwo(queueSize)]),
+  mask(roundUpToPowerOfTwo(queueSize) - 1),
+  enqueuePosition(0),
+  dequeuePosition(0),
+  droppedMessageCount(0),
+  unreportedDroppedMessageCount(0),
+  writerWaiting(false),
+  stopped(false),
+  blockedCount(0) {
+  for (size_t i = 0; i <= mask; ++i) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  writer = std::thread(&AsyncLogger::writerProcedure, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+  stopped = true;
+  wakeWriter();
+  writer.join();
+}
+
+void AsyncLogger::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
+  Record record { category, level, time, body };
+  while (!tryPush(record)) {
+    if (overflowPolicy == OverflowPolicy::DROP) {
+      ++droppedMessageCount;
+      ++unreportedDroppedMessageCount;
+      return;
+    }
+
+    wakeWriter();
+    std::unique_lock<std::mutex> lock(spaceMutex);
+    ++blockedCount;
+    spaceCondition.wait_for(lock, BLOCKED_TIMEOUT);
+    --blockedCount;
+  }
+
+  // pairs with the fence in writerProcedure: either the writer sees the message, or we see it waiting
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (writerWaiting.load(std::memory_order_relaxed)) {
+    wakeWriter();
+  }
+}
+
+uint64_t AsyncLogger::getDroppedMessageCount() const {
+  return droppedMessageCount;
+}
+
+bool AsyncLogger::tryPush(Record& record) {
+  size_t position = enqueuePosition.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots[position & mask];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+    if (difference == 0) {
+      if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        slot.record = std::move(record);
+        slot.sequence.store(position + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncLogger::tryPop(Record& record) {
+  if (empty()) {
+    return false;
+  }
+
+  Slot& slot = slots[dequeuePosition & mask];
+  record = std::move(slot.record);
+  slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+  ++dequeuePosition;
+  return true;
+}
+
+bool AsyncLogger::empty() const {
+  const Slot& slot = slots[dequeuePosition & mask];
+  return slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1;
+}
+
+void AsyncLogger::wakeWriter() {
+  std::unique_lock<std::mutex> lock(writerMutex);
+  writerCondition.notify_one();
+}
+
+void AsyncLogger::writerProcedure() {
+  Record record;
+  for (;;) {
+    size_t count = 0;
+    while (count < MAX_BATCH_SIZE && tryPop(record)) {
+      try {
+        target(record.category, record.level, record.time, record.body);
+      } catch (...) {
+      }
+
+      ++count;
+    }
+
+    uint64_t dropped = unreportedDroppedMessageCount.exchange(0);
+    if (dropped != 0) {
+      try {
+        target("logging", WARNING, boost::posix_time::microsec_clock::local_time(),
+          std::to_string(dropped) + " log messages were dropped, the log queue was full\n");
+      } catch (...) {
+      }
+    }
+
+    if (count != 0 || dropped != 0) {
+      try {
+        target.flush();
+      } catch (...) {
+      }
+
+      if (blockedCount.load() != 0) {
+        std::unique_lock<std::mutex> lock(spaceMutex);
+        spaceCondition.notify_all();
+      }
+
+      continue;
+    }
+
+    // a message may still be in flight in a producer which claimed its slot before we stopped
+    if (stopped && enqueuePosition.load() == dequeuePosition) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(writerMutex);
+    writerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (empty() && !stopped) {
+      writerCondition.wait_for(lock, WRITER_IDLE_TIMEOUT);
+    }
+
+    writerWaiting.store(false, std::memory_order_relaxed);
+  }
+}
+
+}
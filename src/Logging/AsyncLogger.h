@@ -0,0 +1,83 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "ILogger.h"
+
+namespace Logging {
+
+/*
+ * Hands messages to a writer thread through a bounded lock-free ring buffer, so the logging thread
+ * never waits on a disk or console write. The writer delivers messages to the target logger in
+ * batches and flushes it once per batch.
+ */
+class AsyncLogger : public ILogger {
+public:
+  enum class OverflowPolicy {
+    // wait for the writer to free a slot
+    BLOCK,
+    // drop the message; the writer reports how many were dropped
+    DROP
+  };
+
+  AsyncLogger(ILogger& target, size_t queueSize, OverflowPolicy overflowPolicy);
+  AsyncLogger(const AsyncLogger&) = delete;
+  // Writes the queued messages, then stops the writer thread.
+  ~AsyncLogger();
+  AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+
+  uint64_t getDroppedMessageCount() const;
+
+private:
+  struct Record {
+    std::string category;
+    Level level;
+    boost::posix_time::ptime time;
+    std::string body;
+  };
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Record record;
+  };
+
+  bool tryPush(Record& record);
+  bool tryPop(Record& record);
+  bool empty() const;
+  void wakeWriter();
+  void writerProcedure();
+
+  ILogger& target;
+  const OverflowPolicy overflowPolicy;
+
+  std::unique_ptr<Slot[]> slots;
+  size_t mask;
+  std::atomic<size_t> enqueuePosition;
+  // only touched by the writer thread
+  size_t dequeuePosition;
+
+  std::atomic<uint64_t> droppedMessageCount;
+  std::atomic<uint64_t> unreportedDroppedMessageCount;
+
+  std::mutex writerMutex;
+  std::condition_variable writerCondition;
+  std::atomic<bool> writerWaiting;
+  std::atomic<bool> stopped;
+
+  std::mutex spaceMutex;
+  std::condition_variable spaceCondition;
+  std::atomic<size_t> blockedCount;
+
+  std::thread writer;
+};
+
+}
@@ -16,13 +16,53 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "CommonLogger.h"
+#include <sstream>
 
 namespace Logging {
 
 namespace {
 
+// Formatting the date and time through the stream operators dominates the cost of a message, so
+// each thread keeps the formatted date and time of the last second it logged in.
+struct TimestampCache {
+  boost::posix_time::ptime second;
+  std::string date;
+  std::string time;
+};
+
+const TimestampCache& formatTimestamp(boost::posix_time::ptime time) {
+  thread_local TimestampCache cache;
+  boost::posix_time::ptime second(time.date(), boost::posix_time::seconds(time.time_of_day().total_seconds()));
+  if (cache.second != second || cache.date.empty()) {
+    std::stringstream date;
+    date << second.date();
+    cache.date = date.str();
+
+    std::stringstream timeOfDay;
+    timeOfDay << second.time_of_day();
+    cache.time = timeOfDay.str();
+    cache.second = second;
+  }
+
+  return cache;
+}
+
+void appendTimeOfDay(std::string& s, boost::posix_time::ptime time) {
+  const TimestampCache& cache = formatTimestamp(time);
+  s += cache.time;
+
+  // like the stream operator, only print the fractional seconds when there are some
+  auto fraction = time.time_of_day().fractional_seconds();
+  if (fraction != 0) {
+    std::string digits = std::to_string(fraction);
+    s += '.';
+    s.append(boost::posix_time::time_duration::num_fractional_digits() - digits.size(), '0');
+    s += digits;
+  }
+}
+
 std::string formatPattern(const std::string& pattern, const std::string& category, Level level, boost::posix_time::ptime time) {
-  std::stringstream s;
+  std::string s;
 
   for (const char* p = pattern.c_str(); p && *p != 0; ++p) {
     if (*p == '%') {
@@ -31,26 +71,31 @@ std::string formatPattern(const std::string& pattern, const std::string& categor
       case 0:
         break;
       case 'C':
-        s << category;
+        s += category;
         break;
       case 'D':
-        s << time.date();
+        s += formatTimestamp(time).date;
         break;
       case 'T':
-        s << time.time_of_day();
+        appendTimeOfDay(s, time);
         break;
-      case 'L':
-        s << std::setw(7) << std::left << ILogger::LEVEL_NAMES[level];
+      case 'L': {
+        const std::string& name = ILogger::LEVEL_NAMES[level];
+        s += name;
+        if (name.size() < 7) {
+          s.append(7 - name.size(), ' ');
+        }
         break;
+      }
       default:
-        s << *p;
+        s += *p;
       }
     } else {
-      s << *p;
+      s += *p;
     }
   }
 
-  return s.str();
+  return s;
 }
 
 }
@@ -28,6 +28,11 @@ using Common::Console::Color;
 ConsoleLogger::ConsoleLogger(Level level) : CommonLogger(level) {
 }
 
+void ConsoleLogger::flush() {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::cout.flush();
+}
+
 void ConsoleLogger::doLogString(const std::string& message) {
   std::lock_guard<std::mutex> lock(mutex);
   bool readingText = true;
@@ -54,8 +59,14 @@ void ConsoleLogger::doLogString(const std::string& message) {
     { DEFAULT, Color::Default }
   };
 
+  // the text between color markers is written in runs rather than a character at a time
+  size_t textStart = 0;
   for (size_t charPos = 0; charPos < message.size(); ++charPos) {
     if (message[charPos] == ILogger::COLOR_DELIMETER) {
+      if (readingText) {
+        std::cout.write(message.data() + textStart, charPos - textStart);
+      }
+
       readingText = !readingText;
       color += message[charPos];
       if (readingText) {
@@ -63,14 +74,17 @@ void ConsoleLogger::doLogString(const std::string& message) {
         Common::Console::setTextColor(it == colorMapping.end() ? Color::Default : it->second);
         changedColor = true;
         color.clear();
+        textStart = charPos + 1;
       }
-    } else if (readingText) {
-      std::cout << message[charPos];
-    } else {
+    } else if (!readingText) {
       color += message[charPos];
     }
   }
 
+  if (readingText) {
+    std::cout.write(message.data() + textStart, message.size() - textStart);
+  }
+
   if (changedColor) {
     Common::Console::setTextColor(Color::Default);
   }
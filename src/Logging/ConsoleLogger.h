@@ -25,6 +25,7 @@ namespace Logging {
 class ConsoleLogger : public CommonLogger {
 public:
   ConsoleLogger(Level level = DEBUGGING);
+  virtual void flush() override;
 
 protected:
   virtual void doLogString(const std::string& message) override;
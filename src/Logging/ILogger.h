@@ -57,6 +57,9 @@ public:
   const static std::array<std::string, 6> LEVEL_NAMES;
 
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) = 0;
+
+  // Writes out anything the logger has buffered.
+  virtual void flush() {}
 };
 
 #ifndef ENDL
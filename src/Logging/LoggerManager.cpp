@@ -24,16 +24,28 @@ namespace Logging {
 
 using Common::JsonValue;
 
-LoggerManager::LoggerManager() {
+namespace {
+
+const size_t DEFAULT_ASYNC_QUEUE_SIZE = 8192;
+
+}
+
+LoggerManager::LoggerManager() : asyncLoggers(TRACE) {
 }
 
 void LoggerManager::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
-  std::unique_lock<std::mutex> lock(reconfigureLock);
+  std::shared_lock<std::shared_mutex> lock(reconfigureLock);
   LoggerGroup::operator()(category, level, time, body);
 }
 
 void LoggerManager::configure(const JsonValue& val) {
-  std::unique_lock<std::mutex> lock(reconfigureLock);
+  std::unique_lock<std::shared_mutex> lock(reconfigureLock);
+  // write out what is queued before the loggers go away
+  asyncLogger.reset();
+  for (const auto& logger : loggers) {
+    asyncLoggers.removeLogger(*logger);
+  }
+
   loggers.clear();
   LoggerGroup::loggers.clear();
   Level globalLevel;
@@ -49,6 +61,32 @@ void LoggerManager::configure(const JsonValue& val) {
   }
   std::vector<std::string> globalDisabledCategories;
 
+  bool async = false;
+  size_t asyncQueueSize = DEFAULT_ASYNC_QUEUE_SIZE;
+  AsyncLogger::OverflowPolicy asyncOverflowPolicy = AsyncLogger::OverflowPolicy::BLOCK;
+  if (val.contains("async")) {
+    auto asyncVal = val("async");
+    if (!asyncVal.isObject()) {
+      throw std::runtime_error("parameter async has wrong type");
+    }
+
+    async = true;
+    if (asyncVal.contains("queueSize")) {
+      asyncQueueSize = static_cast<size_t>(asyncVal("queueSize").getInteger());
+    }
+
+    if (asyncVal.contains("overflowPolicy")) {
+      std::string policy = asyncVal("overflowPolicy").getString();
+      if (policy == "block") {
+        asyncOverflowPolicy = AsyncLogger::OverflowPolicy::BLOCK;
+      } else if (policy == "drop") {
+        asyncOverflowPolicy = AsyncLogger::OverflowPolicy::DROP;
+      } else {
+        throw std::runtime_error("Unknown async overflow policy: " + policy);
+      }
+    }
+  }
+
   if (val.contains("globalDisabledCategories")) {
     auto globalDisabledCategoriesList = val("globalDisabledCategories");
     if (globalDisabledCategoriesList.isArray()) {
@@ -88,6 +126,8 @@ void LoggerManager::configure(const JsonValue& val) {
           std::string filename = loggerConfiguration("filename").getString();
           auto fileLogger = new FileLogger(level);
           fileLogger->init(filename);
+          // the async writer flushes once per batch instead
+          fileLogger->setAutoFlush(!async);
           logger.reset(fileLogger);
         } else {
           throw std::runtime_error("Unknown logger type: " + type);
@@ -110,7 +150,11 @@ void LoggerManager::configure(const JsonValue& val) {
         }
 
         loggers.emplace_back(std::move(logger));
-        addLogger(*loggers.back());
+        if (async) {
+          asyncLoggers.addLogger(*loggers.back());
+        } else {
+          addLogger(*loggers.back());
+        }
       }
     } else {
       throw std::runtime_error("loggers parameter has wrong type");
@@ -118,6 +162,12 @@ void LoggerManager::configure(const JsonValue& val) {
   } else {
     throw std::runtime_error("loggers parameter missing");
   }
+
+  if (async) {
+    asyncLogger.reset(new AsyncLogger(asyncLoggers, asyncQueueSize, asyncOverflowPolicy));
+    addLogger(*asyncLogger);
+  }
+
   setMaxLevel(globalLevel);
   for (const auto& category : globalDisabledCategories) {
     disableCategory(category);
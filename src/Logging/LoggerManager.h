@@ -19,8 +19,9 @@
 
 #include <list>
 #include <memory>
-#include <mutex>
+#include <shared_mutex>
 #include "../Common/JsonValue.h"
+#include "AsyncLogger.h"
 #include "LoggerGroup.h"
 
 namespace Logging {
@@ -33,7 +34,11 @@ public:
 
 private:
   std::vector<std::unique_ptr<CommonLogger>> loggers;
-  std::mutex reconfigureLock;
+  // with an "async" configuration, messages are passed to the loggers through asyncLogger
+  LoggerGroup asyncLoggers;
+  std::unique_ptr<AsyncLogger> asyncLogger;
+  // logging only reads the logger set, so it takes the lock shared; configure() takes it exclusively
+  std::shared_mutex reconfigureLock;
 };
 
 }
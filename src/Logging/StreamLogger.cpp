@@ -21,29 +21,47 @@
 
 namespace Logging {
 
-StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr) {
+StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr), autoFlush(true) {
 }
 
-StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream) {
+StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream), autoFlush(true) {
 }
 
 void StreamLogger::attachToStream(std::ostream& stream) {
   this->stream = &stream;
 }
 
+void StreamLogger::setAutoFlush(bool autoFlush) {
+  this->autoFlush = autoFlush;
+}
+
+void StreamLogger::flush() {
+  if (stream != nullptr && stream->good()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stream->flush();
+  }
+}
+
 void StreamLogger::doLogString(const std::string& message) {
   if (stream != nullptr && stream->good()) {
     std::lock_guard<std::mutex> lock(mutex);
+    // write the text between color markers in runs rather than a character at a time
     bool readingText = true;
-    for (size_t charPos = 0; charPos < message.size(); ++charPos) {
-      if (message[charPos] == ILogger::COLOR_DELIMETER) {
+    size_t textStart = 0;
+    for (size_t charPos = 0; charPos <= message.size(); ++charPos) {
+      if (charPos == message.size() || message[charPos] == ILogger::COLOR_DELIMETER) {
+        if (readingText) {
+          stream->write(message.data() + textStart, charPos - textStart);
+        }
+
         readingText = !readingText;
-      } else if (readingText) {
-        *stream << message[charPos];
+        textStart = charPos + 1;
       }
     }
 
-    *stream << std::flush;
+    if (autoFlush) {
+      *stream << std::flush;
+    }
   }
 }
 
@@ -27,6 +27,9 @@ public:
   StreamLogger(Level level = DEBUGGING);
   StreamLogger(std::ostream& stream, Level level = DEBUGGING);
   void attachToStream(std::ostream& stream);
+  // When disabled, the stream is only flushed by flush(), e.g. once per batch by an AsyncLogger.
+  void setAutoFlush(bool autoFlush);
+  virtual void flush() override;
 
 protected:
   virtual void doLogString(const std::string& message) override;
@@ -36,6 +39,7 @@ protected:
 
 private:
   std::mutex mutex;
+  bool autoFlush;
 };
 
 }
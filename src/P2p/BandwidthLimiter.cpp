@@ -0,0 +1,47 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BandwidthLimiter.h"
+
+#include <algorithm>
+
+namespace CryptoNote {
+
+BandwidthLimiter::BandwidthLimiter(uint64_t rate) : rate(rate), tokens(static_cast<double>(rate)), updated() {
+}
+
+void BandwidthLimiter::setRate(uint64_t newRate) {
+  rate = newRate;
+  tokens = static_cast<double>(rate);
+  updated = Clock::time_point();
+}
+
+uint64_t BandwidthLimiter::getRate() const {
+  return rate;
+}
+
+bool BandwidthLimiter::isLimited() const {
+  return rate != 0;
+}
+
+std::chrono::nanoseconds BandwidthLimiter::take(size_t size, Clock::time_point now) {
+  if (rate == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+
+  double capacity = static_cast<double>(rate);
+  if (updated != Clock::time_point() && now > updated) {
+    tokens = std::min(capacity, tokens + capacity * std::chrono::duration<double>(now - updated).count());
+  }
+
+  updated = std::max(updated, now);
+  tokens -= static_cast<double>(size);
+  if (tokens >= 0) {
+    return std::chrono::nanoseconds(0);
+  }
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(-tokens / capacity));
+}
+
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace CryptoNote {
+
+/* Token bucket letting through a rate of bytes per second, in bursts of up to a second worth of them.
+   Takers don't wait for the tokens to be there, they run into debt and are told how long to wait instead,
+   so whoever takes next waits behind them. Connections sharing a limiter get their turns in order. */
+class BandwidthLimiter {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /* A rate of 0 doesn't limit anything */
+  explicit BandwidthLimiter(uint64_t rate = 0);
+
+  void setRate(uint64_t rate);
+  uint64_t getRate() const;
+  bool isLimited() const;
+
+  /* Takes size bytes and returns how long to wait before transferring them */
+  std::chrono::nanoseconds take(size_t size, Clock::time_point now);
+
+private:
+  uint64_t rate;
+  double tokens;
+  Clock::time_point updated;
+};
+
+}
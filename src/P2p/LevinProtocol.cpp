@@ -44,6 +44,8 @@ struct bucket_head2
 
 }
 
+const size_t LevinProtocol::HEADER_SIZE = sizeof(bucket_head2);
+
 bool LevinProtocol::Command::needReply() const {
   return !(isNotify || isResponse);
 }
@@ -52,22 +54,8 @@ LevinProtocol::LevinProtocol(System::TcpConnection& connection)
   : m_conn(connection) {}
 
 void LevinProtocol::sendMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
-  bucket_head2 head = { 0 };
-  head.m_signature = LEVIN_SIGNATURE;
-  head.m_cb = out.size();
-  head.m_have_to_return_data = needResponse;
-  head.m_command = command;
-  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
-  head.m_flags = LEVIN_PACKET_REQUEST;
-
   // write header and body in one operation
-  BinaryArray writeBuffer;
-  writeBuffer.reserve(sizeof(head) + out.size());
-
-  Common::VectorOutputStream stream(writeBuffer);
-  stream.writeSome(&head, sizeof(head));
-  stream.writeSome(out.data(), out.size());
-
+  BinaryArray writeBuffer = encodeMessage(command, out, needResponse);
   writeStrict(writeBuffer.data(), writeBuffer.size());
 }
 
@@ -104,6 +92,29 @@ bool LevinProtocol::readCommand(Command& cmd) {
 }
 
 void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode) {
+  BinaryArray writeBuffer = encodeReply(command, out, returnCode);
+  writeStrict(writeBuffer.data(), writeBuffer.size());
+}
+
+BinaryArray LevinProtocol::encodeMessage(uint32_t command, const BinaryArray& out, bool needResponse) {
+  bucket_head2 head = { 0 };
+  head.m_signature = LEVIN_SIGNATURE;
+  head.m_cb = out.size();
+  head.m_have_to_return_data = needResponse;
+  head.m_command = command;
+  head.m_protocol_version = LEVIN_PROTOCOL_VER_1;
+  head.m_flags = LEVIN_PACKET_REQUEST;
+
+  BinaryArray writeBuffer;
+  writeBuffer.reserve(sizeof(head) + out.size());
+
+  Common::VectorOutputStream stream(writeBuffer);
+  stream.writeSome(&head, sizeof(head));
+  stream.writeSome(out.data(), out.size());
+  return writeBuffer;
+}
+
+BinaryArray LevinProtocol::encodeReply(uint32_t command, const BinaryArray& out, int32_t returnCode) {
   bucket_head2 head = { 0 };
   head.m_signature = LEVIN_SIGNATURE;
   head.m_cb = out.size();
@@ -119,8 +130,7 @@ void LevinProtocol::sendReply(uint32_t command, const BinaryArray& out, int32_t
   Common::VectorOutputStream stream(writeBuffer);
   stream.writeSome(&head, sizeof(head));
   stream.writeSome(out.data(), out.size());
-
-  writeStrict(writeBuffer.data(), writeBuffer.size());
+  return writeBuffer;
 }
 
 void LevinProtocol::writeStrict(const uint8_t* ptr, size_t size) {
@@ -80,6 +80,13 @@ public:
   void sendMessage(uint32_t command, const BinaryArray& out, bool needResponse);
   void sendReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
 
+  // Whole packets, header included, for callers which write them in parts with writeStrict
+  static BinaryArray encodeMessage(uint32_t command, const BinaryArray& out, bool needResponse);
+  static BinaryArray encodeReply(uint32_t command, const BinaryArray& out, int32_t returnCode);
+  void writeStrict(const uint8_t* ptr, size_t size);
+
+  static const size_t HEADER_SIZE;
+
   template <typename T>
   static bool decode(const BinaryArray& buf, T& value) {
     try {
@@ -106,7 +113,6 @@ public:
 private:
 
   bool readStrict(uint8_t* ptr, size_t size);
-  void writeStrict(const uint8_t* ptr, size_t size);
   System::TcpConnection& m_conn;
 };
 
@@ -27,10 +27,12 @@
 
 #include "version.h"
 #include <config/CryptoNoteConfig.h>
+#include "Common/Metrics.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Common/Util.h"
 #include "crypto/crypto.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
 
 #include "ConnectionContext.h"
 #include "LevinProtocol.h"
@@ -118,7 +120,12 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
   //-----------------------------------------------------------------------------------
 
   bool P2pConnectionContext::pushMessage(P2pMessage&& msg) {
+    static const std::vector<double> queueSizeBuckets = { 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216 };
+    static auto& queueSize = Metrics::registry().histogram("p2p_write_queue_size_bytes",
+      "Size of the write queue of a connection after a message is queued", queueSizeBuckets);
+
     writeQueueSize += msg.size();
+    queueSize.observe(static_cast<double>(writeQueueSize));
 
     if (writeQueueSize > P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE) {
       logger(DEBUGGING) << *this << "Write queue overflows. Interrupt connection";
@@ -126,24 +133,58 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
       return false;
     }
 
-    writeQueue.push_back(std::move(msg));
+    writeQueues[msg.priority()].push_back(std::move(msg));
     queueEvent.set();
     return true;
   }
 
-  std::vector<P2pMessage> P2pConnectionContext::popBuffer() {
-    writeOperationStartTime = TimePoint();
+  bool P2pConnectionContext::popMessage(BinaryArray& packet) {
+    for (;;) {
+      if (stopped) {
+        return false;
+      }
 
-    while (writeQueue.empty() && !stopped) {
+      for (auto& queue : writeQueues) {
+        if (queue.empty()) {
+          continue;
+        }
+
+        const P2pMessage& msg = queue.front();
+        logger(DEBUGGING) << *this << "msg " << msg.type << ':' << msg.command;
+        switch (msg.type) {
+        case P2pMessage::COMMAND:
+          packet = LevinProtocol::encodeMessage(msg.command, msg.buffer, true);
+          break;
+        case P2pMessage::NOTIFY:
+          packet = LevinProtocol::encodeMessage(msg.command, msg.buffer, false);
+          break;
+        case P2pMessage::REPLY:
+          packet = LevinProtocol::encodeReply(msg.command, msg.buffer, msg.returnCode);
+          break;
+        default:
+          assert(false);
+        }
+
+        writeQueueSize -= msg.size();
+        queue.pop_front();
+        return true;
+      }
+
+      queueEvent.clear();
       queueEvent.wait();
     }
+  }
+
+  size_t P2pConnectionContext::getWriteQueueSize() const {
+    return writeQueueSize;
+  }
 
-    std::vector<P2pMessage> msgs(std::move(writeQueue));
-    writeQueue.clear();
-    writeQueueSize = 0;
+  void P2pConnectionContext::beginWrite() {
     writeOperationStartTime = Clock::now();
-    queueEvent.clear();
-    return msgs;
+  }
+
+  void P2pConnectionContext::endWrite() {
+    writeOperationStartTime = TimePoint();
   }
 
   uint64_t P2pConnectionContext::writeDuration(TimePoint now) const { // in milliseconds
@@ -159,6 +200,25 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
   }
 
 
+  P2pMessage::Priority P2pMessage::priority() const {
+    if (type != NOTIFY) {
+      return CONTROL;
+    }
+
+    switch (command) {
+    case NOTIFY_NEW_BLOCK::ID:
+      return BLOCK;
+    case NOTIFY_NEW_TRANSACTIONS::ID:
+      return TRANSACTION;
+    case NOTIFY_RESPONSE_GET_OBJECTS::ID:
+    case NOTIFY_RESPONSE_CHAIN_ENTRY::ID:
+      return SYNC;
+    default:
+      return CONTROL;
+    }
+  }
+
+
   template <typename Command, typename Handler>
   int invokeAdaptor(const BinaryArray& reqBuf, BinaryArray& resBuf, P2pConnectionContext& ctx, Handler handler) {
     typedef typename Command::request Request;
@@ -183,6 +243,8 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     m_payload_handler(payload_handler),
     m_allow_local_ip(false),
     m_hide_my_port(false),
+    m_peer_upload_limit(0),
+    m_peer_download_limit(0),
     m_network_id(CryptoNote::CRYPTONOTE_NETWORK),
     logger(log, "node_server"),
     m_stopEvent(m_dispatcher),
@@ -328,6 +390,11 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     std::copy(seedNodes.begin(), seedNodes.end(), std::back_inserter(m_seed_nodes));
 
     m_hide_my_port = config.getHideMyPort();
+
+    m_upload_limiter.setRate(config.getUploadLimit());
+    m_download_limiter.setRate(config.getDownloadLimit());
+    m_peer_upload_limit = config.getPeerUploadLimit();
+    m_peer_download_limit = config.getPeerDownloadLimit();
     return true;
   }
 
@@ -844,6 +911,33 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     return count;
   }
 
+  void NodeServer::updateMetrics() {
+    static auto& incoming = Metrics::registry().gauge("p2p_connections", "Open peer connections", "direction=\"in\"");
+    static auto& outgoing = Metrics::registry().gauge("p2p_connections", "Open peer connections", "direction=\"out\"");
+    static auto& queuedBytes = Metrics::registry().gauge("p2p_write_queue_bytes", "Bytes waiting to be written to peers", "connections=\"all\"");
+    static auto& maxQueuedBytes = Metrics::registry().gauge("p2p_write_queue_bytes", "Bytes waiting to be written to peers", "connections=\"largest\"");
+
+    int64_t incomingCount = 0;
+    int64_t outgoingCount = 0;
+    size_t totalQueueSize = 0;
+    size_t maxQueueSize = 0;
+    for (const auto& connection : m_connections) {
+      if (connection.second.m_is_income) {
+        ++incomingCount;
+      } else {
+        ++outgoingCount;
+      }
+
+      totalQueueSize += connection.second.getWriteQueueSize();
+      maxQueueSize = std::max(maxQueueSize, connection.second.getWriteQueueSize());
+    }
+
+    incoming.set(incomingCount);
+    outgoing.set(outgoingCount);
+    queuedBytes.set(static_cast<int64_t>(totalQueueSize));
+    maxQueuedBytes.set(static_cast<int64_t>(maxQueueSize));
+  }
+
   //-----------------------------------------------------------------------------------
   bool NodeServer::idle_worker() {
     try {
@@ -1296,8 +1390,12 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
 
   void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
     // This inner context is necessary in order to stop connection handler at any moment
+    ctx.uploadLimiter.setRate(m_peer_upload_limit);
+    ctx.downloadLimiter.setRate(m_peer_download_limit);
+
     System::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
       System::Context<> writeContext(m_dispatcher, std::bind(&NodeServer::writeHandler, this, std::ref(ctx)));
+      System::Timer bandwidthTimer(m_dispatcher);
 
       try {
         on_connection_new(ctx);
@@ -1332,6 +1430,9 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
             ctx.pushMessage(P2pMessage(P2pMessage::REPLY, cmd.command, std::move(response), retcode));
           }
 
+          // Not reading the next command makes the peer slow down once the socket buffers are full
+          waitForBandwidth(ctx.downloadLimiter, m_download_limiter, LevinProtocol::HEADER_SIZE + cmd.buf.size(), bandwidthTimer);
+
           if (ctx.m_state == CryptoNoteConnectionContext::state_shutdown) {
             break;
           }
@@ -1368,28 +1469,23 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
 
     try {
       LevinProtocol proto(ctx.connection);
-
-      for (;;) {
-        auto msgs = ctx.popBuffer();
-        if (msgs.empty()) {
-          break;
+      System::Timer bandwidthTimer(m_dispatcher);
+      BinaryArray packet;
+
+      while (ctx.popMessage(packet)) {
+        // Under a limit large packets are written in parts, so that they don't hold up the other connections
+        size_t partSize = packet.size();
+        if (ctx.uploadLimiter.isLimited() || m_upload_limiter.isLimited()) {
+          partSize = std::min(partSize, P2P_BANDWIDTH_LIMITED_WRITE_SIZE);
         }
 
-        for (const auto& msg : msgs) {
-          logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
-          switch (msg.type) {
-          case P2pMessage::COMMAND:
-            proto.sendMessage(msg.command, msg.buffer, true);
-            break;
-          case P2pMessage::NOTIFY:
-            proto.sendMessage(msg.command, msg.buffer, false);
-            break;
-          case P2pMessage::REPLY:
-            proto.sendReply(msg.command, msg.buffer, msg.returnCode);
-            break;
-          default:
-            assert(false);
-          }
+        for (size_t offset = 0; offset < packet.size(); offset += partSize) {
+          size_t size = std::min(partSize, packet.size() - offset);
+          waitForBandwidth(ctx.uploadLimiter, m_upload_limiter, size, bandwidthTimer);
+
+          ctx.beginWrite();
+          proto.writeStrict(packet.data() + offset, size);
+          ctx.endWrite();
         }
       }
     } catch (System::InterruptedException&) {
@@ -1403,6 +1499,19 @@ std::string print_peerlist_to_string(const std::list<PeerlistEntry>& pl) {
     logger(DEBUGGING) << ctx << "writeHandler finished";
   }
 
+  // The peer's own limit is waited on first, so that the shared one is only taken from once the peer may go ahead
+  void NodeServer::waitForBandwidth(BandwidthLimiter& peerLimiter, BandwidthLimiter& limiter, size_t size, System::Timer& timer) {
+    auto delay = peerLimiter.take(size, BandwidthLimiter::Clock::now());
+    if (delay.count() > 0) {
+      timer.sleep(delay);
+    }
+
+    delay = limiter.take(size, BandwidthLimiter::Clock::now());
+    if (delay.count() > 0) {
+      timer.sleep(delay);
+    }
+  }
+
   template<typename T>
   void NodeServer::safeInterrupt(T& obj) {
     try {
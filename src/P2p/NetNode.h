@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <array>
+#include <deque>
 #include <functional>
 #include <unordered_map>
 
@@ -23,6 +25,7 @@
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
 #include "Logging/LoggerRef.h"
 
+#include "BandwidthLimiter.h"
 #include "ConnectionContext.h"
 #include "LevinProtocol.h"
 #include "NetNodeCommon.h"
@@ -46,6 +49,15 @@ namespace CryptoNote
       NOTIFY
     };
 
+    // Queued messages are written in this order, new blocks before transactions before the bulk of syncing
+    enum Priority {
+      CONTROL,
+      BLOCK,
+      TRANSACTION,
+      SYNC,
+      PRIORITY_COUNT
+    };
+
     P2pMessage(Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0) :
       type(type), command(command), buffer(buffer), returnCode(returnCode) {
     }
@@ -54,10 +66,12 @@ namespace CryptoNote
       type(msg.type), command(msg.command), buffer(std::move(msg.buffer)), returnCode(msg.returnCode) {
     }
 
-    size_t size() {
+    size_t size() const {
       return buffer.size();
     }
 
+    Priority priority() const;
+
     Type type;
     uint32_t command;
     const BinaryArray buffer;
@@ -72,6 +86,8 @@ namespace CryptoNote
     System::Context<void>* context;
     uint64_t peerId;
     System::TcpConnection connection;
+    BandwidthLimiter uploadLimiter;
+    BandwidthLimiter downloadLimiter;
 
     P2pConnectionContext(System::Dispatcher& dispatcher, Logging::ILogger& log, System::TcpConnection&& conn) :
       context(nullptr),
@@ -87,22 +103,31 @@ namespace CryptoNote
       context(ctx.context),
       peerId(ctx.peerId),
       connection(std::move(ctx.connection)),
+      uploadLimiter(ctx.uploadLimiter),
+      downloadLimiter(ctx.downloadLimiter),
       logger(ctx.logger.getLogger(), "node_server"),
       queueEvent(std::move(ctx.queueEvent)),
       stopped(std::move(ctx.stopped)) {
     }
 
     bool pushMessage(P2pMessage&& msg);
-    std::vector<P2pMessage> popBuffer();
+    // Waits for a message to be queued and takes the one of the highest priority as a Levin packet,
+    // returns false once the connection is stopped
+    bool popMessage(BinaryArray& packet);
     void interrupt();
 
+    size_t getWriteQueueSize() const;
+
+    // Only the time spent in writes counts towards the write timeout, waiting on the bandwidth limits doesn't
+    void beginWrite();
+    void endWrite();
     uint64_t writeDuration(TimePoint now) const;
 
   private:
     Logging::LoggerRef logger;
     TimePoint writeOperationStartTime;
     System::Event queueEvent;
-    std::vector<P2pMessage> writeQueue;
+    std::array<std::deque<P2pMessage>, P2pMessage::PRIORITY_COUNT> writeQueues;
     size_t writeQueueSize = 0;
     bool stopped;
   };
@@ -127,6 +152,9 @@ namespace CryptoNote
     virtual uint64_t get_connections_count() override;
     size_t get_outgoing_connections_count();
 
+    // Sets the connection count and write queue gauges of the metrics registry
+    void updateMetrics();
+
     PeerlistManager& getPeerlistManager() { return m_peerlist; }
 
   private:
@@ -194,6 +222,7 @@ namespace CryptoNote
     void acceptLoop();
     void connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& connection);
     void writeHandler(P2pConnectionContext& ctx);
+    void waitForBandwidth(BandwidthLimiter& peerLimiter, BandwidthLimiter& limiter, size_t size, System::Timer& timer);
     void onIdle();
     void timedSyncLoop();
     void timeoutLoop();
@@ -223,6 +252,10 @@ namespace CryptoNote
     bool m_allow_local_ip;
     bool m_hide_my_port;
     std::string m_p2p_state_filename;
+    BandwidthLimiter m_upload_limiter;
+    BandwidthLimiter m_download_limiter;
+    uint64_t m_peer_upload_limit;
+    uint64_t m_peer_download_limit;
 
     System::Dispatcher& m_dispatcher;
     System::ContextGroup m_workingContextGroup;
@@ -57,6 +57,10 @@ NetNodeConfig::NetNodeConfig() {
   hideMyPort = false;
   configFolder = Tools::getDefaultDataDirectory();
   testnet = false;
+  uploadLimit = 0;
+  downloadLimit = 0;
+  peerUploadLimit = 0;
+  peerDownloadLimit = 0;
 }
 
 bool NetNodeConfig::init(const std::string interface, const int port, const int external, const bool localIp,
@@ -163,6 +167,22 @@ std::string NetNodeConfig::getConfigFolder() const {
   return configFolder;
 }
 
+uint64_t NetNodeConfig::getUploadLimit() const {
+  return uploadLimit;
+}
+
+uint64_t NetNodeConfig::getDownloadLimit() const {
+  return downloadLimit;
+}
+
+uint64_t NetNodeConfig::getPeerUploadLimit() const {
+  return peerUploadLimit;
+}
+
+uint64_t NetNodeConfig::getPeerDownloadLimit() const {
+  return peerDownloadLimit;
+}
+
 void NetNodeConfig::setP2pStateFilename(const std::string& filename) {
   p2pStateFilename = filename;
 }
@@ -207,5 +227,21 @@ void NetNodeConfig::setConfigFolder(const std::string& folder) {
   configFolder = folder;
 }
 
+void NetNodeConfig::setUploadLimit(uint64_t limit) {
+  uploadLimit = limit;
+}
+
+void NetNodeConfig::setDownloadLimit(uint64_t limit) {
+  downloadLimit = limit;
+}
+
+void NetNodeConfig::setPeerUploadLimit(uint64_t limit) {
+  peerUploadLimit = limit;
+}
+
+void NetNodeConfig::setPeerDownloadLimit(uint64_t limit) {
+  peerDownloadLimit = limit;
+}
+
 
 } //namespace nodetool
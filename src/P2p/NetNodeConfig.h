@@ -33,6 +33,11 @@ public:
   std::vector<NetworkAddress> getSeedNodes() const;
   bool getHideMyPort() const;
   std::string getConfigFolder() const;
+  // Bandwidth limits in bytes per second, 0 for none
+  uint64_t getUploadLimit() const;
+  uint64_t getDownloadLimit() const;
+  uint64_t getPeerUploadLimit() const;
+  uint64_t getPeerDownloadLimit() const;
 
   void setP2pStateFilename(const std::string& filename);
   void setTestnet(bool isTestnet);
@@ -46,6 +51,10 @@ public:
   void setSeedNodes(const std::vector<NetworkAddress>& addresses);
   void setHideMyPort(bool hide);
   void setConfigFolder(const std::string& folder);
+  void setUploadLimit(uint64_t limit);
+  void setDownloadLimit(uint64_t limit);
+  void setPeerUploadLimit(uint64_t limit);
+  void setPeerDownloadLimit(uint64_t limit);
 
 private:
   std::string bindIp;
@@ -60,6 +69,10 @@ private:
   std::string configFolder;
   std::string p2pStateFilename;
   bool testnet;
+  uint64_t uploadLimit;
+  uint64_t downloadLimit;
+  uint64_t peerUploadLimit;
+  uint64_t peerDownloadLimit;
 };
 
 } //namespace nodetool
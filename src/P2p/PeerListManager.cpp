@@ -21,8 +21,29 @@ void PeerlistManager::serialize(CryptoNote::ISerializer& s) {
     return;
   }
 
-  s(m_peers_white, "whitelist");
-  s(m_peers_gray, "graylist");
+  std::vector<PeerlistEntry> peersWhite;
+  std::vector<PeerlistEntry> peersGray;
+
+  if (s.type() == CryptoNote::ISerializer::OUTPUT) {
+    peersWhite = m_whitePeerlist.getAll();
+    peersGray = m_grayPeerlist.getAll();
+  }
+
+  s(peersWhite, "whitelist");
+  s(peersGray, "graylist");
+
+  if (s.type() == CryptoNote::ISerializer::INPUT) {
+    m_whitePeerlist.clear();
+    m_grayPeerlist.clear();
+
+    for (const auto& peer : peersWhite) {
+      m_whitePeerlist.add(peer);
+    }
+
+    for (const auto& peer : peersGray) {
+      m_grayPeerlist.add(peer);
+    }
+  }
 }
 
 void serialize(NetworkAddress& na, CryptoNote::ISerializer& s)
@@ -39,8 +60,8 @@ void serialize(PeerlistEntry& pe, CryptoNote::ISerializer& s)
 }
 
 PeerlistManager::PeerlistManager() : 
-  m_whitePeerlist(m_peers_white, CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT),
-  m_grayPeerlist(m_peers_gray, CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT) {}
+  m_whitePeerlist(CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT),
+  m_grayPeerlist(CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT) {}
 
 bool PeerlistManager::init(bool allow_local_ip)
 {
@@ -95,38 +116,18 @@ bool PeerlistManager::is_ip_allowed(uint32_t ip) const
 
 bool PeerlistManager::get_peerlist_head(std::list<PeerlistEntry>& bs_head, uint32_t depth)
 {
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(m_peers_white.begin(), m_peers_white.end(), [](const auto &lhs, const auto &rhs)
-    {
-        return lhs.last_seen > rhs.last_seen;
-    });
-
-    uint32_t i = 0;
-
-    for (const auto &peer : m_peers_white)
-    {
-        if (!peer.last_seen)
-        {
-            continue;
-        }
-
-        bs_head.push_back(peer);
-
-        if (i > depth)
-        {
-            break;
-        }
-
-        i++;
-    }
+    m_whitePeerlist.getNewest(bs_head, depth);
 
     return true;
 }
 
 bool PeerlistManager::get_peerlist_full(std::list<PeerlistEntry>& pl_gray, std::list<PeerlistEntry>& pl_white) const
 {
-    std::copy(m_peers_gray.begin(), m_peers_gray.end(), std::back_inserter(pl_gray));
-    std::copy(m_peers_white.begin(), m_peers_white.end(), std::back_inserter(pl_white));
+    const auto grayPeers = m_grayPeerlist.getAll();
+    const auto whitePeers = m_whitePeerlist.getAll();
+
+    std::copy(grayPeers.begin(), grayPeers.end(), std::back_inserter(pl_gray));
+    std::copy(whitePeers.begin(), whitePeers.end(), std::back_inserter(pl_white));
 
     return true;
 }
@@ -163,37 +164,18 @@ bool PeerlistManager::append_with_peer_white(const PeerlistEntry& newPeer)
             return true;
         }
 
-        /* See if the peer already exists */
-        auto whiteListIterator = std::find_if(m_peers_white.begin(), m_peers_white.end(), [&newPeer](const auto peer)
-        {
-            return peer.adr == newPeer.adr;
-        });
+        /* Add the peer, or update it if it already exists */
+        const bool isNew = !m_whitePeerlist.contains(newPeer.adr);
+
+        m_whitePeerlist.add(newPeer);
 
-        /* Peer doesn't exist */
-        if (whiteListIterator == m_peers_white.end())
+        if (isNew)
         {
-            //put new record into white list
-            m_peers_white.push_back(newPeer);
             trim_white_peerlist();
         }
-        /* It does, update it */
-        else
-        {
-            //update record in white list 
-            *whiteListIterator = newPeer;
-        }
 
         //remove from gray list, if need
-        auto grayListIterator = std::find_if(m_peers_gray.begin(), m_peers_gray.end(), [&newPeer](const auto peer)
-        {
-            return peer.adr == newPeer.adr;
-        });
-
-
-        if (grayListIterator != m_peers_gray.end())
-        {
-            m_peers_gray.erase(grayListIterator);
-        }
+        m_grayPeerlist.remove(newPeer.adr);
 
         return true;
     }
@@ -215,33 +197,20 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry& newPeer)
         }
 
         //find in white list
-        auto whiteListIterator = std::find_if(m_peers_white.begin(), m_peers_white.end(), [&newPeer](const auto peer)
-        {
-            return peer.adr == newPeer.adr;
-        });
-
-        if (whiteListIterator != m_peers_white.end())
+        if (m_whitePeerlist.contains(newPeer.adr))
         {
             return true;
         }
 
         //update gray list
-        auto grayListIterator = std::find_if(m_peers_gray.begin(), m_peers_gray.end(), [&newPeer](const auto peer)
-        {
-            return peer.adr == newPeer.adr;
-        });
+        const bool isNew = !m_grayPeerlist.contains(newPeer.adr);
+
+        m_grayPeerlist.add(newPeer);
 
-        if (grayListIterator == m_peers_gray.end())
+        if (isNew)
         {
-            //put new record into white list
-            m_peers_gray.push_back(newPeer);
             trim_gray_peerlist();
         }
-        else
-        {
-            //update record in white list 
-            *grayListIterator = newPeer;
-        }
 
         return true;
     }
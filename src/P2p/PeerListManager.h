@@ -19,8 +19,8 @@ class PeerlistManager
         PeerlistManager();
 
         bool init(bool allow_local_ip);
-        size_t get_white_peers_count() const { return m_peers_white.size(); }
-        size_t get_gray_peers_count() const { return m_peers_gray.size(); }
+        size_t get_white_peers_count() const { return m_whitePeerlist.count(); }
+        size_t get_gray_peers_count() const { return m_grayPeerlist.count(); }
         bool merge_peerlist(const std::list<PeerlistEntry>& outer_bs);
         bool get_peerlist_head(std::list<PeerlistEntry>& bs_head, uint32_t depth = CryptoNote::P2P_DEFAULT_PEERS_IN_HANDSHAKE);
         bool get_peerlist_full(std::list<PeerlistEntry>& pl_gray, std::list<PeerlistEntry>& pl_white) const;
@@ -43,8 +43,6 @@ class PeerlistManager
     private:
         std::string m_config_folder;
         bool m_allow_local_ip;
-        std::vector<PeerlistEntry> m_peers_gray;
-        std::vector<PeerlistEntry> m_peers_white;
         Peerlist m_whitePeerlist;
         Peerlist m_grayPeerlist;
 };
@@ -4,11 +4,14 @@
 
 #include <P2p/Peerlist.h>
 
-#include <algorithm>
+Peerlist::Peerlist(size_t maxSize) :
+    m_maxSize(maxSize)
+{
+}
 
-Peerlist::Peerlist(std::vector<PeerlistEntry> &peers, size_t maxSize) :
-    m_peers(peers), m_maxSize(maxSize)
+size_t Peerlist::AddressHasher::operator()(const NetworkAddress &address) const
 {
+    return std::hash<uint64_t>{}((static_cast<uint64_t>(address.ip) << 32) | address.port);
 }
 
 size_t Peerlist::count() const
@@ -23,15 +26,58 @@ bool Peerlist::get(PeerlistEntry &entry, size_t i) const
         return false;
     }
 
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(m_peers.begin(), m_peers.end(), [](const auto &lhs, const auto &rhs)
+    entry = *m_peers.get<LastSeenTag>().nth(i);
+
+    return true;
+}
+
+void Peerlist::getNewest(std::list<PeerlistEntry> &peers, size_t count) const
+{
+    const auto &byLastSeen = m_peers.get<LastSeenTag>();
+
+    /* Peers which were never seen sort last, so stop at the first one */
+    for (auto it = byLastSeen.begin(); it != byLastSeen.end() && count > 0 && it->last_seen != 0; ++it, --count)
     {
-        return lhs.last_seen > rhs.last_seen;
-    });
+        peers.push_back(*it);
+    }
+}
 
-    entry = m_peers[i];
+std::vector<PeerlistEntry> Peerlist::getAll() const
+{
+    const auto &byLastSeen = m_peers.get<LastSeenTag>();
 
-    return true;
+    return std::vector<PeerlistEntry>(byLastSeen.begin(), byLastSeen.end());
+}
+
+bool Peerlist::contains(const NetworkAddress &address) const
+{
+    return m_peers.get<AddressTag>().count(address) != 0;
+}
+
+void Peerlist::add(const PeerlistEntry &entry)
+{
+    auto &byAddress = m_peers.get<AddressTag>();
+
+    auto it = byAddress.find(entry.adr);
+
+    if (it == byAddress.end())
+    {
+        byAddress.insert(entry);
+    }
+    else
+    {
+        byAddress.replace(it, entry);
+    }
+}
+
+bool Peerlist::remove(const NetworkAddress &address)
+{
+    return m_peers.get<AddressTag>().erase(address) != 0;
+}
+
+void Peerlist::clear()
+{
+    m_peers.clear();
 }
 
 /* Remove the oldest peers */
@@ -42,12 +88,8 @@ void Peerlist::trim()
         return;
     }
 
-    /* Sort the peers by last seen [Newer peers come first] */
-    std::sort(m_peers.begin(), m_peers.end(), [](const auto &lhs, const auto &rhs)
-    {
-        return lhs.last_seen > rhs.last_seen;
-    });
+    auto &byLastSeen = m_peers.get<LastSeenTag>();
 
     /* Trim to max size */
-    m_peers.erase(m_peers.begin() + m_maxSize, m_peers.end());
+    byLastSeen.erase(byLastSeen.nth(m_maxSize), byLastSeen.end());
 }
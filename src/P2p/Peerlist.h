@@ -6,12 +6,22 @@
 
 #include <P2p/P2pProtocolTypes.h>
 
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ranked_index.hpp>
+
+#include <functional>
+#include <list>
 #include <vector>
 
+/* Peers keyed by address, with an index ordered by last seen time [Newer
+   peers come first]. Lookups, updates and fetching the n'th newest peer are
+   all O(log n), so nothing has to be sorted when a peer list is requested */
 class Peerlist
 {
     public:
-        Peerlist(std::vector<PeerlistEntry> &peers, size_t maxSize);
+        Peerlist(size_t maxSize);
 
         /* Gets the size of the peer list */
         size_t count() const;
@@ -19,11 +29,51 @@ class Peerlist
         /* Gets a peer list entry, indexed by time */
         bool get(PeerlistEntry &entry, size_t index) const;
 
+        /* Gets up to count of the newest peers, skipping ones never seen */
+        void getNewest(std::list<PeerlistEntry> &peers, size_t count) const;
+
+        /* Gets every peer, newest first */
+        std::vector<PeerlistEntry> getAll() const;
+
+        bool contains(const NetworkAddress &address) const;
+
+        /* Adds the peer, or replaces the one with the same address */
+        void add(const PeerlistEntry &entry);
+
+        /* Returns false if there is no peer with this address */
+        bool remove(const NetworkAddress &address);
+
+        void clear();
+
         /* Trim the peer list, removing the oldest ones */
         void trim();
 
     private:
-        std::vector<PeerlistEntry>& m_peers;
+        struct AddressHasher
+        {
+            size_t operator()(const NetworkAddress &address) const;
+        };
+
+        struct AddressTag {};
+        struct LastSeenTag {};
+
+        typedef boost::multi_index_container<
+            PeerlistEntry,
+            boost::multi_index::indexed_by<
+                boost::multi_index::hashed_unique<
+                    boost::multi_index::tag<AddressTag>,
+                    boost::multi_index::member<PeerlistEntry, NetworkAddress, &PeerlistEntry::adr>,
+                    AddressHasher
+                >,
+                boost::multi_index::ranked_non_unique<
+                    boost::multi_index::tag<LastSeenTag>,
+                    boost::multi_index::member<PeerlistEntry, uint64_t, &PeerlistEntry::last_seen>,
+                    std::greater<uint64_t>
+                >
+            >
+        > PeersContainer;
+
+        PeersContainer m_peers;
 
         const size_t m_maxSize;
 };
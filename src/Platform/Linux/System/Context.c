@@ -0,0 +1,99 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <stdint.h>
+#include <string.h>
+#include "Context.h"
+
+#if defined(__x86_64__)
+
+void contextTrampoline(void);
+
+int
+makeContext(Context* context, void* stack, size_t stackSize, void (*entry)(void*), void* arg)
+{
+  uintptr_t* sp;
+
+  /* the frame switchContext restores: the x87 control word and mxcsr,
+     r15-r12, rbx, rbp, and a return address into the trampoline just below
+     the aligned top, so entry is called with an aligned stack */
+  sp = (uintptr_t*)(((uintptr_t)stack + stackSize) & ~(uintptr_t)15);
+  sp -= 8;
+  memset(sp, 0, 8 * sizeof(uintptr_t));
+  sp[0] = 0x037F00001F80;              /* default x87 control word and mxcsr */
+  sp[3] = (uintptr_t)arg;              /* r13 */
+  sp[4] = (uintptr_t)entry;            /* r12 */
+  sp[7] = (uintptr_t)contextTrampoline;
+  context->stackPointer = sp;
+  return 0;
+}
+
+#elif defined(__aarch64__)
+
+void contextTrampoline(void);
+
+int
+makeContext(Context* context, void* stack, size_t stackSize, void (*entry)(void*), void* arg)
+{
+  uintptr_t* sp;
+
+  /* the frame switchContext restores: x19-x30, then d8-d15 */
+  sp = (uintptr_t*)(((uintptr_t)stack + stackSize) & ~(uintptr_t)15);
+  sp -= 20;
+  memset(sp, 0, 20 * sizeof(uintptr_t));
+  sp[0] = (uintptr_t)entry;            /* x19 */
+  sp[1] = (uintptr_t)arg;              /* x20 */
+  sp[11] = (uintptr_t)contextTrampoline; /* x30 */
+  context->stackPointer = sp;
+  return 0;
+}
+
+#else
+
+static void
+contextTrampoline(unsigned int high, unsigned int low)
+{
+  Context* context = (Context*)(((uintptr_t)high << 16 << 16) | low);
+  context->entry(context->arg);
+}
+
+int
+makeContext(Context* context, void* stack, size_t stackSize, void (*entry)(void*), void* arg)
+{
+  uintptr_t pointer = (uintptr_t)context;
+
+  if (getcontext(&context->ucontext) == -1) {
+    return -1;
+  }
+
+  context->ucontext.uc_stack.ss_sp = stack;
+  context->ucontext.uc_stack.ss_size = stackSize;
+  context->ucontext.uc_link = NULL;
+  context->entry = entry;
+  context->arg = arg;
+  makecontext(&context->ucontext, (void(*)(void))contextTrampoline, 2, (unsigned int)(pointer >> 16 >> 16), (unsigned int)pointer);
+  return 0;
+}
+
+int
+switchContext(Context* from, Context* to)
+{
+  return swapcontext(&from->ucontext, &to->ucontext);
+}
+
+#endif
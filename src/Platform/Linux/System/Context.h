@@ -0,0 +1,62 @@
+// Copyright (c) 2012-2017, The CryptoNote developers, The Bytecoin developers
+//
+// This file is part of Bytecoin.
+//
+// Bytecoin is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Bytecoin is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <stddef.h>
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#include <ucontext.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A suspended user-space context. On x86-64 and aarch64 a switch only saves
+ * the callee-saved registers on the stack of the suspended context, so unlike
+ * swapcontext it never enters the kernel to save the signal mask. Other
+ * architectures fall back to ucontext.
+ */
+typedef struct {
+#if defined(__x86_64__) || defined(__aarch64__)
+  void* stackPointer;
+#else
+  ucontext_t ucontext;
+  void (*entry)(void*);
+  void* arg;
+#endif
+} Context;
+
+/*
+ * Prepares a context which calls entry(arg) on the given stack when it is
+ * first switched to. entry must never return. Returns -1 and sets errno on
+ * failure.
+ */
+int makeContext(Context* context, void* stack, size_t stackSize, void (*entry)(void*), void* arg);
+
+/*
+ * Suspends the running context into from and resumes to. Returns 0 when from
+ * is resumed, or -1 and sets errno if to could not be resumed.
+ */
+int switchContext(Context* from, Context* to);
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,15 +16,19 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Dispatcher.h"
+#include <algorithm>
 #include <cassert>
+#include <limits>
 
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/timerfd.h>
 #include <fcntl.h>
 #include <string.h>
-#include <ucontext.h>
+#include <time.h>
 #include <unistd.h>
+#include "Context.h"
 #include "ErrorMessage.h"
 
 namespace System {
@@ -33,7 +37,7 @@ namespace {
 
 struct ContextMakingData {
   Dispatcher* dispatcher;
-  void* ucontext;
+  void* machineContext;
 };
 
 class MutextGuard {
@@ -55,58 +59,118 @@ private:
 
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
-const size_t STACK_SIZE = 64 * 1024;
+size_t pageSize() {
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// The lowest page of the mapping is a guard page, so a context overflowing its stack faults
+// instead of silently writing over whatever lies below it.
+void* allocateStack(size_t stackSize) {
+  void* mapping = mmap(nullptr, pageSize() + stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Dispatcher::getReusableContext, mmap failed, " + lastErrorMessage());
+  }
+
+  if (mprotect(mapping, pageSize(), PROT_NONE) == -1) {
+    std::string message = "Dispatcher::getReusableContext, mprotect failed, " + lastErrorMessage();
+    munmap(mapping, pageSize() + stackSize);
+    throw std::runtime_error(message);
+  }
+
+  return mapping;
+}
+
+void freeStack(void* mapping, size_t stackSize) {
+  auto result = munmap(mapping, pageSize() + stackSize);
+  if (result) {}
+  assert(result == 0);
+}
+
+const uint64_t NO_TIMER_TICK = std::numeric_limits<uint64_t>::max();
+const size_t NO_TIMER_SLOT = std::numeric_limits<size_t>::max();
+const uint64_t NANOSECONDS_PER_TIMER_TICK = 1000000;
+const uint64_t TIMER_TICKS_PER_SECOND = 1000000000 / NANOSECONDS_PER_TIMER_TICK;
+
+uint64_t monotonicNanoseconds() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + static_cast<uint64_t>(now.tv_nsec);
+}
 
 };
 
-Dispatcher::Dispatcher() {
+Dispatcher::Dispatcher(size_t stackSize) : stackSize((stackSize + pageSize() - 1) / pageSize() * pageSize()) {
   std::string message;
   epoll = ::epoll_create1(0);
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
+    mainContext.machineContext = new Context;
+    remoteSpawnEvent = eventfd(0, O_NONBLOCK);
+    if(remoteSpawnEvent == -1) {
+      message = "eventfd failed, " + lastErrorMessage();
     } else {
-      remoteSpawnEvent = eventfd(0, O_NONBLOCK);
-      if(remoteSpawnEvent == -1) {
-        message = "eventfd failed, " + lastErrorMessage();
-      } else {
-        remoteSpawnEventContext.writeContext = nullptr;
-        remoteSpawnEventContext.readContext = nullptr;
+      remoteSpawnEventContext.writeContext = nullptr;
+      remoteSpawnEventContext.readContext = nullptr;
 
-        epoll_event remoteSpawnEventEpollEvent;
-        remoteSpawnEventEpollEvent.events = EPOLLIN;
-        remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
+      epoll_event remoteSpawnEventEpollEvent;
+      remoteSpawnEventEpollEvent.events = EPOLLIN;
+      remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
 
-        if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
-          message = "epoll_ctl failed, " + lastErrorMessage();
+      if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
+        message = "epoll_ctl failed, " + lastErrorMessage();
+      } else {
+        timerEvent = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (timerEvent == -1) {
+          message = "timerfd_create failed, " + lastErrorMessage();
         } else {
-          *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
-
-          mainContext.interrupted = false;
-          mainContext.group = &contextGroup;
-          mainContext.groupPrev = nullptr;
-          mainContext.groupNext = nullptr;
-          mainContext.inExecutionQueue = false;
-          contextGroup.firstContext = nullptr;
-          contextGroup.lastContext = nullptr;
-          contextGroup.firstWaiter = nullptr;
-          contextGroup.lastWaiter = nullptr;
-          currentContext = &mainContext;
-          firstResumingContext = nullptr;
-          firstReusableContext = nullptr;
-          runningContextCount = 0;
-          return;
-        }
+          timerEventContext.writeContext = nullptr;
+          timerEventContext.readContext = nullptr;
+
+          epoll_event timerEpollEvent;
+          timerEpollEvent.events = EPOLLIN;
+          timerEpollEvent.data.ptr = &timerEventContext;
+
+          if (epoll_ctl(epoll, EPOLL_CTL_ADD, timerEvent, &timerEpollEvent) == -1) {
+            message = "epoll_ctl failed, " + lastErrorMessage();
+          } else {
+            *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
+
+            mainContext.interrupted = false;
+            mainContext.group = &contextGroup;
+            mainContext.groupPrev = nullptr;
+            mainContext.groupNext = nullptr;
+            mainContext.inExecutionQueue = false;
+            contextGroup.firstContext = nullptr;
+            contextGroup.lastContext = nullptr;
+            contextGroup.firstWaiter = nullptr;
+            contextGroup.lastWaiter = nullptr;
+            currentContext = &mainContext;
+            firstResumingContext = nullptr;
+            firstReusableContext = nullptr;
+            runningContextCount = 0;
+
+            std::fill(std::begin(timerSlots), std::end(timerSlots), nullptr);
+            std::fill(std::begin(timerSlotBits), std::end(timerSlotBits), 0);
+            timerTick = monotonicNanoseconds() / NANOSECONDS_PER_TIMER_TICK;
+            timerArmedTick = NO_TIMER_TICK;
+            timerCount = 0;
+            return;
+          }
 
-        auto result = close(remoteSpawnEvent);
-        if (result) {}
-        assert(result == 0);
+          auto result = close(timerEvent);
+          if (result) {}
+          assert(result == 0);
+        }
       }
+
+      auto result = close(remoteSpawnEvent);
+      if (result) {}
+      assert(result == 0);
     }
 
+    delete static_cast<Context*>(mainContext.machineContext);
     auto result = close(epoll);
     if (result) {}
     assert(result == 0);
@@ -126,45 +190,34 @@ Dispatcher::~Dispatcher() {
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto machineContext = static_cast<Context*>(firstReusableContext->machineContext);
+    auto stackPtr = firstReusableContext->stackPtr;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stackPtr, stackSize);
+    delete machineContext;
   }
 
-  while (!timers.empty()) {
-    int result = ::close(timers.top());
-    if (result) {}
-    assert(result == 0);
-    timers.pop();
-  }
+  assert(timerCount == 0);
 
   auto result = close(epoll);
   if (result) {}
   assert(result == 0);
   result = close(remoteSpawnEvent);
   assert(result == 0);
+  result = close(timerEvent);
+  assert(result == 0);
   result = pthread_mutex_destroy(reinterpret_cast<pthread_mutex_t*>(this->mutex));
   assert(result == 0);
+  delete static_cast<Context*>(mainContext.machineContext);
 }
 
 void Dispatcher::clear() {
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto machineContext = static_cast<Context*>(firstReusableContext->machineContext);
+    auto stackPtr = firstReusableContext->stackPtr;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
-
-  while (!timers.empty()) {
-    int result = ::close(timers.top());
-    if (result == -1) {
-      throw std::runtime_error("Dispatcher::clear, close failed, "  + lastErrorMessage());
-    }
-
-    timers.pop();
+    freeStack(stackPtr, stackSize);
+    delete machineContext;
   }
 }
 
@@ -185,6 +238,11 @@ void Dispatcher::dispatch() {
     int count = epoll_wait(epoll, &event, 1, -1);
     if (count == 1) {
       ContextPair *contextPair = static_cast<ContextPair*>(event.data.ptr);
+      if (contextPair == &timerEventContext) {
+        processTimerEvent();
+        continue;
+      }
+
       if(((event.events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
         uint64_t buf;
         auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
@@ -221,10 +279,10 @@ void Dispatcher::dispatch() {
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    Context* oldContext = static_cast<Context*>(currentContext->machineContext);
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
+    if (switchContext(oldContext, static_cast<Context*>(context->machineContext)) == -1) {
+      throw std::runtime_error("Dispatcher::dispatch, switchContext failed, " + lastErrorMessage());
     }
   }
 }
@@ -320,6 +378,11 @@ void Dispatcher::yield() {
     if(count > 0) {
       for(int i = 0; i < count; ++i) {
         ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
+        if (contextPair == &timerEventContext) {
+          processTimerEvent();
+          continue;
+        }
+
         if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
           uint64_t buf;
           auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
@@ -375,25 +438,23 @@ int Dispatcher::getEpoll() const {
 
 NativeContext& Dispatcher::getReusableContext() {
   if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
-    }
-
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
-
+    auto stackPointer = allocateStack(stackSize);
+    Context* newlyCreatedContext = new Context;
     ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
+    if (makeContext(newlyCreatedContext, static_cast<uint8_t*>(stackPointer) + pageSize(), stackSize, contextProcedureStatic, &makingContextData) == -1) {
+      std::string message = "Dispatcher::getReusableContext, makeContext failed, " + lastErrorMessage();
+      delete newlyCreatedContext;
+      freeStack(stackPointer, stackSize);
+      throw std::runtime_error(message);
+    }
 
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
+    Context* oldContext = static_cast<Context*>(currentContext->machineContext);
+    if (switchContext(oldContext, newlyCreatedContext) == -1) {
+      throw std::runtime_error("Dispatcher::getReusableContext, switchContext failed, " + lastErrorMessage());
     }
 
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
+    assert(firstReusableContext->machineContext == newlyCreatedContext);
     firstReusableContext->stackPtr = stackPointer;
   };
 
@@ -408,40 +469,38 @@ void Dispatcher::pushReusableContext(NativeContext& context) {
   --runningContextCount;
 }
 
-int Dispatcher::getTimer() {
-  int timer;
-  if (timers.empty()) {
-    timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
-    epoll_event timerEvent;
-    timerEvent.events = EPOLLONESHOT;
-    timerEvent.data.ptr = nullptr;
+void Dispatcher::addTimer(NativeTimer& timer, std::chrono::nanoseconds duration) {
+  assert(duration.count() > 0);
+  advanceTimers();
+  timer.expires = (monotonicNanoseconds() + static_cast<uint64_t>(duration.count()) + NANOSECONDS_PER_TIMER_TICK - 1) / NANOSECONDS_PER_TIMER_TICK;
+  insertTimer(timer);
+  ++timerCount;
+  armTimerEvent();
+}
 
-    if (epoll_ctl(getEpoll(), EPOLL_CTL_ADD, timer, &timerEvent) == -1) {
-      throw std::runtime_error("Dispatcher::getTimer, epoll_ctl failed, "  + lastErrorMessage());
-    }
-  } else {
-    timer = timers.top();
-    timers.pop();
+// The timerfd stays armed, a cancelled timer at most costs a wakeup which finds nothing to do.
+// A timer which has already fired is left alone, its context may have been queued by another event first.
+void Dispatcher::cancelTimer(NativeTimer& timer) {
+  if (timer.slot == NO_TIMER_SLOT) {
+    return;
   }
 
-  return timer;
+  assert(timerCount > 0);
+  removeTimer(timer);
+  --timerCount;
 }
 
-void Dispatcher::pushTimer(int timer) {
-  timers.push(timer);
-}
-
-void Dispatcher::contextProcedure(void* ucontext) {
+void Dispatcher::contextProcedure(void* machineContext) {
   assert(firstReusableContext == nullptr);
   NativeContext context;
-  context.ucontext = ucontext;
+  context.machineContext = machineContext;
   context.interrupted = false;
   context.next = nullptr;
   context.inExecutionQueue = false;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
+  Context* oldContext = static_cast<Context*>(context.machineContext);
+  if (switchContext(oldContext, static_cast<Context*>(currentContext->machineContext)) == -1) {
+    throw std::runtime_error("Dispatcher::contextProcedure, switchContext failed, " + lastErrorMessage());
   }
 
   for (;;) {
@@ -493,7 +552,173 @@ void Dispatcher::contextProcedure(void* ucontext) {
 
 void Dispatcher::contextProcedureStatic(void *context) {
   ContextMakingData* makingContextData = reinterpret_cast<ContextMakingData*>(context);
-  makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+  makingContextData->dispatcher->contextProcedure(makingContextData->machineContext);
+}
+
+void Dispatcher::insertTimer(NativeTimer& timer) {
+  uint64_t expires = std::max(timer.expires, timerTick);
+  const uint64_t delta = expires - timerTick;
+  unsigned level = 0;
+  while (level + 1 < TIMER_WHEEL_LEVELS && (delta >> (TIMER_WHEEL_BITS * (level + 1))) != 0) {
+    ++level;
+  }
+
+  if ((delta >> (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) != 0) {
+    // Beyond the last level, wait in its furthest slot and get placed again when that is cascaded
+    expires = timerTick + (uint64_t(1) << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+  }
+
+  timer.slot = level * TIMER_WHEEL_SLOTS + ((expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+  timer.prev = nullptr;
+  timer.next = timerSlots[timer.slot];
+  if (timer.next != nullptr) {
+    timer.next->prev = &timer;
+  }
+
+  timerSlots[timer.slot] = &timer;
+  timerSlotBits[timer.slot / 64] |= uint64_t(1) << (timer.slot % 64);
+}
+
+void Dispatcher::removeTimer(NativeTimer& timer) {
+  if (timer.prev != nullptr) {
+    timer.prev->next = timer.next;
+  } else {
+    assert(timerSlots[timer.slot] == &timer);
+    timerSlots[timer.slot] = timer.next;
+  }
+
+  if (timer.next != nullptr) {
+    timer.next->prev = timer.prev;
+  }
+
+  if (timerSlots[timer.slot] == nullptr) {
+    timerSlotBits[timer.slot / 64] &= ~(uint64_t(1) << (timer.slot % 64));
+  }
+}
+
+// Resumes the contexts of all timers due by now, jumping over the ticks with nothing to do
+void Dispatcher::advanceTimers() {
+  const uint64_t now = monotonicNanoseconds() / NANOSECONDS_PER_TIMER_TICK;
+  while (timerTick <= now) {
+    if ((timerTick & (TIMER_WHEEL_SLOTS - 1)) == 0) {
+      cascadeTimers();
+    }
+
+    const size_t slot = timerTick & (TIMER_WHEEL_SLOTS - 1);
+    NativeTimer* timer = timerSlots[slot];
+    timerSlots[slot] = nullptr;
+    timerSlotBits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    while (timer != nullptr) {
+      NativeTimer* next = timer->next;
+      --timerCount;
+      timer->slot = NO_TIMER_SLOT;
+      timer->context->interruptProcedure = nullptr;
+      pushContext(timer->context);
+      timer = next;
+    }
+
+    ++timerTick;
+    timerTick = std::min(nextTimerTick(), now + 1);
+  }
+
+  if (timerArmedTick < timerTick) {
+    timerArmedTick = NO_TIMER_TICK;
+  }
+}
+
+// Called at the start of every level 0 rotation, moves the timers of the slots of the higher levels
+// which begin at timerTick down the wheel
+void Dispatcher::cascadeTimers() {
+  for (unsigned level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+    const size_t index = (timerTick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+    const size_t slot = level * TIMER_WHEEL_SLOTS + index;
+    NativeTimer* timer = timerSlots[slot];
+    timerSlots[slot] = nullptr;
+    timerSlotBits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    while (timer != nullptr) {
+      NativeTimer* next = timer->next;
+      insertTimer(*timer);
+      timer = next;
+    }
+
+    if (index != 0) {
+      break;
+    }
+  }
+}
+
+// The first tick at or after timerTick at which a timer expires or a slot has to be cascaded
+uint64_t Dispatcher::nextTimerTick() const {
+  if (timerCount == 0) {
+    return NO_TIMER_TICK;
+  }
+
+  uint64_t next = NO_TIMER_TICK;
+  for (unsigned level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+    const unsigned shift = TIMER_WHEEL_BITS * level;
+    const uint64_t position = timerTick >> shift;
+    const size_t index = position & (TIMER_WHEEL_SLOTS - 1);
+
+    // A slot is due at the start of its span, which for the current one is only still ahead when timerTick is right there
+    const size_t first = (timerTick & ((uint64_t(1) << shift) - 1)) == 0 ? index : index + 1;
+    size_t found = findTimerSlot(level, first, TIMER_WHEEL_SLOTS);
+    if (found == TIMER_WHEEL_SLOTS) {
+      found = findTimerSlot(level, 0, first);
+      if (found == TIMER_WHEEL_SLOTS) {
+        continue;
+      }
+
+      found += TIMER_WHEEL_SLOTS;
+    }
+
+    next = std::min(next, (position + found - index) << shift);
+  }
+
+  return next;
+}
+
+size_t Dispatcher::findTimerSlot(unsigned level, size_t first, size_t last) const {
+  for (size_t index = first; index < last;) {
+    const size_t bit = level * TIMER_WHEEL_SLOTS + index;
+    const uint64_t word = timerSlotBits[bit / 64] >> (bit % 64);
+    if (word != 0) {
+      const size_t found = index + static_cast<size_t>(__builtin_ctzll(word));
+      return found < last ? found : TIMER_WHEEL_SLOTS;
+    }
+
+    index += 64 - bit % 64;
+  }
+
+  return TIMER_WHEEL_SLOTS;
+}
+
+// Only ever moves the timerfd earlier, a later or no timer at all is dealt with when it fires
+void Dispatcher::armTimerEvent() {
+  const uint64_t next = nextTimerTick();
+  if (next >= timerArmedTick) {
+    return;
+  }
+
+  itimerspec expires;
+  expires.it_interval.tv_sec = expires.it_interval.tv_nsec = 0;
+  expires.it_value.tv_sec = static_cast<time_t>(next / TIMER_TICKS_PER_SECOND);
+  expires.it_value.tv_nsec = static_cast<long>((next % TIMER_TICKS_PER_SECOND) * NANOSECONDS_PER_TIMER_TICK);
+  if (timerfd_settime(timerEvent, TFD_TIMER_ABSTIME, &expires, nullptr) == -1) {
+    throw std::runtime_error("Dispatcher::armTimerEvent, timerfd_settime failed, " + lastErrorMessage());
+  }
+
+  timerArmedTick = next;
+}
+
+void Dispatcher::processTimerEvent() {
+  uint64_t expirations;
+  if (::read(timerEvent, &expirations, sizeof expirations) == -1 && errno != EAGAIN) {
+    throw std::runtime_error("Dispatcher::processTimerEvent, read failed, " + lastErrorMessage());
+  }
+
+  timerArmedTick = NO_TIMER_TICK;
+  advanceTimers();
+  armTimerEvent();
 }
 
 }
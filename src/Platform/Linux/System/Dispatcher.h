@@ -17,10 +17,11 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <queue>
-#include <stack>
 #ifndef __GLIBC__
 #include <bits/reg.h>
 #endif
@@ -30,7 +31,7 @@ namespace System {
 struct NativeContextGroup;
 
 struct NativeContext {
-  void* ucontext;
+  void* machineContext;
   void* stackPtr;
   bool interrupted;
   bool inExecutionQueue;
@@ -60,9 +61,21 @@ struct ContextPair {
   OperationContext *writeContext;
 };
 
+// A pending timer, linked into a slot of the dispatcher's timer wheel
+struct NativeTimer {
+  uint64_t expires;
+  size_t slot; // NO_TIMER_SLOT once the timer has fired and left the wheel
+  NativeTimer* prev;
+  NativeTimer* next;
+  NativeContext* context;
+};
+
 class Dispatcher {
 public:
-  Dispatcher();
+  static const size_t DEFAULT_STACK_SIZE = 64 * 1024;
+
+  // stackSize is the usable stack of each spawned context, rounded up to whole pages
+  explicit Dispatcher(size_t stackSize = DEFAULT_STACK_SIZE);
   Dispatcher(const Dispatcher&) = delete;
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
@@ -80,8 +93,11 @@ public:
   int getEpoll() const;
   NativeContext& getReusableContext();
   void pushReusableContext(NativeContext&);
-  int getTimer();
-  void pushTimer(int timer);
+
+  // The context of the timer is resumed once duration has passed, rounded up to whole milliseconds.
+  // Adding and cancelling are O(1) and don't touch the kernel unless the timer is due before all others.
+  void addTimer(NativeTimer& timer, std::chrono::nanoseconds duration);
+  void cancelTimer(NativeTimer& timer);
 
 #ifdef __x86_64__
     # if __WORDSIZE == 64
@@ -96,13 +112,27 @@ static const int SIZEOF_PTHREAD_MUTEX_T = 24;
 #endif
 
 private:
+  // Hashed hierarchical timer wheel with 1 ms ticks. Each level has 256 slots and spans 256 times the
+  // level below, so four levels cover about 49 days. Timers further out wait in the last level.
+  static const unsigned TIMER_WHEEL_LEVELS = 4;
+  static const unsigned TIMER_WHEEL_BITS = 8;
+  static const size_t TIMER_WHEEL_SLOTS = size_t(1) << TIMER_WHEEL_BITS;
+
   void spawn(std::function<void()>&& procedure);
   int epoll;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
   ContextPair remoteSpawnEventContext;
   std::queue<std::function<void()>> remoteSpawningProcedures;
-  std::stack<int> timers;
+
+  // a single timerfd, armed for the next tick with work to do
+  int timerEvent;
+  ContextPair timerEventContext;
+  NativeTimer* timerSlots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+  uint64_t timerSlotBits[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS / 64];
+  uint64_t timerTick; // the next tick to process
+  uint64_t timerArmedTick;
+  size_t timerCount;
 
   NativeContext mainContext;
   NativeContextGroup contextGroup;
@@ -111,9 +141,19 @@ private:
   NativeContext* lastResumingContext;
   NativeContext* firstReusableContext;
   size_t runningContextCount;
+  size_t stackSize;
 
-  void contextProcedure(void* ucontext);
+  void contextProcedure(void* machineContext);
   static void contextProcedureStatic(void* context);
+
+  void insertTimer(NativeTimer& timer);
+  void removeTimer(NativeTimer& timer);
+  void advanceTimers();
+  void cascadeTimers();
+  uint64_t nextTimerTick() const;
+  size_t findTimerSlot(unsigned level, size_t first, size_t last) const;
+  void armTimerEvent();
+  void processTimerEvent();
 };
 
 }
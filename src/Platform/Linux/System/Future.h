@@ -18,6 +18,8 @@
 #pragma once
 
 #include <future>
+#include <memory>
+#include <System/ThreadPool.h>
 
 namespace System {
 
@@ -25,8 +27,12 @@ namespace Detail {
 
 template<class T> using Future = std::future<T>;
 
+// Runs operation in the shared thread pool.
 template<class T> Future<T> async(std::function<T()>&& operation) {
-  return std::async(std::launch::async, std::move(operation));
+  auto task = std::make_shared<std::packaged_task<T()>>(std::move(operation));
+  auto future = task->get_future();
+  ThreadPool::shared().submit([task] { (*task)(); });
+  return future;
 }
 
 }
@@ -16,12 +16,26 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Ipv4Resolver.h"
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <mutex>
 #include <random>
+#include <sstream>
 #include <stdexcept>
+#include <unordered_map>
 
-#include <netdb.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <Common/LruCache.h>
 #include <System/Dispatcher.h>
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
@@ -29,13 +43,575 @@
 
 namespace System {
 
+namespace {
+
+const char RESOLV_CONF_PATH[] = "/etc/resolv.conf";
+const char HOSTS_PATH[] = "/etc/hosts";
+
+// Limits and defaults follow the ones of the libc resolver
+const uint16_t DNS_PORT = 53;
+const size_t MAX_NAMESERVERS = 3;
+const size_t MAX_SEARCH_DOMAINS = 6;
+const unsigned DEFAULT_NDOTS = 1;
+const unsigned MAX_NDOTS = 15;
+const unsigned DEFAULT_TIMEOUT_SECONDS = 5;
+const unsigned MAX_TIMEOUT_SECONDS = 30;
+const unsigned DEFAULT_ATTEMPTS = 2;
+const unsigned MAX_ATTEMPTS = 5;
+
+const size_t CACHE_CAPACITY = 256;
+const uint32_t MAX_CACHE_TTL = 3600;
+
+const size_t DNS_HEADER_SIZE = 12;
+const size_t MAX_DNS_NAME_SIZE = 255;
+const size_t MAX_DNS_LABEL_SIZE = 63;
+const size_t MAX_DNS_MESSAGE_SIZE = 512;
+const uint16_t DNS_TYPE_A = 1;
+const uint16_t DNS_CLASS_IN = 1;
+const uint8_t DNS_FLAG_RESPONSE = 0x80;
+const uint8_t DNS_FLAG_TRUNCATED = 0x02;
+const uint8_t DNS_FLAG_RECURSION_DESIRED = 0x01;
+const uint8_t DNS_RCODE_NXDOMAIN = 3;
+
+struct FileStamp {
+  bool exists;
+  dev_t device;
+  ino_t inode;
+  off_t size;
+  timespec modified;
+};
+
+bool operator==(const FileStamp& left, const FileStamp& right) {
+  if (!left.exists || !right.exists) {
+    return left.exists == right.exists;
+  }
+
+  return left.device == right.device && left.inode == right.inode && left.size == right.size &&
+    left.modified.tv_sec == right.modified.tv_sec && left.modified.tv_nsec == right.modified.tv_nsec;
+}
+
+FileStamp stampFile(const char* path) {
+  FileStamp stamp = {};
+  struct stat status;
+  if (stat(path, &status) == 0) {
+    stamp.exists = true;
+    stamp.device = status.st_dev;
+    stamp.inode = status.st_ino;
+    stamp.size = status.st_size;
+    stamp.modified = status.st_mtim;
+  }
+
+  return stamp;
+}
+
+std::string toLower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return text;
+}
+
+bool parseAddress(const std::string& text, uint32_t& address) {
+  in_addr value;
+  if (inet_pton(AF_INET, text.c_str(), &value) != 1) {
+    return false;
+  }
+
+  address = ntohl(value.s_addr);
+  return true;
+}
+
+unsigned parseOption(const std::string& text, unsigned defaultValue, unsigned maxValue) {
+  char* end;
+  unsigned long value = std::strtoul(text.c_str(), &end, 10);
+  if (text.empty() || *end != '\0') {
+    return defaultValue;
+  }
+
+  return static_cast<unsigned>(std::min<unsigned long>(value, maxValue));
+}
+
+// A nameserver address, either IPv4 or IPv6
+struct Nameserver {
+  sockaddr_storage address;
+  socklen_t size;
+};
+
+Nameserver makeNameserver(uint32_t address, uint16_t port) {
+  Nameserver nameserver = {};
+  sockaddr_in* ipv4 = reinterpret_cast<sockaddr_in*>(&nameserver.address);
+  ipv4->sin_family = AF_INET;
+  ipv4->sin_port = htons(port);
+  ipv4->sin_addr.s_addr = htonl(address);
+  nameserver.size = sizeof(sockaddr_in);
+  return nameserver;
+}
+
+// Takes IPv4 addresses and IPv6 ones, the latter with an optional %interface scope as resolv.conf allows
+bool parseNameserver(const std::string& text, Nameserver& nameserver) {
+  uint32_t address;
+  if (parseAddress(text, address)) {
+    nameserver = makeNameserver(address, DNS_PORT);
+    return true;
+  }
+
+  size_t scopeSeparator = text.find('%');
+  nameserver = {};
+  sockaddr_in6* ipv6 = reinterpret_cast<sockaddr_in6*>(&nameserver.address);
+  if (inet_pton(AF_INET6, text.substr(0, scopeSeparator).c_str(), &ipv6->sin6_addr) != 1) {
+    return false;
+  }
+
+  if (scopeSeparator != std::string::npos) {
+    std::string scope = text.substr(scopeSeparator + 1);
+    ipv6->sin6_scope_id = if_nametoindex(scope.c_str());
+    if (ipv6->sin6_scope_id == 0) {
+      ipv6->sin6_scope_id = parseOption(scope, 0, UINT32_MAX);
+    }
+  }
+
+  ipv6->sin6_family = AF_INET6;
+  ipv6->sin6_port = htons(DNS_PORT);
+  nameserver.size = sizeof(sockaddr_in6);
+  return true;
+}
+
+enum class QueryStatus {
+  ADDRESSES,
+  NO_ADDRESSES,
+  FAILURE,
+  MISMATCH
+};
+
+// Appends name in the label encoding of DNS messages, returns false if it can't be encoded
+bool encodeName(const std::string& name, std::vector<uint8_t>& message) {
+  if (name.size() + 2 > MAX_DNS_NAME_SIZE) {
+    return false;
+  }
+
+  size_t labelStart = 0;
+  for (;;) {
+    size_t labelEnd = name.find('.', labelStart);
+    if (labelEnd == std::string::npos) {
+      labelEnd = name.size();
+    }
+
+    size_t labelSize = labelEnd - labelStart;
+    if (labelSize == 0 || labelSize > MAX_DNS_LABEL_SIZE) {
+      return false;
+    }
+
+    message.push_back(static_cast<uint8_t>(labelSize));
+    message.insert(message.end(), name.begin() + labelStart, name.begin() + labelEnd);
+    if (labelEnd == name.size()) {
+      break;
+    }
+
+    labelStart = labelEnd + 1;
+  }
+
+  message.push_back(0);
+  return true;
+}
+
+// Moves offset past a possibly compressed name, returns false if the name runs off the message
+bool skipName(const uint8_t* message, size_t size, size_t& offset) {
+  for (;;) {
+    if (offset >= size) {
+      return false;
+    }
+
+    uint8_t labelSize = message[offset];
+    if ((labelSize & 0xc0) == 0xc0) {
+      offset += 2;
+      return offset <= size;
+    }
+
+    if (labelSize > MAX_DNS_LABEL_SIZE) {
+      return false;
+    }
+
+    offset += 1 + labelSize;
+    if (labelSize == 0) {
+      return true;
+    }
+  }
+}
+
+uint16_t readUint16(const uint8_t* data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+uint32_t readUint32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+}
+
+// Collects the A records of a response to query. Responses which don't belong to the query are reported as MISMATCH
+// and are to be ignored, a resolver could be answering an earlier query from the same port.
+QueryStatus parseResponse(const std::vector<uint8_t>& query, const uint8_t* response, size_t size, std::vector<uint32_t>& addresses, uint32_t& ttl) {
+  if (size < query.size() || response[0] != query[0] || response[1] != query[1] || (response[2] & DNS_FLAG_RESPONSE) == 0 ||
+    readUint16(response + 4) != 1) {
+    return QueryStatus::MISMATCH;
+  }
+
+  // The question is echoed back, resolvers are free to change the case of the name
+  for (size_t i = DNS_HEADER_SIZE; i < query.size(); ++i) {
+    if (std::tolower(response[i]) != std::tolower(query[i])) {
+      return QueryStatus::MISMATCH;
+    }
+  }
+
+  uint8_t responseCode = response[3] & 0x0f;
+  if (responseCode == DNS_RCODE_NXDOMAIN) {
+    return QueryStatus::NO_ADDRESSES;
+  }
+
+  if (responseCode != 0) {
+    return QueryStatus::FAILURE;
+  }
+
+  // Answers for an alias come with its CNAME records, the A records of the canonical name are taken as they are
+  addresses.clear();
+  ttl = MAX_CACHE_TTL;
+  size_t offset = query.size();
+  for (uint16_t answerCount = readUint16(response + 6); answerCount != 0; --answerCount) {
+    if (!skipName(response, size, offset) || size - offset < 10) {
+      break;
+    }
+
+    uint16_t type = readUint16(response + offset);
+    uint16_t recordClass = readUint16(response + offset + 2);
+    uint32_t recordTtl = readUint32(response + offset + 4);
+    uint16_t dataSize = readUint16(response + offset + 8);
+    offset += 10;
+    if (size - offset < dataSize) {
+      break;
+    }
+
+    if (type == DNS_TYPE_A && recordClass == DNS_CLASS_IN && dataSize == 4) {
+      addresses.push_back(readUint32(response + offset));
+      ttl = std::min(ttl, recordTtl);
+    }
+
+    offset += dataSize;
+  }
+
+  if (!addresses.empty()) {
+    return QueryStatus::ADDRESSES;
+  }
+
+  // A truncated response without answers has to be asked again over TCP, leave it to the next nameserver
+  return (response[2] & DNS_FLAG_TRUNCATED) != 0 ? QueryStatus::FAILURE : QueryStatus::NO_ADDRESSES;
+}
+
+// Suspends the current context until the socket has a datagram to read, returns false if the deadline passes first
+bool waitReadable(Dispatcher& dispatcher, int socket, std::chrono::steady_clock::time_point deadline) {
+  auto now = std::chrono::steady_clock::now();
+  if (now >= deadline) {
+    return false;
+  }
+
+  OperationContext operationContext;
+  operationContext.interrupted = false;
+  operationContext.context = dispatcher.getCurrentContext();
+  operationContext.events = 0;
+  ContextPair contextPair;
+  contextPair.readContext = &operationContext;
+  contextPair.writeContext = nullptr;
+
+  epoll_event socketEvent;
+  socketEvent.events = EPOLLIN | EPOLLONESHOT;
+  socketEvent.data.ptr = &contextPair;
+  if (epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_ADD, socket, &socketEvent) == -1) {
+    throw std::runtime_error("Ipv4Resolver::resolve, epoll_ctl failed, " + lastErrorMessage());
+  }
+
+  NativeTimer timer;
+  timer.context = dispatcher.getCurrentContext();
+  dispatcher.addTimer(timer, deadline - now);
+
+  dispatcher.getCurrentContext()->interruptProcedure = [&]() {
+    dispatcher.cancelTimer(timer);
+    if (epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_DEL, socket, nullptr) == -1) {
+      throw std::runtime_error("Ipv4Resolver::resolve, interrupt procedure, epoll_ctl failed, " + lastErrorMessage());
+    }
+
+    operationContext.interrupted = true;
+    dispatcher.pushContext(operationContext.context);
+  };
+
+  dispatcher.dispatch();
+  dispatcher.getCurrentContext()->interruptProcedure = nullptr;
+  assert(operationContext.context == dispatcher.getCurrentContext());
+  if (operationContext.interrupted) {
+    throw InterruptedException();
+  }
+
+  // The timer may have fired as well after the socket event queued this context, cancelling it is a no-op then
+  dispatcher.cancelTimer(timer);
+
+  if (epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_DEL, socket, nullptr) == -1) {
+    throw std::runtime_error("Ipv4Resolver::resolve, epoll_ctl failed, " + lastErrorMessage());
+  }
+
+  return operationContext.events != 0;
+}
+
+// Sends query to a nameserver from a fresh port and waits for the answer until timeout
+QueryStatus exchange(Dispatcher& dispatcher, const Nameserver& nameserver, const std::vector<uint8_t>& query,
+  std::chrono::milliseconds timeout, std::vector<uint32_t>& addresses, uint32_t& ttl) {
+  int socket = ::socket(nameserver.address.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+  if (socket == -1) {
+    // A host without IPv6 can't reach an IPv6 nameserver, the next one is asked
+    if (errno == EAFNOSUPPORT) {
+      return QueryStatus::FAILURE;
+    }
+
+    throw std::runtime_error("Ipv4Resolver::resolve, socket failed, " + lastErrorMessage());
+  }
+
+  QueryStatus status = QueryStatus::FAILURE;
+  try {
+    // Connecting makes the kernel drop datagrams from anyone but the nameserver
+    if (connect(socket, reinterpret_cast<const sockaddr*>(&nameserver.address), nameserver.size) == 0 && send(socket, query.data(), query.size(), 0) != -1) {
+      auto deadline = std::chrono::steady_clock::now() + timeout;
+      uint8_t response[MAX_DNS_MESSAGE_SIZE];
+      for (;;) {
+        ssize_t transferred = recv(socket, response, sizeof response, 0);
+        if (transferred == -1) {
+          if (errno != EAGAIN || !waitReadable(dispatcher, socket, deadline)) {
+            break;
+          }
+        } else {
+          status = parseResponse(query, response, static_cast<size_t>(transferred), addresses, ttl);
+          if (status != QueryStatus::MISMATCH) {
+            break;
+          }
+
+          status = QueryStatus::FAILURE;
+        }
+      }
+    }
+  } catch (...) {
+    close(socket);
+    throw;
+  }
+
+  if (close(socket) == -1) {
+    throw std::runtime_error("Ipv4Resolver::resolve, close failed, " + lastErrorMessage());
+  }
+
+  return status;
+}
+
+Ipv4Address pickAddress(const std::vector<uint32_t>& addresses) {
+  assert(!addresses.empty());
+  std::mt19937 generator{ std::random_device()() };
+  return Ipv4Address(addresses[std::uniform_int_distribution<std::size_t>(0, addresses.size() - 1)(generator)]);
+}
+
+}
+
+struct Ipv4Resolver::State {
+  struct CacheEntry {
+    std::vector<uint32_t> addresses;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  // Set when the configuration comes from /etc/resolv.conf and /etc/hosts, which are read again once they change
+  bool system;
+
+  std::mutex mutex;
+  FileStamp resolvConfStamp;
+  FileStamp hostsStamp;
+  std::vector<Nameserver> nameservers;
+  std::vector<std::string> search;
+  unsigned ndots;
+  std::chrono::milliseconds timeout;
+  unsigned attempts;
+  std::unordered_map<std::string, uint32_t> hosts;
+
+  // Entries past their TTL are dropped when they are looked up
+  Common::LruCache<std::string, CacheEntry> cache;
+
+  explicit State(bool system);
+
+  void refresh();
+  void loadResolvConf();
+  void loadHosts();
+  bool findHost(const std::string& name, uint32_t& address);
+  bool findCached(const std::string& name, std::vector<uint32_t>& addresses);
+  void insertCached(const std::string& name, const std::vector<uint32_t>& addresses, uint32_t ttl);
+};
+
+Ipv4Resolver::State::State(bool system) : system(system), resolvConfStamp(), hostsStamp(), ndots(DEFAULT_NDOTS),
+  timeout(std::chrono::seconds(DEFAULT_TIMEOUT_SECONDS)), attempts(DEFAULT_ATTEMPTS), cache(CACHE_CAPACITY) {
+  if (system) {
+    loadResolvConf();
+  }
+}
+
+void Ipv4Resolver::State::refresh() {
+  if (!system) {
+    return;
+  }
+
+  FileStamp stamp = stampFile(RESOLV_CONF_PATH);
+  if (!(stamp == resolvConfStamp)) {
+    loadResolvConf();
+  }
+
+  stamp = stampFile(HOSTS_PATH);
+  if (!(stamp == hostsStamp)) {
+    loadHosts();
+  }
+}
+
+void Ipv4Resolver::State::loadResolvConf() {
+  resolvConfStamp = stampFile(RESOLV_CONF_PATH);
+  nameservers.clear();
+  search.clear();
+  ndots = DEFAULT_NDOTS;
+  timeout = std::chrono::seconds(DEFAULT_TIMEOUT_SECONDS);
+  attempts = DEFAULT_ATTEMPTS;
+
+  std::ifstream file(RESOLV_CONF_PATH);
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string keyword;
+    if (!(fields >> keyword) || keyword[0] == '#' || keyword[0] == ';') {
+      continue;
+    }
+
+    std::string value;
+    if (keyword == "nameserver") {
+      Nameserver nameserver;
+      // Nameservers beyond the limit are ignored
+      if (fields >> value && nameservers.size() < MAX_NAMESERVERS && parseNameserver(value, nameserver)) {
+        nameservers.push_back(nameserver);
+      }
+    } else if (keyword == "domain" || keyword == "search") {
+      // Whichever of them comes last wins
+      search.clear();
+      while (fields >> value && value[0] != '#' && value[0] != ';' && search.size() < MAX_SEARCH_DOMAINS) {
+        value = toLower(value);
+        if (value.back() == '.') {
+          value.pop_back();
+        }
+
+        if (!value.empty()) {
+          search.push_back(value);
+        }
+      }
+    } else if (keyword == "options") {
+      while (fields >> value) {
+        size_t separator = value.find(':');
+        std::string name = value.substr(0, separator);
+        std::string argument = separator != std::string::npos ? value.substr(separator + 1) : std::string();
+        if (name == "ndots") {
+          ndots = parseOption(argument, DEFAULT_NDOTS, MAX_NDOTS);
+        } else if (name == "timeout") {
+          timeout = std::chrono::seconds(std::max(parseOption(argument, DEFAULT_TIMEOUT_SECONDS, MAX_TIMEOUT_SECONDS), 1u));
+        } else if (name == "attempts") {
+          attempts = std::max(parseOption(argument, DEFAULT_ATTEMPTS, MAX_ATTEMPTS), 1u);
+        }
+      }
+    }
+  }
+
+  // Without nameservers the local one is asked, like the libc resolver does
+  if (nameservers.empty()) {
+    nameservers.push_back(makeNameserver(INADDR_LOOPBACK, DNS_PORT));
+  }
+
+  // The answers may have come from nameservers which are no longer used
+  cache.clear();
+}
+
+void Ipv4Resolver::State::loadHosts() {
+  hostsStamp = stampFile(HOSTS_PATH);
+  hosts.clear();
+
+  std::ifstream file(HOSTS_PATH);
+  std::string line;
+  while (std::getline(file, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string text;
+    uint32_t address;
+    if (!(fields >> text) || !parseAddress(text, address)) {
+      continue;
+    }
+
+    // The first line naming a host is the one used
+    std::string name;
+    while (fields >> name) {
+      name = toLower(name);
+      if (name.back() == '.') {
+        name.pop_back();
+      }
+
+      hosts.emplace(name, address);
+    }
+  }
+}
+
+bool Ipv4Resolver::State::findHost(const std::string& name, uint32_t& address) {
+  auto it = hosts.find(name);
+  if (it != hosts.end()) {
+    address = it->second;
+    return true;
+  }
+
+  if (system && name == "localhost") {
+    address = INADDR_LOOPBACK;
+    return true;
+  }
+
+  return false;
+}
+
+bool Ipv4Resolver::State::findCached(const std::string& name, std::vector<uint32_t>& addresses) {
+  CacheEntry entry;
+  if (!cache.find(name, entry)) {
+    return false;
+  }
+
+  if (entry.expires <= std::chrono::steady_clock::now()) {
+    cache.erase(name);
+    return false;
+  }
+
+  addresses = std::move(entry.addresses);
+  return true;
+}
+
+void Ipv4Resolver::State::insertCached(const std::string& name, const std::vector<uint32_t>& addresses, uint32_t ttl) {
+  if (ttl == 0) {
+    return;
+  }
+
+  cache.insert(name, CacheEntry{addresses, std::chrono::steady_clock::now() + std::chrono::seconds(std::min(ttl, MAX_CACHE_TTL))});
+}
+
 Ipv4Resolver::Ipv4Resolver() : dispatcher(nullptr) {
 }
 
 Ipv4Resolver::Ipv4Resolver(Dispatcher& dispatcher) : dispatcher(&dispatcher) {
+  // Shared by all resolvers of the process, whichever thread they run on
+  static std::shared_ptr<State> systemState = std::make_shared<State>(true);
+  state = systemState;
+}
+
+Ipv4Resolver::Ipv4Resolver(Dispatcher& dispatcher, const std::vector<std::pair<Ipv4Address, uint16_t>>& nameservers, std::chrono::milliseconds timeout) :
+  dispatcher(&dispatcher), state(std::make_shared<State>(false)) {
+  for (auto& nameserver : nameservers) {
+    state->nameservers.push_back(makeNameserver(nameserver.first.getValue(), nameserver.second));
+  }
+
+  state->timeout = timeout;
 }
 
-Ipv4Resolver::Ipv4Resolver(Ipv4Resolver&& other) : dispatcher(other.dispatcher) {
+Ipv4Resolver::Ipv4Resolver(Ipv4Resolver&& other) : dispatcher(other.dispatcher), state(std::move(other.state)) {
   if (dispatcher != nullptr) {
     other.dispatcher = nullptr;
   }
@@ -46,6 +622,7 @@ Ipv4Resolver::~Ipv4Resolver() {
 
 Ipv4Resolver& Ipv4Resolver::operator=(Ipv4Resolver&& other) {
   dispatcher = other.dispatcher;
+  state = std::move(other.state);
   if (dispatcher != nullptr) {
     other.dispatcher = nullptr;
   }
@@ -59,28 +636,93 @@ Ipv4Address Ipv4Resolver::resolve(const std::string& host) {
     throw InterruptedException();
   }
 
-  addrinfo hints = { 0, AF_INET, SOCK_STREAM, IPPROTO_TCP, 0, NULL, NULL, NULL };
-  addrinfo* addressInfos;
-  int result = getaddrinfo(host.c_str(), NULL, &hints, &addressInfos);
-  if (result != 0) {
-    throw std::runtime_error("Ipv4Resolver::resolve, getaddrinfo failed, " + errorMessage(result));
+  // Numeric addresses are taken in all the forms inet_aton knows, as getaddrinfo did
+  in_addr numericAddress;
+  if (inet_aton(host.c_str(), &numericAddress) != 0) {
+    return Ipv4Address(ntohl(numericAddress.s_addr));
   }
-  
-  std::size_t count = 0;
-  for (addrinfo* addressInfo = addressInfos; addressInfo != nullptr; addressInfo = addressInfo->ai_next) {
-    ++count;
+
+  std::string name = toLower(host);
+  bool absolute = !name.empty() && name.back() == '.';
+  if (absolute) {
+    name.pop_back();
+  }
+
+  std::vector<uint32_t> addresses;
+  std::vector<Nameserver> nameservers;
+  std::vector<std::string> candidates;
+  std::chrono::milliseconds timeout;
+  unsigned attempts;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->refresh();
+
+    uint32_t address;
+    if (state->findHost(name, address)) {
+      return Ipv4Address(address);
+    }
+
+    if (state->findCached(name, addresses)) {
+      return pickAddress(addresses);
+    }
+
+    // Names with fewer dots than ndots are looked up in the search domains first, the libc resolver does the same
+    size_t dots = static_cast<size_t>(std::count(name.begin(), name.end(), '.'));
+    if (absolute || dots >= state->ndots) {
+      candidates.push_back(name);
+    }
+
+    if (!absolute) {
+      for (auto& domain : state->search) {
+        candidates.push_back(name + '.' + domain);
+      }
+
+      if (dots < state->ndots) {
+        candidates.push_back(name);
+      }
+    }
+
+    nameservers = state->nameservers;
+    timeout = state->timeout;
+    attempts = state->attempts;
   }
 
   std::mt19937 generator{ std::random_device()() };
-  std::size_t index = std::uniform_int_distribution<std::size_t>(0, count - 1)(generator);
-  addrinfo* addressInfo = addressInfos;
-  for (std::size_t i = 0; i < index; ++i) {
-    addressInfo = addressInfo->ai_next;
+  std::vector<uint8_t> query;
+  for (auto& candidate : candidates) {
+    uint16_t id = static_cast<uint16_t>(std::uniform_int_distribution<unsigned>(0, 0xffff)(generator));
+    query = { static_cast<uint8_t>(id >> 8), static_cast<uint8_t>(id), DNS_FLAG_RECURSION_DESIRED, 0, 0, 1, 0, 0, 0, 0, 0, 0 };
+    if (!encodeName(candidate, query)) {
+      continue;
+    }
+
+    query.insert(query.end(), { 0, DNS_TYPE_A, 0, DNS_CLASS_IN });
+
+    bool answered = false;
+    for (unsigned attempt = 0; attempt < attempts && !answered; ++attempt) {
+      for (auto& nameserver : nameservers) {
+        uint32_t ttl;
+        QueryStatus status = exchange(*dispatcher, nameserver, query, timeout, addresses, ttl);
+        if (status == QueryStatus::ADDRESSES) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          state->insertCached(name, addresses, ttl);
+          return pickAddress(addresses);
+        }
+
+        if (status == QueryStatus::NO_ADDRESSES) {
+          answered = true;
+          break;
+        }
+      }
+    }
+
+    // Going through the rest of the candidates would only multiply the time spent waiting on the same nameservers
+    if (!answered) {
+      throw std::runtime_error("Ipv4Resolver::resolve, no nameserver answered for " + host);
+    }
   }
 
-  Ipv4Address address(ntohl(reinterpret_cast<sockaddr_in*>(addressInfo->ai_addr)->sin_addr.s_addr));
-  freeaddrinfo(addressInfo);
-  return address;
+  throw std::runtime_error("Ipv4Resolver::resolve, no address found for " + host);
 }
 
 }
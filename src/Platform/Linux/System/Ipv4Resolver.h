@@ -17,17 +17,27 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace System {
 
 class Dispatcher;
 class Ipv4Address;
 
+// Resolves host names with /etc/hosts and non-blocking UDP queries to the nameservers of /etc/resolv.conf,
+// suspending only the calling context. Answers are kept in a bounded cache for as long as their TTL allows.
 class Ipv4Resolver {
 public:
   Ipv4Resolver();
   explicit Ipv4Resolver(Dispatcher& dispatcher);
+  // Queries only the given nameservers and ports, ignoring /etc/hosts and /etc/resolv.conf, with a cache of its own.
+  // Lets the resolver run against a local responder.
+  Ipv4Resolver(Dispatcher& dispatcher, const std::vector<std::pair<Ipv4Address, uint16_t>>& nameservers, std::chrono::milliseconds timeout);
   Ipv4Resolver(const Ipv4Resolver&) = delete;
   Ipv4Resolver(Ipv4Resolver&& other);
   ~Ipv4Resolver();
@@ -36,7 +46,10 @@ public:
   Ipv4Address resolve(const std::string& host);
 
 private:
+  struct State;
+
   Dispatcher* dispatcher;
+  std::shared_ptr<State> state;
 };
 
 }
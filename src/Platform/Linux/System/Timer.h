@@ -37,7 +37,6 @@ public:
 private:
   Dispatcher* dispatcher;
   void* context;
-  int timer;
 };
 
 }
@@ -19,7 +19,7 @@
 
 #include <condition_variable>
 #include <mutex>
-#include <thread>
+#include <System/ThreadPool.h>
 
 namespace System {
 
@@ -36,20 +36,17 @@ enum class State : unsigned {
 }
 
 // Simplest possible future implementation. The reason why this class even exist is because currenty std future has a
-// memory corrupting bug on OSX. Spawn a new thread, execute procedure in it, get result, and wait thread to shut down.
-// Actualy, this is what libstdc++'s std::future is doing.
+// memory corrupting bug on OSX. Execute procedure in the shared thread pool, get result, and wait for it to complete.
 template<class T> class Future {
 public:
-  // Create a new thread, and run `operation` in it.
-  explicit Future(std::function<T()>&& operation) : procedure(std::move(operation)), state(State::STARTED), worker{[this] { asyncOp(); }} {
+  // Run `operation` in the shared thread pool.
+  explicit Future(std::function<T()>&& operation) : procedure(std::move(operation)), state(State::STARTED) {
+    ThreadPool::shared().submit([this] { asyncOp(); });
   }
 
-  // Wait for async op to complete, then if thread wasn't detached, join it.
+  // Wait for async op to complete.
   ~Future() {
     wait();
-    if (worker.joinable()) {
-      worker.join();
-    }
   }
 
   // Get result of async operation. UB if called more than once.
@@ -78,7 +75,7 @@ public:
   }
 
 private:
-  // This function is executed in a separate thread.
+  // This function is executed in the thread pool.
   void asyncOp() {
     try {
       assert(procedure != nullptr);
@@ -98,21 +95,18 @@ private:
   mutable std::mutex operationMutex;
   mutable std::condition_variable operationCondition;
   mutable State state;
-  std::thread worker;
 };
 
 template<> class Future<void> {
 public:
-  // Create a new thread, and run `operation` in it.
-  explicit Future(std::function<void()>&& operation) : procedure(std::move(operation)), state(State::STARTED), worker{[this] { asyncOp(); }} {
+  // Run `operation` in the shared thread pool.
+  explicit Future(std::function<void()>&& operation) : procedure(std::move(operation)), state(State::STARTED) {
+    ThreadPool::shared().submit([this] { asyncOp(); });
   }
 
-  // Wait for async op to complete, then if thread wasn't detached, join it.
+  // Wait for async op to complete.
   ~Future() {
     wait();
-    if (worker.joinable()) {
-      worker.join();
-    }
   }
 
   // Get result of async operation. UB if called more than once.
@@ -139,7 +133,7 @@ public:
   }
 
 private:
-  // This function is executed in a separate thread.
+  // This function is executed in the thread pool.
   void asyncOp() {
     try {
       assert(procedure != nullptr);
@@ -158,7 +152,6 @@ private:
   mutable std::mutex operationMutex;
   mutable std::condition_variable operationCondition;
   mutable State state;
-  std::thread worker;
 };
 
 template<class T> std::function<T()> async(std::function<T()>&& operation) {
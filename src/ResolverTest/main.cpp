@@ -0,0 +1,299 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/InterruptedException.h>
+#include <System/Ipv4Address.h>
+#include <System/Ipv4Resolver.h>
+#include <System/Timer.h>
+
+/* Runs Ipv4Resolver against a DNS responder on a local UDP port, which answers
+   the names below the way a real nameserver would, and checks the cache, TTL
+   expiry, CNAME answers, NXDOMAIN and SERVFAIL, the fallback to the next
+   nameserver on a timeout and interrupting a pending query. */
+
+using namespace System;
+
+namespace {
+
+const uint16_t DNS_TYPE_A = 1;
+const uint16_t DNS_TYPE_CNAME = 5;
+const uint8_t DNS_RCODE_SERVFAIL = 2;
+const uint8_t DNS_RCODE_NXDOMAIN = 3;
+
+void appendUint16(std::vector<uint8_t>& message, uint16_t value) {
+  message.push_back(static_cast<uint8_t>(value >> 8));
+  message.push_back(static_cast<uint8_t>(value));
+}
+
+void appendUint32(std::vector<uint8_t>& message, uint32_t value) {
+  appendUint16(message, static_cast<uint16_t>(value >> 16));
+  appendUint16(message, static_cast<uint16_t>(value));
+}
+
+void appendName(std::vector<uint8_t>& message, const std::string& name) {
+  size_t labelStart = 0;
+  for (;;) {
+    size_t labelEnd = std::min(name.find('.', labelStart), name.size());
+    message.push_back(static_cast<uint8_t>(labelEnd - labelStart));
+    message.insert(message.end(), name.begin() + labelStart, name.begin() + labelEnd);
+    if (labelEnd == name.size()) {
+      break;
+    }
+
+    labelStart = labelEnd + 1;
+  }
+
+  message.push_back(0);
+}
+
+// Appends a record for the name of the question, which starts right after the header
+void appendAnswer(std::vector<uint8_t>& message, uint16_t type, uint32_t ttl, const std::vector<uint8_t>& data) {
+  appendUint16(message, 0xc00c);
+  appendUint16(message, type);
+  appendUint16(message, 1);
+  appendUint32(message, ttl);
+  appendUint16(message, static_cast<uint16_t>(data.size()));
+  message.insert(message.end(), data.begin(), data.end());
+}
+
+std::vector<uint8_t> addressData(uint32_t address) {
+  std::vector<uint8_t> data;
+  appendUint32(data, address);
+  return data;
+}
+
+// Binds a UDP socket to a free port of the loopback interface
+int bindLoopback(uint16_t& port) {
+  int socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  assert(socket != -1);
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert(bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof address) == 0);
+
+  socklen_t size = sizeof address;
+  assert(getsockname(socket, reinterpret_cast<sockaddr*>(&address), &size) == 0);
+  port = ntohs(address.sin_port);
+  return socket;
+}
+
+class FakeResponder {
+public:
+  FakeResponder() : stopped(false) {
+    socket = bindLoopback(port);
+
+    // lets the thread notice it is stopped
+    timeval timeout = {0, 50000};
+    assert(setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) == 0);
+
+    thread = std::thread([this] { run(); });
+  }
+
+  ~FakeResponder() {
+    stopped = true;
+    thread.join();
+    close(socket);
+  }
+
+  uint16_t getPort() const {
+    return port;
+  }
+
+  size_t getQueryCount(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queryCounts[name];
+  }
+
+private:
+  void run() {
+    while (!stopped) {
+      uint8_t query[512];
+      sockaddr_in sender;
+      socklen_t senderSize = sizeof sender;
+      ssize_t size = recvfrom(socket, query, sizeof query, 0, reinterpret_cast<sockaddr*>(&sender), &senderSize);
+      if (size < 17) {
+        continue;
+      }
+
+      // the question is a single name followed by its type and class
+      std::string name;
+      size_t offset = 12;
+      while (offset < static_cast<size_t>(size) && query[offset] != 0) {
+        if (!name.empty()) {
+          name += '.';
+        }
+
+        name.append(reinterpret_cast<const char*>(query + offset + 1), query[offset]);
+        offset += 1 + query[offset];
+      }
+
+      size_t questionEnd = offset + 5;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++queryCounts[name];
+      }
+
+      std::vector<uint8_t> response(query, query + questionEnd);
+      response[2] = 0x81;
+      response[3] = 0x80;
+      uint16_t answerCount = 0;
+      std::vector<uint8_t> answers;
+      if (name == "cached.test") {
+        appendAnswer(answers, DNS_TYPE_A, 300, addressData(0x0a000001));
+        answerCount = 1;
+      } else if (name == "short.test") {
+        appendAnswer(answers, DNS_TYPE_A, 1, addressData(0x0a000002));
+        answerCount = 1;
+      } else if (name == "uncached.test") {
+        appendAnswer(answers, DNS_TYPE_A, 0, addressData(0x0a000003));
+        answerCount = 1;
+      } else if (name == "alias.test") {
+        std::vector<uint8_t> target;
+        appendName(target, "target.test");
+        appendAnswer(answers, DNS_TYPE_CNAME, 300, target);
+        answers.insert(answers.end(), target.begin(), target.end());
+        appendUint16(answers, DNS_TYPE_A);
+        appendUint16(answers, 1);
+        appendUint32(answers, 300);
+        appendUint16(answers, 4);
+        appendUint32(answers, 0x0a000004);
+        answerCount = 2;
+      } else if (name == "fallback.test") {
+        appendAnswer(answers, DNS_TYPE_A, 300, addressData(0x0a000005));
+        answerCount = 1;
+      } else if (name == "missing.test") {
+        response[3] |= DNS_RCODE_NXDOMAIN;
+      } else if (name == "broken.test") {
+        response[3] |= DNS_RCODE_SERVFAIL;
+      } else {
+        continue;
+      }
+
+      response[6] = static_cast<uint8_t>(answerCount >> 8);
+      response[7] = static_cast<uint8_t>(answerCount);
+      response.insert(response.end(), answers.begin(), answers.end());
+      sendto(socket, response.data(), response.size(), 0, reinterpret_cast<sockaddr*>(&sender), senderSize);
+    }
+  }
+
+  int socket;
+  uint16_t port;
+  std::atomic<bool> stopped;
+  std::mutex mutex;
+  std::map<std::string, size_t> queryCounts;
+  std::thread thread;
+};
+
+// Expects resolving host to fail with a message containing reason
+void assertResolveFails(Ipv4Resolver& resolver, const std::string& host, const std::string& reason) {
+  try {
+    resolver.resolve(host);
+  } catch (InterruptedException&) {
+    throw;
+  } catch (std::exception& e) {
+    assert(std::string(e.what()).find(reason) != std::string::npos);
+    return;
+  }
+
+  assert(false);
+}
+
+}
+
+int main() {
+  try {
+    FakeResponder responder;
+    const Ipv4Address loopback("127.0.0.1");
+
+    // a bound port which never answers
+    uint16_t silentPort;
+    int silentSocket = bindLoopback(silentPort);
+
+    Dispatcher dispatcher;
+    Ipv4Resolver resolver(dispatcher, {{loopback, responder.getPort()}}, std::chrono::milliseconds(1000));
+
+    assert(resolver.resolve("cached.test") == Ipv4Address("10.0.0.1"));
+    assert(resolver.resolve("CACHED.test.") == Ipv4Address("10.0.0.1"));
+    assert(responder.getQueryCount("cached.test") == 1);
+    std::cout << "cache: OK" << std::endl;
+
+    assert(resolver.resolve("uncached.test") == Ipv4Address("10.0.0.3"));
+    assert(resolver.resolve("uncached.test") == Ipv4Address("10.0.0.3"));
+    assert(responder.getQueryCount("uncached.test") == 2);
+
+    assert(resolver.resolve("short.test") == Ipv4Address("10.0.0.2"));
+    assert(resolver.resolve("short.test") == Ipv4Address("10.0.0.2"));
+    assert(responder.getQueryCount("short.test") == 1);
+    Timer(dispatcher).sleep(std::chrono::milliseconds(1100));
+    assert(resolver.resolve("short.test") == Ipv4Address("10.0.0.2"));
+    assert(responder.getQueryCount("short.test") == 2);
+    std::cout << "ttl: OK" << std::endl;
+
+    assert(resolver.resolve("alias.test") == Ipv4Address("10.0.0.4"));
+    std::cout << "cname: OK" << std::endl;
+
+    assertResolveFails(resolver, "missing.test", "no address found");
+    assert(responder.getQueryCount("missing.test") == 1);
+    std::cout << "nxdomain: OK" << std::endl;
+
+    assertResolveFails(resolver, "broken.test", "no nameserver answered");
+    assert(responder.getQueryCount("broken.test") > 1);
+    std::cout << "servfail: OK" << std::endl;
+
+    Ipv4Resolver fallbackResolver(dispatcher, {{loopback, silentPort}, {loopback, responder.getPort()}}, std::chrono::milliseconds(100));
+    auto start = std::chrono::steady_clock::now();
+    assert(fallbackResolver.resolve("fallback.test") == Ipv4Address("10.0.0.5"));
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(100));
+    assertResolveFails(fallbackResolver, "silent.test", "no nameserver answered");
+    std::cout << "timeout fallback: OK" << std::endl;
+
+    Ipv4Resolver silentResolver(dispatcher, {{loopback, silentPort}}, std::chrono::seconds(30));
+    bool interrupted = false;
+    ContextGroup group(dispatcher);
+    group.spawn([&] {
+      try {
+        silentResolver.resolve("silent.test");
+      } catch (InterruptedException&) {
+        interrupted = true;
+      }
+    });
+
+    start = std::chrono::steady_clock::now();
+    Timer(dispatcher).sleep(std::chrono::milliseconds(100));
+    group.interrupt();
+    group.wait();
+    assert(interrupted);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    std::cout << "interrupt: OK" << std::endl;
+
+    close(silentSocket);
+  } catch (std::exception& e) {
+    std::cout << "Something went terribly wrong..." << std::endl << e.what() << std::endl << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -172,12 +172,23 @@ public:
 
   std::string getBody() {
     psResp.set("jsonrpc", std::string("2.0"));
-    return psResp.toString();
+    std::string body = psResp.toString();
+
+    if (!result.empty()) {
+      // "result" sorts after the other members, so it is where Common::JsonValue would have put it
+      body.pop_back();
+      body += ",\"result\":";
+      body += result;
+      body += '}';
+    }
+
+    return body;
   }
 
+  // The result is written straight to JSON text, it is not kept as a Common::JsonValue
   template <typename T>
   bool setResult(const T& v) {
-    psResp.set("result", storeToJsonValue(v));
+    result = storeToJson(v);
     return true;
   }
 
@@ -193,6 +204,7 @@ public:
 
 private:
   Common::JsonValue psResp;
+  std::string result;
 };
 
 
@@ -6,10 +6,12 @@
 
 #include "RpcServer.h"
 #include <future>
+#include <mutex>
 #include <unordered_map>
 #include "math.h"
 
 // CryptoNote
+#include "Common/Metrics.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/Core.h"
@@ -17,6 +19,7 @@
 #include <config/CryptoNoteConfig.h>
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "P2p/NetNode.h"
+#include "System/ThreadPool.h"
 #include "CoreRpcServerErrorCodes.h"
 #include "JsonRpc.h"
 #include "version.h"
@@ -109,10 +112,20 @@ RpcServer::HandlerFunction jsonMethod(bool (RpcServer::*handler)(typename Comman
   };
 }
 
+// Looks the latency histogram of every handler of a table up once, labelled with the key of its entry
+template <class Table>
+Table withDurations(Table handlers, const std::string& name, const std::string& help, const std::string& label) {
+  for (auto& handler : handlers) {
+    handler.second.duration = &Metrics::registry().histogram(name, help, Metrics::latencyBuckets(), label + "=\"" + handler.first + "\"");
+  }
+
+  return handlers;
+}
 
 }
 
-std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers = {
+std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction>> RpcServer::s_handlers =
+  withDurations<std::unordered_map<std::string, RpcHandler<HandlerFunction>>>({
   // old json handlers - remove me in 2019
   { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
   { "/getheight", { jsonMethod<COMMAND_RPC_GET_HEIGHT>(&RpcServer::on_get_height), true } },
@@ -147,8 +160,11 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/get_transactions_status", { jsonMethod<COMMAND_RPC_GET_TRANSACTIONS_STATUS>(&RpcServer::onGetTransactionsStatus), false} },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
-};
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } },
+
+  // metrics in the Prometheus text format
+  { "/metrics", { std::bind(&RpcServer::processMetricsRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+}, "rpc_request_seconds", "Time spent handling each RPC path", "path");
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, Core& c, NodeServer& p2p, ICryptoNoteProtocolHandler& protocol) :
   HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocol(protocol) {
@@ -174,6 +190,8 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
+  Metrics::ScopedTimer timer(*it->second.duration);
+
   it->second.handler(this, request, response);
 }
 
@@ -194,7 +212,8 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
     jsonRequest.parseRequest(request.getBody());
     jsonResponse.setId(jsonRequest.getId()); // copy id
 
-    static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
+    static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers =
+      withDurations<std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>>>({
       { "f_blocks_list_json", { makeMemberMethod(&RpcServer::f_on_blocks_list_json), false } },
       { "f_block_json", { makeMemberMethod(&RpcServer::f_on_block_json), false } },
       { "f_transaction_json", { makeMemberMethod(&RpcServer::f_on_transaction_json), false } },
@@ -207,7 +226,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       { "getlastblockheader", { makeMemberMethod(&RpcServer::on_get_last_block_header), false } },
       { "getblockheaderbyhash", { makeMemberMethod(&RpcServer::on_get_block_header_by_hash), false } },
       { "getblockheaderbyheight", { makeMemberMethod(&RpcServer::on_get_block_header_by_height), false } }
-    };
+    }, "rpc_json_rpc_request_seconds", "Time spent handling each JSON-RPC method", "method");
 
     auto it = jsonRpcHandlers.find(jsonRequest.getMethod());
     if (it == jsonRpcHandlers.end()) {
@@ -218,6 +237,8 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
+    Metrics::ScopedTimer timer(*it->second.duration);
+
     it->second.handler(this, jsonRequest, jsonResponse);
 
   } catch (const JsonRpcError& err) {
@@ -227,7 +248,48 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
   }
 
   response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
+  logger(TRACE) << "JSON-RPC response: " << response.getBody();
+  return true;
+}
+
+bool RpcServer::processMetricsRequest(const HttpRequest& request, HttpResponse& response) {
+  if (!Metrics::enabled()) {
+    response.setStatus(HttpResponse::STATUS_404);
+    return true;
+  }
+
+  static auto& poolSize = Metrics::registry().gauge("core_pool_transactions", "Transactions in the mempool");
+  static auto& height = Metrics::registry().gauge("core_height", "Height of the main chain");
+
+  static auto& threads = Metrics::registry().gauge("system_thread_pool_threads", "Threads started by the shared thread pool");
+  static auto& busyThreads = Metrics::registry().gauge("system_thread_pool_busy_threads", "Threads of the shared thread pool running an operation");
+  static auto& queuedOperations = Metrics::registry().gauge("system_thread_pool_queued_operations", "Operations waiting for a thread of the shared thread pool");
+  static auto& peakQueuedOperations = Metrics::registry().gauge("system_thread_pool_peak_queued_operations", "Most operations ever waiting for a thread of the shared thread pool");
+  static auto& completedOperations = Metrics::registry().counter("system_thread_pool_completed_operations_total", "Operations run by the shared thread pool");
+  static auto& saturatedOperations = Metrics::registry().counter("system_thread_pool_saturated_operations_total", "Operations which waited because every thread of the shared thread pool was busy");
+  static std::mutex threadPoolMetricsMutex;
+
+  poolSize.set(static_cast<int64_t>(m_core.getPoolTransactionCount()));
+  height.set(static_cast<int64_t>(m_core.getTopBlockIndex()) + 1);
+
+  {
+    // the pool keeps its own totals, so the counters are moved up to them. Concurrent
+    // requests take turns, or an older snapshot could move a counter backwards
+    std::lock_guard<std::mutex> lock(threadPoolMetricsMutex);
+
+    const auto threadPool = System::ThreadPool::shared().getStatistics();
+    threads.set(static_cast<int64_t>(threadPool.threadCount));
+    busyThreads.set(static_cast<int64_t>(threadPool.busyThreadCount));
+    queuedOperations.set(static_cast<int64_t>(threadPool.queuedOperationCount));
+    peakQueuedOperations.set(static_cast<int64_t>(threadPool.peakQueuedOperationCount));
+    completedOperations.increment(threadPool.completedOperationCount - completedOperations.value());
+    saturatedOperations.increment(threadPool.saturatedOperationCount - saturatedOperations.value());
+  }
+
+  m_p2p.updateMetrics();
+
+  response.addHeader("Content-Type", "text/plain; version=0.0.4");
+  response.setBody(Metrics::registry().toPrometheusText());
   return true;
 }
 
@@ -444,12 +506,7 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
 
 bool RpcServer::onGetBlocksDetailsByHeights(const COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::request& req, COMMAND_RPC_GET_BLOCKS_DETAILS_BY_HEIGHTS::response& rsp) {
   try {
-    std::vector<BlockDetails> blockDetails;
-    for (const uint32_t& height : req.blockHeights) {
-      blockDetails.push_back(m_core.getBlockDetails(height));
-    }
-
-    rsp.blocks = std::move(blockDetails);
+    rsp.blocks = m_core.getBlocksDetails(req.blockHeights);
   } catch (std::system_error& e) {
     rsp.status = e.what();
     return false;
@@ -697,28 +754,33 @@ bool RpcServer::f_on_blocks_list_json(const F_COMMAND_RPC_GET_BLOCKS_LIST::reque
     last_height = 0;
   }
 
+  std::vector<uint32_t> heights;
   for (uint32_t i = static_cast<uint32_t>(req.height); i >= last_height; i--) {
-    Hash block_hash = m_core.getBlockHashByIndex(static_cast<uint32_t>(i));
-    if (!m_core.hasBlock(block_hash)) {
-      throw JsonRpc::JsonRpcError{
-        CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
-        "Internal error: can't get block by height. Height = " + std::to_string(i) + '.' };
-    }
-    BlockTemplate blk = m_core.getBlockByHash(block_hash);
-    BlockDetails blkDetails = m_core.getBlockDetails(block_hash);
+    heights.push_back(i);
 
+    if (i == 0)
+      break;
+  }
+
+  std::vector<BlockDetails> blocksDetails;
+  try {
+    blocksDetails = m_core.getBlocksDetails(heights);
+  } catch (std::exception& e) {
+    throw JsonRpc::JsonRpcError{
+      CORE_RPC_ERROR_CODE_INTERNAL_ERROR,
+      "Internal error: can't get blocks by height. " + std::string(e.what()) };
+  }
+
+  for (const BlockDetails& blkDetails : blocksDetails) {
     f_block_short_response block_short;
     block_short.cumul_size = blkDetails.blockSize;
-    block_short.timestamp = blk.timestamp;
+    block_short.timestamp = blkDetails.timestamp;
     block_short.difficulty = blkDetails.difficulty;
-    block_short.height = i;
-    block_short.hash = Common::podToHex(block_hash);
-    block_short.tx_count = blk.transactionHashes.size() + 1;
+    block_short.height = blkDetails.index;
+    block_short.hash = Common::podToHex(blkDetails.hash);
+    block_short.tx_count = blkDetails.transactions.size();
 
     res.blocks.push_back(block_short);
-
-    if (i == 0)
-      break;
   }
 
   res.status = CORE_RPC_STATUS_OK;
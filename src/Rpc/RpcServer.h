@@ -13,6 +13,7 @@
 
 #include <Logging/LoggerRef.h>
 #include "Common/Math.h"
+#include "Common/Metrics.h"
 #include "CoreRpcServerCommandsDefinitions.h"
 #include "JsonRpc.h"
 
@@ -41,6 +42,8 @@ private:
   struct RpcHandler {
     const Handler handler;
     const bool allowBusyCore;
+    // set once when the table is built, so requests don't look the histogram up
+    Metrics::Histogram* duration;
   };
 
   typedef void (RpcServer::*HandlerPtr)(const HttpRequest& request, HttpResponse& response);
@@ -48,6 +51,7 @@ private:
 
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
+  bool processMetricsRequest(const HttpRequest& request, HttpResponse& response);
   bool isCoreReady();
 
   // json handlers
@@ -37,25 +37,6 @@ void readVarintAs(IInputStream& s, T &i) {
 
 }
 
-ISerializer::SerializerType BinaryInputStreamSerializer::type() const {
-  return ISerializer::INPUT;
-}
-
-bool BinaryInputStreamSerializer::beginObject(Common::StringView name) {
-  return true;
-}
-
-void BinaryInputStreamSerializer::endObject() {
-}
-
-bool BinaryInputStreamSerializer::beginArray(uint64_t& size, Common::StringView name) {
-  readVarintAs<uint64_t>(stream, size);
-  return true;
-}
-
-void BinaryInputStreamSerializer::endArray() {
-}
-
 bool BinaryInputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
   readVarint(stream, value);
   return true;
@@ -101,7 +82,7 @@ bool BinaryInputStreamSerializer::operator()(std::string& value, Common::StringV
   readVarint(stream, size);
 
   /* Can't take up more than a block size */
-  if (size > CryptoNote::parameters::MAX_EXTRA_SIZE && std::string(name.getData()) == "mm_tag")
+  if (size > CryptoNote::parameters::MAX_EXTRA_SIZE && name == "mm_tag")
   {
     std::vector<char> temp;
     temp.resize(1);
@@ -118,11 +99,8 @@ bool BinaryInputStreamSerializer::operator()(std::string& value, Common::StringV
   }
 
   if (size > 0) {
-    std::vector<char> temp;
-    temp.resize(size);
-    checkedRead(&temp[0], size);
-    value.reserve(size);
-    value.assign(&temp[0], size);
+    value.resize(size);
+    checkedRead(&value[0], size);
   } else {
     value.clear();
   }
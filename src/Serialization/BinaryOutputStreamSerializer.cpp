@@ -25,25 +25,6 @@ using namespace Common;
 
 namespace CryptoNote {
 
-ISerializer::SerializerType BinaryOutputStreamSerializer::type() const {
-  return ISerializer::OUTPUT;
-}
-
-bool BinaryOutputStreamSerializer::beginObject(Common::StringView name) {
-  return true;
-}
-
-void BinaryOutputStreamSerializer::endObject() {
-}
-
-bool BinaryOutputStreamSerializer::beginArray(uint64_t& size, Common::StringView name) {
-  writeVarint(stream, size);
-  return true;
-}
-
-void BinaryOutputStreamSerializer::endArray() {
-}
-
 bool BinaryOutputStreamSerializer::operator()(uint8_t& value, Common::StringView name) {
   writeVarint(stream, value);
   return true;
@@ -18,23 +18,37 @@
 #pragma once
 
 #include "Common/IOutputStream.h"
+#include "Common/StreamTools.h"
 #include "ISerializer.h"
 #include "SerializationOverloads.h"
 
 namespace CryptoNote {
 
-class BinaryOutputStreamSerializer : public ISerializer {
+// Final, and with the trivial members defined here, so that code templated on
+// the concrete serializer (see CryptoNoteSerialization) calls them directly.
+class BinaryOutputStreamSerializer final : public ISerializer {
 public:
   BinaryOutputStreamSerializer(Common::IOutputStream& strm) : stream(strm) {}
   virtual ~BinaryOutputStreamSerializer() {}
 
-  virtual ISerializer::SerializerType type() const override;
+  virtual ISerializer::SerializerType type() const override {
+    return ISerializer::OUTPUT;
+  }
+
+  virtual bool beginObject(Common::StringView name) override {
+    return true;
+  }
 
-  virtual bool beginObject(Common::StringView name) override;
-  virtual void endObject() override;
+  virtual void endObject() override {
+  }
 
-  virtual bool beginArray(uint64_t& size, Common::StringView name) override;
-  virtual void endArray() override;
+  virtual bool beginArray(uint64_t& size, Common::StringView name) override {
+    Common::writeVarint(stream, size);
+    return true;
+  }
+
+  virtual void endArray() override {
+  }
 
   virtual bool operator()(uint8_t& value, Common::StringView name) override;
   virtual bool operator()(int16_t& value, Common::StringView name) override;
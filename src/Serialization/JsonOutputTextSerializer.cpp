@@ -0,0 +1,159 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "JsonOutputTextSerializer.h"
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+#include "Common/StreamTools.h"
+#include "Common/StringTools.h"
+
+using namespace CryptoNote;
+
+JsonOutputTextSerializer::JsonOutputTextSerializer(Common::IOutputStream& stream) : stream(stream) {
+  chain.push_back({false, true});
+  write("{", 1);
+}
+
+JsonOutputTextSerializer::~JsonOutputTextSerializer() {
+}
+
+ISerializer::SerializerType JsonOutputTextSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool JsonOutputTextSerializer::beginObject(Common::StringView name) {
+  writeName(name);
+  write("{", 1);
+  chain.push_back({false, true});
+  return true;
+}
+
+void JsonOutputTextSerializer::endObject() {
+  assert(!chain.empty() && !chain.back().isArray);
+  chain.pop_back();
+  write("}", 1);
+}
+
+bool JsonOutputTextSerializer::beginArray(uint64_t& size, Common::StringView name) {
+  writeName(name);
+  write("[", 1);
+  chain.push_back({true, true});
+  return true;
+}
+
+void JsonOutputTextSerializer::endArray() {
+  assert(!chain.empty() && chain.back().isArray);
+  chain.pop_back();
+  write("]", 1);
+}
+
+bool JsonOutputTextSerializer::operator()(uint64_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(uint16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(int16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(uint32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(int32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(uint8_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputTextSerializer::operator()(int64_t& value, Common::StringView name) {
+  char buffer[24];
+  int length = snprintf(buffer, sizeof(buffer), "%" PRId64, value);
+
+  writeName(name);
+  write(buffer, length);
+  return true;
+}
+
+bool JsonOutputTextSerializer::operator()(double& value, Common::StringView name) {
+  // the same as Common::JsonValue: fixed with 11 digits, without the trailing zeros
+  char buffer[400];
+  int length = snprintf(buffer, sizeof(buffer), "%.11f", value);
+  while (length > 1 && buffer[length - 2] != '.' && buffer[length - 1] == '0') {
+    --length;
+  }
+
+  writeName(name);
+  write(buffer, length);
+  return true;
+}
+
+bool JsonOutputTextSerializer::operator()(bool& value, Common::StringView name) {
+  writeName(name);
+  if (value) {
+    write("true", 4);
+  } else {
+    write("false", 5);
+  }
+
+  return true;
+}
+
+bool JsonOutputTextSerializer::operator()(std::string& value, Common::StringView name) {
+  writeString(name, value.data(), value.size());
+  return true;
+}
+
+bool JsonOutputTextSerializer::binary(void* value, uint64_t size, Common::StringView name) {
+  std::string hex = Common::toHex(value, size);
+  writeString(name, hex.data(), hex.size());
+  return true;
+}
+
+bool JsonOutputTextSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void JsonOutputTextSerializer::writeName(Common::StringView name) {
+  assert(!chain.empty());
+  Level& level = chain.back();
+
+  if (!level.isEmpty) {
+    write(",", 1);
+  }
+
+  level.isEmpty = false;
+
+  if (!level.isArray) {
+    write("\"", 1);
+    write(name.getData(), name.getSize());
+    write("\":", 2);
+  }
+}
+
+// strings are not escaped, as Common::JsonValue neither escapes them when printing nor unescapes them when parsing
+void JsonOutputTextSerializer::writeString(Common::StringView name, const char* data, uint64_t size) {
+  writeName(name);
+  write("\"", 1);
+  write(data, size);
+  write("\"", 1);
+}
+
+void JsonOutputTextSerializer::write(const char* data, uint64_t size) {
+  Common::write(stream, data, size);
+}
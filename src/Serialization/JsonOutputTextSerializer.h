@@ -0,0 +1,66 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/IOutputStream.h"
+#include "ISerializer.h"
+
+namespace CryptoNote {
+
+// Writes JSON text to the stream as the fields are visited, instead of building a Common::JsonValue
+// first as JsonOutputStreamSerializer does. Values are printed the same way as Common::JsonValue
+// prints them, but the fields of an object are written in the order they are serialized.
+//
+// The root object is opened on construction, and is closed by a call to endObject() once the value
+// has been serialized.
+class JsonOutputTextSerializer : public ISerializer {
+public:
+  JsonOutputTextSerializer(Common::IOutputStream& stream);
+  virtual ~JsonOutputTextSerializer();
+
+  SerializerType type() const override;
+
+  virtual bool beginObject(Common::StringView name) override;
+  virtual void endObject() override;
+
+  virtual bool beginArray(uint64_t& size, Common::StringView name) override;
+  virtual void endArray() override;
+
+  virtual bool operator()(uint8_t& value, Common::StringView name) override;
+  virtual bool operator()(int16_t& value, Common::StringView name) override;
+  virtual bool operator()(uint16_t& value, Common::StringView name) override;
+  virtual bool operator()(int32_t& value, Common::StringView name) override;
+  virtual bool operator()(uint32_t& value, Common::StringView name) override;
+  virtual bool operator()(int64_t& value, Common::StringView name) override;
+  virtual bool operator()(uint64_t& value, Common::StringView name) override;
+  virtual bool operator()(double& value, Common::StringView name) override;
+  virtual bool operator()(bool& value, Common::StringView name) override;
+  virtual bool operator()(std::string& value, Common::StringView name) override;
+  virtual bool binary(void* value, uint64_t size, Common::StringView name) override;
+  virtual bool binary(std::string& value, Common::StringView name) override;
+
+  template<typename T>
+  bool operator()(T& value, Common::StringView name) {
+    return ISerializer::operator()(value, name);
+  }
+
+private:
+  struct Level {
+    bool isArray;
+    bool isEmpty;
+  };
+
+  // writes the separator from the previous value, and the name when inside an object
+  void writeName(Common::StringView name);
+  void writeString(Common::StringView name, const char* data, uint64_t size);
+  void write(const char* data, uint64_t size);
+
+  Common::IOutputStream& stream;
+  std::vector<Level> chain;
+};
+
+}
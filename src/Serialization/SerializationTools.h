@@ -23,6 +23,7 @@
 #include <Common/StringOutputStream.h>
 #include "JsonInputStreamSerializer.h"
 #include "JsonOutputStreamSerializer.h"
+#include "JsonOutputTextSerializer.h"
 #include "KVBinaryInputStreamSerializer.h"
 #include "KVBinaryOutputStreamSerializer.h"
 #include <zedwallet/Types.h>
@@ -110,6 +111,25 @@ void loadFromJsonValue(std::list<T>& v, const Common::JsonValue& js) {
 
 template <typename T>
 std::string storeToJson(const T& v) {
+  std::string result;
+  Common::StringOutputStream stream(result);
+  JsonOutputTextSerializer s(stream);
+  serialize(const_cast<T&>(v), s);
+  s.endObject();
+  return result;
+}
+
+template <typename T>
+std::string storeToJson(const std::vector<T>& v) {
+  return storeToJsonValue(v).toString();
+}
+
+template <typename T>
+std::string storeToJson(const std::list<T>& v) {
+  return storeToJsonValue(v).toString();
+}
+
+inline std::string storeToJson(const std::string& v) {
   return storeToJsonValue(v).toString();
 }
 
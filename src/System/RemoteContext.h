@@ -27,7 +27,7 @@ namespace System {
 
 template<class T = void> class RemoteContext {
 public:
-  // Start a thread, execute operation in it, continue execution of current context.
+  // Execute operation in the shared thread pool, continue execution of current context.
   RemoteContext(Dispatcher& d, std::function<T()>&& operation)
       : dispatcher(d), event(d), procedure(std::move(operation)), future(System::Detail::async<T>([this] { return asyncProcedure(); })), interrupted(false) {
   }
@@ -61,7 +61,7 @@ public:
     }
 
     try {
-      // windows future implementation doesn't wait for completion on destruction
+      // a pooled future doesn't wait for completion on destruction
       if (future.valid()) {
         future.wait();
       }
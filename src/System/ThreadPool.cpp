@@ -0,0 +1,104 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace System {
+
+ThreadPool::ThreadPool(size_t maxThreadCount) : maxThreadCount(std::max<size_t>(maxThreadCount, 1)), idleThreadCount(0),
+  busyThreadCount(0), peakQueuedOperationCount(0), completedOperationCount(0), saturatedOperationCount(0), stopped(false) {
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stopped = true;
+  }
+
+  operationAvailable.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+ThreadPool& ThreadPool::shared() {
+  // miner workers hold their threads for as long as they mine, so leave plenty for everything else
+  static ThreadPool pool(std::max<size_t>(64, 4 * std::thread::hardware_concurrency()));
+  return pool;
+}
+
+ThreadPool::Statistics ThreadPool::getStatistics() const {
+  std::unique_lock<std::mutex> lock(mutex);
+  Statistics statistics;
+  statistics.maxThreadCount = maxThreadCount;
+  statistics.threadCount = threads.size();
+  statistics.busyThreadCount = busyThreadCount;
+  statistics.queuedOperationCount = operations.size();
+  statistics.peakQueuedOperationCount = peakQueuedOperationCount;
+  statistics.completedOperationCount = completedOperationCount;
+  statistics.saturatedOperationCount = saturatedOperationCount;
+  return statistics;
+}
+
+void ThreadPool::submit(std::function<void()>&& operation) {
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    assert(!stopped);
+    operations.push_back(std::move(operation));
+    peakQueuedOperationCount = std::max(peakQueuedOperationCount, operations.size());
+    if (operations.size() > idleThreadCount) {
+      if (threads.size() < maxThreadCount) {
+        try {
+          threads.emplace_back([this] { workerProcedure(); });
+        } catch (...) {
+          operations.pop_back();
+          throw;
+        }
+
+        // the new thread picks the operation up once it starts
+        return;
+      }
+
+      ++saturatedOperationCount;
+    }
+  }
+
+  operationAvailable.notify_one();
+}
+
+void ThreadPool::workerProcedure() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    ++idleThreadCount;
+    while (!stopped && operations.empty()) {
+      operationAvailable.wait(lock);
+    }
+
+    --idleThreadCount;
+    if (operations.empty()) {
+      return;
+    }
+
+    auto operation = std::move(operations.front());
+    operations.pop_front();
+    ++busyThreadCount;
+    lock.unlock();
+
+    try {
+      operation();
+    } catch (...) {
+    }
+
+    // release whatever the operation captured before taking the lock again
+    operation = nullptr;
+    lock.lock();
+    --busyThreadCount;
+    ++completedOperationCount;
+  }
+}
+
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace System {
+
+// Runs blocking operations off the dispatcher threads. Threads are started on demand, up to a
+// limit, and are kept for the next operations; once every thread is busy, operations wait in a queue.
+class ThreadPool {
+public:
+  struct Statistics {
+    size_t maxThreadCount;
+    size_t threadCount;
+    size_t busyThreadCount;
+    size_t queuedOperationCount;
+    size_t peakQueuedOperationCount;
+    uint64_t completedOperationCount;
+    // operations which had to wait in the queue because every thread was busy
+    uint64_t saturatedOperationCount;
+  };
+
+  explicit ThreadPool(size_t maxThreadCount);
+  ThreadPool(const ThreadPool&) = delete;
+  // Runs the queued operations, then joins the threads.
+  ~ThreadPool();
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // The pool RemoteContext runs its operations in.
+  static ThreadPool& shared();
+
+  Statistics getStatistics() const;
+  void submit(std::function<void()>&& operation);
+
+private:
+  void workerProcedure();
+
+  const size_t maxThreadCount;
+  mutable std::mutex mutex;
+  std::condition_variable operationAvailable;
+  std::deque<std::function<void()>> operations;
+  std::vector<std::thread> threads;
+  size_t idleThreadCount;
+  size_t busyThreadCount;
+  size_t peakQueuedOperationCount;
+  uint64_t completedOperationCount;
+  uint64_t saturatedOperationCount;
+  bool stopped;
+};
+
+}
@@ -221,6 +221,13 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
   std::atomic<bool> stopProcessing(false);
   std::atomic<size_t> emptyBlockCount(0);
 
+  {
+    std::lock_guard<std::mutex> lock(m_batchGlobalIndicesMutex);
+    m_batchGlobalIndices = BatchGlobalIndices();
+    m_batchGlobalIndices.startHeight = startHeight;
+    m_batchGlobalIndices.endHeight = startHeight + count;
+  }
+
   auto pushingThread = std::async(std::launch::async, [&] {
     for( uint32_t i = 0; i < count && !stopProcessing; ++i) {
       const auto& block = blocks[i].block;
@@ -296,6 +303,11 @@ uint32_t TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint32_t st
     }
   }
 
+  {
+    std::lock_guard<std::mutex> lock(m_batchGlobalIndicesMutex);
+    m_batchGlobalIndices = BatchGlobalIndices();
+  }
+
   if (processingError) {
     forEachSubscription([&](TransfersSubscription& sub) {
       sub.onError(processingError, startHeight);
@@ -604,6 +616,35 @@ void TransfersConsumer::processOutputs(const TransactionBlockInfo& blockInfo, Tr
 }
 
 std::error_code TransfersConsumer::getGlobalIndices(const Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices) {
+  {
+    std::lock_guard<std::mutex> lock(m_batchGlobalIndicesMutex);
+    BatchGlobalIndices& batch = m_batchGlobalIndices;
+
+    if (batch.startHeight < batch.endHeight) {
+      // one request covers every transaction of the batch, the other workers wait for it on the lock
+      if (!batch.requested) {
+        batch.requested = true;
+
+        std::error_code ec = requestGlobalIndicesForRange(batch.startHeight, batch.endHeight, batch.indices);
+        if (ec) {
+          m_logger(DEBUGGING) << "Failed to get global indexes for blocks " << batch.startHeight << " - " << batch.endHeight - 1 <<
+            ", requesting them per transaction: " << ec.message();
+          batch.indices.clear();
+        }
+      }
+
+      auto it = batch.indices.find(transactionHash);
+      if (it != batch.indices.end()) {
+        outsGlobalIndices.assign(it->second.begin(), it->second.end());
+        return std::error_code();
+      }
+    }
+  }
+
+  return requestGlobalIndices(transactionHash, outsGlobalIndices);
+}
+
+std::error_code TransfersConsumer::requestGlobalIndices(const Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices) {
   std::promise<std::error_code> prom;
   std::future<std::error_code> f = prom.get_future();
 
@@ -618,4 +659,21 @@ std::error_code TransfersConsumer::getGlobalIndices(const Hash& transactionHash,
   return f.get();
 }
 
+std::error_code TransfersConsumer::requestGlobalIndicesForRange(uint32_t startHeight, uint32_t endHeight,
+  std::unordered_map<Hash, std::vector<uint64_t>>& indices) {
+
+  std::promise<std::error_code> prom;
+  std::future<std::error_code> f = prom.get_future();
+
+  INode::Callback cb = [&prom](std::error_code ec) {
+    std::promise<std::error_code> p(std::move(prom));
+    p.set_value(ec);
+  };
+
+  indices.clear();
+  m_node.getGlobalIndexesForRange(startHeight, endHeight, indices, cb);
+
+  return f.get();
+}
+
 }
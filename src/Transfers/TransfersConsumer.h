@@ -17,6 +17,8 @@
 
 #include "IObservableImpl.h"
 
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace CryptoNote {
@@ -68,6 +70,8 @@ private:
     const std::vector<TransactionOutputInformationIn>& outputs, const std::vector<uint32_t>& globalIdxs, bool& contains, bool& updated);
 
   std::error_code getGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code requestGlobalIndices(const Crypto::Hash& transactionHash, std::vector<uint32_t>& outsGlobalIndices);
+  std::error_code requestGlobalIndicesForRange(uint32_t startHeight, uint32_t endHeight, std::unordered_map<Crypto::Hash, std::vector<uint64_t>>& indices);
 
   void updateSyncStart();
 
@@ -78,6 +82,18 @@ private:
   std::unordered_set<Crypto::PublicKey> m_spendKeys;
   std::unordered_set<Crypto::Hash> m_poolTxs;
 
+  // global output indexes of the blocks passed to onNewBlocks(), fetched with a single request
+  // by the first transaction of the batch which pays us
+  struct BatchGlobalIndices {
+    uint32_t startHeight = 0;
+    uint32_t endHeight = 0;
+    bool requested = false;
+    std::unordered_map<Crypto::Hash, std::vector<uint64_t>> indices;
+  };
+
+  std::mutex m_batchGlobalIndicesMutex;
+  BatchGlobalIndices m_batchGlobalIndices;
+
   INode& m_node;
   const CryptoNote::Currency& m_currency;
   Logging::LoggerRef m_logger;
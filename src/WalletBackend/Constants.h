@@ -30,6 +30,19 @@ namespace Constants
         0x79, 0x6f, 0x75, 0x2e
     }};
 
+    /* Follows IS_A_WALLET_IDENTIFIER in wallet files made of a snapshot and
+       a journal of changes, rather than one encrypted JSON blob. Lets us
+       tell the two formats apart before decrypting */
+    const std::array<char, 16> IS_A_JOURNAL_WALLET_IDENTIFIER =
+    {{
+        0x57, 0x61, 0x6c, 0x6c, 0x65, 0x74, 0x4a, 0x6f, 0x75, 0x72, 0x6e,
+        0x61, 0x6c, 0x20, 0x76, 0x31
+    }};
+
+    /* Once the journal records in a wallet file add up to this many bytes,
+       fold them into a new snapshot in the background */
+    const uint64_t WALLET_JOURNAL_COMPACTION_SIZE = 1024 * 1024 * 4;
+
     /* The number of iterations of PBKDF2 to perform on the wallet
        password. */
     const uint64_t PBKDF2_ITERATIONS = 500000;
@@ -62,6 +62,10 @@ void SubWallet::fromJson(const json &j)
     m_spentInputs = j.at("spentInputs").get<std::vector<WalletTypes::TransactionInput>>();
     m_syncStartHeight = j.at("syncStartHeight").get<uint64_t>();
     m_isPrimaryAddress = j.at("isPrimaryAddress").get<bool>();
+
+    /* The indexes and balances aren't stored, they are derived from the
+       inputs */
+    rebuildInputIndexes();
 }
 
 ///////////////
@@ -99,6 +103,8 @@ void SubWallets::fromJson(const json &j)
     m_lockedTransactions = j.at("lockedTransactions").get<std::vector<WalletTypes::Transaction>>();
     m_privateViewKey = j.at("privateViewKey").get<Crypto::SecretKey>();
     m_isViewWallet = j.at("isViewWallet").get<bool>();
+
+    rebuildKeyImageOwners();
 }
 
 ///////////////////
@@ -157,14 +163,7 @@ WalletError WalletBackend::fromJson(
         return error;
     }
 
-    m_filename = filename;
-    m_password = password;
-
-    m_daemon = std::make_shared<CryptoNote::NodeRpcProxy>(
-        daemonHost, daemonPort, m_logger->getLogger()
-    );
-
-    return init();
+    return initAfterLoad(filename, password, daemonHost, daemonPort);
 }
 
 /* Declaration of to_json and from_json have to be in the same namespace as
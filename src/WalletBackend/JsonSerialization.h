@@ -32,25 +32,31 @@ void from_json(const json &j, SubWallet &s);
 void to_json(json &j, const WalletBackend &w);
 void from_json(const json &j, WalletBackend &w);
 
-/* Crypto::SecretKey */
-void to_json(json &j, const Crypto::SecretKey &s);
+/* Declaration of to_json and from_json have to be in the same namespace as
+   the type itself was declared in */
+namespace Crypto
+{
+    /* Crypto::SecretKey */
+    void to_json(json &j, const SecretKey &s);
+    void from_json(const json &j, SecretKey &s);
 
-/* Crypto::PublicKey */
-void to_json(json &j, const Crypto::PublicKey &s);
+    /* Crypto::PublicKey */
+    void to_json(json &j, const PublicKey &p);
+    void from_json(const json &j, PublicKey &p);
 
-/* Crypto::Hash */
-void to_json(json &j, const Crypto::Hash &s);
+    /* Crypto::Hash */
+    void to_json(json &j, const Hash &h);
+    void from_json(const json &j, Hash &h);
 
-/* Crypto::KeyImage */
-void to_json(json &j, const Crypto::KeyImage &s);
+    /* Crypto::KeyImage */
+    void to_json(json &j, const KeyImage &k);
+    void from_json(const json &j, KeyImage &k);
+}
 
 /* CryptoNote::WalletTransaction */
 void to_json(json &j, const CryptoNote::WalletTransaction &t);
 void from_json(const json &j, CryptoNote::WalletTransaction &t);
 
-/* Crypto::Hash */
-void to_json(json &j, const Crypto::Hash &h);
-
 /* WalletSynchronizer */
 void to_json(json &j, const WalletSynchronizer &w);
 void from_json(const json &j, WalletSynchronizer &w);
@@ -63,13 +69,16 @@ void from_json(const json &j, SynchronizationStatus &s);
 void to_json(json &j, const Transfer &t);
 void from_json(const json &j, Transfer &t);
 
-/* TransactionInput */
-void to_json(json &j, const WalletTypes::TransactionInput &t);
-void from_json(const json &j, WalletTypes::TransactionInput &t);
-
-/* WalletTypes::Transaction */
-void to_json(json &j, const WalletTypes::Transaction &t);
-void from_json(const json &j, WalletTypes::Transaction &t);
+namespace WalletTypes
+{
+    /* WalletTypes::TransactionInput */
+    void to_json(json &j, const TransactionInput &t);
+    void from_json(const json &j, TransactionInput &t);
+
+    /* WalletTypes::Transaction */
+    void to_json(json &j, const Transaction &t);
+    void from_json(const json &j, Transaction &t);
+}
 
 std::vector<Transfer> transfersToVector(std::unordered_map<Crypto::PublicKey, int64_t> transfers);
 
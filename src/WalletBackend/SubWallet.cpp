@@ -6,6 +6,8 @@
 #include <WalletBackend/SubWallet.h>
 ////////////////////////////////////
 
+#include <config/CryptoNoteConfig.h>
+
 #include <CryptoNoteCore/Account.h>
 #include <CryptoNoteCore/CryptoNoteBasicImpl.h>
 
@@ -55,7 +57,7 @@ SubWallet::SubWallet(
 /* CLASS FUNCTIONS */
 /////////////////////
 
-void SubWallet::completeAndStoreTransactionInput(
+Crypto::KeyImage SubWallet::completeAndStoreTransactionInput(
     const Crypto::KeyDerivation derivation,
     const size_t outputIndex,
     WalletTypes::TransactionInput input,
@@ -90,30 +92,51 @@ void SubWallet::completeAndStoreTransactionInput(
         input.keyImage = keyImage;
     }
 
+    storeTransactionInput(input);
+
+    return input.keyImage;
+}
+
+void SubWallet::storeTransactionInput(const WalletTypes::TransactionInput input)
+{
+    if (!isViewWallet())
+    {
+        m_unspentInputIndexes[input.keyImage] = m_unspentInputs.size();
+    }
+
+    addUnspentBalance(input);
+
     m_unspentInputs.push_back(input);
 }
 
 std::tuple<uint64_t, uint64_t> SubWallet::getBalance(
     const uint64_t currentHeight) const
 {
-    uint64_t unlockedBalance = 0;
+    /* Inputs which unlocked at a greater height may be locked again at this
+       one, so start from scratch (This only happens on a fork or a rescan) */
+    if (currentHeight < m_balanceHeight)
+    {
+        const_cast<SubWallet *>(this)->rebuildInputIndexes();
+    }
 
-    uint64_t lockedBalance = 0;
+    m_balanceHeight = currentHeight;
 
-    for (const auto input : m_unspentInputs)
+    /* Move the amounts which have unlocked since the last call into the
+       unlocked balance. They are ordered by unlock time, so once we find one
+       that is still locked, the rest are too */
+    for (auto amounts : {&m_heightLockedAmounts, &m_timeLockedAmounts})
     {
-        /* If an unlock height is present, check if the input is unlocked */
-        if (Utilities::isInputUnlocked(input.unlockTime, currentHeight))
+        while (!amounts->empty()
+            && Utilities::isInputUnlocked(amounts->begin()->first, currentHeight))
         {
-            unlockedBalance += input.amount;
-        }
-        else
-        {
-            lockedBalance += input.amount;
+            m_unlockedBalance += amounts->begin()->second;
+            m_lockedBalance -= amounts->begin()->second;
+
+            amounts->erase(amounts->begin());
         }
     }
 
-    return {unlockedBalance, lockedBalance};
+    return {m_unlockedBalance, m_lockedBalance};
 }
 
 void SubWallet::reset(const uint64_t scanHeight)
@@ -133,13 +156,12 @@ void SubWallet::reset(const uint64_t scanHeight)
         return input.blockHeight >= scanHeight;
     });
 
-    if (it != m_unspentInputs.end())
-    {
-        m_unspentInputs.erase(it);
-    }
+    m_unspentInputs.erase(it, m_unspentInputs.end());
+
+    std::vector<WalletTypes::TransactionInput> returnedInputs;
 
     it = std::remove_if(m_spentInputs.begin(), m_spentInputs.end(),
-    [&scanHeight, this](auto &input)
+    [&scanHeight, &returnedInputs](auto &input)
     {
         /* Input was received after scan height, remove */
         if (input.blockHeight >= scanHeight)
@@ -153,7 +175,7 @@ void SubWallet::reset(const uint64_t scanHeight)
         {
             input.spendHeight = 0;
 
-            m_unspentInputs.push_back(input);
+            returnedInputs.push_back(input);
 
             return true;
         }
@@ -161,10 +183,11 @@ void SubWallet::reset(const uint64_t scanHeight)
         return false;
     });
 
-    if (it != m_spentInputs.end())
-    {
-        m_spentInputs.erase(it);
-    }
+    m_spentInputs.erase(it, m_spentInputs.end());
+
+    m_unspentInputs.insert(m_unspentInputs.end(), returnedInputs.begin(), returnedInputs.end());
+
+    rebuildInputIndexes();
 }
 
 bool SubWallet::isPrimaryAddress() const
@@ -194,29 +217,10 @@ std::vector<WalletTypes::TransactionInput> SubWallet::spentInput() const
 
 bool SubWallet::hasKeyImage(const Crypto::KeyImage keyImage) const
 {
-    auto it = std::find_if(m_unspentInputs.begin(), m_unspentInputs.end(),
-    [&keyImage](const auto &input)
-    {
-        return input.keyImage == keyImage;
-    });
-
-    /* Found the key image */
-    if (it != m_unspentInputs.end())
-    {
-        return true;
-    }
-
-    /* Didn't find it in unlocked inputs, check the locked inputs */
-    it = std::find_if(m_lockedInputs.begin(), m_lockedInputs.end(),
-    [&keyImage](const auto &input)
-    {
-        return input.keyImage == keyImage;
-    });
-
-    return it != m_lockedInputs.end();
-
     /* Note: We don't need to check the spent inputs - it should never show
        up there, as the same key image can only be used once */
+    return m_unspentInputIndexes.find(keyImage) != m_unspentInputIndexes.end()
+        || m_lockedInputIndexes.find(keyImage) != m_lockedInputIndexes.end();
 }
 
 Crypto::PublicKey SubWallet::publicSpendKey() const
@@ -234,43 +238,37 @@ void SubWallet::markInputAsSpent(
     const uint64_t spendHeight)
 {
     /* Find the input */
-    auto it = std::find_if(m_unspentInputs.begin(), m_unspentInputs.end(),
-    [&keyImage](const auto x)
-    {
-        return x.keyImage == keyImage;
-    });
+    auto it = m_unspentInputIndexes.find(keyImage);
 
-    if (it != m_unspentInputs.end())
+    if (it != m_unspentInputIndexes.end())
     {
+        /* Remove from the unspent vector */
+        auto input = takeInput(m_unspentInputs, m_unspentInputIndexes, it->second);
+
+        removeUnspentBalance(input);
+
         /* Set the spend height */
-        it->spendHeight = spendHeight;
+        input.spendHeight = spendHeight;
 
         /* Add to the spent inputs vector */
-        m_spentInputs.push_back(*it);
-
-        /* Remove from the unspent vector */
-        m_unspentInputs.erase(it);
+        m_spentInputs.push_back(input);
 
         return;
     }
 
     /* Didn't find it, lets try in the locked inputs */
-    it = std::find_if(m_lockedInputs.begin(), m_lockedInputs.end(),
-    [&keyImage](const auto x)
-    {
-        return x.keyImage == keyImage;
-    });
+    it = m_lockedInputIndexes.find(keyImage);
 
-    if (it != m_lockedInputs.end())
+    if (it != m_lockedInputIndexes.end())
     {
+        /* Remove from the locked vector */
+        auto input = takeInput(m_lockedInputs, m_lockedInputIndexes, it->second);
+
         /* Set the spend height */
-        it->spendHeight = spendHeight;
+        input.spendHeight = spendHeight;
 
         /* Add to the spent inputs vector */
-        m_spentInputs.push_back(*it);
-
-        /* Remove from the locked vector */
-        m_lockedInputs.erase(it);
+        m_spentInputs.push_back(input);
 
         return;
     }
@@ -282,23 +280,23 @@ void SubWallet::markInputAsSpent(
 void SubWallet::markInputAsLocked(const Crypto::KeyImage keyImage)
 {
     /* Find the input */
-    auto it = std::find_if(m_unspentInputs.begin(), m_unspentInputs.end(),
-    [&keyImage](const auto x)
-    {
-        return x.keyImage == keyImage;
-    });
+    const auto it = m_unspentInputIndexes.find(keyImage);
 
     /* Shouldn't happen */
-    if (it == m_unspentInputs.end())
+    if (it == m_unspentInputIndexes.end())
     {
         throw std::runtime_error("Could not find key image to lock!");
     }
 
-    /* Add to the spent inputs vector */
-    m_lockedInputs.push_back(*it);
-
     /* Remove from the unspent vector */
-    m_unspentInputs.erase(it);
+    const auto input = takeInput(m_unspentInputs, m_unspentInputIndexes, it->second);
+
+    removeUnspentBalance(input);
+
+    /* Add to the locked inputs vector */
+    m_lockedInputIndexes[keyImage] = m_lockedInputs.size();
+
+    m_lockedInputs.push_back(input);
 }
 
 void SubWallet::removeForkedInputs(const uint64_t forkHeight)
@@ -320,10 +318,9 @@ void SubWallet::removeForkedInputs(const uint64_t forkHeight)
         return false;
     });
 
-    if (it != m_spentInputs.end())
-    {
-        m_spentInputs.erase(it);
-    }
+    m_spentInputs.erase(it, m_spentInputs.end());
+
+    rebuildInputIndexes();
 }
 
 void SubWallet::removeCancelledTransactions(const std::unordered_set<Crypto::Hash> cancelledTransactions)
@@ -347,10 +344,9 @@ void SubWallet::removeCancelledTransactions(const std::unordered_set<Crypto::Has
     });
 
     /* Remove the inputs used in the cancelled tranactions */
-    if (it != m_lockedInputs.end())
-    {
-        m_spentInputs.erase(it);
-    }
+    m_lockedInputs.erase(it, m_lockedInputs.end());
+
+    rebuildInputIndexes();
 }
 
 std::vector<WalletTypes::TxInputAndOwner> SubWallet::getInputs() const
@@ -374,3 +370,129 @@ uint64_t SubWallet::syncStartTimestamp() const
 {
     return m_syncStartTimestamp;
 }
+
+std::vector<Crypto::KeyImage> SubWallet::getKeyImages() const
+{
+    std::vector<Crypto::KeyImage> keyImages;
+
+    for (const auto &[keyImage, index] : m_unspentInputIndexes)
+    {
+        keyImages.push_back(keyImage);
+    }
+
+    for (const auto &[keyImage, index] : m_lockedInputIndexes)
+    {
+        keyImages.push_back(keyImage);
+    }
+
+    return keyImages;
+}
+
+void SubWallet::rebuildInputIndexes()
+{
+    m_unspentInputIndexes.clear();
+    m_lockedInputIndexes.clear();
+
+    m_unlockedBalance = 0;
+    m_lockedBalance = 0;
+
+    m_heightLockedAmounts.clear();
+    m_timeLockedAmounts.clear();
+
+    /* Everything locked goes back in the locked maps, the next getBalance()
+       call will unlock it again */
+    m_balanceHeight = 0;
+
+    for (size_t i = 0; i < m_unspentInputs.size(); i++)
+    {
+        if (!isViewWallet())
+        {
+            m_unspentInputIndexes[m_unspentInputs[i].keyImage] = i;
+        }
+
+        addUnspentBalance(m_unspentInputs[i]);
+    }
+
+    if (!isViewWallet())
+    {
+        for (size_t i = 0; i < m_lockedInputs.size(); i++)
+        {
+            m_lockedInputIndexes[m_lockedInputs[i].keyImage] = i;
+        }
+    }
+}
+
+WalletTypes::TransactionInput SubWallet::takeInput(
+    std::vector<WalletTypes::TransactionInput> &inputs,
+    std::unordered_map<Crypto::KeyImage, size_t> &indexes,
+    const size_t index)
+{
+    const auto input = inputs[index];
+
+    indexes.erase(input.keyImage);
+
+    /* Fill the gap with the last input, so we don't have to shift the rest
+       of the vector down */
+    if (index != inputs.size() - 1)
+    {
+        inputs[index] = inputs.back();
+        indexes[inputs[index].keyImage] = index;
+    }
+
+    inputs.pop_back();
+
+    return input;
+}
+
+void SubWallet::addUnspentBalance(const WalletTypes::TransactionInput &input)
+{
+    if (input.unlockTime == 0)
+    {
+        m_unlockedBalance += input.amount;
+        return;
+    }
+
+    m_lockedBalance += input.amount;
+
+    lockedAmounts(input.unlockTime).emplace(input.unlockTime, input.amount);
+}
+
+void SubWallet::removeUnspentBalance(const WalletTypes::TransactionInput &input)
+{
+    auto &amounts = lockedAmounts(input.unlockTime);
+
+    const auto [begin, end] = amounts.equal_range(input.unlockTime);
+
+    const auto it = std::find_if(begin, end, [&input](const auto &amount)
+    {
+        return amount.second == input.amount;
+    });
+
+    /* Still locked */
+    if (it != end)
+    {
+        m_lockedBalance -= input.amount;
+        amounts.erase(it);
+    }
+    else
+    {
+        m_unlockedBalance -= input.amount;
+    }
+}
+
+std::multimap<uint64_t, uint64_t> &SubWallet::lockedAmounts(
+    const uint64_t unlockTime) const
+{
+    /* Same split as Utilities::isInputUnlocked() */
+    if (unlockTime >= CryptoNote::parameters::CRYPTONOTE_MAX_BLOCK_NUMBER)
+    {
+        return m_timeLockedAmounts;
+    }
+
+    return m_heightLockedAmounts;
+}
+
+bool SubWallet::isViewWallet() const
+{
+    return m_privateSpendKey == Constants::BLANK_SECRET_KEY;
+}
@@ -10,8 +10,12 @@
 
 #include "json.hpp"
 
+#include <map>
+
 #include <string>
 
+#include <unordered_map>
+
 #include <unordered_set>
 
 #include <WalletBackend/WalletErrors.h>
@@ -56,13 +60,18 @@ class SubWallet
         void fromJson(const json &j);
 
         /* Generates a key image from the derivation, and stores the
-           transaction input along with the key image filled in */
-        void completeAndStoreTransactionInput(
+           transaction input along with the key image filled in. Returns the
+           key image (unset for view wallets) */
+        Crypto::KeyImage completeAndStoreTransactionInput(
             const Crypto::KeyDerivation derivation,
             const size_t outputIndex,
             WalletTypes::TransactionInput,
             const bool isViewWallet);
 
+        /* Stores a transaction input which already has its key image filled
+           in (if we're not a view wallet) */
+        void storeTransactionInput(const WalletTypes::TransactionInput input);
+
         std::tuple<uint64_t, uint64_t> getBalance(
             const uint64_t currentHeight) const;
 
@@ -96,6 +105,9 @@ class SubWallet
 
         std::vector<WalletTypes::TransactionInput> spentInput() const;
 
+        /* The key images of the unspent and locked inputs */
+        std::vector<Crypto::KeyImage> getKeyImages() const;
+
         uint64_t syncStartHeight() const;
 
         uint64_t syncStartTimestamp() const;
@@ -106,6 +118,34 @@ class SubWallet
 
     private:
 
+        //////////////////////////////
+        /* Private member functions */
+        //////////////////////////////
+
+        /* Recomputes the key image indexes and the cached balances from
+           the inputs */
+        void rebuildInputIndexes();
+
+        /* Removes the input at the given index by moving the last input into
+           its place, and returns it */
+        WalletTypes::TransactionInput takeInput(
+            std::vector<WalletTypes::TransactionInput> &inputs,
+            std::unordered_map<Crypto::KeyImage, size_t> &indexes,
+            const size_t index);
+
+        void addUnspentBalance(const WalletTypes::TransactionInput &input);
+
+        void removeUnspentBalance(const WalletTypes::TransactionInput &input);
+
+        std::multimap<uint64_t, uint64_t> &lockedAmounts(
+            const uint64_t unlockTime) const;
+
+        bool isViewWallet() const;
+
+        //////////////////////////////
+        /* Private member variables */
+        //////////////////////////////
+
         /* A vector of the stored transaction input data, to be used for
            sending transactions later */
         std::vector<WalletTypes::TransactionInput> m_unspentInputs;
@@ -136,4 +176,25 @@ class SubWallet
         /* The wallet has one 'main' address which we will use by default
            when treating it as a single user wallet */
         bool m_isPrimaryAddress;
+
+        /* The position of each input in m_unspentInputs and m_lockedInputs,
+           by key image. Empty for view wallets, which have no key images */
+        std::unordered_map<Crypto::KeyImage, size_t> m_unspentInputIndexes;
+
+        std::unordered_map<Crypto::KeyImage, size_t> m_lockedInputIndexes;
+
+        /* The balance of the unspent inputs, kept up to date as inputs are
+           added and removed, so it doesn't need summing on every call */
+        mutable uint64_t m_unlockedBalance = 0;
+
+        mutable uint64_t m_lockedBalance = 0;
+
+        /* The amounts in m_lockedBalance, by the height or timestamp they
+           unlock at. They move to m_unlockedBalance as they unlock */
+        mutable std::multimap<uint64_t, uint64_t> m_heightLockedAmounts;
+
+        mutable std::multimap<uint64_t, uint64_t> m_timeLockedAmounts;
+
+        /* The highest height the balance has been unlocked at */
+        mutable uint64_t m_balanceHeight = 0;
 };
@@ -16,6 +16,7 @@
 
 #include <random>
 
+#include <WalletBackend/JsonSerialization.h>
 #include <WalletBackend/Utilities.h>
 
 ///////////////////////////////////
@@ -79,6 +80,7 @@ SubWallets::SubWallets(const SubWallets &other) :
     m_lockedTransactions(other.m_lockedTransactions),
     m_privateViewKey(other.m_privateViewKey),
     m_isViewWallet(other.m_isViewWallet),
+    m_keyImageOwners(other.m_keyImageOwners),
     m_publicSpendKeys(other.m_publicSpendKeys)
 {
 }
@@ -115,6 +117,8 @@ WalletError SubWallets::addSubWallet()
         Utilities::getCurrentTimestampAdjusted(), isPrimaryAddress
     );
 
+    m_journalComplete = false;
+
     return SUCCESS;
 }
 
@@ -155,6 +159,8 @@ WalletError SubWallets::importSubWallet(
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    m_journalComplete = false;
+
     return SUCCESS;
 }
 
@@ -194,6 +200,8 @@ WalletError SubWallets::importViewSubWallet(
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    m_journalComplete = false;
+
     return SUCCESS;
 }
 
@@ -254,6 +262,11 @@ void SubWallets::addUnconfirmedTransaction(const WalletTypes::Transaction tx)
     std::scoped_lock lock(m_mutex);
 
     m_lockedTransactions.push_back(tx);
+
+    m_journal.push_back({
+        {"type", "unconfirmedTransaction"},
+        {"transaction", tx}
+    });
 }
 
 void SubWallets::addTransaction(const WalletTypes::Transaction tx)
@@ -277,6 +290,11 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
     }
 
     m_transactions.push_back(tx);
+
+    m_journal.push_back({
+        {"type", "transaction"},
+        {"transaction", tx}
+    });
 }
 
 void SubWallets::completeAndStoreTransactionInput(
@@ -293,9 +311,20 @@ void SubWallets::completeAndStoreTransactionInput(
     if (it != m_subWallets.end())
     {
         /* If we have a view wallet, don't attempt to derive the key image */
-        it->second.completeAndStoreTransactionInput(
+        input.keyImage = it->second.completeAndStoreTransactionInput(
             derivation, outputIndex, input, m_isViewWallet
         );
+
+        if (!m_isViewWallet)
+        {
+            m_keyImageOwners[input.keyImage] = publicSpendKey;
+        }
+
+        m_journal.push_back({
+            {"type", "input"},
+            {"publicSpendKey", publicSpendKey},
+            {"input", input}
+        });
     }
 }
 
@@ -310,12 +339,11 @@ std::tuple<bool, Crypto::PublicKey>
 
     std::scoped_lock lock(m_mutex);
 
-    for (const auto & [publicKey, subWallet] : m_subWallets)
+    const auto it = m_keyImageOwners.find(keyImage);
+
+    if (it != m_keyImageOwners.end())
     {
-        if (subWallet.hasKeyImage(keyImage))
-        {
-            return {true, subWallet.publicSpendKey()};
-        }
+        return {true, it->second};
     }
 
     return {false, Crypto::PublicKey()};
@@ -574,6 +602,15 @@ void SubWallets::markInputAsSpent(
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsSpent(keyImage, spendHeight);
+
+    m_keyImageOwners.erase(keyImage);
+
+    m_journal.push_back({
+        {"type", "spend"},
+        {"keyImage", keyImage},
+        {"publicSpendKey", publicKey},
+        {"spendHeight", spendHeight}
+    });
 }
 
 /* Mark a key image as locked, can no longer be used in transactions till it
@@ -589,6 +626,12 @@ void SubWallets::markInputAsLocked(
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsLocked(keyImage);
+
+    m_journal.push_back({
+        {"type", "lock"},
+        {"keyImage", keyImage},
+        {"publicSpendKey", publicKey}
+    });
 }
 
 /* Remove transactions and key images that occured on a forked chain */
@@ -603,16 +646,21 @@ void SubWallets::removeForkedTransactions(uint64_t forkHeight)
         return tx.blockHeight >= forkHeight;
     });
 
-    if (it != m_transactions.end())
-    {
-        m_transactions.erase(it);
-    }
+    m_transactions.erase(it, m_transactions.end());
 
     /* Loop through each subwallet */
     for (auto & [publicKey, subWallet] : m_subWallets)
     {
         subWallet.removeForkedInputs(forkHeight);
     }
+
+    /* Spent inputs may have been returned */
+    rebuildKeyImageOwners();
+
+    m_journal.push_back({
+        {"type", "fork"},
+        {"forkHeight", forkHeight}
+    });
 }
 
 void SubWallets::removeCancelledTransactions(
@@ -630,16 +678,18 @@ void SubWallets::removeCancelledTransactions(
         return cancelledTransactions.find(tx.hash) != cancelledTransactions.end();
     });
 
-    if (it != m_lockedTransactions.end())
-    {
-        /* Remove the cancelled transactions */
-        m_lockedTransactions.erase(it);
-    }
+    /* Remove the cancelled transactions */
+    m_lockedTransactions.erase(it, m_lockedTransactions.end());
 
     for (auto &[pubKey, subWallet] : m_subWallets)
     {
         subWallet.removeCancelledTransactions(cancelledTransactions);
     }
+
+    m_journal.push_back({
+        {"type", "cancel"},
+        {"transactionHashes", cancelledTransactions}
+    });
 }
 
 Crypto::SecretKey SubWallets::getPrivateViewKey() const
@@ -672,6 +722,25 @@ void SubWallets::throwIfViewWallet() const
     }
 }
 
+void SubWallets::rebuildKeyImageOwners()
+{
+    m_keyImageOwners.clear();
+
+    /* View wallets don't have key images */
+    if (m_isViewWallet)
+    {
+        return;
+    }
+
+    for (const auto &[publicKey, subWallet] : m_subWallets)
+    {
+        for (const auto &keyImage : subWallet.getKeyImages())
+        {
+            m_keyImageOwners[keyImage] = publicKey;
+        }
+    }
+}
+
 bool SubWallets::isViewWallet() const
 {
     return m_isViewWallet;
@@ -693,15 +762,16 @@ void SubWallets::reset(const uint64_t scanHeight)
         return tx.blockHeight >= scanHeight;
     });
 
-    if (it != m_transactions.end())
-    {
-        m_transactions.erase(it);
-    }
+    m_transactions.erase(it, m_transactions.end());
 
     for (auto &[pubKey, subWallet] : m_subWallets)
     {
         subWallet.reset(scanHeight);
     }
+
+    rebuildKeyImageOwners();
+
+    m_journalComplete = false;
 }
 
 std::vector<Crypto::SecretKey> SubWallets::getPrivateSpendKeys() const
@@ -746,3 +816,96 @@ std::vector<WalletTypes::Transaction> SubWallets::getUnconfirmedTransactions() c
 {
     return m_lockedTransactions;
 }
+
+std::tuple<bool, json, std::shared_ptr<SubWallets>> SubWallets::takeJournal(
+    const bool takeSnapshot)
+{
+    std::scoped_lock lock(m_mutex);
+
+    const bool journalComplete = m_journalComplete;
+
+    json journal = json::array();
+
+    std::swap(journal, m_journal);
+
+    m_journalComplete = true;
+
+    /* The copy constructor doesn't lock other, we're holding it. If we copied
+       after unlocking, a change could end up both in the copy and the next
+       journal, and replaying it twice fails when the wallet is opened */
+    std::shared_ptr<SubWallets> snapshot;
+
+    if (takeSnapshot || !journalComplete)
+    {
+        snapshot = std::make_shared<SubWallets>(*this);
+    }
+
+    return {journalComplete, journal, snapshot};
+}
+
+void SubWallets::replayJournal(const json &journal)
+{
+    /* These are the same calls that made the changes originally, so they
+       leave the wallet in the same state */
+    for (const auto &change : journal)
+    {
+        const std::string type = change.at("type").get<std::string>();
+
+        if (type == "input")
+        {
+            std::scoped_lock lock(m_mutex);
+
+            const auto publicSpendKey = change.at("publicSpendKey").get<Crypto::PublicKey>();
+            const auto input = change.at("input").get<WalletTypes::TransactionInput>();
+
+            m_subWallets.at(publicSpendKey).storeTransactionInput(input);
+
+            if (!m_isViewWallet)
+            {
+                m_keyImageOwners[input.keyImage] = publicSpendKey;
+            }
+        }
+        else if (type == "spend")
+        {
+            markInputAsSpent(
+                change.at("keyImage").get<Crypto::KeyImage>(),
+                change.at("publicSpendKey").get<Crypto::PublicKey>(),
+                change.at("spendHeight").get<uint64_t>()
+            );
+        }
+        else if (type == "lock")
+        {
+            markInputAsLocked(
+                change.at("keyImage").get<Crypto::KeyImage>(),
+                change.at("publicSpendKey").get<Crypto::PublicKey>()
+            );
+        }
+        else if (type == "transaction")
+        {
+            addTransaction(change.at("transaction").get<WalletTypes::Transaction>());
+        }
+        else if (type == "unconfirmedTransaction")
+        {
+            addUnconfirmedTransaction(change.at("transaction").get<WalletTypes::Transaction>());
+        }
+        else if (type == "fork")
+        {
+            removeForkedTransactions(change.at("forkHeight").get<uint64_t>());
+        }
+        else if (type == "cancel")
+        {
+            removeCancelledTransactions(
+                change.at("transactionHashes").get<std::unordered_set<Crypto::Hash>>()
+            );
+        }
+        else
+        {
+            throw std::runtime_error("Unknown wallet journal entry: " + type);
+        }
+    }
+
+    /* Replaying recorded the changes again, they're already on disk */
+    std::scoped_lock lock(m_mutex);
+
+    m_journal = json::array();
+}
@@ -6,6 +6,8 @@
 
 #include <crypto/crypto.h>
 
+#include <memory>
+
 #include <WalletBackend/SubWallet.h>
 
 class SubWallets
@@ -148,6 +150,22 @@ class SubWallets
            block yet. */
         std::vector<WalletTypes::Transaction> getUnconfirmedTransactions() const;
 
+        /* Takes the changes made since the last call, so they can be
+           appended to the wallet file. Returns false if a change was made
+           which isn't journaled (Adding a subwallet, resetting), in which
+           case the whole wallet needs saving.
+
+           If takeSnapshot is set, or the journal is incomplete, also returns
+           a copy of the wallet made under the same lock, so it holds exactly
+           the changes taken, and none of the ones the next call will take.
+           Otherwise the copy is a nullptr. */
+        std::tuple<bool, json, std::shared_ptr<SubWallets>> takeJournal(
+            const bool takeSnapshot);
+
+        /* Applies changes returned by takeJournal() to a freshly loaded
+           wallet */
+        void replayJournal(const json &journal);
+
         /////////////////////////////
         /* Public member variables */
         /////////////////////////////
@@ -164,6 +182,9 @@ class SubWallets
 
         void throwIfViewWallet() const;
 
+        /* Recomputes m_keyImageOwners from the subwallets inputs */
+        void rebuildKeyImageOwners();
+
         //////////////////////////////
         /* Private member variables */
         //////////////////////////////
@@ -181,6 +202,16 @@ class SubWallets
 
         bool m_isViewWallet;
 
+        /* The subwallet owning each unspent or locked key image, so we don't
+           have to ask every subwallet when checking an input */
+        std::unordered_map<Crypto::KeyImage, Crypto::PublicKey> m_keyImageOwners;
+
+        /* The changes made since takeJournal() was last called */
+        json m_journal = json::array();
+
+        /* Whether m_journal holds every change made since it was taken */
+        bool m_journalComplete = true;
+
         /* Need a mutex for accessing inputs, transactions, and locked
            transactions, etc as these are modified on multiple threads */
         mutable std::mutex m_mutex;
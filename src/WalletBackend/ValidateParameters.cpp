@@ -7,6 +7,9 @@
 /////////////////////////////////////////////
 
 #include <Common/Base58.h>
+#include <Common/StringTools.h>
+
+#include <cstring>
 
 #include <config/CryptoNoteConfig.h>
 #include <config/WalletConfig.h>
@@ -259,10 +262,12 @@ WalletError validateDestinations(
 }
 
 WalletError validateAddresses(
-    std::vector<std::string> addresses,
+    const std::vector<std::string> &addresses,
     const bool integratedAddressesAllowed)
 {
-    for (auto &address : addresses)
+    const size_t paymentIDLength = 64;
+
+    for (const auto &address : addresses)
     {
         /* Address is the wrong length */
         if (address.length() != WalletConfig::standardAddressLength &&
@@ -297,49 +302,54 @@ WalletError validateAddresses(
                 );
             }
 
-            std::string decoded;
+            /* The payment ID in hex, followed by the binary public keys */
+            uint8_t decoded[paymentIDLength + sizeof(Crypto::PublicKey) * 2];
+            size_t decodedSize;
 
             /* Don't need this */
             uint64_t ignore;
 
-            if (!Tools::Base58::decode_addr(address, ignore, decoded))
+            if (!Tools::Base58::decode_addr(
+                    address, ignore, decoded, sizeof(decoded), decodedSize))
             {
                 return ADDRESS_NOT_BASE58;
             }
 
-            const uint64_t paymentIDLen = 64;
-
-            /* Grab the payment ID from the decoded address */
-            std::string paymentID = decoded.substr(0, paymentIDLen);
-
-            std::vector<uint8_t> extra;
-
-            /* Verify the extracted payment ID is valid */
-            if (!CryptoNote::createTxExtraWithPaymentId(paymentID, extra))
+            if (decodedSize < paymentIDLength)
             {
                 return INTEGRATED_ADDRESS_PAYMENT_ID_INVALID;
             }
 
-            /* The binary array encoded keys are the rest of the address */
-            std::string keys = decoded.substr(paymentIDLen, std::string::npos);
+            /* Verify the extracted payment ID is valid hex */
+            for (size_t i = 0; i < paymentIDLength; i++)
+            {
+                uint8_t ignoreNibble;
+
+                if (!Common::fromHex(static_cast<char>(decoded[i]), ignoreNibble))
+                {
+                    return INTEGRATED_ADDRESS_PAYMENT_ID_INVALID;
+                }
+            }
+
+            Crypto::PublicKey spendKey;
+            Crypto::PublicKey viewKey;
 
-            /* Convert keys as string to binary array */
-            CryptoNote::BinaryArray ba = Common::asBinaryArray(keys);
+            /* The keys are the rest of the address - verify them directly
+               rather than re-encoding them as a standard address */
+            if (decodedSize != sizeof(decoded))
+            {
+                return ADDRESS_NOT_VALID;
+            }
 
-            CryptoNote::AccountPublicAddress addr;
+            std::memcpy(&spendKey, decoded + paymentIDLength, sizeof(spendKey));
+            std::memcpy(&viewKey, decoded + paymentIDLength + sizeof(spendKey), sizeof(viewKey));
 
-            /* Convert from binary array to public keys */
-            if (!CryptoNote::fromBinaryArray(addr, ba))
+            if (!Crypto::check_key(spendKey) || !Crypto::check_key(viewKey))
             {
                 return ADDRESS_NOT_VALID;
             }
 
-            /* Convert the set of extracted keys back into an address, then
-               verify that as a normal address */
-            address = CryptoNote::getAccountAddressAsStr(
-                CryptoNote::parameters::CRYPTONOTE_PUBLIC_ADDRESS_BASE58_PREFIX,
-                addr
-            );
+            continue;
         }
 
         /* Not used */
@@ -49,7 +49,7 @@ WalletError validateDestinations(
     const std::vector<std::pair<std::string, uint64_t>> destinations);
 
 WalletError validateAddresses(
-    std::vector<std::string> addresses,
+    const std::vector<std::string> &addresses,
     const bool integratedAddressesAllowed);
 
 WalletError validateOurAddresses(
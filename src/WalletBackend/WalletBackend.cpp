@@ -15,13 +15,6 @@
 #include <CryptoNoteCore/CryptoNoteTools.h>
 #include <CryptoNoteCore/CryptoNoteBasicImpl.h>
 
-#include <cryptopp/aes.h>
-#include <cryptopp/algparam.h>
-#include <cryptopp/filters.h>
-#include <cryptopp/modes.h>
-#include <cryptopp/sha.h>
-#include <cryptopp/pwdbased.h>
-
 #include <fstream>
 
 #include <future>
@@ -48,32 +41,6 @@ using json = nlohmann::json;
 /* Anonymous namespace so it doesn't clash with anything else */
 namespace {
 
-/* Check data has the magic indicator from first : last, and remove it if
-   it does. Else, return an error depending on where we failed */
-template <class Buffer, class Identifier>
-WalletError hasMagicIdentifier(
-    Buffer &data,
-    const Identifier &identifier,
-    const WalletError tooSmallError,
-    const WalletError wrongIdentifierError)
-{
-    /* Check we've got space for the identifier */
-    if (data.size() < identifier.size())
-    {
-        return tooSmallError;
-    }
-
-    if (!std::equal(identifier.begin(), identifier.end(), data.begin()))
-    {
-        return wrongIdentifierError;
-    }
-
-    /* Remove the identifier from the string */
-    data.erase(data.begin(), data.begin() + identifier.size());
-
-    return SUCCESS;
-}
-
 /* Check the wallet filename for the new wallet to be created is valid */
 WalletError checkNewWalletFilename(std::string filename)
 {
@@ -140,7 +107,8 @@ WalletBackend::WalletBackend(
     const uint16_t daemonPort) :
 
     m_filename(filename),
-    m_password(password)
+    m_password(password),
+    m_walletFile(std::make_shared<WalletFile>(filename, password))
 {
     m_logManager = std::make_shared<Logging::LoggerManager>();
 
@@ -175,7 +143,8 @@ WalletBackend::WalletBackend(
     const uint16_t daemonPort) :
 
     m_filename(filename),
-    m_password(password)
+    m_password(password),
+    m_walletFile(std::make_shared<WalletFile>(filename, password))
 {
     m_logManager = std::make_shared<Logging::LoggerManager>();
 
@@ -419,88 +388,9 @@ std::tuple<WalletError, std::shared_ptr<WalletBackend>> WalletBackend::openWalle
     const std::string daemonHost,
     const uint16_t daemonPort)
 {
-    /* Open in binary mode, since we have encrypted data */
-    std::ifstream file(filename, std::ios_base::binary);
-
-    /* Check we successfully opened the file */
-    if (!file)
-    {
-        return {FILENAME_NON_EXISTENT, nullptr}; 
-    }
-
-    /* Read file into a buffer */
-    std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
-                             (std::istreambuf_iterator<char>()));
-
-    /* Check that the decrypted data has the 'isAWallet' identifier,
-       and remove it it does. If it doesn't, return an error. */
-    WalletError error = hasMagicIdentifier(
-        buffer, Constants::IS_A_WALLET_IDENTIFIER,
-        NOT_A_WALLET_FILE, NOT_A_WALLET_FILE
-    );
-
-    if (error)
-    {
-        return {error, nullptr}; 
-    }
-
-    using namespace CryptoPP;
-
-    /* The salt we use for both PBKDF2, and AES decryption */
-    byte salt[16];
-
-    /* Check the file is large enough for the salt */
-    if (buffer.size() < sizeof(salt))
-    {
-        return {WALLET_FILE_CORRUPTED, nullptr};
-    }
-
-    /* Copy the salt to the salt array */
-    std::copy(buffer.begin(), buffer.begin() + sizeof(salt), salt);
-
-    /* Remove the salt, don't need it anymore */
-    buffer.erase(buffer.begin(), buffer.begin() + sizeof(salt));
-
-    /* The key we use for AES decryption, generated with PBKDF2 */
-    byte key[16];
-
-    /* Using SHA256 as the algorithm */
-    PKCS5_PBKDF2_HMAC<SHA256> pbkdf2;
-
-    /* Generate the AES Key using pbkdf2 */
-    pbkdf2.DeriveKey(
-        key, sizeof(key), 0, (byte *)password.c_str(),
-        password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS
-    );
-
-    CBC_Mode<AES>::Decryption cbcDecryption;
-
-    /* Initialize our decrypter with the key and salt/iv */
-    cbcDecryption.SetKeyWithIV(key, sizeof(key), salt);
-
-    /* This will store the decrypted data */
-    std::string decryptedData;
-
-    try
-    {
-        /* Decrypt, handling padding */
-        StringSource((byte *)buffer.data(), buffer.size(), true, new StreamTransformationFilter(
-            cbcDecryption, new StringSink(decryptedData))
-        );
-    }
-    /* do NOT report an alternate error for invalid padding. It allows them
-       to do a padding oracle attack, I believe. Just report the wrong password
-       error. */
-    catch (const CryptoPP::Exception &)
-    {
-        return {WRONG_PASSWORD, nullptr};
-    }
-
-    /* Check that the decrypted data has the 'isCorrectPassword' identifier,
-       and remove it it does. If it doesn't, return an error. */
-    error = hasMagicIdentifier(
-        decryptedData, Constants::IS_CORRECT_PASSWORD_IDENTIFIER,
-        WALLET_FILE_CORRUPTED, WRONG_PASSWORD
+    /* Decrypts the file, deriving the key we'll use to save it again */
+    const auto [error, walletFile, walletJson, journal] = WalletFile::open(
+        filename, password
     );
 
     if (error)
@@ -510,17 +400,30 @@ std::tuple<WalletError, std::shared_ptr<WalletBackend>> WalletBackend::openWalle
 
     try
     {
-        /* Parse the json */
-        const json walletJson = json::parse(decryptedData);
-
         /* Make our wallet object */
         const auto wallet = std::make_shared<WalletBackend>();
 
         /* Initialize it from the json (We could do this in less steps, but it
            requires a move/copy constructor) */
-        error = wallet->fromJson(
-            walletJson, filename, password, daemonHost, daemonPort
-        );
+        if (WalletError loadError = wallet->fromJson(walletJson); loadError != SUCCESS)
+        {
+            return {loadError, wallet};
+        }
+
+        /* Apply the changes saved since the snapshot was taken */
+        for (const auto &record : journal)
+        {
+            wallet->m_subWallets->replayJournal(record.at("subWallets"));
+        }
+
+        if (!journal.empty())
+        {
+            wallet->m_walletSynchronizer = std::make_shared<WalletSynchronizer>(
+                journal.back().at("walletSynchronizer").get<WalletSynchronizer>()
+            );
+        }
+
+        wallet->m_walletFile = walletFile;
 
         const bool dumpJson = false;
 
@@ -529,12 +432,16 @@ std::tuple<WalletError, std::shared_ptr<WalletBackend>> WalletBackend::openWalle
         {
             std::ofstream o("walletData.json");
 
-            o << std::setw(4) << walletJson << std::endl;
+            o << std::setw(4) << wallet->toJson() << std::endl;
         }
 
-        return {error, wallet};
+        return {
+            wallet->initAfterLoad(filename, password, daemonHost, daemonPort),
+            wallet
+        };
     }
-    catch (const json::parse_error &)
+    /* The records checksummed fine, so this is a bug, or tampering */
+    catch (const std::exception &)
     {
         return {WALLET_FILE_CORRUPTED, nullptr};
     }
@@ -602,6 +509,27 @@ WalletError WalletBackend::init()
     return returnCode;
 }
 
+WalletError WalletBackend::initAfterLoad(
+    const std::string filename,
+    const std::string password,
+    const std::string daemonHost,
+    const uint16_t daemonPort)
+{
+    m_filename = filename;
+    m_password = password;
+
+    if (m_walletFile == nullptr)
+    {
+        m_walletFile = std::make_shared<WalletFile>(filename, password);
+    }
+
+    m_daemon = std::make_shared<CryptoNote::NodeRpcProxy>(
+        daemonHost, daemonPort, m_logger->getLogger()
+    );
+
+    return init();
+}
+
 WalletError WalletBackend::save() const
 {
     /* Stop the wallet synchronizer, so we're not in an invalid state */
@@ -625,77 +553,74 @@ WalletError WalletBackend::save() const
    blockchain synchronizer first (Call save()) */
 WalletError WalletBackend::unsafeSave() const
 {
-    /* Add an identifier to the start of the string so we can verify the wallet
-       has been correctly decrypted */
-    std::string identiferAsString(
-        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(),
-        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end()
-    );
-
-    /* Serialize wallet to json */
-    json walletJson = *this;
+    const bool needsSnapshot = m_walletFile->needsSnapshot();
 
-    /* Add magic identifier, and get json as a string */
-    std::string walletData = identiferAsString + walletJson.dump();
+    /* Fold the journal into a new snapshot once it gets large */
+    const bool compact = m_walletFile->journalSize() >= Constants::WALLET_JOURNAL_COMPACTION_SIZE;
 
-    using namespace CryptoPP;
-
-    /* The key we use for AES encryption, generated with PBKDF2 */
-    byte key[16];
-
-    /* The salt we use for both PBKDF2, and AES Encryption */
-    byte salt[16];
-
-    /* Generate 16 random bytes for the salt */
-    Crypto::generate_random_bytes(16, salt);
-
-    /* Using SHA256 as the algorithm */
-    PKCS5_PBKDF2_HMAC<SHA256> pbkdf2;
-
-    /* Generate the AES Key using pbkdf2 */
-    pbkdf2.DeriveKey(
-        key, sizeof(key), 0, (byte *)m_password.c_str(),
-        m_password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS
+    /* The copy of the wallet is taken along with the journal, since sends
+       from the wallet api can change it while the synchronizer is stopped */
+    const auto [journalComplete, journal, subWallets] = m_subWallets->takeJournal(
+        needsSnapshot || compact
     );
 
-    CBC_Mode<AES>::Encryption cbcEncryption;
+    const json walletSynchronizer = *m_walletSynchronizer;
 
-    /* Initialize our encryptor with the key and salt/iv */
-    cbcEncryption.SetKeyWithIV(key, sizeof(key), salt);
+    const auto takeSnapshot = [subWallets = subWallets, walletSynchronizer]
+    {
+        return json
+        {
+            {"walletFileFormatVersion", Constants::WALLET_FILE_FORMAT_VERSION},
+            {"subWallets", subWallets->toJson()},
+            {"walletSynchronizer", walletSynchronizer}
+        };
+    };
 
-    /* This will store the encrypted data */
-    std::string encryptedData;
+    /* Rewrite the whole wallet if we have to, otherwise just append what
+       has changed since the last save */
+    if (!journalComplete || needsSnapshot)
+    {
+        return m_walletFile->writeSnapshot(takeSnapshot());
+    }
 
-    /* Encrypt, and pad */
-    StringSource(walletData, true, new StreamTransformationFilter(
-        cbcEncryption, new StringSink(encryptedData))
-    );
+    const json record
+    {
+        {"subWallets", journal},
+        {"walletSynchronizer", walletSynchronizer}
+    };
 
-    std::ofstream file(m_filename, std::ios_base::binary);
+    if (WalletError error = m_walletFile->appendRecord(record); error != SUCCESS)
+    {
+        return error;
+    }
 
-    if (!file)
+    /* The copy holds the record we just appended, serialize and write it in
+       the background */
+    if (compact)
     {
-        return INVALID_WALLET_FILENAME;
+        m_walletFile->compact(takeSnapshot);
     }
 
-    std::string saltString = std::string(salt, salt + sizeof(salt));
+    return SUCCESS;
+}
 
-    /* Write the isAWalletIdentifier to the file, so when we open it we can
-       verify that it is a wallet file */
-    std::copy(Constants::IS_A_WALLET_IDENTIFIER.begin(),
-              Constants::IS_A_WALLET_IDENTIFIER.end(),
-              std::ostreambuf_iterator<char>(file));
+WalletError WalletBackend::exportJsonWallet(const std::string filename) const
+{
+    /* Stop the wallet synchronizer, so we're not in an invalid state */
+    if (m_walletSynchronizer != nullptr)
+    {
+        m_walletSynchronizer->stop();
+    }
 
-    /* Write the salt to the file, so we can use it to unencrypt the file
-       later. Note that the salt is unencrypted. */
-    std::copy(std::begin(salt), std::end(salt),
-              std::ostreambuf_iterator<char>(file));
+    WalletError error = WalletFile::saveJsonWallet(filename, m_password, toJson());
 
-    /* Write the encrypted wallet data to the file */
-    std::copy(encryptedData.begin(), encryptedData.end(),
-              std::ostreambuf_iterator<char>(file));
+    /* Continue syncing */
+    if (m_walletSynchronizer != nullptr)
+    {
+        m_walletSynchronizer->start();
+    }
 
-    return SUCCESS;
+    return error;
 }
 
 /* Get the balance for one subwallet (error, unlocked, locked) */
@@ -945,6 +870,10 @@ WalletError WalletBackend::changePassword(const std::string newPassword)
 
     m_password = newPassword;
 
+    /* Derive a key for the new password. This makes the next save write a
+       new snapshot, encrypted with it */
+    m_walletFile = std::make_shared<WalletFile>(m_filename, newPassword);
+
     return save();
 }
 
@@ -20,6 +20,7 @@
 
 #include <WalletBackend/SubWallets.h>
 #include <WalletBackend/WalletErrors.h>
+#include <WalletBackend/WalletFile.h>
 #include <WalletBackend/WalletSynchronizer.h>
 
 using nlohmann::json;
@@ -111,9 +112,16 @@ class WalletBackend
         /* Public member functions */
         /////////////////////////////
 
-        /* Save the wallet to disk */
+        /* Save the wallet to disk. A wallet opened from a JSON wallet file is
+           converted to the snapshot and journal format in place on its first
+           save, after which older versions report WRONG_PASSWORD for it,
+           rather than an unsupported format */
         WalletError save() const;
 
+        /* Save a copy of the wallet to filename, in the JSON wallet file
+           format, so older versions can open it (zedwallet++ export_json) */
+        WalletError exportJsonWallet(const std::string filename) const;
+
         /* Converts the class to a json object */
         json toJson() const;
 
@@ -269,6 +277,13 @@ class WalletBackend
 
         WalletError init();
 
+        /* Inits the stuff we can't init from the json */
+        WalletError initAfterLoad(
+            const std::string filename,
+            const std::string password,
+            const std::string daemonHost,
+            const uint16_t daemonPort);
+
         //////////////////////////////
         /* Private member variables */
         //////////////////////////////
@@ -279,6 +294,10 @@ class WalletBackend
         /* The password the wallet is encrypted with */
         std::string m_password;
 
+        /* The wallet file on disk, holding the key derived from the
+           password */
+        std::shared_ptr<WalletFile> m_walletFile;
+
         /* The sub wallets container (Using a shared_ptr here so
            the WalletSynchronizer has access to it) */
         std::shared_ptr<SubWallets> m_subWallets;
@@ -0,0 +1,714 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+/////////////////////////////////////
+#include <WalletBackend/WalletFile.h>
+/////////////////////////////////////
+
+#include <Common/FileSystemShim.h>
+
+#include <crypto/crypto.h>
+#include <crypto/hash.h>
+
+#include <cryptopp/aes.h>
+#include <cryptopp/algparam.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/sha.h>
+#include <cryptopp/pwdbased.h>
+
+#include <WalletBackend/Constants.h>
+
+//////////////////////////
+/* NON MEMBER FUNCTIONS */
+//////////////////////////
+
+/* Anonymous namespace so it doesn't clash with anything else */
+namespace {
+
+/* Record layout: a 4 byte little endian length, then the IV, the encrypted
+   data, and a hash of the IV and encrypted data */
+const size_t RECORD_LENGTH_SIZE = 4;
+
+const size_t RECORD_IV_SIZE = 16;
+
+const size_t RECORD_CHECKSUM_SIZE = sizeof(Crypto::Hash);
+
+/* Check data has the magic indicator from first : last, and remove it if
+   it does. Else, return an error depending on where we failed */
+template <class Buffer, class Identifier>
+WalletError hasMagicIdentifier(
+    Buffer &data,
+    const Identifier &identifier,
+    const WalletError tooSmallError,
+    const WalletError wrongIdentifierError)
+{
+    /* Check we've got space for the identifier */
+    if (data.size() < identifier.size())
+    {
+        return tooSmallError;
+    }
+
+    if (!std::equal(identifier.begin(), identifier.end(), data.begin()))
+    {
+        return wrongIdentifierError;
+    }
+
+    /* Remove the identifier from the string */
+    data.erase(data.begin(), data.begin() + identifier.size());
+
+    return SUCCESS;
+}
+
+/* Decrypts the contents of a JSON wallet file, following the
+   IS_A_WALLET_IDENTIFIER */
+std::tuple<WalletError, json> decryptJsonWallet(
+    std::vector<char> buffer,
+    const std::string password)
+{
+    using namespace CryptoPP;
+
+    /* The salt we use for both PBKDF2, and AES decryption */
+    byte salt[16];
+
+    /* Check the file is large enough for the salt */
+    if (buffer.size() < sizeof(salt))
+    {
+        return {WALLET_FILE_CORRUPTED, json()};
+    }
+
+    /* Copy the salt to the salt array */
+    std::copy(buffer.begin(), buffer.begin() + sizeof(salt), salt);
+
+    /* Remove the salt, don't need it anymore */
+    buffer.erase(buffer.begin(), buffer.begin() + sizeof(salt));
+
+    /* The key we use for AES decryption, generated with PBKDF2 */
+    byte key[16];
+
+    /* Using SHA256 as the algorithm */
+    PKCS5_PBKDF2_HMAC<SHA256> pbkdf2;
+
+    /* Generate the AES Key using pbkdf2 */
+    pbkdf2.DeriveKey(
+        key, sizeof(key), 0, (byte *)password.c_str(),
+        password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS
+    );
+
+    CBC_Mode<AES>::Decryption cbcDecryption;
+
+    /* Initialize our decrypter with the key and salt/iv */
+    cbcDecryption.SetKeyWithIV(key, sizeof(key), salt);
+
+    /* This will store the decrypted data */
+    std::string decryptedData;
+
+    try
+    {
+        /* Decrypt, handling padding */
+        StringSource((byte *)buffer.data(), buffer.size(), true, new StreamTransformationFilter(
+            cbcDecryption, new StringSink(decryptedData))
+        );
+    }
+    /* do NOT report an alternate error for invalid padding. It allows them
+       to do a padding oracle attack, I believe. Just report the wrong password
+       error. */
+    catch (const CryptoPP::Exception &)
+    {
+        return {WRONG_PASSWORD, json()};
+    }
+
+    /* Check that the decrypted data has the 'isCorrectPassword' identifier,
+       and remove it it does. If it doesn't, return an error. */
+    WalletError error = hasMagicIdentifier(
+        decryptedData, Constants::IS_CORRECT_PASSWORD_IDENTIFIER,
+        WALLET_FILE_CORRUPTED, WRONG_PASSWORD
+    );
+
+    if (error)
+    {
+        return {error, json()};
+    }
+
+    try
+    {
+        return {SUCCESS, json::parse(decryptedData)};
+    }
+    catch (const json::parse_error &)
+    {
+        return {WALLET_FILE_CORRUPTED, json()};
+    }
+}
+
+} // namespace
+
+///////////////////////////////////
+/* CONSTRUCTORS / DECONSTRUCTORS */
+///////////////////////////////////
+
+WalletFile::WalletFile(
+    const std::string filename,
+    const std::string password) :
+
+    m_filename(filename)
+{
+    /* Generate 16 random bytes for the salt */
+    Crypto::generate_random_bytes(m_salt.size(), m_salt.data());
+
+    deriveKey(password);
+}
+
+WalletFile::WalletFile(
+    const std::string filename,
+    const std::string password,
+    const std::array<uint8_t, 16> salt) :
+
+    m_filename(filename),
+    m_salt(salt)
+{
+    deriveKey(password);
+}
+
+WalletFile::~WalletFile()
+{
+    if (m_compaction.valid())
+    {
+        m_compaction.wait();
+    }
+}
+
+//////////////////////
+/* STATIC FUNCTIONS */
+//////////////////////
+
+std::tuple<WalletError, std::shared_ptr<WalletFile>, json, std::vector<json>> WalletFile::open(
+    const std::string filename,
+    const std::string password)
+{
+    /* Open in binary mode, since we have encrypted data */
+    std::ifstream file(filename, std::ios_base::binary);
+
+    /* Check we successfully opened the file */
+    if (!file)
+    {
+        return {FILENAME_NON_EXISTENT, nullptr, json(), {}};
+    }
+
+    /* Read file into a buffer */
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)),
+                             (std::istreambuf_iterator<char>()));
+
+    /* Check that the data has the 'isAWallet' identifier, and remove it it
+       does. If it doesn't, return an error. */
+    WalletError error = hasMagicIdentifier(
+        buffer, Constants::IS_A_WALLET_IDENTIFIER,
+        NOT_A_WALLET_FILE, NOT_A_WALLET_FILE
+    );
+
+    if (error)
+    {
+        return {error, nullptr, json(), {}};
+    }
+
+    /* A JSON wallet file. Load it, and write it as a snapshot on the first
+       save */
+    if (hasMagicIdentifier(buffer, Constants::IS_A_JOURNAL_WALLET_IDENTIFIER,
+                           NOT_A_WALLET_FILE, NOT_A_WALLET_FILE) != SUCCESS)
+    {
+        auto [jsonError, walletJson] = decryptJsonWallet(buffer, password);
+
+        if (jsonError)
+        {
+            return {jsonError, nullptr, json(), {}};
+        }
+
+        return {
+            SUCCESS, std::make_shared<WalletFile>(filename, password),
+            walletJson, {}
+        };
+    }
+
+    std::array<uint8_t, 16> salt;
+
+    /* Check the file is large enough for the salt */
+    if (buffer.size() < salt.size())
+    {
+        return {WALLET_FILE_CORRUPTED, nullptr, json(), {}};
+    }
+
+    std::copy(buffer.begin(), buffer.begin() + salt.size(), salt.begin());
+
+    const size_t headerSize = Constants::IS_A_WALLET_IDENTIFIER.size()
+                            + Constants::IS_A_JOURNAL_WALLET_IDENTIFIER.size()
+                            + salt.size();
+
+    /* Can't use make_shared with a private constructor */
+    std::shared_ptr<WalletFile> walletFile(new WalletFile(filename, password, salt));
+
+    json snapshot;
+
+    std::vector<json> journal;
+
+    size_t position = salt.size();
+
+    size_t snapshotEnd = 0;
+
+    /* If we fail to read a record, it's the end of the file getting cut off
+       by a crash in the middle of a save. We keep what we have, and write a
+       new snapshot on the next save. */
+    bool tornWrite = false;
+
+    while (position < buffer.size())
+    {
+        const bool isSnapshot = snapshotEnd == 0;
+
+        if (buffer.size() - position < RECORD_LENGTH_SIZE)
+        {
+            tornWrite = true;
+            break;
+        }
+
+        uint32_t recordSize = 0;
+
+        for (size_t i = 0; i < RECORD_LENGTH_SIZE; i++)
+        {
+            recordSize |= static_cast<uint32_t>(static_cast<uint8_t>(buffer[position + i])) << (8 * i);
+        }
+
+        const char *record = buffer.data() + position + RECORD_LENGTH_SIZE;
+
+        if (buffer.size() - position - RECORD_LENGTH_SIZE < recordSize
+         || recordSize < RECORD_IV_SIZE + RECORD_CHECKSUM_SIZE)
+        {
+            tornWrite = true;
+            break;
+        }
+
+        const size_t dataSize = recordSize - RECORD_CHECKSUM_SIZE;
+
+        const Crypto::Hash checksum = Crypto::cn_fast_hash(record, dataSize);
+
+        if (!std::equal(checksum.data, checksum.data + sizeof(checksum.data), (const uint8_t *)record + dataSize))
+        {
+            tornWrite = true;
+            break;
+        }
+
+        using namespace CryptoPP;
+
+        CBC_Mode<AES>::Decryption cbcDecryption;
+
+        cbcDecryption.SetKeyWithIV(
+            walletFile->m_key.data(), walletFile->m_key.size(), (const byte *)record
+        );
+
+        std::string decryptedData;
+
+        try
+        {
+            /* Decrypt, handling padding */
+            StringSource((const byte *)record + RECORD_IV_SIZE, dataSize - RECORD_IV_SIZE, true,
+                new StreamTransformationFilter(cbcDecryption, new StringSink(decryptedData))
+            );
+        }
+        /* The checksum matched, so this can only be a wrong password */
+        catch (const CryptoPP::Exception &)
+        {
+            return {WRONG_PASSWORD, nullptr, json(), {}};
+        }
+
+        error = hasMagicIdentifier(
+            decryptedData, Constants::IS_CORRECT_PASSWORD_IDENTIFIER,
+            WALLET_FILE_CORRUPTED, WRONG_PASSWORD
+        );
+
+        if (error)
+        {
+            return {error, nullptr, json(), {}};
+        }
+
+        try
+        {
+            json j = json::from_cbor(decryptedData);
+
+            if (isSnapshot)
+            {
+                snapshot = std::move(j);
+            }
+            else
+            {
+                journal.push_back(std::move(j));
+            }
+        }
+        catch (const json::exception &)
+        {
+            return {WALLET_FILE_CORRUPTED, nullptr, json(), {}};
+        }
+
+        position += RECORD_LENGTH_SIZE + recordSize;
+
+        if (isSnapshot)
+        {
+            snapshotEnd = position;
+        }
+    }
+
+    /* Didn't get as far as a whole snapshot */
+    if (snapshotEnd == 0)
+    {
+        return {WALLET_FILE_CORRUPTED, nullptr, json(), {}};
+    }
+
+    walletFile->m_fileSize = headerSize - salt.size() + position;
+    walletFile->m_journalSize = position - snapshotEnd;
+    walletFile->m_needsSnapshot = tornWrite;
+
+    return {SUCCESS, walletFile, snapshot, journal};
+}
+
+WalletError WalletFile::saveJsonWallet(
+    const std::string filename,
+    const std::string password,
+    const json &walletJson)
+{
+    /* Add an identifier to the start of the string so we can verify the wallet
+       has been correctly decrypted */
+    std::string identiferAsString(
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(),
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end()
+    );
+
+    /* Add magic identifier, and get json as a string */
+    std::string walletData = identiferAsString + walletJson.dump();
+
+    using namespace CryptoPP;
+
+    /* The key we use for AES encryption, generated with PBKDF2 */
+    byte key[16];
+
+    /* The salt we use for both PBKDF2, and AES Encryption */
+    byte salt[16];
+
+    /* Generate 16 random bytes for the salt */
+    Crypto::generate_random_bytes(16, salt);
+
+    /* Using SHA256 as the algorithm */
+    PKCS5_PBKDF2_HMAC<SHA256> pbkdf2;
+
+    /* Generate the AES Key using pbkdf2 */
+    pbkdf2.DeriveKey(
+        key, sizeof(key), 0, (byte *)password.c_str(),
+        password.size(), salt, sizeof(salt), Constants::PBKDF2_ITERATIONS
+    );
+
+    CBC_Mode<AES>::Encryption cbcEncryption;
+
+    /* Initialize our encryptor with the key and salt/iv */
+    cbcEncryption.SetKeyWithIV(key, sizeof(key), salt);
+
+    /* This will store the encrypted data */
+    std::string encryptedData;
+
+    /* Encrypt, and pad */
+    StringSource(walletData, true, new StreamTransformationFilter(
+        cbcEncryption, new StringSink(encryptedData))
+    );
+
+    std::ofstream file(filename, std::ios_base::binary);
+
+    if (!file)
+    {
+        return INVALID_WALLET_FILENAME;
+    }
+
+    /* Write the isAWalletIdentifier to the file, so when we open it we can
+       verify that it is a wallet file */
+    std::copy(Constants::IS_A_WALLET_IDENTIFIER.begin(),
+              Constants::IS_A_WALLET_IDENTIFIER.end(),
+              std::ostreambuf_iterator<char>(file));
+
+    /* Write the salt to the file, so we can use it to unencrypt the file
+       later. Note that the salt is unencrypted. */
+    std::copy(std::begin(salt), std::end(salt),
+              std::ostreambuf_iterator<char>(file));
+
+    /* Write the encrypted wallet data to the file */
+    std::copy(encryptedData.begin(), encryptedData.end(),
+              std::ostreambuf_iterator<char>(file));
+
+    return SUCCESS;
+}
+
+/////////////////////
+/* CLASS FUNCTIONS */
+/////////////////////
+
+WalletError WalletFile::writeSnapshot(const json &walletJson)
+{
+    /* The compaction would only overwrite us with an older snapshot */
+    if (m_compaction.valid())
+    {
+        m_compaction.wait();
+    }
+
+    std::scoped_lock lock(m_mutex);
+
+    /* Write to a temporary file, then swap it in, so a crash can't leave us
+       with half a wallet */
+    const std::string tmpFilename = m_filename + ".tmp";
+
+    const auto [error, size] = writeSnapshotFile(tmpFilename, walletJson);
+
+    /* Whatever we failed to write is no longer in the journal either, so
+       keep trying to write a snapshot */
+    if (error)
+    {
+        m_needsSnapshot = true;
+        return error;
+    }
+
+    std::error_code ec;
+
+    fs::rename(tmpFilename, m_filename, ec);
+
+    if (ec)
+    {
+        m_needsSnapshot = true;
+        return INVALID_WALLET_FILENAME;
+    }
+
+    m_fileSize = size;
+    m_journalSize = 0;
+    m_needsSnapshot = false;
+
+    return SUCCESS;
+}
+
+WalletError WalletFile::appendRecord(const json &record)
+{
+    /* Encrypt before taking the lock, the compaction may be copying the
+       journal */
+    const std::string data = makeRecord(record);
+
+    std::scoped_lock lock(m_mutex);
+
+    std::ofstream file(m_filename, std::ios_base::binary | std::ios_base::app);
+
+    file.write(data.data(), data.size());
+    file.flush();
+
+    /* If some of the record made it to disk, it will fail its checksum when
+       the file is opened, and any later records would be lost with it */
+    if (!file)
+    {
+        m_needsSnapshot = true;
+        return INVALID_WALLET_FILENAME;
+    }
+
+    m_fileSize += data.size();
+    m_journalSize += data.size();
+
+    return SUCCESS;
+}
+
+void WalletFile::compact(const std::function<json()> takeSnapshot)
+{
+    /* Already compacting */
+    if (m_compaction.valid()
+     && m_compaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return;
+    }
+
+    uint64_t compactFrom;
+
+    {
+        std::scoped_lock lock(m_mutex);
+        compactFrom = m_fileSize;
+    }
+
+    m_compaction = std::async(std::launch::async, [this, takeSnapshot, compactFrom]
+    {
+        const std::string tmpFilename = m_filename + ".tmp";
+
+        std::error_code ec;
+
+        try
+        {
+            const auto [error, size] = writeSnapshotFile(tmpFilename, takeSnapshot());
+
+            if (error)
+            {
+                fs::remove(tmpFilename, ec);
+                return;
+            }
+
+            std::scoped_lock lock(m_mutex);
+
+            /* An append failed while we were writing, so the journal may
+               have garbage in it. The next save will write a snapshot. */
+            if (m_needsSnapshot)
+            {
+                fs::remove(tmpFilename, ec);
+                return;
+            }
+
+            /* Copy across the records appended since the snapshot was taken */
+            std::ifstream oldFile(m_filename, std::ios_base::binary);
+            std::ofstream newFile(tmpFilename, std::ios_base::binary | std::ios_base::app);
+
+            oldFile.seekg(compactFrom);
+
+            std::vector<char> records(m_fileSize - compactFrom);
+
+            oldFile.read(records.data(), records.size());
+            newFile.write(records.data(), records.size());
+            newFile.flush();
+
+            if (!oldFile || !newFile)
+            {
+                fs::remove(tmpFilename, ec);
+                return;
+            }
+
+            oldFile.close();
+            newFile.close();
+
+            fs::rename(tmpFilename, m_filename, ec);
+
+            if (ec)
+            {
+                return;
+            }
+
+            m_journalSize = records.size();
+            m_fileSize = size + records.size();
+        }
+        /* Not fatal, we'll try again with the next save */
+        catch (const std::exception &)
+        {
+            fs::remove(tmpFilename, ec);
+        }
+    });
+}
+
+bool WalletFile::needsSnapshot() const
+{
+    std::scoped_lock lock(m_mutex);
+
+    return m_needsSnapshot;
+}
+
+uint64_t WalletFile::journalSize() const
+{
+    std::scoped_lock lock(m_mutex);
+
+    return m_journalSize;
+}
+
+void WalletFile::deriveKey(const std::string password)
+{
+    using namespace CryptoPP;
+
+    /* Using SHA256 as the algorithm */
+    PKCS5_PBKDF2_HMAC<SHA256> pbkdf2;
+
+    /* Generate the AES Key using pbkdf2. This is the slow part of saving, so
+       it is only done once, when the file is opened or created */
+    pbkdf2.DeriveKey(
+        m_key.data(), m_key.size(), 0, (const byte *)password.c_str(),
+        password.size(), m_salt.data(), m_salt.size(), Constants::PBKDF2_ITERATIONS
+    );
+}
+
+std::string WalletFile::makeRecord(const json &j) const
+{
+    /* Add an identifier to the start of the data so we can verify the record
+       has been correctly decrypted */
+    std::string recordData(
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.begin(),
+        Constants::IS_CORRECT_PASSWORD_IDENTIFIER.end()
+    );
+
+    const std::vector<uint8_t> cbor = json::to_cbor(j);
+
+    recordData.append(cbor.begin(), cbor.end());
+
+    using namespace CryptoPP;
+
+    /* The key is the same for every record, so each gets its own IV */
+    std::string record(RECORD_LENGTH_SIZE + RECORD_IV_SIZE, '\0');
+
+    Crypto::generate_random_bytes(RECORD_IV_SIZE, &record[RECORD_LENGTH_SIZE]);
+
+    CBC_Mode<AES>::Encryption cbcEncryption;
+
+    cbcEncryption.SetKeyWithIV(
+        m_key.data(), m_key.size(), (const byte *)&record[RECORD_LENGTH_SIZE]
+    );
+
+    /* Encrypt, and pad */
+    StringSource(recordData, true, new StreamTransformationFilter(
+        cbcEncryption, new StringSink(record))
+    );
+
+    /* Checksum the IV and the encrypted data */
+    const Crypto::Hash checksum = Crypto::cn_fast_hash(
+        &record[RECORD_LENGTH_SIZE], record.size() - RECORD_LENGTH_SIZE
+    );
+
+    record.append(std::begin(checksum.data), std::end(checksum.data));
+
+    const uint32_t recordSize = static_cast<uint32_t>(record.size() - RECORD_LENGTH_SIZE);
+
+    for (size_t i = 0; i < RECORD_LENGTH_SIZE; i++)
+    {
+        record[i] = static_cast<char>((recordSize >> (8 * i)) & 0xff);
+    }
+
+    return record;
+}
+
+std::tuple<WalletError, uint64_t> WalletFile::writeSnapshotFile(
+    const std::string filename,
+    const json &walletJson) const
+{
+    const std::string record = makeRecord(walletJson);
+
+    std::ofstream file(filename, std::ios_base::binary | std::ios_base::trunc);
+
+    if (!file)
+    {
+        return {INVALID_WALLET_FILENAME, 0};
+    }
+
+    writeHeader(file);
+
+    file.write(record.data(), record.size());
+    file.flush();
+
+    if (!file)
+    {
+        return {INVALID_WALLET_FILENAME, 0};
+    }
+
+    return {SUCCESS, static_cast<uint64_t>(file.tellp())};
+}
+
+void WalletFile::writeHeader(std::ofstream &file) const
+{
+    /* Write the isAWalletIdentifier to the file, so when we open it we can
+       verify that it is a wallet file */
+    std::copy(Constants::IS_A_WALLET_IDENTIFIER.begin(),
+              Constants::IS_A_WALLET_IDENTIFIER.end(),
+              std::ostreambuf_iterator<char>(file));
+
+    std::copy(Constants::IS_A_JOURNAL_WALLET_IDENTIFIER.begin(),
+              Constants::IS_A_JOURNAL_WALLET_IDENTIFIER.end(),
+              std::ostreambuf_iterator<char>(file));
+
+    /* The salt is unencrypted, we need it to derive the key */
+    std::copy(m_salt.begin(), m_salt.end(),
+              std::ostreambuf_iterator<char>(file));
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <array>
+
+#include <fstream>
+
+#include <functional>
+
+#include <future>
+
+#include "json.hpp"
+
+#include <memory>
+
+#include <mutex>
+
+#include <string>
+
+#include <tuple>
+
+#include <vector>
+
+#include <WalletBackend/WalletErrors.h>
+
+using nlohmann::json;
+
+/* The wallet file is a binary snapshot of the wallet, followed by a journal
+   of the changes made since the snapshot was taken. Each save appends one
+   record, so saving costs what changed, rather than the size of the wallet.
+   Once the journal grows large, it is folded into a new snapshot.
+
+   Every record is encrypted with AES, with a key derived from the password
+   once per session, and carries a checksum so a torn write at the end of
+   the file can be detected and dropped. */
+class WalletFile
+{
+    public:
+
+        //////////////////
+        /* Constructors */
+        //////////////////
+
+        /* Derives a key for the password with a new salt. Nothing is written
+           until the first snapshot */
+        WalletFile(const std::string filename, const std::string password);
+
+        /* Waits for any compaction to finish */
+        ~WalletFile();
+
+        /* Delete the copy constructor */
+        WalletFile(const WalletFile &) = delete;
+
+        /* Delete the assignment operator */
+        WalletFile & operator=(const WalletFile &) = delete;
+
+        /////////////////////////////
+        /* Public static functions */
+        /////////////////////////////
+
+        /* Opens a wallet file in either format. Returns the file, the wallet
+           json, and the journal records to apply on top of it (Always empty
+           for a JSON wallet file) */
+        static std::tuple<WalletError, std::shared_ptr<WalletFile>, json, std::vector<json>> open(
+            const std::string filename,
+            const std::string password);
+
+        /* Writes the wallet in the JSON format, which any version of the
+           wallet can import */
+        static WalletError saveJsonWallet(
+            const std::string filename,
+            const std::string password,
+            const json &walletJson);
+
+        /////////////////////////////
+        /* Public member functions */
+        /////////////////////////////
+
+        /* Replaces the file with a snapshot of the wallet, discarding the
+           journal */
+        WalletError writeSnapshot(const json &walletJson);
+
+        /* Appends a record of changes to the journal */
+        WalletError appendRecord(const json &record);
+
+        /* Writes a new snapshot in a background thread, keeping any records
+           appended while it is being written. Does nothing if a compaction
+           is already running. */
+        void compact(const std::function<json()> takeSnapshot);
+
+        /* If the next save has to be a snapshot - nothing has been written
+           yet, or the journal can't be safely appended to */
+        bool needsSnapshot() const;
+
+        /* The size of the journal records on disk, in bytes */
+        uint64_t journalSize() const;
+
+    private:
+
+        //////////////////////////
+        /* Private constructors */
+        //////////////////////////
+
+        /* Derives the key for the password with the salt of an existing
+           file */
+        WalletFile(
+            const std::string filename,
+            const std::string password,
+            const std::array<uint8_t, 16> salt);
+
+        //////////////////////////////
+        /* Private member functions */
+        //////////////////////////////
+
+        void deriveKey(const std::string password);
+
+        /* Encrypts and checksums a record, ready to be written to disk */
+        std::string makeRecord(const json &j) const;
+
+        /* Writes the header and the snapshot record to a temporary file,
+           returning its size */
+        std::tuple<WalletError, uint64_t> writeSnapshotFile(
+            const std::string filename,
+            const json &walletJson) const;
+
+        /* Writes the file header: the identifiers, and the salt */
+        void writeHeader(std::ofstream &file) const;
+
+        //////////////////////////////
+        /* Private member variables */
+        //////////////////////////////
+
+        std::string m_filename;
+
+        /* The salt, stored unencrypted in the header */
+        std::array<uint8_t, 16> m_salt;
+
+        /* The AES key, derived from the password and salt with PBKDF2 */
+        std::array<uint8_t, 16> m_key;
+
+        /* The size of the file on disk, and how much of it is journal */
+        uint64_t m_fileSize = 0;
+
+        uint64_t m_journalSize = 0;
+
+        bool m_needsSnapshot = true;
+
+        /* The running background compaction, if any */
+        std::future<void> m_compaction;
+
+        /* Held while writing to the file */
+        mutable std::mutex m_mutex;
+};
@@ -0,0 +1,251 @@
+// Copyright (c) 2018, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#undef NDEBUG
+
+#include <assert.h>
+
+#include <Common/FileSystemShim.h>
+
+#include <crypto/crypto.h>
+
+#include <atomic>
+
+#include <future>
+
+#include <iostream>
+
+#include <string>
+
+#include <thread>
+
+#include <vector>
+
+#include <WalletBackend/JsonSerialization.h>
+#include <WalletBackend/SubWallets.h>
+#include <WalletBackend/Utilities.h>
+#include <WalletBackend/WalletFile.h>
+
+/* Checks the wallet file survives a crash in the middle of a save, and that
+   a snapshot and the journal records after it replay to the wallet they were
+   taken from, including while the wallet is being changed, and once the
+   journal has been compacted. */
+
+namespace {
+
+const std::string PASSWORD = "password";
+
+/* Opens filename, expecting it to succeed */
+std::tuple<std::shared_ptr<WalletFile>, json, std::vector<json>> openWalletFile(
+    const std::string filename)
+{
+    auto [error, walletFile, snapshot, journal] = WalletFile::open(filename, PASSWORD);
+
+    assert(error == SUCCESS);
+
+    return {walletFile, snapshot, journal};
+}
+
+void testTornRecord(const std::string filename)
+{
+    {
+        WalletFile walletFile(filename, PASSWORD);
+
+        assert(walletFile.writeSnapshot({{"snapshot", 1}}) == SUCCESS);
+        assert(walletFile.appendRecord({{"record", 1}}) == SUCCESS);
+        assert(walletFile.appendRecord({{"record", 2}}) == SUCCESS);
+    }
+
+    /* A crash part of the way through writing the last record */
+    fs::resize_file(filename, fs::file_size(filename) - 5);
+
+    auto [walletFile, snapshot, journal] = openWalletFile(filename);
+
+    assert(snapshot == json({{"snapshot", 1}}));
+    assert(journal.size() == 1 && journal[0] == json({{"record", 1}}));
+
+    /* The garbage at the end can't be appended to */
+    assert(walletFile->needsSnapshot());
+
+    assert(walletFile->writeSnapshot({{"snapshot", 2}}) == SUCCESS);
+    assert(walletFile->appendRecord({{"record", 3}}) == SUCCESS);
+
+    auto [reopenedFile, newSnapshot, newJournal] = openWalletFile(filename);
+
+    assert(newSnapshot == json({{"snapshot", 2}}));
+    assert(newJournal.size() == 1 && newJournal[0] == json({{"record", 3}}));
+
+    std::cout << "torn record: OK" << std::endl;
+}
+
+void testCompaction(const std::string filename)
+{
+    const uint64_t uncompactedSize = [&filename]
+    {
+        WalletFile walletFile(filename, PASSWORD);
+
+        assert(walletFile.writeSnapshot({{"snapshot", 1}}) == SUCCESS);
+
+        for (int i = 0; i < 100; i++)
+        {
+            assert(walletFile.appendRecord({{"record", i}}) == SUCCESS);
+        }
+
+        std::promise<void> appended;
+
+        walletFile.compact([&appended]
+        {
+            /* Let a save happen while the snapshot is being written */
+            appended.get_future().wait();
+
+            return json({{"snapshot", 2}});
+        });
+
+        assert(walletFile.appendRecord({{"record", 100}}) == SUCCESS);
+
+        appended.set_value();
+
+        return fs::file_size(filename);
+    }();
+
+    auto [walletFile, snapshot, journal] = openWalletFile(filename);
+
+    /* Only the record appended during the compaction is left */
+    assert(snapshot == json({{"snapshot", 2}}));
+    assert(journal.size() == 1 && journal[0] == json({{"record", 100}}));
+    assert(fs::file_size(filename) < uncompactedSize);
+    assert(!walletFile->needsSnapshot());
+
+    std::cout << "compaction: OK" << std::endl;
+}
+
+void testReplay()
+{
+    Crypto::PublicKey publicSpendKey;
+    Crypto::SecretKey privateSpendKey;
+    Crypto::PublicKey publicViewKey;
+    Crypto::SecretKey privateViewKey;
+
+    Crypto::generate_keys(publicSpendKey, privateSpendKey);
+    Crypto::generate_keys(publicViewKey, privateViewKey);
+
+    SubWallets subWallets(
+        privateSpendKey, privateViewKey,
+        Utilities::privateKeysToAddress(privateSpendKey, privateViewKey), 0, false
+    );
+
+    const size_t inputCount = 1000;
+
+    std::vector<Crypto::KeyImage> keyImages(inputCount);
+
+    /* Give the wallet some inputs to lock */
+    json inputs = json::array();
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        WalletTypes::TransactionInput input {};
+
+        Crypto::generate_random_bytes(sizeof(keyImages[i]), &keyImages[i]);
+
+        input.keyImage = keyImages[i];
+        input.amount = 1000 + i;
+        input.blockHeight = i;
+        input.globalOutputIndex = i;
+
+        inputs.push_back({
+            {"type", "input"},
+            {"publicSpendKey", publicSpendKey},
+            {"input", input}
+        });
+    }
+
+    subWallets.replayJournal(inputs);
+
+    std::atomic<bool> sent(false);
+
+    /* Send transactions like the wallet api does, while the wallet is saved */
+    std::thread sender([&]
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            WalletTypes::Transaction tx;
+
+            Crypto::generate_random_bytes(sizeof(tx.hash), &tx.hash);
+
+            tx.transfers[publicSpendKey] = -static_cast<int64_t>(1000 + i);
+
+            subWallets.markInputAsLocked(keyImages[i], publicSpendKey);
+            subWallets.addUnconfirmedTransaction(tx);
+        }
+
+        sent = true;
+    });
+
+    /* The snapshot of the last compaction, and the records appended since */
+    std::shared_ptr<SubWallets> compacted;
+
+    std::vector<json> records;
+
+    for (size_t save = 0; !sent; save++)
+    {
+        auto [complete, journal, snapshot] = subWallets.takeJournal(save % 50 == 0);
+
+        assert(complete);
+
+        /* The snapshot holds the record of the save that compacted */
+        if (snapshot != nullptr)
+        {
+            compacted = snapshot;
+            records.clear();
+        }
+        else
+        {
+            records.push_back(journal);
+        }
+    }
+
+    sender.join();
+
+    records.push_back(std::get<1>(subWallets.takeJournal(false)));
+
+    /* Opening the wallet replays the records after the snapshot. If any of
+       them were in it already, locking the input again would throw */
+    SubWallets opened;
+
+    opened.fromJson(compacted->toJson());
+
+    for (const auto &journal : records)
+    {
+        opened.replayJournal(journal);
+    }
+
+    assert(opened.toJson() == subWallets.toJson());
+    assert(opened.getUnconfirmedTransactions().size() == inputCount);
+
+    std::cout << "replay after snapshot: OK" << std::endl;
+}
+
+}
+
+int main()
+{
+    const std::string filename = (fs::temp_directory_path() / "wallettest.wallet").string();
+
+    try
+    {
+        testTornRecord(filename);
+        testCompaction(filename);
+        testReplay();
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Something went terribly wrong..." << std::endl << e.what() << std::endl << std::endl;
+        fs::remove(filename);
+        return 1;
+    }
+
+    fs::remove(filename);
+
+    return 0;
+}
@@ -229,6 +229,7 @@ const uint8_t  P2P_MINIMUM_VERSION                           = 2;
 const uint8_t  P2P_UPGRADE_WINDOW                            = 2;
 
 const size_t   P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE          = 32 * 1024 * 1024; // 32 MB
+const size_t   P2P_BANDWIDTH_LIMITED_WRITE_SIZE              = 16 * 1024;        // bytes written at a time under a bandwidth limit
 const uint32_t P2P_DEFAULT_CONNECTIONS_COUNT                 = 8;
 const size_t   P2P_DEFAULT_WHITELIST_CONNECTIONS_PERCENT     = 70;
 const uint32_t P2P_DEFAULT_HANDSHAKE_INTERVAL                = 60;            // seconds
@@ -245,6 +246,10 @@ const uint64_t DATABASE_READ_BUFFER_MB_DEFAULT_SIZE          = 10;
 const uint32_t DATABASE_DEFAULT_MAX_OPEN_FILES               = 100;
 const uint16_t DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT     = 2;
 
+const size_t   RING_MEMBER_CACHE_DEFAULT_SIZE                = 100000;        // decoded keys, roughly 45 MB
+const size_t   BLOCK_DETAILS_CACHE_DEFAULT_SIZE              = 2000;          // blocks
+const uint32_t BLOCK_DETAILS_CACHE_MIN_CONFIRMATIONS         = 60;            // blocks above the cached height
+
 const char     LATEST_VERSION_URL[]                          = "";
 const std::string LICENSE_URL                                = "";
 const static   boost::uuids::uuid CRYPTONOTE_NETWORK         =
@@ -16,10 +16,19 @@
 // along with Bytecoin.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "crypto-ops.h"
 
+/* CRYPTO_OPS_FE64 replaces the ref10 field multiplication and squaring with
+   versions working on five 51 bit limbs and 128 bit products. The storage
+   format of fe is unchanged, so the rest of this file is shared and results
+   are bit for bit identical. It needs compiler support for __int128. */
+#if defined(CRYPTO_OPS_FE64) && !defined(__SIZEOF_INT128__)
+#undef CRYPTO_OPS_FE64
+#endif
+
 /* Predeclarations */
 
 static void fe_mul(fe, const fe, const fe);
@@ -51,6 +60,171 @@ static uint64_t load_4(const unsigned char *in)
   return result;
 }
 
+#ifdef CRYPTO_OPS_FE64
+
+/* 64 bit field arithmetic, radix 2^51 */
+
+typedef __int128 int128_t;
+typedef int64_t fe64[5];
+
+#define FE64_MASK51 ((((int64_t) 1) << 51) - 1)
+
+/*
+Packs the ten limbs of f into five limbs of 51 bits. The limbs of f are
+signed, so the packed limbs may be negative as well.
+
+Preconditions:
+   |f| bounded by 1.65*2^26,1.65*2^25,1.65*2^26,1.65*2^25,etc.
+
+Postconditions:
+   |h| bounded by 1.65*2^51
+*/
+
+static void fe64_frome(fe64 h, const fe f) {
+  h[0] = (int64_t) f[0] + (int64_t) f[1] * (((int64_t) 1) << 26);
+  h[1] = (int64_t) f[2] + (int64_t) f[3] * (((int64_t) 1) << 26);
+  h[2] = (int64_t) f[4] + (int64_t) f[5] * (((int64_t) 1) << 26);
+  h[3] = (int64_t) f[6] + (int64_t) f[7] * (((int64_t) 1) << 26);
+  h[4] = (int64_t) f[8] + (int64_t) f[9] * (((int64_t) 1) << 26);
+}
+
+/*
+Carries the 128 bit limbs of a product down to 51 bits and unpacks them into
+the ten limb representation.
+
+Preconditions:
+   |r| bounded by 2^111
+
+Postconditions:
+   |h| bounded by 1.01*2^25,1.01*2^24,1.01*2^25,1.01*2^24,etc.
+*/
+
+static void fe64_carry_toe(fe h, int128_t r0, int128_t r1, int128_t r2, int128_t r3, int128_t r4) {
+  int64_t l0, l1, l2, l3, l4;
+  int64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9;
+  int64_t carry0, carry1, carry2, carry3, carry4, carry5, carry6, carry7, carry8, carry9;
+
+  r1 += r0 >> 51; l0 = (int64_t) (r0 & FE64_MASK51);
+  r2 += r1 >> 51; l1 = (int64_t) (r1 & FE64_MASK51);
+  r3 += r2 >> 51; l2 = (int64_t) (r2 & FE64_MASK51);
+  r4 += r3 >> 51; l3 = (int64_t) (r3 & FE64_MASK51);
+  r0 = (int128_t) l0 + (r4 >> 51) * 19; l4 = (int64_t) (r4 & FE64_MASK51);
+  /* |r0| <= 2^65 */
+  l1 += (int64_t) (r0 >> 51); l0 = (int64_t) (r0 & FE64_MASK51);
+  /* 0 <= l0, l2, l3, l4 < 2^51, -2^14 < l1 < 2^52 */
+
+  h0 = l0 & 67108863; h1 = l0 >> 26;
+  h2 = l1 & 67108863; h3 = l1 >> 26;
+  h4 = l2 & 67108863; h5 = l2 >> 26;
+  h6 = l3 & 67108863; h7 = l3 >> 26;
+  h8 = l4 & 67108863; h9 = l4 >> 26;
+
+  carry0 = (h0 + (int64_t) (1<<25)) >> 26; h1 += carry0; h0 -= carry0 << 26;
+  carry1 = (h1 + (int64_t) (1<<24)) >> 25; h2 += carry1; h1 -= carry1 << 25;
+  carry2 = (h2 + (int64_t) (1<<25)) >> 26; h3 += carry2; h2 -= carry2 << 26;
+  carry3 = (h3 + (int64_t) (1<<24)) >> 25; h4 += carry3; h3 -= carry3 << 25;
+  carry4 = (h4 + (int64_t) (1<<25)) >> 26; h5 += carry4; h4 -= carry4 << 26;
+  carry5 = (h5 + (int64_t) (1<<24)) >> 25; h6 += carry5; h5 -= carry5 << 25;
+  carry6 = (h6 + (int64_t) (1<<25)) >> 26; h7 += carry6; h6 -= carry6 << 26;
+  carry7 = (h7 + (int64_t) (1<<24)) >> 25; h8 += carry7; h7 -= carry7 << 25;
+  carry8 = (h8 + (int64_t) (1<<25)) >> 26; h9 += carry8; h8 -= carry8 << 26;
+  carry9 = (h9 + (int64_t) (1<<24)) >> 25; h0 += carry9 * 19; h9 -= carry9 << 25;
+  carry0 = (h0 + (int64_t) (1<<25)) >> 26; h1 += carry0; h0 -= carry0 << 26;
+
+  h[0] = (int32_t) h0;
+  h[1] = (int32_t) h1;
+  h[2] = (int32_t) h2;
+  h[3] = (int32_t) h3;
+  h[4] = (int32_t) h4;
+  h[5] = (int32_t) h5;
+  h[6] = (int32_t) h6;
+  h[7] = (int32_t) h7;
+  h[8] = (int32_t) h8;
+  h[9] = (int32_t) h9;
+}
+
+/*
+h = f * g
+Can overlap h with f or g.
+
+Same pre- and postconditions as the ref10 fe_mul below.
+*/
+
+static void fe_mul(fe h, const fe f, const fe g) {
+  fe64 a;
+  fe64 b;
+  int64_t b1_19, b2_19, b3_19, b4_19;
+  int128_t r0, r1, r2, r3, r4;
+
+  fe64_frome(a, f);
+  fe64_frome(b, g);
+
+  b1_19 = 19 * b[1];
+  b2_19 = 19 * b[2];
+  b3_19 = 19 * b[3];
+  b4_19 = 19 * b[4];
+
+  r0 = (int128_t) a[0] * b[0] + (int128_t) a[1] * b4_19 + (int128_t) a[2] * b3_19 + (int128_t) a[3] * b2_19 + (int128_t) a[4] * b1_19;
+  r1 = (int128_t) a[0] * b[1] + (int128_t) a[1] * b[0] + (int128_t) a[2] * b4_19 + (int128_t) a[3] * b3_19 + (int128_t) a[4] * b2_19;
+  r2 = (int128_t) a[0] * b[2] + (int128_t) a[1] * b[1] + (int128_t) a[2] * b[0] + (int128_t) a[3] * b4_19 + (int128_t) a[4] * b3_19;
+  r3 = (int128_t) a[0] * b[3] + (int128_t) a[1] * b[2] + (int128_t) a[2] * b[1] + (int128_t) a[3] * b[0] + (int128_t) a[4] * b4_19;
+  r4 = (int128_t) a[0] * b[4] + (int128_t) a[1] * b[3] + (int128_t) a[2] * b[2] + (int128_t) a[3] * b[1] + (int128_t) a[4] * b[0];
+
+  fe64_carry_toe(h, r0, r1, r2, r3, r4);
+}
+
+/*
+Computes the five limbs of f * f, without carrying.
+*/
+
+static void fe64_sq(int128_t r[5], const fe f) {
+  fe64 a;
+  int64_t a0_2, a1_2, a2_2, a3_2, a3_19, a4_19;
+
+  fe64_frome(a, f);
+
+  a0_2 = 2 * a[0];
+  a1_2 = 2 * a[1];
+  a2_2 = 2 * a[2];
+  a3_2 = 2 * a[3];
+  a3_19 = 19 * a[3];
+  a4_19 = 19 * a[4];
+
+  r[0] = (int128_t) a[0] * a[0] + (int128_t) a1_2 * a4_19 + (int128_t) a2_2 * a3_19;
+  r[1] = (int128_t) a0_2 * a[1] + (int128_t) a2_2 * a4_19 + (int128_t) a[3] * a3_19;
+  r[2] = (int128_t) a0_2 * a[2] + (int128_t) a[1] * a[1] + (int128_t) a3_2 * a4_19;
+  r[3] = (int128_t) a0_2 * a[3] + (int128_t) a1_2 * a[2] + (int128_t) a[4] * a4_19;
+  r[4] = (int128_t) a0_2 * a[4] + (int128_t) a1_2 * a[3] + (int128_t) a[2] * a[2];
+}
+
+/*
+h = f * f
+Can overlap h with f.
+
+Same pre- and postconditions as the ref10 fe_sq below.
+*/
+
+static void fe_sq(fe h, const fe f) {
+  int128_t r[5];
+  fe64_sq(r, f);
+  fe64_carry_toe(h, r[0], r[1], r[2], r[3], r[4]);
+}
+
+/*
+h = 2 * f * f
+Can overlap h with f.
+
+Same pre- and postconditions as the ref10 fe_sq2 below.
+*/
+
+static void fe_sq2(fe h, const fe f) {
+  int128_t r[5];
+  fe64_sq(r, f);
+  fe64_carry_toe(h, 2 * r[0], 2 * r[1], 2 * r[2], 2 * r[3], 2 * r[4]);
+}
+
+#endif
+
 /* From fe_0.c */
 
 /*
@@ -360,6 +534,7 @@ Can get away with 11 carries, but then data flow is much deeper.
 With tighter constraints on inputs can squeeze carries into int32.
 */
 
+#ifndef CRYPTO_OPS_FE64
 static void fe_mul(fe h, const fe f, const fe g) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -577,6 +752,7 @@ static void fe_mul(fe h, const fe f, const fe g) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
 
 /* From fe_neg.c */
 
@@ -640,6 +816,7 @@ Postconditions:
 See fe_mul.c for discussion of implementation strategy.
 */
 
+#ifndef CRYPTO_OPS_FE64
 static void fe_sq(fe h, const fe f) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -770,6 +947,7 @@ static void fe_sq(fe h, const fe f) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
 
 /* From fe_sq2.c */
 
@@ -788,6 +966,7 @@ Postconditions:
 See fe_mul.c for discussion of implementation strategy.
 */
 
+#ifndef CRYPTO_OPS_FE64
 static void fe_sq2(fe h, const fe f) {
   int32_t f0 = f[0];
   int32_t f1 = f[1];
@@ -929,6 +1108,7 @@ static void fe_sq2(fe h, const fe f) {
   h[8] = (int32_t) h8;
   h[9] = (int32_t) h9;
 }
+#endif
 
 /* From fe_sub.c */
 
@@ -1603,6 +1783,46 @@ void ge_tobytes(unsigned char *s, const ge_p2 *h) {
   s[31] ^= fe_isnegative(x) << 7;
 }
 
+/*
+Same as ge_tobytes for count points at once, writing 32 bytes per point to s.
+Uses Montgomery's trick so only one field inversion is needed for the whole
+batch. scratch must have room for count field elements.
+*/
+
+void ge_tobytes_batch(unsigned char *s, const ge_p2 *h, fe *scratch, size_t count) {
+  fe acc;
+  fe recip;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  /* scratch[i] = Z_0 * Z_1 * ... * Z_i */
+  fe_copy(scratch[0], h[0].Z);
+  for (i = 1; i < count; ++i) {
+    fe_mul(scratch[i], scratch[i - 1], h[i].Z);
+  }
+
+  /* acc = 1 / (Z_0 * ... * Z_i), peeling off one Z per step */
+  fe_invert(acc, scratch[count - 1]);
+  for (i = count - 1; i > 0; --i) {
+    fe_mul(recip, acc, scratch[i - 1]);
+    fe_mul(acc, acc, h[i].Z);
+    fe_mul(x, h[i].X, recip);
+    fe_mul(y, h[i].Y, recip);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+
+  fe_mul(x, h[0].X, acc);
+  fe_mul(y, h[0].Y, acc);
+  fe_tobytes(s, y);
+  s[31] ^= fe_isnegative(x) << 7;
+}
+
 /* From sc_reduce.c */
 
 /*
@@ -511,4 +511,115 @@ namespace Crypto {
     sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
     return sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
   }
+
+  static_assert(sizeof(DecodedPublicKey::point) == sizeof(ge_p3), "DecodedPublicKey must hold a ge_p3");
+  static_assert(sizeof(DecodedPublicKey::hashedPoint) == sizeof(ge_p3), "DecodedPublicKey must hold a ge_p3");
+
+  bool crypto_ops::decode_public_key(const PublicKey &pub, DecodedPublicKey &decoded) {
+    ge_p3 &point = reinterpret_cast<ge_p3 &>(decoded.point);
+    ge_p3 &hashedPoint = reinterpret_cast<ge_p3 &>(decoded.hashedPoint);
+    if (ge_frombytes_vartime(&point, reinterpret_cast<const unsigned char*>(&pub)) != 0) {
+      return false;
+    }
+    hash_to_ec(pub, hashedPoint);
+    return true;
+  }
+
+  /* Computes the a and b points of every member of a decoded ring, unconverted, writing them to
+   * points[2 * i] and points[2 * i + 1]. Returns false if the key image or a signature is malformed. */
+  static bool ring_signature_points(const KeyImage &image, const DecodedPublicKey *const *pubs, size_t pubs_count,
+    const Signature *sig, bool checkKeyImage, ge_p2 *points) {
+    ge_p3 image_unp;
+    ge_dsmp image_pre;
+    if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char*>(&image)) != 0) {
+      return false;
+    }
+    ge_dsm_precomp(image_pre, &image_unp);
+    if (checkKeyImage && ge_check_subgroup_precomp_vartime(image_pre) != 0) {
+      return false;
+    }
+    for (size_t i = 0; i < pubs_count; i++) {
+      const ge_p3 &point = reinterpret_cast<const ge_p3 &>(pubs[i]->point);
+      const ge_p3 &hashedPoint = reinterpret_cast<const ge_p3 &>(pubs[i]->hashedPoint);
+      if (sc_check(reinterpret_cast<const unsigned char*>(&sig[i])) != 0 || sc_check(reinterpret_cast<const unsigned char*>(&sig[i]) + 32) != 0) {
+        return false;
+      }
+      ge_double_scalarmult_base_vartime(&points[2 * i], reinterpret_cast<const unsigned char*>(&sig[i]), &point, reinterpret_cast<const unsigned char*>(&sig[i]) + 32);
+      ge_double_scalarmult_precomp_vartime(&points[2 * i + 1], reinterpret_cast<const unsigned char*>(&sig[i]) + 32, &hashedPoint, reinterpret_cast<const unsigned char*>(&sig[i]), image_pre);
+    }
+    return true;
+  }
+
+  /* Hashes the encoded ring points and checks that the challenges of the signature sum up to the result. */
+  static bool ring_signature_challenge_matches(const Hash &prefix_hash, const EllipticCurvePoint *encoded,
+    size_t pubs_count, const Signature *sig) {
+    EllipticCurveScalar sum, h;
+    rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs_count)));
+    buf->h = prefix_hash;
+    memcpy(buf->ab, encoded, 2 * sizeof(EllipticCurvePoint) * pubs_count);
+    sc_0(reinterpret_cast<unsigned char*>(&sum));
+    for (size_t i = 0; i < pubs_count; i++) {
+      sc_add(reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<unsigned char*>(&sum), reinterpret_cast<const unsigned char*>(&sig[i]));
+    }
+    hash_to_scalar(buf, rs_comm_size(pubs_count), h);
+    sc_sub(reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&h), reinterpret_cast<unsigned char*>(&sum));
+    return sc_isnonzero(reinterpret_cast<unsigned char*>(&h)) == 0;
+  }
+
+  bool crypto_ops::check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const DecodedPublicKey *const *pubs, size_t pubs_count,
+    const Signature *sig, bool checkKeyImage) {
+    ge_p2 *const points = reinterpret_cast<ge_p2 *>(alloca(2 * sizeof(ge_p2) * pubs_count));
+    EllipticCurvePoint *const encoded = reinterpret_cast<EllipticCurvePoint *>(alloca(2 * sizeof(EllipticCurvePoint) * pubs_count));
+    if (!ring_signature_points(image, pubs, pubs_count, sig, checkKeyImage, points)) {
+      return false;
+    }
+    for (size_t i = 0; i < 2 * pubs_count; i++) {
+      ge_tobytes(reinterpret_cast<unsigned char*>(&encoded[i]), &points[i]);
+    }
+    return ring_signature_challenge_matches(prefix_hash, encoded, pubs_count, sig);
+  }
+
+  size_t crypto_ops::check_ring_signatures(const RingSignatureCheck *checks, size_t checks_count) {
+    size_t pointCount = 0;
+    for (size_t i = 0; i < checks_count; i++) {
+      pointCount += 2 * checks[i].publicKeys.size();
+    }
+
+    std::vector<ge_p2> points(pointCount);
+    std::vector<EllipticCurvePoint> encoded(pointCount);
+    std::unique_ptr<fe[]> scratch(new fe[pointCount == 0 ? 1 : pointCount]);
+
+    /* Compute the points of every ring first. If one of the signatures is malformed, we only
+     * need to look at the ones before it to find the first invalid signature. */
+    size_t failed = checks_count;
+    size_t prepared = 0;
+    size_t offset = 0;
+    for (; prepared < checks_count; prepared++) {
+      const auto &check = checks[prepared];
+      std::vector<const DecodedPublicKey *> pubs;
+      pubs.reserve(check.publicKeys.size());
+      for (const auto &key : check.publicKeys) {
+        pubs.push_back(&key);
+      }
+      if (!ring_signature_points(check.keyImage, pubs.data(), pubs.size(), check.signatures, check.checkKeyImage, &points[offset])) {
+        failed = prepared;
+        break;
+      }
+      offset += 2 * pubs.size();
+    }
+
+    ge_tobytes_batch(reinterpret_cast<unsigned char*>(encoded.data()), points.data(), scratch.get(), offset);
+
+    offset = 0;
+    for (size_t i = 0; i < prepared; i++) {
+      const auto &check = checks[i];
+      if (!ring_signature_challenge_matches(check.prefixHash, &encoded[offset], check.publicKeys.size(), check.signatures)) {
+        return i;
+      }
+      offset += 2 * check.publicKeys.size();
+    }
+
+    return failed;
+  }
 }
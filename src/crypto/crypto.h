@@ -33,6 +33,23 @@ struct EllipticCurveScalar {
   uint8_t data[32];
 };
 
+/* A ring member public key that has already been decompressed and hashed to the curve.
+ * The two members are laid out as ge_p3 points, see crypto-ops.h. */
+struct DecodedPublicKey {
+  int32_t point[40];
+  int32_t hashedPoint[40];
+};
+
+/* A ring signature queued for check_ring_signatures. The signatures must stay
+ * valid until the check has run. */
+struct RingSignatureCheck {
+  Hash prefixHash;
+  KeyImage keyImage;
+  std::vector<DecodedPublicKey> publicKeys;
+  const Signature *signatures;
+  bool checkKeyImage;
+};
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -83,6 +100,14 @@ struct EllipticCurveScalar {
       const PublicKey *const *, size_t, const Signature *, bool);
     friend bool check_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const Signature *, bool);
+    static bool decode_public_key(const PublicKey &, DecodedPublicKey &);
+    friend bool decode_public_key(const PublicKey &, DecodedPublicKey &);
+    static bool check_ring_signature(const Hash &, const KeyImage &,
+      const DecodedPublicKey *const *, size_t, const Signature *, bool);
+    friend bool check_ring_signature(const Hash &, const KeyImage &,
+      const DecodedPublicKey *const *, size_t, const Signature *, bool);
+    static size_t check_ring_signatures(const RingSignatureCheck *, size_t);
+    friend size_t check_ring_signatures(const RingSignatureCheck *, size_t);
 
     public:
 
@@ -239,4 +264,37 @@ struct EllipticCurveScalar {
     const Signature *sig, bool checkKeyImage) {
     return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig, checkKeyImage);
   }
+
+  /* Decompresses a public key and computes its hash_to_ec point, so the result can be reused
+   * by every ring signature the key appears in. Returns false if the key is not a valid point.
+   */
+  inline bool decode_public_key(const PublicKey &pub, DecodedPublicKey &decoded) {
+    return crypto_ops::decode_public_key(pub, decoded);
+  }
+
+  /* Variants taking ring members which have already been decoded with decode_public_key.
+   */
+  inline bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const DecodedPublicKey *const *pubs, size_t pubs_count,
+    const Signature *sig, bool checkKeyImage) {
+    return crypto_ops::check_ring_signature(prefix_hash, image, pubs, pubs_count, sig, checkKeyImage);
+  }
+
+  inline bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const std::vector<const DecodedPublicKey *> &pubs,
+    const Signature *sig, bool checkKeyImage) {
+    return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig, checkKeyImage);
+  }
+
+  /* Checks a batch of ring signatures, such as all the inputs of a block. This is cheaper than checking
+   * them one by one, as the points of every ring share a single field inversion. Returns the index of the
+   * first invalid signature, or the number of checks if they are all valid.
+   */
+  inline size_t check_ring_signatures(const RingSignatureCheck *checks, size_t checks_count) {
+    return crypto_ops::check_ring_signatures(checks, checks_count);
+  }
+
+  inline size_t check_ring_signatures(const std::vector<RingSignatureCheck> &checks) {
+    return check_ring_signatures(checks.data(), checks.size());
+  }
 }
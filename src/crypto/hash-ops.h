@@ -64,6 +64,11 @@ enum {
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
+/* The same as cn_fast_hash() on each of count inputs, which are hashed several at a time */
+void cn_fast_hash_batch(const void *const *data, const size_t *length, size_t count, char (*hashes)[HASH_SIZE]);
+/* For count inputs of length bytes each, one after another. The hashes may be written over
+   the inputs when length is at least HASH_SIZE and less than HASH_DATA_AREA */
+void cn_fast_hash_batch_fixed(const void *data, size_t length, size_t count, char (*hashes)[HASH_SIZE]);
 void cn_slow_hash(const void *data, size_t length, char *hash, int light, int variant, int prehashed, uint32_t page_size, uint32_t scratchpad, uint32_t iterations);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
@@ -35,3 +35,11 @@ void cn_fast_hash(const void *data, size_t length, char *hash) {
   hash_process(&state, data, length);
   memcpy(hash, &state, HASH_SIZE);
 }
+
+void cn_fast_hash_batch(const void *const *data, const size_t *length, size_t count, char (*hashes)[HASH_SIZE]) {
+  keccak_multi((const uint8_t *const *) data, length, count, (uint8_t *) hashes, HASH_SIZE);
+}
+
+void cn_fast_hash_batch_fixed(const void *data, size_t length, size_t count, char (*hashes)[HASH_SIZE]) {
+  keccak_multi_fixed(data, length, count, (uint8_t *) hashes, HASH_SIZE);
+}
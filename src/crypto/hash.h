@@ -54,6 +54,10 @@ namespace Crypto {
     return h;
   }
 
+  inline void cn_fast_hash_batch(const void *const *data, const size_t *length, size_t count, Hash *hashes) {
+    cn_fast_hash_batch(data, length, count, reinterpret_cast<char (*)[HASH_SIZE]>(hashes));
+  }
+
   // Standard CryptoNight
   inline void cn_slow_hash_v0(const void *data, size_t length, Hash &hash) {
     cn_slow_hash(data, length, reinterpret_cast<char *>(&hash), 0, 0, 0, CN_PAGE_SIZE, CN_SCRATCHPAD, CN_ITERATIONS);
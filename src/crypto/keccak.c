@@ -5,6 +5,36 @@
 #include "hash-ops.h"
 #include "keccak.h"
 
+// Several independent states are permuted at once, one per SIMD lane. The
+// lane width is picked at compile time, so building with -march/ARCH for an
+// AVX2 capable cpu hashes four inputs per permutation, and plain x86_64
+// (which always has SSE2) two.
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i keccak_lane_t;
+#define LANE_XOR(a, b)    _mm256_xor_si256(a, b)
+#define LANE_ANDNOT(a, b) _mm256_andnot_si256(a, b)
+#define LANE_ROTL(a, n)   _mm256_or_si256(_mm256_sll_epi64(a, _mm_cvtsi32_si128(n)), \
+                                          _mm256_srl_epi64(a, _mm_cvtsi32_si128(64 - (n))))
+#define LANE_SET1(x)      _mm256_set1_epi64x((long long) (x))
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+typedef __m128i keccak_lane_t;
+#define LANE_XOR(a, b)    _mm_xor_si128(a, b)
+#define LANE_ANDNOT(a, b) _mm_andnot_si128(a, b)
+#define LANE_ROTL(a, n)   _mm_or_si128(_mm_sll_epi64(a, _mm_cvtsi32_si128(n)), \
+                                       _mm_srl_epi64(a, _mm_cvtsi32_si128(64 - (n))))
+#define LANE_SET1(x)      _mm_set1_epi64x((long long) (x))
+#else
+typedef uint64_t keccak_lane_t;
+#define LANE_XOR(a, b)    ((a) ^ (b))
+#define LANE_ANDNOT(a, b) (~(a) & (b))
+#define LANE_ROTL(a, n)   ROTL64(a, n)
+#define LANE_SET1(x)      (x)
+#endif
+
+#define KECCAK_LANES (sizeof(keccak_lane_t) / sizeof(uint64_t))
+
 const uint64_t keccakf_rndc[24] = 
 {
     0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
@@ -117,3 +147,155 @@ void keccak1600(const uint8_t *in, int inlen, uint8_t *md)
 {
     keccak(in, inlen, md, sizeof(state_t));
 }
+
+// keccakf() on KECCAK_LANES interleaved states
+
+static void keccakf_lanes(keccak_lane_t st[25], int rounds)
+{
+    int i, j, round;
+    keccak_lane_t t, bc[5];
+
+    for (round = 0; round < rounds; round++) {
+
+        // Theta
+        for (i = 0; i < 5; i++)
+            bc[i] = LANE_XOR(LANE_XOR(LANE_XOR(LANE_XOR(st[i], st[i + 5]), st[i + 10]), st[i + 15]), st[i + 20]);
+
+        for (i = 0; i < 5; i++) {
+            t = LANE_XOR(bc[(i + 4) % 5], LANE_ROTL(bc[(i + 1) % 5], 1));
+            for (j = 0; j < 25; j += 5)
+                st[j + i] = LANE_XOR(st[j + i], t);
+        }
+
+        // Rho Pi
+        t = st[1];
+        for (i = 0; i < 24; i++) {
+            j = keccakf_piln[i];
+            bc[0] = st[j];
+            st[j] = LANE_ROTL(t, keccakf_rotc[i]);
+            t = bc[0];
+        }
+
+        //  Chi
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++)
+                bc[i] = st[j + i];
+            for (i = 0; i < 5; i++)
+                st[j + i] = LANE_XOR(st[j + i], LANE_ANDNOT(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+        }
+
+        //  Iota
+        st[0] = LANE_XOR(st[0], LANE_SET1(keccakf_rndc[round]));
+    }
+}
+
+// Hashes the inputs in the lanes as they free up, so a long input doesn't
+// hold back the others. Input i is in[i] if in is given, otherwise it is at
+// base + i * stride. The same for the lengths with inlen and fixedlen.
+
+static void keccak_lanes(const uint8_t *const *in, const size_t *inlen, const uint8_t *base, size_t fixedlen,
+                         size_t count, uint8_t *md, int mdlen)
+{
+    union {
+        keccak_lane_t v[25];
+        uint64_t w[25][KECCAK_LANES];
+    } st;
+    const uint8_t *pos[KECCAK_LANES];
+    size_t left[KECCAK_LANES];
+    size_t input[KECCAK_LANES];
+    int busy[KECCAK_LANES];
+    uint8_t temp[144];
+    uint64_t word;
+    size_t lane, next, done;
+    int i, rsiz, rsizw, last[KECCAK_LANES];
+
+    const int HASH_DATA_AREA = 136;
+
+    rsiz = sizeof(state_t) == mdlen ? HASH_DATA_AREA : 200 - 2 * mdlen;
+    rsizw = rsiz / 8;
+
+    memset(&st, 0, sizeof(st));
+
+    for (lane = 0, next = 0; lane < KECCAK_LANES; lane++) {
+        busy[lane] = next < count;
+        if (busy[lane]) {
+            input[lane] = next;
+            pos[lane] = in ? in[next] : base + next * fixedlen;
+            left[lane] = inlen ? inlen[next] : fixedlen;
+            next++;
+        }
+    }
+
+    for (done = 0; done < count; ) {
+        for (lane = 0; lane < KECCAK_LANES; lane++) {
+            if (!busy[lane])
+                continue;
+
+            last[lane] = left[lane] < (size_t) rsiz;
+            if (last[lane]) {
+                // last block and padding
+                memcpy(temp, pos[lane], left[lane]);
+                temp[left[lane]] = 1;
+                memset(temp + left[lane] + 1, 0, rsiz - left[lane] - 1);
+                temp[rsiz - 1] |= 0x80;
+            } else {
+                memcpy(temp, pos[lane], rsiz);
+                pos[lane] += rsiz;
+                left[lane] -= rsiz;
+            }
+
+            for (i = 0; i < rsizw; i++) {
+                memcpy(&word, temp + i * 8, sizeof(word));
+                st.w[i][lane] ^= word;
+            }
+        }
+
+        keccakf_lanes(st.v, KECCAK_ROUNDS);
+
+        for (lane = 0; lane < KECCAK_LANES; lane++) {
+            if (!busy[lane] || !last[lane])
+                continue;
+
+            for (i = 0; i * 8 < mdlen; i++) {
+                word = st.w[i][lane];
+                memcpy(md + input[lane] * mdlen + i * 8, &word, mdlen - i * 8 < 8 ? mdlen - i * 8 : 8);
+            }
+
+            for (i = 0; i < 25; i++)
+                st.w[i][lane] = 0;
+
+            done++;
+            busy[lane] = next < count;
+            if (busy[lane]) {
+                input[lane] = next;
+                pos[lane] = in ? in[next] : base + next * fixedlen;
+                left[lane] = inlen ? inlen[next] : fixedlen;
+                next++;
+            }
+        }
+    }
+}
+
+void keccak_multi(const uint8_t *const *in, const size_t *inlen, size_t count, uint8_t *md, int mdlen)
+{
+    size_t i;
+
+    if (KECCAK_LANES == 1 || count == 1) {
+        for (i = 0; i < count; i++)
+            keccak(in[i], (int) inlen[i], md + i * mdlen, mdlen);
+    } else if (count > 1) {
+        keccak_lanes(in, inlen, NULL, 0, count, md, mdlen);
+    }
+}
+
+void keccak_multi_fixed(const uint8_t *in, size_t inlen, size_t count, uint8_t *md, int mdlen)
+{
+    size_t i;
+
+    if (KECCAK_LANES == 1 || count == 1) {
+        for (i = 0; i < count; i++)
+            keccak(in + i * inlen, (int) inlen, md + i * mdlen, mdlen);
+    } else if (count > 1) {
+        keccak_lanes(NULL, NULL, in, inlen, count, md, mdlen);
+    }
+}
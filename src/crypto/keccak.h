@@ -4,6 +4,7 @@
 #ifndef KECCAK_H
 #define KECCAK_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -23,4 +24,14 @@ void keccakf(uint64_t st[25], int norounds);
 
 void keccak1600(const uint8_t *in, int inlen, uint8_t *md);
 
+// compute the keccak hashes of count independent inputs, several at a time,
+// into md (mdlen bytes each, one after another)
+void keccak_multi(const uint8_t *const *in, const size_t *inlen, size_t count, uint8_t *md, int mdlen);
+
+// the same for count inputs of inlen bytes each, one after another at in. When
+// the inputs are shorter than a block, hash i is only written once inputs 0..i
+// have been read, so the hashes may overwrite the inputs (md <= in and
+// mdlen <= inlen) as when hashing a layer of a Merkle tree in place
+void keccak_multi_fixed(const uint8_t *in, size_t inlen, size_t count, uint8_t *md, int mdlen);
+
 #endif
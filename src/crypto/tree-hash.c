@@ -29,7 +29,7 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
   } else if (count == 2) {
     cn_fast_hash(hashes, 2 * HASH_SIZE, root_hash);
   } else {
-    size_t i, j;
+    size_t i;
     size_t cnt = count - 1;
     char (*ints)[HASH_SIZE];
     for (i = 1; i < 8 * sizeof(size_t); i <<= 1) {
@@ -38,15 +38,11 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
     cnt &= ~(cnt >> 1);
     ints = alloca(cnt * HASH_SIZE);
     memcpy(ints, hashes, (2 * cnt - count) * HASH_SIZE);
-    for (i = 2 * cnt - count, j = 2 * cnt - count; j < cnt; i += 2, ++j) {
-      cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-    }
-    assert(i == count);
+    /* Each layer is hashed in one batch, in place for all but the first */
+    cn_fast_hash_batch_fixed(hashes[2 * cnt - count], 2 * HASH_SIZE, count - cnt, ints + (2 * cnt - count));
     while (cnt > 2) {
       cnt >>= 1;
-      for (i = 0, j = 0; j < cnt; i += 2, ++j) {
-        cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-      }
+      cn_fast_hash_batch_fixed(ints, 2 * HASH_SIZE, cnt, ints);
     }
     cn_fast_hash(ints[0], 2 * HASH_SIZE, root_hash);
   }
@@ -66,7 +62,7 @@ size_t tree_depth(size_t count) {
 }
 
 void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[HASH_SIZE]) {
-  size_t i, j;
+  size_t i;
   size_t cnt = 1;
   size_t depth = 0;
   char (*ints)[HASH_SIZE];
@@ -81,18 +77,13 @@ void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[H
   assert(depth == tree_depth(count));
   ints = alloca((cnt - 1) * HASH_SIZE);
   memcpy(ints, hashes + 1, (2 * cnt - count - 1) * HASH_SIZE);
-  for (i = 2 * cnt - count, j = 2 * cnt - count - 1; j < cnt - 1; i += 2, ++j) {
-    cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-  }
-  assert(i == count);
+  cn_fast_hash_batch_fixed(hashes[2 * cnt - count], 2 * HASH_SIZE, count - cnt, ints + (2 * cnt - count - 1));
   while (depth > 0) {
     assert(cnt == 1ULL << depth);
     cnt >>= 1;
     --depth;
     memcpy(branch[depth], ints[0], HASH_SIZE);
-    for (i = 1, j = 0; j < cnt - 1; i += 2, ++j) {
-      cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-    }
+    cn_fast_hash_batch_fixed(ints[1], 2 * HASH_SIZE, cnt - 1, ints);
   }
 }
 
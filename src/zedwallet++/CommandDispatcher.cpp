@@ -75,6 +75,10 @@ bool handleCommand(
     {
         changePassword(walletBackend);
     }
+    else if (command == "export_json")
+    {
+        exportJson(walletBackend);
+    }
     else if (command == "make_integrated_address")
     {
         createIntegratedAddress();
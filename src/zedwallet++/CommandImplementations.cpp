@@ -6,6 +6,7 @@
 #include <zedwallet++/CommandImplementations.h>
 ///////////////////////////////////////////////
 
+#include <Common/FileSystemShim.h>
 #include <Common/FormatTools.h>
 
 #include <config/WalletConfig.h>
@@ -504,6 +505,72 @@ void save(const std::shared_ptr<WalletBackend> walletBackend)
     }
 }
 
+void exportJson(const std::shared_ptr<WalletBackend> walletBackend)
+{
+    std::cout << InformationMsg("Saving a copy of your wallet in the JSON ")
+              << InformationMsg("wallet format, which older versions of ")
+              << InformationMsg("zedwallet++ can open.")
+              << std::endl << std::endl
+              << WarningMsg("Your current wallet file was converted to the ")
+              << WarningMsg("new format when it was first saved. Older ")
+              << WarningMsg("versions report a wrong password for it, use ")
+              << WarningMsg("the exported copy with them instead.")
+              << std::endl << std::endl;
+
+    std::string filename;
+
+    while (true)
+    {
+        std::cout << InformationMsg("What would you like to call the ")
+                  << InformationMsg("exported wallet?: ");
+
+        std::getline(std::cin, filename);
+
+        ZedUtilities::trim(filename);
+
+        try
+        {
+            if (filename == "")
+            {
+                std::cout << WarningMsg("\nFilename can't be blank! Try again.\n\n");
+            }
+            else if (fs::exists(filename))
+            {
+                std::cout << std::endl
+                          << WarningMsg("A file with the filename ")
+                          << InformationMsg(filename)
+                          << WarningMsg(" already exists!")
+                          << std::endl
+                          << "Try another name." << std::endl << std::endl;
+            }
+            else
+            {
+                break;
+            }
+        }
+        catch (const fs::filesystem_error &)
+        {
+            std::cout << WarningMsg("\nInvalid filename! Try again.\n\n");
+        }
+    }
+
+    std::cout << InformationMsg("Exporting.") << std::endl;
+
+    WalletError error = walletBackend->exportJsonWallet(filename);
+
+    if (error)
+    {
+        std::cout << WarningMsg("Failed to export wallet! Error: ")
+                  << WarningMsg(error) << std::endl;
+    }
+    else
+    {
+        std::cout << SuccessMsg("Wallet exported to ")
+                  << SuccessMsg(filename)
+                  << SuccessMsg("!") << std::endl;
+    }
+}
+
 void createIntegratedAddress()
 {
     std::cout << InformationMsg("Creating an integrated address from an ")
@@ -39,6 +39,8 @@ void saveCSV(const std::shared_ptr<WalletBackend> walletBackend);
 
 void save(const std::shared_ptr<WalletBackend> walletBackend);
 
+void exportJson(const std::shared_ptr<WalletBackend> walletBackend);
+
 void listTransfers(
     const bool incoming,
     const bool outgoing, 
@@ -53,6 +53,7 @@ std::vector<AdvancedCommand> allCommands()
         AdvancedCommand("ab_list", "List everyone in your address book", true, true),
         AdvancedCommand("ab_send", "Send " + WalletConfig::ticker + " to someone in your address book", false, true),
         AdvancedCommand("change_password", "Change your wallet password", true, true),
+        AdvancedCommand("export_json", "Save a copy of your wallet older versions can open", true, true),
         AdvancedCommand("make_integrated_address", "Make a combined address + payment ID", true, true),
         AdvancedCommand("incoming_transfers", "Show incoming transfers", true, true),
         AdvancedCommand("list_transfers", "Show all transfers", false, true),